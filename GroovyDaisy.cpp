@@ -6,7 +6,8 @@
  * - Play/Stop/Record state controllable from companion
  * - Tempo control with BPM display
  * - Position tracking (bar:beat:tick)
- * - MIDI input from KeyLab via UART, forwarded to companion
+ * - MIDI input from KeyLab via UART (parsed in ISR, applied sample-accurately
+ *   in the audio callback), forwarded to companion
  * - Pod buttons: Button1=Play/Stop, Button2=Record toggle
  * - Encoder: Adjust tempo
  * - 8-voice sample drum engine triggered by KeyLab pads (notes 36-43)
@@ -19,73 +20,245 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
 #include "daisy_pod.h"
 #include "daisysp.h"
 #include "protocol.h"
+#include "protocol_codec.h"
 #include "transport.h"
 #include "sampler.h"
 #include "sequencer.h"
 #include "synth.h"
 #include "cc_map.h"
 #include "midi_router.h"
+#include "midi_input.h"
 #include "automation.h"
 #include "audio_track.h"
+#include "memory_map.h"
+#include "spsc_queue.h"
+#include "engine_command.h"
+#include "usb_tx.h"
+#include "pattern_transfer.h"
+#include "state_sync.h"
+#include "reliable_link.h"
+#include "clock_sync.h"
+#include "telemetry.h"
+#include "task_scheduler.h"
+#include "session.h"
+#include "smf.h"
+#include "audio_config.h"
 #include "samples/drums.h"
 #include "util/CpuLoadMeter.h"
 
 using namespace daisy;
 using namespace daisysp;
+namespace Codec = ProtocolCodec;
 
 DaisyPod hw;
-Transport::Engine transport;
-Sampler::Engine sampler;
-Sequencer::Engine sequencer;
-Synth::Engine synth;
-Automation::Engine automation;
+
+// Hot per-sample engine state in DTCM (see memory_map.h)
+Transport::Engine HOT_STATE_DTCM transport;
+Sampler::Engine HOT_STATE_DTCM sampler;
+Synth::Engine HOT_STATE_DTCM synth;
+CCMap::Engine HOT_STATE_DTCM cc_engine;
+CCMap::Coalescer HOT_STATE_DTCM cc_coalescer;  // CC -> parameter updates, once per block
+
+// Audio track manager for freeze/unfreeze operations (slot state read per sample)
+AudioTrack::Manager HOT_STATE_DTCM audio_track_manager;
+
+// Bulk event/automation storage in AXI SRAM (touched per tick, not per sample)
+Sequencer::Engine BULK_STATE_AXI sequencer;
+Automation::Engine BULK_STATE_AXI automation;
 MidiRouter::Router midi_router;
-CCMap::Engine cc_engine;
 
 // Sample bank in SDRAM (must be at global scope with DSY_SDRAM_BSS)
-DrumSamples::SampleBank DSY_SDRAM_BSS sample_bank;
+DrumSamples::SampleBank COLD_AUDIO_SDRAM sample_bank;
 
 // Audio track buffers in SDRAM for frozen tracks (3 slots × stereo × 32 sec max)
-float DSY_SDRAM_BSS frozen_track_L[AudioTrack::NUM_FROZEN_SLOTS][AudioTrack::MAX_TRACK_SAMPLES];
-float DSY_SDRAM_BSS frozen_track_R[AudioTrack::NUM_FROZEN_SLOTS][AudioTrack::MAX_TRACK_SAMPLES];
-
-// Audio track manager for freeze/unfreeze operations
-AudioTrack::Manager audio_track_manager;
+float COLD_AUDIO_SDRAM frozen_track_L[AudioTrack::NUM_FROZEN_SLOTS][AudioTrack::MAX_TRACK_SAMPLES];
+float COLD_AUDIO_SDRAM frozen_track_R[AudioTrack::NUM_FROZEN_SLOTS][AudioTrack::MAX_TRACK_SAMPLES];
+
+// Compile-time check that the placement fits each region's budget
+static_assert(sizeof(transport) + sizeof(sampler) + sizeof(synth) + sizeof(cc_engine) +
+                  sizeof(cc_coalescer) + sizeof(audio_track_manager) <= MemoryMap::DTCM_HOT_BUDGET,
+              "Hot engine state exceeds DTCM budget");
+static_assert(sizeof(sequencer) + sizeof(automation) <= MemoryMap::AXI_BULK_BUDGET,
+              "Bulk engine state exceeds AXI SRAM budget");
+static_assert(sizeof(sample_bank) + sizeof(frozen_track_L) + sizeof(frozen_track_R)
+                  <= MemoryMap::SDRAM_SIZE,
+              "Audio buffers exceed SDRAM");
 
 // CPU load meter for diagnostics
 CpuLoadMeter cpu_meter;
 
-// Playback queue for sequencer events -> main loop (for MIDI Monitor)
-// Audio callback queues events, main loop sends to companion
-struct PlaybackEvent { uint8_t status; uint8_t data1; uint8_t data2; };
-constexpr size_t PLAYBACK_QUEUE_SIZE = 64;
-PlaybackEvent playback_queue[PLAYBACK_QUEUE_SIZE];
-volatile uint8_t playback_queue_head = 0;
-volatile uint8_t playback_queue_tail = 0;
+// All audio <-> main loop traffic goes through SPSC queues (see spsc_queue.h)
 
-// Debug counters for tracking playback events
-volatile uint32_t debug_noteon_queued = 0;
-volatile uint32_t debug_noteoff_queued = 0;
-volatile uint32_t debug_queue_full = 0;
+// Audio callback -> main loop: sequencer and live MIDI events for the MIDI Monitor
+struct MonitorEvent { uint8_t status; uint8_t data1; uint8_t data2; };
+static Spsc::Queue<MonitorEvent, 64> monitor_queue;
 
-// Flag to send transport state update
-static volatile bool send_transport_update = false;
-
-// Flag to send track state update (after freeze completes)
-static volatile bool send_track_state_update = false;
-
-// Staggered pattern dump state (to avoid USB buffer overflow)
-static uint8_t pending_dump_track = 0xFF;  // 0xFF = no pending dump
-static uint32_t last_dump_time = 0;
-constexpr uint32_t DUMP_INTERVAL_MS = 10;  // 10ms between track dumps
+// Audio callback -> main loop: events for the main loop to act on. They
+// carry no payload, so each is a sticky pending bit: posting one twice
+// before the main loop looks is a single report, and none can be lost.
+// (Transport, synth and voice state reach the companion via state sync.)
+enum class Notify : uint8_t
+{
+    TRACK_STATE,  // Freeze started recording or finished
+    CC_BANK,      // CC bank switched (by command or by CC)
+    LIVE_NOTE,    // Live note on (LED flash)
+};
+static std::atomic<uint32_t> notify_pending{0};
+
+// Audio callback -> main loop: freeze/unfreeze command results. Freeze
+// commands come one at a time from the main loop, so this never fills.
+struct FreezeResult { uint8_t freeze; uint8_t ok; };  // freeze: 1 freeze / 0 unfreeze
+static Spsc::Queue<FreezeResult, 8> freeze_queue;
+
+// Audio callback -> main loop: stored session applied (LOAD_SESSION complete).
+// A sticky flag rather than a notification, so a full queue cannot leave
+// session saving disabled until the next boot.
+static std::atomic<bool> session_loaded{false};
+
+// Main loop -> audio callback: engine commands, applied at block start (see engine_command.h)
+static EngineCommand::Queue    engine_queue;
+static EngineCommand::Executor engine_executor;
+
+// Live MIDI input: UART bytes are parsed in the receive ISR into a
+// timestamped queue that the audio callback drains at block start
+UartHandler midi_uart;
+static uint8_t DMA_BUFFER_MEM_SECTION midi_rx_dma[64];
+static MidiInput::Parser      midi_parser;
+static MidiInput::EventQueue  midi_in_queue;
+static MidiInput::SampleClock midi_clock;
+
+// Full-pattern sync to the companion (credit-based bulk transfer)
+static PatternTransfer::Sender pattern_sender;
+
+// Playhead anchors: published by the audio callback, sent when the companion's
+// extrapolation would drift (replaces periodic MSG_TICK)
+static ClockSync::Publisher clock_publisher;
+static ClockSync::Scheduler clock_scheduler;
+
+// Optional level/scope/spectrum stream: the audio callback taps the buses,
+// the main loop analyzes and sends within a CPU budget (off until configured)
+static Telemetry::Tap      telemetry_tap;
+static Telemetry::Analyzer telemetry;
+static_assert(Codec::Telemetry::NUM_BUSES == Telemetry::NUM_BUSES, "Telemetry buses out of step");
+static_assert(Telemetry::SCOPE_POINTS <= Codec::Telemetry::MAX_SCOPE
+                  && Telemetry::NUM_BANDS <= Codec::Telemetry::MAX_BANDS,
+              "Telemetry frame does not fit MSG_TELEMETRY");
+
+// CRC framing + retransmit history for bulk messages (off until the companion asks)
+static ReliableLink::History link_history;
+
+// Companion state mirror, sent as versioned deltas once per frame
+static StateSync::Tracker state_sync;
+static_assert(StateSync::NUM_FADER_FIELDS == CCMap::NUM_FADERS, "Fader fields out of step");
+static_assert(StateSync::NUM_SYNTH_FIELDS == Synth::PARAM_LEVEL + 1, "Synth fields out of step");
+static_assert(StateSync::NUM_TRACK_FIELDS == 2 * AudioTrack::Manager::NUM_SYNTH_TRACKS,
+              "Track fields out of step");
+static_assert(StateSync::NUM_MOD_FIELDS == Synth::PARAM_COUNT - Synth::PARAM_LFO1_RATE,
+              "Mod fields out of step");
+
+// MIDI Monitor batching: queued events go out as one message per frame
+constexpr uint32_t MONITOR_FRAME_MS = 16;  // ~60 fps
+constexpr uint32_t VOICE_DIAG_MS    = 250;
+static_assert(Synth::NUM_VOICES <= Codec::VoiceDiag::MAX_VOICES, "Voices do not fit MSG_VOICE_DIAG");
+
+// Session snapshot in QSPI flash (see session.h): restored at boot, saved
+// in the background as chunks change
+static Session::Directory            session_dir;
+static Session::Saver BULK_STATE_AXI session_saver;
+constexpr uint32_t SESSION_BUDGET_US = 300;  // Per scheduler run (a sector erase always overruns)
+static_assert(Session::NUM_PATTERNS == Sequencer::NUM_TOTAL_TRACKS
+                  && Session::MAX_PATTERN_EVENTS == Sequencer::MAX_EVENTS_PER_TRACK,
+              "Session patterns out of step");
+static_assert(Session::NUM_AUTO_LANES == Automation::NUM_AUTO_CCS
+                  && Session::MAX_AUTO_POINTS == Automation::MAX_AUTO_POINTS,
+              "Session automation out of step");
+constexpr bool SessionLanesMatch()
+{
+    for(uint8_t i = 0; i < Session::NUM_AUTO_LANES; i++)
+    {
+        if(Session::AUTO_LANE_CCS[i] != Automation::AUTO_CCS[i])
+            return false;
+    }
+    return true;
+}
+static_assert(SessionLanesMatch(), "Session lane CCs out of step");
+static_assert(Session::MAX_SYNTH_PARAMS >= Synth::PARAM_COUNT, "Synth params do not fit the session");
+static_assert(Session::NUM_SYNTH_TRACKS == AudioTrack::Manager::NUM_SYNTH_TRACKS,
+              "Session tracks out of step");
+
+// Sample rate and block size (see audio_config.h). audio_settings is the
+// session's choice; a benchmark run steps the hardware through the matrix
+// (audio_running) and back to it, one cell per resource report.
+struct AudioBenchState
+{
+    bool     active;
+    uint8_t  cell;        // Cell being measured
+    uint32_t applied_ms;  // When its settings took effect
+};
+static AudioConfig::Settings audio_settings = AudioConfig::DEFAULTS;
+static AudioConfig::Settings audio_running  = AudioConfig::DEFAULTS;
+static AudioBenchState       audio_bench;
+constexpr uint32_t AUDIO_BENCH_SETTLE_MS = 900;  // CPU meter smoothing (1 Hz) settles first
+static_assert(AudioConfig::NUM_BENCH_CELLS <= 0xFF, "Bench cells do not fit MSG_AUDIO_BENCH");
+
+// Standard MIDI File import/export (see smf.h). Imported chunks are parsed
+// here and the mapped events queued to the audio callback, which adds them
+// once the RESET_AND_CLEAR ahead of them has run; a chunk is acknowledged
+// when the queue has room for the next one, so the companion is paced by
+// the engine. Exports are produced a chunk per CMD_SMF_EXPORT.
+struct SmfImportState
+{
+    bool     active;         // Parsing a file
+    bool     reply_pending;  // Last chunk not acknowledged yet
+    bool     tempo_set;      // First tempo event applied
+    uint32_t total;          // File size
+    uint16_t notes;
+    uint16_t points;
+    uint16_t dropped;        // Past the pattern end
+};
+static Smf::Parser    smf_parser;
+static Smf::Writer    smf_writer;
+static bool           smf_export_started = false;
+static SmfImportState smf_import;
+static Spsc::Queue<Sequencer::MidiEvent, 128> import_queue;
+static volatile uint16_t import_rejected = 0;  // Audio callback: track or lane full
+constexpr uint32_t IMPORT_EVENTS_PER_BLOCK = 16;
+// Most events one chunk can complete: every 3 bytes (delta + 2 data bytes),
+// plus one event split across the previous chunk and finished in this one
+constexpr uint32_t IMPORT_CHUNK_EVENTS     = Codec::SmfImport::MAX_DATA / 3 + 1;
+constexpr uint8_t  SMF_EXPORT_TRACKS = Sequencer::NUM_TOTAL_TRACKS + Automation::NUM_AUTO_CCS;
+static_assert(decltype(import_queue)::Capacity() >= IMPORT_CHUNK_EVENTS,
+              "Import queue cannot hold a chunk");
+
+// Drum read-stall profiling: worst per-block sampler time, reported with the
+// periodic diagnostics. Build with SAMPLER_ATTACK_CACHE=0 and =1 to compare.
+#ifndef PROFILE_DRUM_STALLS
+#define PROFILE_DRUM_STALLS 0
+#endif
+#if PROFILE_DRUM_STALLS
+static volatile uint32_t drum_ticks_max = 0;  // System ticks (see System::GetTickFreq)
+#endif
+
+// Active voice counts, stored by the audio callback every block (state sync fields)
+static std::atomic<uint8_t> synth_voice_count{0};
+static std::atomic<uint8_t> drum_voice_count{0};
+
+inline uint32_t NotifyBit(Notify type)
+{
+    return 1u << static_cast<uint8_t>(type);
+}
 
-// Voice count tracking for MSG_VOICES
-static volatile uint8_t last_synth_count = 0;
-static volatile uint8_t last_drum_count = 0;
-static volatile bool send_voices_update = false;
+/**
+ * Flag an event for the main loop (audio callback only)
+ */
+inline void PostNotification(Notify type)
+{
+    notify_pending.fetch_or(NotifyBit(type), std::memory_order_release);
+}
 
 /**
  * Record callback - called by router to record events to sequencer
@@ -103,73 +276,15 @@ void ApplyParamTarget(CCMap::ParamTarget target, uint8_t cc_value)
 {
     using namespace CCMap;
 
-    switch(target)
+    // Synth parameters: curve and param id come from the CC tables
+    if(IsSynthTarget(target))
     {
-        // Synth parameters
-        case TARGET_SYNTH_OSC1_WAVE:
-            synth.SetParam(Synth::PARAM_OSC1_WAVE, CCToWave(cc_value));
-            break;
-        case TARGET_SYNTH_OSC2_WAVE:
-            synth.SetParam(Synth::PARAM_OSC2_WAVE, CCToWave(cc_value));
-            break;
-        case TARGET_SYNTH_OSC1_LEVEL:
-            synth.SetParam(Synth::PARAM_OSC1_LEVEL, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_OSC2_LEVEL:
-            synth.SetParam(Synth::PARAM_OSC2_LEVEL, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_OSC2_DETUNE:
-            synth.SetParam(Synth::PARAM_OSC2_DETUNE, CCToSemitones(cc_value));
-            break;
-        case TARGET_SYNTH_FILTER_CUTOFF:
-            synth.SetParam(Synth::PARAM_FILTER_CUTOFF, CCToFreq(cc_value));
-            break;
-        case TARGET_SYNTH_FILTER_RES:
-            synth.SetParam(Synth::PARAM_FILTER_RES, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_FILTER_ENV_AMT:
-            synth.SetParam(Synth::PARAM_FILTER_ENV_AMT, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_AMP_ATTACK:
-            synth.SetParam(Synth::PARAM_AMP_ATTACK, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_AMP_DECAY:
-            synth.SetParam(Synth::PARAM_AMP_DECAY, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_AMP_SUSTAIN:
-            synth.SetParam(Synth::PARAM_AMP_SUSTAIN, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_AMP_RELEASE:
-            synth.SetParam(Synth::PARAM_AMP_RELEASE, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_FILT_ATTACK:
-            synth.SetParam(Synth::PARAM_FILT_ATTACK, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_FILT_DECAY:
-            synth.SetParam(Synth::PARAM_FILT_DECAY, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_FILT_SUSTAIN:
-            synth.SetParam(Synth::PARAM_FILT_SUSTAIN, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_FILT_RELEASE:
-            synth.SetParam(Synth::PARAM_FILT_RELEASE, CCToTime(cc_value));
-            break;
-        case TARGET_SYNTH_VEL_TO_AMP:
-            synth.SetParam(Synth::PARAM_VEL_TO_AMP, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_VEL_TO_FILTER:
-            synth.SetParam(Synth::PARAM_VEL_TO_FILTER, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_LEVEL:
-            synth.SetParam(Synth::PARAM_LEVEL, CCToNorm(cc_value));
-            break;
-        case TARGET_SYNTH_PAN:
-            synth.SetParam(Synth::PARAM_PAN, CCToPan(cc_value));
-            break;
-        case TARGET_SYNTH_MASTER_LEVEL:
-            synth.SetParam(Synth::PARAM_MASTER_LEVEL, CCToNorm(cc_value));
-            break;
+        ApplySynthTarget(target, cc_value, synth);
+        return;
+    }
 
+    switch(target)
+    {
         // Drum levels
         case TARGET_DRUM_1_LEVEL:
             sampler.SetLevel(0, CCToNorm(cc_value));
@@ -247,10 +362,17 @@ void AutomationPlaybackCallback(uint8_t cc, uint8_t value)
     // For now, apply to synth directly since automation is synth-focused
     uint8_t out_value;
     CCMap::ParamTarget target = cc_engine.ProcessCC(cc, value, out_value);
-    if(target != CCMap::TARGET_NONE)
-    {
-        ApplyParamTarget(target, out_value);
-    }
+    cc_coalescer.Set(target, out_value);  // Applied at block end
+}
+
+/**
+ * Queue an event for the MIDI Monitor (sent to companion by the main loop)
+ * Called from the audio callback for sequencer and live events
+ */
+void QueueMonitorEvent(uint8_t status, uint8_t data1, uint8_t data2)
+{
+    MonitorEvent e = {status, data1, data2};
+    monitor_queue.Push(e);  // Full queue counts an overflow (reported in diagnostics)
 }
 
 /**
@@ -259,53 +381,419 @@ void AutomationPlaybackCallback(uint8_t cc, uint8_t value)
  */
 void SequencerPlaybackCallback(uint8_t status, uint8_t data1, uint8_t data2)
 {
-    // Queue for MIDI Monitor (processed in main loop)
-    uint8_t next = (playback_queue_head + 1) % PLAYBACK_QUEUE_SIZE;
-    if(next != playback_queue_tail)  // Not full
+    QueueMonitorEvent(status, data1, data2);
+
+    // Trigger sound immediately (real-time path, same routing table as live input)
+    midi_router.RouteEvent(status, data1, data2, MidiRouter::Source::SEQUENCER);
+}
+
+/**
+ * Apply a live MIDI event - called from audio callback at the event's sample offset
+ * Sound, recording and automation happen here; the companion is notified
+ * through the monitor queue (no USB traffic from the audio callback)
+ */
+void ApplyLiveMidi(uint8_t status, uint8_t data1, uint8_t data2)
+{
+    uint8_t  channel   = status & 0x0F;
+    uint8_t  type      = status & 0xF0;
+    bool     recording = transport.IsRecording();
+    uint32_t tick      = transport.GetPosition().tick;
+
+    switch(type)
     {
-        playback_queue[playback_queue_head].status = status;
-        playback_queue[playback_queue_head].data1 = data1;
-        playback_queue[playback_queue_head].data2 = data2;
-        playback_queue_head = next;
+        case 0x90:
+            // Per MIDI spec: NoteOn with velocity=0 is NoteOff
+            if(data2 == 0)
+            {
+                midi_router.RouteNoteOff(channel, data1,
+                                         MidiRouter::Source::LIVE_INPUT,
+                                         recording, tick);
+            }
+            else
+            {
+                PostNotification(Notify::LIVE_NOTE);  // Flash LED on note on
+                midi_router.RouteNoteOn(channel, data1, data2,
+                                        MidiRouter::Source::LIVE_INPUT,
+                                        recording, tick);
+            }
+            break;
+
+        case 0x80:
+            midi_router.RouteNoteOff(channel, data1,
+                                     MidiRouter::Source::LIVE_INPUT,
+                                     recording, tick);
+            break;
+
+        case 0xB0:
+        {
+            // Route through bank-aware CC engine
+            uint8_t out_value;
+            CCMap::ParamTarget target = cc_engine.ProcessCC(data1, data2, out_value);
+            cc_coalescer.Set(target, out_value);  // Last value per block wins
+
+            // Mod matrix wheel source. Not CC 1: on the KeyLab that is the
+            // bank-next button, handled by ProcessCC above.
+            if(channel == Synth::SYNTH_CHANNEL && data1 == CCMap::MOD_WHEEL)
+            {
+                synth.SetModWheel(CCMap::CCToNorm(data2));
+            }
+
+            // Forward CC to companion for MIDI monitor
+            // (bank changes are reported at the end of the audio block)
+            QueueMonitorEvent(status, data1, data2);
+
+            // Automation: record CC if automated and in record mode
+            if(channel == Synth::SYNTH_CHANNEL && automation.IsAutomatedCC(data1))
+            {
+                // Always update current value for blend tracking
+                automation.UpdateCurrentValue(data1, data2);
+
+                if(recording)
+                {
+                    automation.RecordCC(tick, data1, data2);
+                }
+            }
+            break;
+        }
+
+        case 0xA0:  // Poly pressure
+        case 0xD0:  // Channel pressure
+        case 0xE0:  // Pitch bend
+            // Not routed to engines yet - forward to companion only
+            QueueMonitorEvent(status, data1, data2);
+            break;
 
-        // Debug: track what's being queued
-        uint8_t type = status & 0xF0;
-        if(type == 0x90 && data2 > 0)
-            debug_noteon_queued++;
-        else if(type == 0x80 || (type == 0x90 && data2 == 0))
-            debug_noteoff_queued++;
+        default:
+            // Program change is not handled yet
+            break;
     }
-    else
+}
+
+/**
+ * UART receive callback (ISR context) - parse MIDI bytes into the
+ * timestamped live input queue
+ */
+void MidiUartRxCallback(uint8_t* data, size_t size, void* context, UartHandler::Result result)
+{
+    (void)context;
+    if(result != UartHandler::Result::OK)
+        return;
+
+    // One stamp per DMA chunk: the chunk is delivered on line idle
+    uint32_t now = midi_clock.Stamp(System::GetTick());
+
+    for(size_t i = 0; i < size; i++)
     {
-        debug_queue_full++;
+        MidiInput::TimedEvent e;
+        if(midi_parser.Feed(data[i], e.status, e.data1, e.data2))
+        {
+            e.sample_time = now;
+            midi_in_queue.Push(e);
+        }
     }
+}
+
+/**
+ * Sample offset of a live event within the block that starts rendering
+ * events stamped from window_start
+ */
+inline size_t LiveEventOffset(const MidiInput::TimedEvent& e, uint32_t window_start)
+{
+    if(MidiInput::IsBefore(e.sample_time, window_start))
+        return 0;  // Late event - apply at block start
+    return e.sample_time - window_start;
+}
 
-    // Trigger sound immediately (real-time path)
-    uint8_t channel = status & 0x0F;
-    uint8_t type = status & 0xF0;
+// LOAD_SESSION progress between steps (audio callback only)
+struct SessionLoad
+{
+    uint8_t  chunk;      // Chunk being applied
+    size_t   pos;        // Reader offset of the next event (0 = chunk not started)
+    uint32_t remaining;  // Events left in a pattern/automation chunk
+    uint32_t tick;       // Running tick of the delta encoding
+    uint8_t  lane;       // Automation lane of an AUTO chunk
+};
+static SessionLoad session_load;
+
+/**
+ * Apply the next part of a stored session chunk (audio callback, LOAD_SESSION)
+ * Pattern and automation chunks are decoded Session::LOAD_STEP_EVENTS
+ * events per call, everything else in one. Returns true when the chunk is
+ * done. Chunks that fail to decode leave that part of the engine as it was.
+ */
+bool ApplySessionChunk(SessionLoad& load)
+{
+    using namespace Session;
+
+    uint8_t      id    = load.chunk;
+    const Chunk& chunk = session_dir.Get(id);
+    if(!chunk.valid)
+        return true;
+    Codec::Reader r(chunk.data, chunk.len);
+    r.pos = load.pos;
 
-    if(channel == Sequencer::DRUM_CHANNEL)
+    if(id == CHUNK_TRANSPORT)
+    {
+        uint16_t bpm   = r.U16();
+        uint8_t  flags = r.U8();
+        if(!r.ok)
+            return true;
+        transport.SetBpm(bpm);
+        sequencer.SetOverdubMode(flags & TRANSPORT_OVERDUB);
+        automation.SetBlendEnabled(flags & TRANSPORT_BLEND);
+    }
+    else if(id == CHUNK_MIXER)
+    {
+        float levels[NUM_DRUMS], pans[NUM_DRUMS];
+        for(uint8_t i = 0; i < NUM_DRUMS; i++)
+            levels[i] = r.F32();
+        for(uint8_t i = 0; i < NUM_DRUMS; i++)
+            pans[i] = r.F32();
+        float drum_master = r.F32();
+        float master_out  = r.F32();
+        if(!r.ok)
+            return true;
+        for(uint8_t i = 0; i < NUM_DRUMS; i++)
+        {
+            sampler.SetLevel(i, levels[i]);
+            sampler.SetPan(i, pans[i]);
+        }
+        sampler.SetMasterLevel(drum_master);
+        cc_engine.SetMasterOutput(master_out);
+    }
+    else if(id == CHUNK_SYNTH)
+    {
+        // Parameters added since the save keep their current values
+        uint8_t count = r.U8();
+        for(uint8_t i = 0; i < count && i < Synth::PARAM_COUNT; i++)
+        {
+            float value = r.F32();
+            if(r.ok)
+                synth.SetParam(static_cast<Synth::ParamId>(i), value);
+        }
+    }
+    else if(id < CHUNK_AUTO)
+    {
+        uint8_t track = id - CHUNK_PATTERN;
+        if(load.pos == 0)
+        {
+            load.remaining = r.Varint();
+            load.tick      = 0;
+            sequencer.ClearTrack(track);
+        }
+        for(uint32_t i = 0; i < LOAD_STEP_EVENTS && load.remaining > 0 && r.ok; i++, load.remaining--)
+        {
+            Sequencer::MidiEvent ev;
+            ev.tick   = GetTick(r, load.tick);
+            ev.status = r.U8();
+            ev.data1  = r.U8();
+            ev.data2  = r.U8();
+            if(r.ok && !sequencer.AppendEvent(track, ev))
+                return true;
+        }
+        load.pos = r.pos;
+        return !r.ok || load.remaining == 0;
+    }
+    else if(id < CHUNK_TRACKS)
+    {
+        if(load.pos == 0)
+        {
+            uint8_t cc     = r.U8();
+            load.lane      = automation.GetCCIndex(cc);
+            load.remaining = r.Varint();
+            load.tick      = 0;
+            if(!r.ok || load.lane >= Automation::NUM_AUTO_CCS)
+                return true;
+            automation.ClearCC(cc);
+        }
+        for(uint32_t i = 0; i < LOAD_STEP_EVENTS && load.remaining > 0 && r.ok; i++, load.remaining--)
+        {
+            uint32_t t     = GetTick(r, load.tick);
+            uint8_t  value = r.U8();
+            if(r.ok && !automation.AppendPoint(load.lane, t, value))
+                return true;
+        }
+        load.pos = r.pos;
+        return !r.ok || load.remaining == 0;
+    }
+    else if(id == CHUNK_TRACKS)
     {
-        // Drum note - trigger sampler
-        if(type == 0x90 && data2 > 0)
+        // Frozen audio is not stored: tracks are re-rendered on the next loop
+        uint8_t count = r.U8();
+        for(uint8_t i = 0; i < count && i < NUM_SYNTH_TRACKS; i++)
         {
-            sampler.TriggerMidi(channel, data1, data2);
+            if(r.U8() && r.ok)
+                audio_track_manager.StartFreeze(i);
         }
     }
-    else if(channel == Sequencer::SYNTH_CHANNEL)
+    return true;
+}
+
+/**
+ * Apply one step of a command queued by the main loop
+ * Called by engine_executor at block start. Returns true when complete.
+ */
+bool ApplyEngineCommand(const EngineCommand::Command& cmd, uint16_t step)
+{
+    using EngineCommand::Type;
+
+    switch(cmd.type)
     {
-        // Synth note - trigger synth
-        if(type == 0x90 && data2 > 0)
+        case Type::PLAY:
+            // Capture base values for blend mode before starting
+            automation.CaptureBaseValues();
+            automation.ResetPlayback();
+            transport.Play();
+            return true;
+
+        case Type::STOP:
+            transport.Stop();
+            synth.AllNotesOff();
+            sequencer.ResetPlayback();
+            automation.ResetPlayback();
+            if(cmd.arg)
+            {
+                audio_track_manager.ResetPlayheads();
+            }
+            return true;
+
+        case Type::RESET_AND_CLEAR:
+        {
+            // One track per step: step 0 stops, then sequencer tracks, then
+            // automation lanes, then a final rewind
+            constexpr uint16_t SEQ_END  = 1 + Sequencer::NUM_TOTAL_TRACKS;
+            constexpr uint16_t AUTO_END = SEQ_END + Automation::NUM_AUTO_CCS;
+            if(step == 0)
+            {
+                transport.StopAndReset();
+            }
+            else if(step < SEQ_END)
+            {
+                sequencer.ClearTrack(step - 1);
+            }
+            else if(step < AUTO_END)
+            {
+                automation.ClearCC(Automation::AUTO_CCS[step - SEQ_END]);
+            }
+            else
+            {
+                sequencer.ResetPlayback();
+                automation.ResetPlayback();
+                return true;
+            }
+            return false;
+        }
+
+        case Type::TOGGLE_RECORD:
+            transport.ToggleRecord();
+            if(transport.IsRecording())
+            {
+                sequencer.StartRecordPass();  // Reset for replace mode
+            }
+            return true;
+
+        case Type::SET_BPM:
+            transport.SetBpm(static_cast<uint16_t>(cmd.value));
+            return true;
+
+        case Type::ADJUST_BPM:
+            transport.AdjustBpm(static_cast<int16_t>(cmd.value));
+            return true;
+
+        case Type::SET_OVERDUB:
+            sequencer.SetOverdubMode(cmd.arg != 0);
+            return true;
+
+        case Type::SYNTH_PARAM:
+            synth.SetParam(static_cast<Synth::ParamId>(cmd.arg), cmd.value);
+            return true;
+
+        case Type::LOAD_PRESET:
+            synth.LoadPreset(cmd.arg, cmd.value);  // value = morph time (ms)
+            return true;
+
+        case Type::SET_BANK:
+            cc_engine.SetBank(static_cast<CCMap::Bank>(cmd.arg));  // Reported via BankChanged()
+            return true;
+
+        case Type::FREEZE_TRACK:
+        {
+            FreezeResult result = {1, static_cast<uint8_t>(audio_track_manager.StartFreeze(cmd.arg) ? 1 : 0)};
+            freeze_queue.Push(result);
+            return true;
+        }
+
+        case Type::UNFREEZE_TRACK:
+        {
+            FreezeResult result = {0, static_cast<uint8_t>(audio_track_manager.Unfreeze(cmd.arg) ? 1 : 0)};
+            freeze_queue.Push(result);
+            return true;
+        }
+
+        case Type::TELEMETRY:
+            telemetry_tap.Configure(cmd.arg != 0, static_cast<uint8_t>(cmd.value));
+            return true;
+
+        case Type::LOAD_SESSION:
         {
-            synth.NoteOn(data1, data2);
+            // Step 0 stops, then each chunk in one or more bounded steps,
+            // then a final rewind
+            if(step == 0)
+            {
+                transport.StopAndReset();
+                synth.AllNotesOff();
+                session_load.chunk = 0;
+                session_load.pos   = 0;
+            }
+            else if(session_load.chunk < Session::NUM_CHUNKS)
+            {
+                if(ApplySessionChunk(session_load))
+                {
+                    session_load.chunk++;
+                    session_load.pos = 0;
+                }
+            }
+            else
+            {
+                sequencer.ResetPlayback();
+                automation.ResetPlayback();
+                session_loaded.store(true, std::memory_order_release);
+                return true;
+            }
+            return false;
         }
-        else if(type == 0x80 || (type == 0x90 && data2 == 0))
+    }
+    return true;
+}
+
+/**
+ * Add imported MIDI file events (audio callback)
+ * Events were routed by the main loop, so a refusal means a full track.
+ */
+void ApplyImportedEvents()
+{
+    Sequencer::MidiEvent ev;
+    for(uint32_t n = 0; n < IMPORT_EVENTS_PER_BLOCK && import_queue.Pop(ev); n++)
+    {
+        bool added = (ev.status & 0xF0) == 0xB0
+                         ? automation.ImportCC(ev.tick, ev.data1, ev.data2)
+                         : sequencer.ImportEvent(ev.tick, ev.status, ev.data1, ev.data2);
+        if(!added)
         {
-            synth.NoteOff(data1);
+            import_rejected = import_rejected + 1;
         }
     }
 }
 
+/**
+ * Queue a command for the audio callback (main loop only)
+ */
+bool QueueEngineCommand(EngineCommand::Type type, uint8_t arg = 0, float value = 0.0f)
+{
+    EngineCommand::Command cmd = {type, arg, value};
+    return engine_queue.Push(cmd);
+}
+
 // Audio callback - processes transport timing, synth, drums, and frozen tracks
 void AudioCallback(AudioHandle::InputBuffer  in,
                    AudioHandle::OutputBuffer out,
@@ -313,9 +801,48 @@ void AudioCallback(AudioHandle::InputBuffer  in,
 {
     cpu_meter.OnBlockStart();
 
+    // Apply engine commands from the main loop before rendering the block
+    // (bounded per block - large commands continue next block)
+    engine_executor.Run(engine_queue);
+
+    // Imported MIDI file events, only once the commands queued ahead of
+    // them (the clear that starts an import) are done
+    if(engine_queue.Empty())
+    {
+        ApplyImportedEvents();
+    }
+
+    // Swap in or morph towards a staged preset, then push synth parameters
+    // changed since the last block (commands above and CCs flushed at the end
+    // of the previous block) to the voices
+    synth.Update(size);
+
+    // Collect live MIDI that arrived during the previous block. Each event is
+    // applied at its arrival offset: one block of latency, no jitter.
+    uint32_t window_start = midi_clock.BeginBlock(size, System::GetTick());
+    uint32_t due_before   = midi_clock.GetBlockStart();
+    MidiInput::TimedEvent live[MidiInput::MAX_EVENTS_PER_BLOCK];
+    size_t                live_count = 0;
+    size_t                live_next  = 0;
+    while(live_count < MidiInput::MAX_EVENTS_PER_BLOCK
+          && midi_in_queue.Peek(live[live_count])
+          && MidiInput::IsBefore(live[live_count].sample_time, due_before))
+    {
+        midi_in_queue.Drop();
+        live_count++;
+    }
+
     // Check if currently rendering a freeze
     bool is_rendering = (audio_track_manager.GetRenderTarget() != AudioTrack::NO_SLOT);
     bool has_pending = audio_track_manager.HasPendingFreeze();
+    bool tap_on      = telemetry_tap.IsEnabled();
+    if(tap_on)
+    {
+        telemetry_tap.BeginBlock();
+    }
+#if PROFILE_DRUM_STALLS
+    uint32_t drum_ticks = 0;
+#endif
 
     for(size_t i = 0; i < size; i++)
     {
@@ -331,14 +858,14 @@ void AudioCallback(AudioHandle::InputBuffer  in,
                 audio_track_manager.BeginRecording();
                 is_rendering = true;
                 has_pending = false;
-                send_track_state_update = true;
+                PostNotification(Notify::TRACK_STATE);
             }
             else if(is_rendering)
             {
                 // Pattern looped while rendering - finalize the freeze
                 audio_track_manager.FinalizeFreeze();
                 is_rendering = false;
-                send_track_state_update = true;
+                PostNotification(Notify::TRACK_STATE);
             }
         }
 
@@ -350,6 +877,13 @@ void AudioCallback(AudioHandle::InputBuffer  in,
             automation.Process(tick, AutomationPlaybackCallback);
         }
 
+        // Apply live MIDI due at this sample
+        while(live_next < live_count && LiveEventOffset(live[live_next], window_start) <= i)
+        {
+            ApplyLiveMidi(live[live_next].status, live[live_next].data1, live[live_next].data2);
+            live_next++;
+        }
+
         // Process synth engine (stereo)
         float synth_left, synth_right;
         synth.ProcessStereo(&synth_left, &synth_right);
@@ -379,42 +913,84 @@ void AudioCallback(AudioHandle::InputBuffer  in,
 
         // Process drum sampler (stereo)
         float drum_left, drum_right;
+#if PROFILE_DRUM_STALLS
+        uint32_t drum_start = System::GetTick();
+        sampler.ProcessStereo(&drum_left, &drum_right);
+        drum_ticks += System::GetTick() - drum_start;
+#else
         sampler.ProcessStereo(&drum_left, &drum_right);
+#endif
 
         // Mix: synth (live) + frozen tracks + drums
         // Apply master output level from CC engine
         float master = cc_engine.GetMasterOutput();
         out[0][i] = in[0][i] + (synth_left + frozen_left + drum_left) * master;
         out[1][i] = in[1][i] + (synth_right + frozen_right + drum_right) * master;
+
+        // Telemetry: buses before the master level, master as output
+        if(tap_on)
+        {
+            const float bus_l[Telemetry::NUM_BUSES] = {synth_left, frozen_left, drum_left, out[0][i]};
+            const float bus_r[Telemetry::NUM_BUSES] = {synth_right, frozen_right, drum_right, out[1][i]};
+            telemetry_tap.Process(bus_l, bus_r);
+        }
+    }
+    if(tap_on)
+    {
+        telemetry_tap.EndBlock();
+    }
+
+    // Anything left over (block size shrank) is applied at the block end
+    while(live_next < live_count)
+    {
+        ApplyLiveMidi(live[live_next].status, live[live_next].data1, live[live_next].data2);
+        live_next++;
     }
 
-    // Check if transport state changed (flag for main loop)
-    if(transport.CheckStateChanged())
+    // Apply this block's CC changes once per target
+    cc_coalescer.Flush();
+
+    // Publish the transport clock as of the end of this block
+    ClockSync::Snapshot clock;
+    clock.sample        = midi_clock.GetBlockStart() + static_cast<uint32_t>(size);
+    clock.tick          = transport.GetPosition().tick;
+    clock.phase         = transport.GetTickPhase();
+    clock.bpm           = transport.GetBpm();
+    clock.pattern_ticks = transport.GetPatternTicks();
+    clock.running       = !transport.IsStopped();
+    clock_publisher.Publish(clock);
+
+    // Check if CC bank changed (command or bank-switch CC)
+    if(cc_engine.BankChanged())
     {
-        send_transport_update = true;
+        PostNotification(Notify::CC_BANK);
     }
 
-    // Check if voice counts changed
-    uint8_t synth_count = synth.GetActiveCount();
-    uint8_t drum_count = sampler.GetActiveCount();
-    if(synth_count != last_synth_count || drum_count != last_drum_count)
+    // Voice counts for the next state capture
+    synth_voice_count.store(synth.GetActiveCount(), std::memory_order_relaxed);
+    drum_voice_count.store(sampler.GetActiveCount(), std::memory_order_relaxed);
+
+#if PROFILE_DRUM_STALLS
+    if(drum_ticks > drum_ticks_max)
     {
-        last_synth_count = synth_count;
-        last_drum_count = drum_count;
-        send_voices_update = true;
+        drum_ticks_max = drum_ticks;
     }
+#endif
 
     cpu_meter.OnBlockEnd();
 }
 
-// Transmit buffer for building messages
-static uint8_t tx_buffer[Protocol::MAX_MESSAGE];
+// Outgoing USB data: messages are built in place, flushed once per main-loop iteration
+static UsbTx::Ring usb_tx;
+
+// Received USB data (USB ISR -> main loop). Sized for a burst of uploads,
+// e.g. a full preset plus a pattern, arriving before the main loop runs.
+static Spsc::ByteRing<4096> usb_rx;
+static volatile bool        flash_led = false;
 
-// Receive buffer and state
-static uint8_t          rx_buffer[256];
-static volatile uint32_t rx_len    = 0;
-static volatile bool     rx_ready  = false;
-static volatile bool     flash_led = false;
+// Text outside protocol frames (PING / STATUS test commands), one line
+static char   text_line[32];
+static size_t text_len = 0;
 
 // Protocol parser for incoming binary messages
 static Protocol::Parser parser;
@@ -422,19 +998,28 @@ static Protocol::Parser parser;
 // USB receive callback
 void UsbReceiveCallback(uint8_t* buf, uint32_t* len)
 {
-    if(*len > 0 && *len < sizeof(rx_buffer))
+    if(*len > 0)
     {
-        memcpy((void*)rx_buffer, buf, *len);
-        rx_len    = *len;
-        rx_ready  = true;
+        usb_rx.Write(buf, *len);  // Full ring drops the packet (reported in diagnostics)
         flash_led = true;
     }
 }
 
-// Send raw bytes over USB
+// Start a CDC transfer (false while the previous one is still in flight)
+bool UsbTransmit(uint8_t* data, size_t len)
+{
+    return hw.seed.usb_handle.TransmitInternal(data, len) == UsbHandle::Result::OK;
+}
+
+// Queue raw bytes for USB
 void UsbSendRaw(const uint8_t* data, size_t len)
 {
-    hw.seed.usb_handle.TransmitInternal((uint8_t*)data, len);
+    uint8_t* dst = usb_tx.Reserve(len);
+    if(dst != nullptr)
+    {
+        memcpy(dst, data, len);
+        usb_tx.Commit(len);
+    }
 }
 
 // Send a text string (for backwards compatibility)
@@ -443,311 +1028,736 @@ void UsbSendText(const char* str)
     UsbSendRaw((const uint8_t*)str, strlen(str));
 }
 
-// Send a binary protocol message
-void SendMessage(uint8_t type, const uint8_t* payload, uint16_t len)
-{
-    size_t msg_len = Protocol::BuildMessage(tx_buffer, type, payload, len);
-    UsbSendRaw(tx_buffer, msg_len);
-}
-
-// Send a TICK message with current position
-void SendTick()
+// Queue a framed (CRC-16, sequenced) message
+void SendFramed(uint8_t type, uint8_t seq, const uint8_t* payload, uint16_t len)
 {
-    const Transport::Position& pos = transport.GetPosition();
-    uint8_t payload[4];
-    payload[0] = pos.tick & 0xFF;
-    payload[1] = (pos.tick >> 8) & 0xFF;
-    payload[2] = (pos.tick >> 16) & 0xFF;
-    payload[3] = (pos.tick >> 24) & 0xFF;
-    SendMessage(Protocol::MSG_TICK, payload, 4);
+    uint8_t* dst = usb_tx.Reserve(len + Protocol::FRAMED_OVERHEAD);
+    if(dst != nullptr)
+    {
+        usb_tx.Commit(Protocol::BuildFramedMessage(dst, type, seq, payload, len));
+    }
 }
 
-// Send a TRANSPORT message with current state
-void SendTransport()
+// Queue a binary protocol message (built directly in the TX ring)
+// Bulk types go out framed and are kept for retransmit once the link is enabled.
+void SendMessage(uint8_t type, const uint8_t* payload, uint16_t len)
 {
-    uint8_t playing   = transport.IsPlaying() || transport.IsRecording() ? 1 : 0;
-    uint8_t recording = transport.IsRecording() ? 1 : 0;
-    uint16_t bpm      = transport.GetBpm();
-
-    uint8_t payload[4];
-    payload[0] = playing;
-    payload[1] = recording;
-    payload[2] = bpm & 0xFF;
-    payload[3] = (bpm >> 8) & 0xFF;
-    SendMessage(Protocol::MSG_TRANSPORT, payload, 4);
-}
+    if(link_history.ShouldFrame(type))
+    {
+        SendFramed(type, link_history.Store(type, payload, len), payload, len);
+        return;
+    }
 
-// Send a DEBUG text message
-void SendDebug(const char* text)
-{
-    size_t len = strlen(text);
-    if(len > Protocol::MAX_PAYLOAD)
+    uint8_t* dst = usb_tx.Reserve(4 + len + 1);
+    if(dst != nullptr)
     {
-        len = Protocol::MAX_PAYLOAD;
+        usb_tx.Commit(Protocol::BuildMessage(dst, type, payload, len));
     }
-    SendMessage(Protocol::MSG_DEBUG, (const uint8_t*)text, len);
 }
 
-// Send a MIDI_IN message (forward MIDI event to companion)
-void SendMidiIn(uint8_t status, uint8_t data1, uint8_t data2)
+// Answer a NAK: resend each listed message, or report it lost
+void HandleLinkNak(const uint8_t* seqs, uint16_t count)
 {
-    uint8_t payload[3] = {status, data1, data2};
-    SendMessage(Protocol::MSG_MIDI_IN, payload, 3);
-}
+    for(uint16_t i = 0; i < count; i++)
+    {
+        if(link_history.IsUnsent(seqs[i]))
+            continue;
 
-// Send a VOICES message with active voice counts
-void SendVoices()
+        uint8_t        type;
+        const uint8_t* payload;
+        uint16_t       len;
+        if(link_history.Find(seqs[i], type, payload, len))
+        {
+            SendFramed(type, seqs[i], payload, len);
+        }
+        else
+        {
+            SendFramed(Protocol::MSG_LINK_GAP, seqs[i], nullptr, 0);
+        }
+    }
+}
+
+// Encode a typed message (protocol_codec.h) and queue it
+template <typename M>
+void Send(const M& msg)
+{
+    uint8_t payload[M::MAX_SIZE > 0 ? M::MAX_SIZE : 1];
+    SendMessage(M::TYPE, payload, msg.Encode(payload));
+}
+
+// Send a playhead anchor if the companion's extrapolation needs one
+void SendClockSync(uint32_t now)
 {
-    uint8_t payload[2] = {last_synth_count, last_drum_count};
-    SendMessage(Protocol::MSG_VOICES, payload, 2);
+    ClockSync::Snapshot snap = clock_publisher.Read();
+    if(!clock_scheduler.Due(snap, now))
+        return;
+
+    Codec::ClockSync msg;
+    msg.sample        = snap.sample;
+    msg.tick          = snap.tick;
+    msg.phase         = snap.phase;
+    msg.bpm           = snap.bpm;
+    msg.pattern_ticks = snap.pattern_ticks;
+    msg.sample_rate   = static_cast<uint32_t>(hw.AudioSampleRate());
+    msg.flags         = snap.running ? Codec::ClockSync::FLAG_RUNNING : 0;
+    Send(msg);
+    clock_scheduler.Sent(snap, now);
 }
 
-// Send current CC bank
-void SendCCBank()
+// Send a DEBUG text message
+void SendDebug(const char* text)
 {
-    uint8_t payload[1] = {static_cast<uint8_t>(cc_engine.GetBank())};
-    SendMessage(Protocol::MSG_CC_BANK, payload, 1);
+    Codec::Debug msg;
+    msg.text = text;
+    msg.len  = strlen(text);
+    Send(msg);
 }
 
-// Send fader pickup states
-void SendFaderState()
+// Send a warning when an SPSC queue dropped items since the last check
+void ReportQueueOverflow(const char* name, uint32_t overflows, uint32_t& last_seen)
 {
-    uint8_t payload[CCMap::NUM_FADERS];
-    for(uint8_t i = 0; i < CCMap::NUM_FADERS; i++)
+    if(overflows != last_seen)
     {
-        const CCMap::FaderState& state = cc_engine.GetFaderState(i);
-        // Pack state: bit 0 = picked_up, bit 1 = needs_pickup
-        payload[i] = (state.picked_up ? 0x01 : 0) | (state.needs_pickup ? 0x02 : 0);
+        char buf[48];
+        sprintf(buf, "WARN: %s queue overflow (%lu)", name, overflows - last_seen);
+        last_seen = overflows;
+        SendDebug(buf);
     }
-    SendMessage(Protocol::MSG_FADER_STATE, payload, CCMap::NUM_FADERS);
 }
 
-// Send mixer state (drum/synth levels, pans, masters)
-void SendMixerState()
+// Send a telemetry frame when one is due (analysis time counts against the budget)
+void SendTelemetry(uint32_t now)
 {
-    // [drum_levels:8][drum_pans:8][drum_master:1][synth_level:1][synth_pan:1][synth_master:1][master_out:1]
-    uint8_t payload[21];
-    size_t idx = 0;
+    telemetry.Collect(telemetry_tap);
+    if(!telemetry.Due(now))
+        return;
 
-    // Drum levels (0-127)
-    for(uint8_t i = 0; i < 8; i++)
+    Telemetry::Frame frame;
+    uint32_t         start = System::GetUs();
+    telemetry.Analyze(telemetry_tap, frame, now);
+    telemetry.SetCost(System::GetUs() - start);
+
+    Codec::Telemetry msg;
+    msg.flags      = frame.flags;
+    msg.clip       = frame.clip;
+    msg.decimation = frame.decimation;
+    memcpy(msg.peak, frame.peak, sizeof(msg.peak));
+    memcpy(msg.rms, frame.rms, sizeof(msg.rms));
+    msg.scope       = frame.scope;
+    msg.scope_count = Telemetry::SCOPE_POINTS;
+    msg.bands       = frame.bands;
+    msg.band_count  = Telemetry::NUM_BANDS;
+    Send(msg);
+}
+
+// Send per-voice synth state and CPU load as one binary VOICE_DIAG message
+void SendVoiceDiag()
+{
+    Synth::VoiceDiag diag[Synth::NUM_VOICES];
+    synth.GetVoiceDiag(diag);
+
+    Codec::VoiceDiag msg;
+    msg.cpu_percent = static_cast<uint8_t>(cpu_meter.GetAvgCpuLoad() * 100.0f);
+    msg.active      = synth.GetActiveCount();
+    msg.count       = Synth::NUM_VOICES;
+    float ms_per_sample = 1000.0f / hw.AudioSampleRate();
+    for(uint8_t i = 0; i < Synth::NUM_VOICES; i++)
     {
-        payload[idx++] = CCMap::NormToCC(sampler.GetLevel(i));
+        const Synth::VoiceDiag& d = diag[i];
+        Codec::VoiceDiag::Voice& v = msg.voices[i];
+        float age_ms = d.age_samples * ms_per_sample;
+
+        v.note            = d.note;
+        v.velocity        = d.velocity;
+        v.state           = (d.active ? Codec::VoiceDiag::STATE_ACTIVE : 0)
+                  | (d.gate ? Codec::VoiceDiag::STATE_GATE : 0)
+                  | ((d.stage & 0x07) << Codec::VoiceDiag::STATE_STAGE_SHIFT);
+        v.env             = static_cast<uint8_t>(fclamp(d.env, 0.0f, 1.0f) * 255.0f);
+        v.age_ms          = age_ms >= 65535.0f ? 65535 : static_cast<uint16_t>(age_ms);
+        v.release_samples = d.release_samples;
+        v.cutoff_hz       = static_cast<uint16_t>(fclamp(d.cutoff, 0.0f, 65535.0f));
     }
+    Send(msg);
+}
 
-    // Drum pans (0=left, 64=center, 127=right)
-    for(uint8_t i = 0; i < 8; i++)
+// Send queued MIDI Monitor events as one MIDI_BATCH message
+// Returns the number of events sent (the rest go in the next frame)
+size_t SendMidiBatch()
+{
+    Codec::MidiEvent events[Protocol::MAX_BATCH_EVENTS];
+    Codec::MidiBatch msg;
+    msg.events = events;
+    msg.count  = 0;
+
+    MonitorEvent mon;
+    while(msg.count < Protocol::MAX_BATCH_EVENTS && monitor_queue.Pop(mon))
     {
-        payload[idx++] = CCMap::PanToCC(sampler.GetPan(i));
+        events[msg.count].status = mon.status;
+        events[msg.count].data1  = mon.data1;
+        events[msg.count].data2  = mon.data2;
+        msg.count++;
     }
+    if(msg.count > 0)
+    {
+        Send(msg);
+    }
+    return msg.count;
+}
+
+// Capture everything the companion mirrors into the state table
+void CaptureState()
+{
+    using namespace StateSync;
+
+    state_sync.Set(TRANSPORT_PLAYING, transport.IsPlaying() || transport.IsRecording() ? 1 : 0);
+    state_sync.Set(TRANSPORT_RECORDING, transport.IsRecording() ? 1 : 0);
+    state_sync.Set(TRANSPORT_BPM, transport.GetBpm());
+    state_sync.Set(VOICES_SYNTH, synth_voice_count.load(std::memory_order_relaxed));
+    state_sync.Set(VOICES_DRUMS, drum_voice_count.load(std::memory_order_relaxed));
+    state_sync.Set(CC_BANK, static_cast<uint8_t>(cc_engine.GetBank()));
 
-    // Drum master level
-    payload[idx++] = CCMap::NormToCC(sampler.GetMasterLevel());
+    // Fader pickup: bit 0 = picked_up, bit 1 = needs_pickup
+    for(uint8_t i = 0; i < CCMap::NUM_FADERS; i++)
+    {
+        const CCMap::FaderState& fs = cc_engine.GetFaderState(i);
+        state_sync.Set(FADER_FIRST + i, (fs.picked_up ? 0x01 : 0) | (fs.needs_pickup ? 0x02 : 0));
+    }
 
-    // Synth level, pan, master
+    // Mixer: [drum_levels:8][drum_pans:8][drum_master][synth_level][synth_pan][synth_master][master_out]
     const Synth::SynthParams& p = synth.GetParams();
-    payload[idx++] = CCMap::NormToCC(p.level);
-    payload[idx++] = CCMap::PanToCC(p.pan);
-    payload[idx++] = CCMap::NormToCC(p.master_level);
+    uint8_t f = MIXER_FIRST;
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        state_sync.Set(f++, CCMap::NormToCC(sampler.GetLevel(i)));
+    }
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        state_sync.Set(f++, CCMap::PanToCC(sampler.GetPan(i)));
+    }
+    state_sync.Set(f++, CCMap::NormToCC(sampler.GetMasterLevel()));
+    state_sync.Set(f++, CCMap::NormToCC(p.level));
+    state_sync.Set(f++, CCMap::PanToCC(p.pan));
+    state_sync.Set(f++, CCMap::NormToCC(p.master_level));
+    state_sync.Set(f++, CCMap::NormToCC(cc_engine.GetMasterOutput()));
+
+    // Synth parameters in ParamId order (floats, waves/detune included)
+    const float synth_values[NUM_SYNTH_FIELDS] = {
+        static_cast<float>(p.osc1_wave), static_cast<float>(p.osc2_wave),
+        p.osc1_level, p.osc2_level, static_cast<float>(p.osc2_detune),
+        p.filter_cutoff, p.filter_res, p.filter_env_amt,
+        p.amp_attack, p.amp_decay, p.amp_sustain, p.amp_release,
+        p.filt_attack, p.filt_decay, p.filt_sustain, p.filt_release,
+        p.vel_to_amp, p.vel_to_filter, p.level,
+    };
+    for(uint8_t i = 0; i < NUM_SYNTH_FIELDS; i++)
+    {
+        state_sync.SetFloat(SYNTH_FIRST + i, synth_values[i]);
+    }
+    state_sync.Set(SYNTH_PRESET, synth.GetCurrentPreset());
+
+    // Synth track freeze state
+    for(uint8_t i = 0; i < AudioTrack::Manager::NUM_SYNTH_TRACKS; i++)
+    {
+        const AudioTrack::TrackState& ts = audio_track_manager.GetTrackState(i);
+        state_sync.Set(TRACK_FIRST + i * 2, static_cast<uint8_t>(ts.status));
+        state_sync.Set(TRACK_FIRST + i * 2 + 1, ts.frozen_slot);
+    }
+
+    // Modulation: synth parameters in ParamId order from LFO1_RATE
+    for(uint8_t i = 0; i < NUM_MOD_FIELDS; i++)
+    {
+        Synth::ParamId id = static_cast<Synth::ParamId>(Synth::PARAM_LFO1_RATE + i);
+        state_sync.SetFloat(MOD_FIRST + i, synth.GetParam(id));
+    }
+
+    state_sync.Commit();
+}
 
-    // Master output
-    payload[idx++] = CCMap::NormToCC(cc_engine.GetMasterOutput());
+// Send state changes (or a requested snapshot) to the companion
+void SendStateSync(uint32_t now)
+{
+    if(!state_sync.Begin(now))
+        return;
 
-    SendMessage(Protocol::MSG_MIXER_STATE, payload, idx);
+    uint8_t payload[StateSync::MAX_MESSAGE];
+    size_t  len;
+    while((len = state_sync.NextMessage(payload)) > 0)
+    {
+        SendMessage(Protocol::MSG_STATE_DELTA, payload, len);
+    }
 }
 
-// Helper to write a float as 4 little-endian bytes
-void WriteFloat(uint8_t* buf, float value)
+// Command track ID (8-11) -> synth track index (0-3)
+uint8_t SynthTrackIndex(uint8_t track_id)
 {
-    union { float f; uint8_t b[4]; } u;
-    u.f = value;
-    buf[0] = u.b[0];
-    buf[1] = u.b[1];
-    buf[2] = u.b[2];
-    buf[3] = u.b[3];
+    return track_id >= 8 ? track_id - 8 : track_id;
 }
 
-// Helper to read a float from 4 little-endian bytes
-float ReadFloat(const uint8_t* buf)
+// Send resource usage (memory + CPU)
+void SendResources()
 {
-    union { float f; uint8_t b[4]; } u;
-    u.b[0] = buf[0];
-    u.b[1] = buf[1];
-    u.b[2] = buf[2];
-    u.b[3] = buf[3];
-    return u.f;
+    // Calculate memory usage
+    // Base: drum samples (TOTAL_SAMPLES floats at 4 bytes each, scaled to the rate)
+    size_t drum_samples_size = sample_bank.Length(DrumSamples::TOTAL_SAMPLES) * sizeof(float);
+    size_t memory_used = drum_samples_size + audio_track_manager.GetUsedMemory();
+    constexpr size_t memory_total = 64 * 1024 * 1024;  // 64 MB SDRAM
+
+    Codec::Resources msg;
+    msg.memory_used  = memory_used;
+    msg.memory_total = memory_total;
+    msg.cpu_percent  = static_cast<uint8_t>(cpu_meter.GetAvgCpuLoad() * 100.0f);
+    Send(msg);
 }
 
-// Send full synth state to companion
-void SendSynthState()
+// Send pattern dump for a single track
+// Sends in chunks if track has many events (max ~35 per message)
+void SendPatternDump(uint8_t track_id)
 {
-    const Synth::SynthParams& p = synth.GetParams();
+    // Track IDs: 0-7 = drums, 8-11 = synth
+    uint16_t event_count = sequencer.GetTrackEventCount(track_id);
 
-    // Payload: all params serialized as bytes/floats
-    // Order must match companion's parsing
-    // Size: 2 + 8 + 1 + 12 + 16 + 16 + 8 + 4 + 1 = 68 bytes
-    uint8_t payload[72];
-    size_t idx = 0;
+    // Events are copied straight into the payload in wire layout
+    uint8_t payload[Codec::PatternDump::MAX_SIZE];
+    Codec::PatternDump msg;
+    msg.track_id = track_id;
+    msg.offset   = 0;
+    msg.events   = &payload[Codec::PatternDump::HEADER_SIZE];
 
-    // Oscillators (2 bytes + 2 floats + 1 int8)
-    payload[idx++] = p.osc1_wave;
-    payload[idx++] = p.osc2_wave;
-    WriteFloat(&payload[idx], p.osc1_level); idx += 4;
-    WriteFloat(&payload[idx], p.osc2_level); idx += 4;
-    payload[idx++] = static_cast<uint8_t>(p.osc2_detune + 24);  // Offset to unsigned
+    do
+    {
+        msg.count = sequencer.GetTrackEvents(track_id, msg.offset,
+                                             &payload[Codec::PatternDump::HEADER_SIZE],
+                                             Codec::PatternDump::MAX_EVENTS);
+        SendMessage(msg.TYPE, payload, msg.Encode(payload));
+        msg.offset += msg.count;
+        // An empty track still gets one message (count = 0); stop if nothing was copied
+    } while(msg.count > 0 && msg.offset < event_count);
+}
 
-    // Filter (3 floats)
-    WriteFloat(&payload[idx], p.filter_cutoff); idx += 4;
-    WriteFloat(&payload[idx], p.filter_res); idx += 4;
-    WriteFloat(&payload[idx], p.filter_env_amt); idx += 4;
+// Send queued bulk pattern chunks (no fixed pacing: limited only by the
+// companion's credits and free space in the TX ring)
+void ServicePatternSync(uint32_t now)
+{
+    static uint8_t chunk[PatternTransfer::MAX_CHUNK];
+    while(pattern_sender.IsActive()
+          && usb_tx.CanReserve(pattern_sender.ChunkSize() + Protocol::FRAMED_OVERHEAD))
+    {
+        size_t len = pattern_sender.NextChunk(chunk);
+        if(len == 0)
+            break;  // Waiting for credits
+        SendMessage(Protocol::MSG_PATTERN_BULK, chunk, len);
+        if(!pattern_sender.IsActive())
+        {
+            SendDebug("Pattern sync complete");
+        }
+    }
+    if(pattern_sender.CheckTimeout(now))
+    {
+        SendDebug("WARN: Pattern sync abandoned (no credits)");
+    }
+}
 
-    // Amp envelope (4 floats)
-    WriteFloat(&payload[idx], p.amp_attack); idx += 4;
-    WriteFloat(&payload[idx], p.amp_decay); idx += 4;
-    WriteFloat(&payload[idx], p.amp_sustain); idx += 4;
-    WriteFloat(&payload[idx], p.amp_release); idx += 4;
+// Send pattern clear notification
+void SendPatternClear(uint8_t track_id)
+{
+    Codec::PatternClear msg;
+    msg.value = track_id;
+    Send(msg);
+}
 
-    // Filter envelope (4 floats)
-    WriteFloat(&payload[idx], p.filt_attack); idx += 4;
-    WriteFloat(&payload[idx], p.filt_decay); idx += 4;
-    WriteFloat(&payload[idx], p.filt_sustain); idx += 4;
-    WriteFloat(&payload[idx], p.filt_release); idx += 4;
+// ============================================================================
+// Standard MIDI File import/export (see smf.h)
 
-    // Velocity sensitivity (2 floats)
-    WriteFloat(&payload[idx], p.vel_to_amp); idx += 4;
-    WriteFloat(&payload[idx], p.vel_to_filter); idx += 4;
+void SendSmfStatus(uint8_t op, Protocol::SmfState state, uint32_t offset)
+{
+    Codec::SmfStatus msg;
+    msg.op      = op;
+    msg.state   = state;
+    msg.offset  = offset;
+    msg.notes   = op == Protocol::SMF_OP_IMPORT ? smf_import.notes : 0;
+    msg.points  = op == Protocol::SMF_OP_IMPORT ? smf_import.points : 0;
+    msg.dropped = op == Protocol::SMF_OP_IMPORT ? smf_import.dropped + import_rejected : 0;
+    Send(msg);
+}
 
-    // Master level (1 float)
-    WriteFloat(&payload[idx], p.level); idx += 4;
+/**
+ * Map a file event onto the engine (Smf::Parser callback, main loop)
+ * Channel 10 pad notes go to the drum tracks, notes on any other channel
+ * to the synth, automated CCs to their lanes; everything else is ignored.
+ */
+void OnSmfEvent(uint8_t track, const Smf::Event& ev)
+{
+    (void)track;
+    uint8_t              type    = ev.status & 0xF0;
+    uint8_t              channel = ev.status & 0x0F;
+    Sequencer::MidiEvent out     = {ev.tick, ev.status, ev.data1, ev.data2};
 
-    // Current preset index
-    payload[idx++] = synth.GetCurrentPreset();
+    if(type == 0x90 || type == 0x80)
+    {
+        if(type == 0x90 && ev.data2 == 0)
+        {
+            out.status = 0x80 | channel;  // Note on with velocity 0 is a note off
+        }
+        if(channel == Sequencer::DRUM_CHANNEL)
+        {
+            if(ev.data1 < Sequencer::FIRST_PAD_NOTE || ev.data1 > Sequencer::LAST_PAD_NOTE)
+                return;
+        }
+        else
+        {
+            out.status = (out.status & 0xF0) | Sequencer::SYNTH_CHANNEL;
+        }
+    }
+    else if(type != 0xB0 || !automation.IsAutomatedCC(ev.data1))
+    {
+        return;
+    }
 
-    SendMessage(Protocol::MSG_SYNTH_STATE, payload, idx);
+    if(ev.tick >= transport.GetPatternTicks() || !import_queue.Push(out))
+    {
+        smf_import.dropped++;
+        return;
+    }
+    if(type == 0xB0)
+        smf_import.points++;
+    else
+        smf_import.notes++;
 }
 
-// Send resource usage (memory + CPU)
-void SendResources()
+// The file's first tempo sets the BPM; later changes are ignored
+void OnSmfTempo(uint32_t tick, uint32_t us_per_quarter)
 {
-    // Calculate memory usage
-    // Base: drum samples (TOTAL_SAMPLES floats at 4 bytes each)
-    constexpr size_t DRUM_SAMPLES_SIZE = DrumSamples::TOTAL_SAMPLES * sizeof(float);
-    size_t memory_used = DRUM_SAMPLES_SIZE + audio_track_manager.GetUsedMemory();
-    constexpr size_t memory_total = 64 * 1024 * 1024;  // 64 MB SDRAM
+    (void)tick;
+    if(smf_import.tempo_set || us_per_quarter == 0)
+        return;
+    smf_import.tempo_set = true;
+    float bpm = (60000000.0f / us_per_quarter) + 0.5f;
+    QueueEngineCommand(EngineCommand::Type::SET_BPM, 0, bpm);
+}
 
-    // Get CPU load as percentage (0-100)
-    uint8_t cpu_pct = static_cast<uint8_t>(cpu_meter.GetAvgCpuLoad() * 100.0f);
+void HandleSmfImport(const Codec::SmfImport& msg)
+{
+    using Protocol::SmfState;
 
-    // Payload: [mem_used:4][mem_total:4][cpu:1]
-    uint8_t payload[9];
-    payload[0] = memory_used & 0xFF;
-    payload[1] = (memory_used >> 8) & 0xFF;
-    payload[2] = (memory_used >> 16) & 0xFF;
-    payload[3] = (memory_used >> 24) & 0xFF;
-    payload[4] = memory_total & 0xFF;
-    payload[5] = (memory_total >> 8) & 0xFF;
-    payload[6] = (memory_total >> 16) & 0xFF;
-    payload[7] = (memory_total >> 24) & 0xFF;
-    payload[8] = cpu_pct;
+    if(msg.offset == 0)
+    {
+        // New file: clear everything first. Not while events of a previous
+        // import are still queued, they would land after the clear.
+        if(!import_queue.Empty()
+           || !QueueEngineCommand(EngineCommand::Type::RESET_AND_CLEAR))
+        {
+            SendSmfStatus(Protocol::SMF_OP_IMPORT, SmfState::BUSY, 0);
+            return;
+        }
+        smf_parser.Init(OnSmfEvent, OnSmfTempo);
+        smf_import        = SmfImportState();
+        smf_import.active = true;
+        smf_import.total  = msg.total;
+        import_rejected   = 0;
+    }
+    else if(smf_import.reply_pending)
+    {
+        SendSmfStatus(Protocol::SMF_OP_IMPORT, SmfState::BUSY, msg.offset);
+        return;
+    }
+    if(!smf_import.active || msg.offset != smf_parser.GetPosition())
+    {
+        SendSmfStatus(Protocol::SMF_OP_IMPORT, SmfState::SEQUENCE,
+                      smf_import.active ? smf_parser.GetPosition() : 0);
+        return;
+    }
 
-    SendMessage(Protocol::MSG_RESOURCES, payload, 9);
+    smf_parser.Feed(msg.data, msg.len);
+    bool truncated = !smf_parser.IsDone() && smf_parser.GetPosition() >= smf_import.total;
+    if(smf_parser.GetError() != Smf::Error::NONE || truncated)
+    {
+        // Events already queued stay: the pattern holds what was readable
+        smf_import.active = false;
+        SendSmfStatus(Protocol::SMF_OP_IMPORT, SmfState::FORMAT, smf_parser.GetPosition());
+        SendDebug("SMF: import failed (not a type 0/1 MIDI file)");
+        return;
+    }
+    if(smf_parser.IsDone())
+    {
+        smf_import.active = false;  // Trailing bytes are not parsed
+    }
+    smf_import.reply_pending = true;
 }
 
-// Send track state for all synth tracks
-void SendTrackState()
+// Acknowledge an imported chunk once the audio callback has room for the
+// next one; the last one once every event has been added
+void TaskSmf(uint32_t now)
 {
-    // 4 synth tracks × [id:1][status:1][frozen_slot:1][source:1]
-    uint8_t payload[16];
+    (void)now;
+    if(!smf_import.reply_pending)
+        return;
 
-    for(uint8_t i = 0; i < AudioTrack::Manager::NUM_SYNTH_TRACKS; i++)
+    uint32_t queued = import_queue.Size();
+    if(smf_import.active)
     {
-        const AudioTrack::TrackState& ts = audio_track_manager.GetTrackState(i);
-        size_t base = i * 4;
-        payload[base + 0] = i + 8;  // Track ID (8-11 for synth tracks)
-        payload[base + 1] = static_cast<uint8_t>(ts.status);
-        payload[base + 2] = ts.frozen_slot;
-        payload[base + 3] = i;      // Source track (same as synth track index)
+        if(queued + IMPORT_CHUNK_EVENTS > import_queue.Capacity())
+            return;
+        smf_import.reply_pending = false;
+        SendSmfStatus(Protocol::SMF_OP_IMPORT, Protocol::SmfState::OK, smf_parser.GetPosition());
+        return;
     }
+    if(queued > 0)
+        return;
 
-    SendMessage(Protocol::MSG_TRACK_STATE, payload, 16);
+    smf_import.reply_pending = false;
+    SendSmfStatus(Protocol::SMF_OP_IMPORT, Protocol::SmfState::DONE, smf_import.total);
+    char buf[64];
+    sprintf(buf, "SMF: imported %u notes, %u points, %u dropped",
+            smf_import.notes, smf_import.points,
+            static_cast<unsigned>(smf_import.dropped + import_rejected));
+    SendDebug(buf);
 }
 
-// Send pattern dump for a single track
-// Sends in chunks if track has many events (max ~35 per message)
-void SendPatternDump(uint8_t track_id)
+// Export sources: sequencer tracks, then automation lanes as CCs on the
+// synth channel
+uint16_t SmfTrackCount(uint8_t track)
 {
-    // Get events from sequencer
-    // Track IDs: 0-7 = drums, 8-11 = synth
-    uint16_t event_count = sequencer.GetTrackEventCount(track_id);
+    if(track < Sequencer::NUM_TOTAL_TRACKS)
+        return sequencer.GetTrackEventCount(track);
+    return automation.GetTrack(track - Sequencer::NUM_TOTAL_TRACKS).point_count;
+}
 
-    if(event_count == 0)
+void SmfTrackEvent(uint8_t track, uint16_t index, Smf::Event& ev)
+{
+    if(track < Sequencer::NUM_TOTAL_TRACKS)
     {
-        // Send empty dump with count = 0
-        uint8_t payload[5] = {track_id, 0, 0, 0, 0};
-        SendMessage(Protocol::MSG_PATTERN_DUMP, payload, 5);
+        const Sequencer::MidiEvent& e = sequencer.GetTrackEvent(track, index);
+        ev.tick   = e.tick;
+        ev.status = e.status;
+        ev.data1  = e.data1;
+        ev.data2  = e.data2;
         return;
     }
+    uint8_t                      lane  = track - Sequencer::NUM_TOTAL_TRACKS;
+    const Automation::AutoPoint& point = automation.GetTrack(lane).points[index];
+    ev.tick   = point.tick;
+    ev.status = 0xB0 | Sequencer::SYNTH_CHANNEL;
+    ev.data1  = Automation::AUTO_CCS[lane];
+    ev.data2  = point.value;
+}
 
-    // Send events in chunks
-    // Each event: [tick:4][status:1][data1:1][data2:1] = 7 bytes
-    // Max ~35 events per 256-byte payload (after 5-byte header)
-    constexpr uint16_t MAX_EVENTS_PER_MSG = 35;
+/**
+ * Answer an export request with the chunk at offset
+ * Offset 0 fixes the file layout; editing the pattern before the last
+ * chunk would make the track lengths wrong, so recording refuses exports.
+ */
+void HandleSmfExport(uint32_t offset)
+{
+    using Protocol::SmfState;
 
-    uint16_t offset = 0;
-    while(offset < event_count)
+    if(transport.IsRecording())
+    {
+        SendSmfStatus(Protocol::SMF_OP_EXPORT, SmfState::BUSY, offset);
+        return;
+    }
+    if(offset == 0)
+    {
+        smf_writer.Begin(SMF_EXPORT_TRACKS, SmfTrackCount, SmfTrackEvent,
+                         transport.GetPatternTicks(), 60000000 / transport.GetBpm());
+        smf_export_started = true;
+    }
+    else if(!smf_export_started || offset > smf_writer.GetTotalSize())
+    {
+        SendSmfStatus(Protocol::SMF_OP_EXPORT, SmfState::SEQUENCE, 0);
+        return;
+    }
+    if(offset != smf_writer.GetPosition())
     {
-        // Build payload header
-        uint8_t payload[5 + MAX_EVENTS_PER_MSG * 7];
-        payload[0] = track_id;
-        payload[1] = offset & 0xFF;
-        payload[2] = (offset >> 8) & 0xFF;
+        smf_writer.Seek(offset);  // Companion re-requested a chunk
+    }
 
-        // Get events from sequencer into payload buffer
-        uint16_t copied = sequencer.GetTrackEvents(track_id, offset, &payload[5], MAX_EVENTS_PER_MSG);
+    uint8_t        data[Codec::SmfData::MAX_DATA];
+    Codec::SmfData msg;
+    msg.offset = offset;
+    msg.total  = smf_writer.GetTotalSize();
+    msg.data   = data;
+    msg.len    = smf_writer.Fill(data, sizeof(data));
+    Send(msg);
+    if(smf_writer.Done())
+    {
+        SendSmfStatus(Protocol::SMF_OP_EXPORT, SmfState::DONE, msg.total);
+    }
+}
 
-        // Update count in header
-        payload[3] = copied & 0xFF;
-        payload[4] = (copied >> 8) & 0xFF;
+// ============================================================================
+// Audio configuration (see audio_config.h)
 
-        // Calculate total payload length
-        size_t payload_len = 5 + (copied * 7);
+SaiHandle::Config::SampleRate SaiRate(uint32_t rate)
+{
+    switch(rate)
+    {
+        case 32000: return SaiHandle::Config::SampleRate::SAI_32KHZ;
+        case 96000: return SaiHandle::Config::SampleRate::SAI_96KHZ;
+        default: return SaiHandle::Config::SampleRate::SAI_48KHZ;
+    }
+}
 
-        SendMessage(Protocol::MSG_PATTERN_DUMP, payload, payload_len);
+/**
+ * Rate and block size stored with the session, or the defaults
+ */
+AudioConfig::Settings StoredAudioSettings()
+{
+    const Session::Chunk& chunk = session_dir.Get(Session::CHUNK_AUDIO);
+    if(!chunk.valid)
+        return AudioConfig::DEFAULTS;
+    Codec::Reader         r(chunk.data, chunk.len);
+    AudioConfig::Settings s;
+    s.rate  = r.U32();
+    s.block = r.U16();
+    return r.ok && AudioConfig::IsValid(s) ? s : AudioConfig::DEFAULTS;
+}
 
-        offset += copied;
+// Load samples into sampler slots (pads 0-7 = notes 36-43) at the bank's rate
+void LoadDrumSamples()
+{
+    using namespace DrumSamples;
+    sampler.LoadSample(0, sample_bank.kick, sample_bank.Length(KICK_LENGTH), "Kick");
+    sampler.LoadSample(1, sample_bank.snare, sample_bank.Length(SNARE_LENGTH), "Snare");
+    sampler.LoadSample(2, sample_bank.hihat_closed, sample_bank.Length(HIHAT_C_LENGTH), "HH Closed");
+    sampler.LoadSample(3, sample_bank.hihat_open, sample_bank.Length(HIHAT_O_LENGTH), "HH Open");
+    sampler.LoadSample(4, sample_bank.clap, sample_bank.Length(CLAP_LENGTH), "Clap");
+    sampler.LoadSample(5, sample_bank.tom_low, sample_bank.Length(TOM_LOW_LENGTH), "Tom Low");
+    sampler.LoadSample(6, sample_bank.tom_mid, sample_bank.Length(TOM_MID_LENGTH), "Tom Mid");
+    sampler.LoadSample(7, sample_bank.rim, sample_bank.Length(RIM_LENGTH), "Rim");
+}
 
-        // Safety check - break if no events copied to prevent infinite loop
-        if(copied == 0)
-            break;
+// Set up the buffer pointers for the 3 frozen track slots (all tracks MIDI)
+void InitAudioTracks()
+{
+    float* buf_l[AudioTrack::NUM_FROZEN_SLOTS];
+    float* buf_r[AudioTrack::NUM_FROZEN_SLOTS];
+    for(uint8_t i = 0; i < AudioTrack::NUM_FROZEN_SLOTS; i++)
+    {
+        buf_l[i] = frozen_track_L[i];
+        buf_r[i] = frozen_track_R[i];
     }
+    audio_track_manager.Init(buf_l, buf_r);
 }
 
-// Send pattern clear notification
-void SendPatternClear(uint8_t track_id)
+void SendAudioConfig(Protocol::AudioState state)
 {
-    uint8_t payload[1] = {track_id};
-    SendMessage(Protocol::MSG_PATTERN_CLEAR, payload, 1);
+    Codec::AudioStatus msg;
+    msg.rate       = audio_running.rate;
+    msg.block      = audio_running.block;
+    msg.latency_us = AudioConfig::LatencyUs(audio_running);
+    msg.state      = state;
+    Send(msg);
 }
 
-// Check if received text matches a command
-bool MatchCommand(const char* cmd)
+/**
+ * Restart audio at a new rate / block size (main loop)
+ * Everything the audio callback touches is retuned while it is stopped.
+ * Sounding notes are cut; frozen tracks hold audio at the old rate and are
+ * re-rendered on the next loop, as after a session load.
+ */
+void ApplyAudioConfig(const AudioConfig::Settings& s)
 {
-    size_t cmd_len = strlen(cmd);
+    hw.StopAudio();
+    hw.SetAudioSampleRate(SaiRate(s.rate));
+    hw.SetAudioBlockSize(s.block);
+    float rate = hw.AudioSampleRate();
+
+    transport.SetSampleRate(rate);
+    synth.SetSampleRate(rate);
+    sampler.SetSampleRate(rate);
+    sample_bank.Generate(rate);
+    LoadDrumSamples();
+
+    bool frozen[AudioTrack::Manager::NUM_SYNTH_TRACKS];
+    for(uint8_t i = 0; i < AudioTrack::Manager::NUM_SYNTH_TRACKS; i++)
+        frozen[i] = audio_track_manager.GetTrackState(i).status != AudioTrack::Status::MIDI;
+    InitAudioTracks();
+    for(uint8_t i = 0; i < AudioTrack::Manager::NUM_SYNTH_TRACKS; i++)
+    {
+        if(frozen[i])
+            audio_track_manager.StartFreeze(i);
+    }
+
+    midi_clock.SetSampleRate(rate, System::GetTickFreq());
+    clock_scheduler.Init(rate, Transport::PPQN);
+    telemetry.SetSampleRate(rate);
+    cpu_meter.Init(rate, s.block);
+    audio_running = s;
+
+    hw.StartAudio(AudioCallback);
+}
+
+void HandleAudioConfig(const Codec::AudioConfigCmd& msg)
+{
+    if(msg.query)
+    {
+        SendAudioConfig(Protocol::AudioState::OK);
+        return;
+    }
+    if(audio_bench.active)
+    {
+        SendAudioConfig(Protocol::AudioState::BUSY);
+        return;
+    }
+    AudioConfig::Settings s = {msg.rate, msg.block};
+    if(!AudioConfig::IsValid(s))
+    {
+        SendAudioConfig(Protocol::AudioState::INVALID);
+        return;
+    }
+    audio_settings = s;  // Saved with the session
+    ApplyAudioConfig(s);
+    SendAudioConfig(Protocol::AudioState::OK);
+}
+
+void StartAudioBench()
+{
+    if(audio_bench.active)
+        return;
+    audio_bench.active     = true;
+    audio_bench.cell       = 0;
+    audio_bench.applied_ms = System::GetNow();
+    ApplyAudioConfig(AudioConfig::BenchCell(0));
+}
+
+// Report the cell being measured and move to the next (resource task)
+void StepAudioBench(uint32_t now)
+{
+    if(!audio_bench.active || now - audio_bench.applied_ms < AUDIO_BENCH_SETTLE_MS)
+        return;
 
-    uint32_t check_len = rx_len;
-    while(check_len > 0 &&
-          (rx_buffer[check_len - 1] == '\r' ||
-           rx_buffer[check_len - 1] == '\n'))
+    Codec::AudioBench msg;
+    msg.index    = audio_bench.cell;
+    msg.count    = AudioConfig::NUM_BENCH_CELLS;
+    msg.rate     = audio_running.rate;
+    msg.block    = audio_running.block;
+    msg.avg_load = Codec::Saturate16(static_cast<uint32_t>(cpu_meter.GetAvgCpuLoad() * 10000.0f));
+    msg.max_load = Codec::Saturate16(static_cast<uint32_t>(cpu_meter.GetMaxCpuLoad() * 10000.0f));
+    Send(msg);
+
+    if(++audio_bench.cell < AudioConfig::NUM_BENCH_CELLS)
+    {
+        ApplyAudioConfig(AudioConfig::BenchCell(audio_bench.cell));
+        audio_bench.applied_ms = System::GetNow();
+    }
+    else
     {
-        check_len--;
+        audio_bench.active = false;
+        ApplyAudioConfig(audio_settings);
+        SendAudioConfig(Protocol::AudioState::OK);
     }
+}
 
-    if(check_len != cmd_len)
+// Check if the received text line matches a command
+bool MatchCommand(const char* cmd)
+{
+    size_t cmd_len = strlen(cmd);
+    if(text_len != cmd_len)
         return false;
 
     for(size_t i = 0; i < cmd_len; i++)
     {
-        char a = rx_buffer[i];
+        char a = text_line[i];
         char b = cmd[i];
         if(a >= 'a' && a <= 'z') a -= 32;
         if(b >= 'a' && b <= 'z') b -= 32;
@@ -763,687 +1773,876 @@ void ProcessBinaryCommand()
     switch(parser.type)
     {
         case Protocol::CMD_PLAY:
-            // Capture base values for blend mode before starting
-            automation.CaptureBaseValues();
-            automation.ResetPlayback();
-            transport.Play();
-            SendTransport();
+            // Transport commands are confirmed by the next state delta once applied
+            QueueEngineCommand(EngineCommand::Type::PLAY);
             SendDebug("CMD: PLAY");
             break;
 
         case Protocol::CMD_STOP:
-            transport.Stop();
-            synth.AllNotesOff();
-            sequencer.ResetPlayback();
-            automation.ResetPlayback();
-            audio_track_manager.ResetPlayheads();
-            SendTransport();
-            // Start staggered pattern dump (avoids USB buffer overflow)
-            pending_dump_track = 0;
-            last_dump_time = 0;  // Send first one immediately
-            SendTrackState();
+            QueueEngineCommand(EngineCommand::Type::STOP, 1);  // Also rewind frozen tracks
+            pattern_sender.Start(&sequencer, System::GetNow());  // Full pattern sync
             SendResources();
             SendDebug("CMD: STOP");
             break;
 
         case Protocol::CMD_RECORD:
-            transport.ToggleRecord();
-            SendTransport();
+            QueueEngineCommand(EngineCommand::Type::TOGGLE_RECORD);
             SendDebug("CMD: RECORD");
             break;
 
         case Protocol::CMD_TEMPO:
-            if(parser.payload_len >= 2)
+        {
+            Codec::Tempo msg;
+            if(Codec::Decode(parser, msg))
             {
-                uint16_t bpm = parser.payload[0] | (parser.payload[1] << 8);
-                transport.SetBpm(bpm);
-                SendTransport();
+                QueueEngineCommand(EngineCommand::Type::SET_BPM, 0, msg.bpm);
                 char buf[32];
-                sprintf(buf, "CMD: TEMPO=%d", bpm);
+                sprintf(buf, "CMD: TEMPO=%d", msg.bpm);
                 SendDebug(buf);
             }
             break;
+        }
 
         case Protocol::CMD_REQ_STATE:
-            // Send current state
-            SendTransport();
-            SendTick();
-            SendVoices();
-            SendTrackState();
+            // Send current state (full snapshot, deltas from then on)
+            state_sync.RequestSnapshot();
+            clock_scheduler.RequestSync();
             SendResources();
-            // Start staggered pattern dump (avoids USB buffer overflow)
-            pending_dump_track = 0;
-            last_dump_time = 0;  // Send first one immediately
+            pattern_sender.Start(&sequencer, System::GetNow());  // Full pattern sync
             SendDebug("CMD: STATE");
             break;
 
         case Protocol::CMD_SYNTH_PARAM:
-            if(parser.payload_len >= 5)
+        {
+            Codec::SynthParam msg;
+            if(Codec::Decode(parser, msg) && msg.param_id < Synth::PARAM_COUNT)
             {
-                uint8_t param_id = parser.payload[0];
-                float value = ReadFloat(&parser.payload[1]);
-                if(param_id < Synth::PARAM_COUNT)
-                {
-                    synth.SetParam(static_cast<Synth::ParamId>(param_id), value);
-                    SendSynthState();  // Confirm change
-                }
+                // Confirmed by the next state delta once the audio callback applies it
+                QueueEngineCommand(EngineCommand::Type::SYNTH_PARAM, msg.param_id, msg.value);
             }
             break;
+        }
 
         case Protocol::CMD_LOAD_PRESET:
-            if(parser.payload_len >= 1)
+        {
+            Codec::LoadPreset msg;
+            if(Codec::Decode(parser, msg))
             {
-                uint8_t preset = parser.payload[0];
-                synth.LoadPreset(preset);
-                SendSynthState();
+                QueueEngineCommand(EngineCommand::Type::LOAD_PRESET, msg.preset, msg.morph_ms);
                 char buf[32];
-                sprintf(buf, "Preset: %s", Synth::FactoryPresets::GetPresetName(preset));
+                sprintf(buf, "Preset: %s", Synth::FactoryPresets::GetPresetName(msg.preset));
                 SendDebug(buf);
             }
             break;
+        }
 
         case Protocol::CMD_REQ_SYNTH:
-            SendSynthState();
+            state_sync.RequestSnapshot();
             SendDebug("CMD: SYNTH_STATE");
             break;
 
         case Protocol::CMD_SET_BANK:
-            if(parser.payload_len >= 1)
+        {
+            Codec::SetBank msg;
+            if(Codec::Decode(parser, msg) && msg.value < CCMap::NUM_BANKS)
             {
-                uint8_t bank = parser.payload[0];
-                if(bank < CCMap::NUM_BANKS)
-                {
-                    cc_engine.SetBank(static_cast<CCMap::Bank>(bank));
-                    SendCCBank();
-                    SendFaderState();
-                    char buf[32];
-                    sprintf(buf, "Bank: %s", cc_engine.GetBankName());
-                    SendDebug(buf);
-                }
+                // The bank field changes once the audio callback applies the switch
+                QueueEngineCommand(EngineCommand::Type::SET_BANK, msg.value);
             }
             break;
+        }
 
         case Protocol::CMD_FREEZE_TRACK:
-            if(parser.payload_len >= 1)
+        {
+            Codec::FreezeTrack msg;
+            if(Codec::Decode(parser, msg))
             {
-                uint8_t synth_track = parser.payload[0];
-                // Convert from track ID (8-11) to synth track index (0-3)
-                if(synth_track >= 8)
-                    synth_track -= 8;
-
-                if(audio_track_manager.StartFreeze(synth_track))
-                {
-                    SendDebug("CMD: FREEZE started");
-                    SendTrackState();
-                    SendResources();
-                }
-                else
-                {
-                    SendDebug("CMD: FREEZE failed (no slots)");
-                }
+                // Result is reported when the audio callback applies it
+                QueueEngineCommand(EngineCommand::Type::FREEZE_TRACK, SynthTrackIndex(msg.value));
             }
             break;
+        }
 
         case Protocol::CMD_UNFREEZE_TRACK:
-            if(parser.payload_len >= 1)
+        {
+            Codec::UnfreezeTrack msg;
+            if(Codec::Decode(parser, msg))
             {
-                uint8_t synth_track = parser.payload[0];
-                // Convert from track ID (8-11) to synth track index (0-3)
-                if(synth_track >= 8)
-                    synth_track -= 8;
-
-                if(audio_track_manager.Unfreeze(synth_track))
-                {
-                    SendDebug("CMD: UNFREEZE done");
-                    SendTrackState();
-                    SendResources();
-                }
-                else
-                {
-                    SendDebug("CMD: UNFREEZE failed");
-                }
+                QueueEngineCommand(EngineCommand::Type::UNFREEZE_TRACK, SynthTrackIndex(msg.value));
             }
             break;
+        }
 
         case Protocol::CMD_REQ_PATTERN:
+        {
             // Request pattern dump for one or all tracks
-            if(parser.payload_len >= 1)
+            Codec::ReqPattern msg;
+            Codec::Decode(parser, msg);
+            if(msg.all_tracks)
             {
-                // Single track request
-                uint8_t track_id = parser.payload[0];
-                if(track_id < Sequencer::NUM_TOTAL_TRACKS)
-                {
-                    SendPatternDump(track_id);
-                }
+                // All tracks: one bulk stream
+                pattern_sender.Start(&sequencer, System::GetNow());
             }
-            else
+            else if(msg.track_id < Sequencer::NUM_TOTAL_TRACKS)
             {
-                // All tracks request
-                for(uint8_t i = 0; i < Sequencer::NUM_TOTAL_TRACKS; i++)
-                {
-                    SendPatternDump(i);
-                }
+                SendPatternDump(msg.track_id);
             }
-            SendTrackState();
             SendResources();
             break;
+        }
 
-        default:
-            SendDebug("CMD: Unknown");
-            break;
-    }
-}
-
-int main(void)
-{
-    // Initialize hardware
-    hw.Init();
-
-    // Enable FPU Flush-to-Zero mode to prevent denormalized float slowdowns
-    // This is critical for audio DSP - denormals can cause 10-100x slowdown
-    uint32_t fpscr = __get_FPSCR();
-    fpscr |= (1 << 24);  // Set FZ (Flush-to-Zero) bit
-    __set_FPSCR(fpscr);
-
-    // Initialize USB CDC
-    hw.seed.usb_handle.Init(UsbHandle::FS_INTERNAL);
-    hw.seed.usb_handle.SetReceiveCallback(UsbReceiveCallback,
-                                          UsbHandle::FS_INTERNAL);
-
-    // Start ADC and Audio (required for full hardware init)
-    hw.StartAdc();
-    hw.SetAudioBlockSize(64);  // Larger block size for more CPU headroom with 6-voice synth
-    hw.StartAudio(AudioCallback);
-
-    // Initialize CPU load meter for diagnostics
-    cpu_meter.Init(hw.AudioSampleRate(), hw.AudioBlockSize());
-
-    // Initialize transport engine with audio sample rate
-    transport.Init(hw.AudioSampleRate());
-
-    // Initialize sequencer with pattern length from transport
-    sequencer.Init(transport.GetPatternTicks());
-
-    // Initialize automation with same pattern length
-    automation.Init(transport.GetPatternTicks());
-
-    // Initialize sampler and generate samples
-    sampler.Init();
-    sample_bank.Generate();
-
-    // Initialize synth engine
-    synth.Init(hw.AudioSampleRate());
-
-    // Initialize MIDI router (connects sampler, synth, and companion)
-    midi_router.Init(&sampler, &synth, SendMidiIn);
-    midi_router.SetRecordCallback(RouterRecordCallback);
-
-    // Initialize CC mapping engine (4-bank system)
-    cc_engine.Init();
-
-    // Initialize audio track manager for freeze/unfreeze
-    // Set up buffer pointers for the 3 frozen track slots
-    float* buf_l[AudioTrack::NUM_FROZEN_SLOTS];
-    float* buf_r[AudioTrack::NUM_FROZEN_SLOTS];
-    for(uint8_t i = 0; i < AudioTrack::NUM_FROZEN_SLOTS; i++)
-    {
-        buf_l[i] = frozen_track_L[i];
-        buf_r[i] = frozen_track_R[i];
-    }
-    audio_track_manager.Init(buf_l, buf_r);
-
-    // Connect sequencer playback to callback (for unified routing)
-    sequencer.SetPlaybackCallback(SequencerPlaybackCallback);
-
-    // Load samples into sampler slots (pads 0-7 = notes 36-43)
-    sampler.LoadSample(0, sample_bank.kick, DrumSamples::KICK_LENGTH, "Kick");
-    sampler.LoadSample(1, sample_bank.snare, DrumSamples::SNARE_LENGTH, "Snare");
-    sampler.LoadSample(2, sample_bank.hihat_closed, DrumSamples::HIHAT_C_LENGTH, "HH Closed");
-    sampler.LoadSample(3, sample_bank.hihat_open, DrumSamples::HIHAT_O_LENGTH, "HH Open");
-    sampler.LoadSample(4, sample_bank.clap, DrumSamples::CLAP_LENGTH, "Clap");
-    sampler.LoadSample(5, sample_bank.tom_low, DrumSamples::TOM_LOW_LENGTH, "Tom Low");
-    sampler.LoadSample(6, sample_bank.tom_mid, DrumSamples::TOM_MID_LENGTH, "Tom Mid");
-    sampler.LoadSample(7, sample_bank.rim, DrumSamples::RIM_LENGTH, "Rim");
-
-    // Initialize MIDI input (UART on D14)
-    hw.midi.StartReceive();
-
-    // Initialize parser
-    parser.Reset();
-
-    // Give USB time to enumerate
-    System::Delay(500);
-
-    // Send startup message (as DEBUG)
-    SendDebug("GroovyDaisy v1.0 - Synth + Drums");
-
-    // Send initial state
-    SendTransport();
-    SendSynthState();
-    SendCCBank();
-    SendFaderState();
-    SendMixerState();
-    SendTrackState();
-    SendResources();
-
-    // Timing
-    uint32_t last_tick_send      = 0;
-    uint32_t last_transport_send = 0;
-    uint32_t last_resources_send = 0;
-    uint32_t flash_start         = 0;
-    bool     midi_flash          = false;
-
-    // Double-stop detection for reset
-    uint32_t last_stop_time = 0;
-
-    // Main loop
-    while(1)
-    {
-        uint32_t now = System::GetNow();
-
-        // Process Pod controls (buttons, encoder)
-        hw.ProcessAllControls();
-
-        // Button 1: Play/Stop toggle
-        if(hw.button1.RisingEdge())
+        case Protocol::CMD_BULK_ACK:
         {
-            if(transport.IsPlaying() || transport.IsRecording())
+            Codec::BulkAck msg;
+            if(Codec::Decode(parser, msg))
             {
-                // First stop - just stop
-                transport.Stop();
-                synth.AllNotesOff();
-                sequencer.ResetPlayback();
-                automation.ResetPlayback();
-                last_stop_time = now;
-                SendDebug("Transport: Stop");
+                pattern_sender.AddCredits(msg.value, System::GetNow());
             }
-            else
-            {
-                // Stopped: check for double-click to reset
-                if(now - last_stop_time < 500)
-                {
-                    transport.StopAndReset();
-                    sequencer.Clear();
-                    sequencer.ResetPlayback();
-                    automation.Clear();
-                    automation.ResetPlayback();
-                    SendDebug("Transport: Reset + Clear");
-                }
-                else
-                {
-                    // Starting playback - capture base values for blend mode
-                    automation.CaptureBaseValues();
-                    automation.ResetPlayback();
-                    transport.Play();
-                    SendDebug("Transport: Play");
-                }
-            }
-            SendTransport();
+            break;
         }
 
-        // Button 2: Record toggle
-        if(hw.button2.RisingEdge())
+        case Protocol::CMD_BULK_CONFIG:
         {
-            transport.ToggleRecord();
-            if(transport.IsRecording())
+            Codec::BulkConfig msg;
+            if(Codec::Decode(parser, msg))
             {
-                sequencer.StartRecordPass();  // Reset for replace mode
-                SendDebug("Transport: Record ON");
-            }
-            else
-            {
-                SendDebug("Transport: Record OFF");
+                pattern_sender.Configure(msg.max_chunk, msg.window);
+                char buf[32];
+                sprintf(buf, "Bulk: %u B chunks", pattern_sender.ChunkSize());
+                SendDebug(buf);
             }
-            SendTransport();
+            break;
         }
 
-        // Encoder rotation: Adjust tempo
-        int32_t enc_inc = hw.encoder.Increment();
-        if(enc_inc != 0)
+        case Protocol::CMD_LINK_CONFIG:
         {
-            transport.AdjustBpm(enc_inc);
-            SendTransport();
-            char buf[32];
-            sprintf(buf, "BPM: %d", transport.GetBpm());
-            SendDebug(buf);
+            Codec::LinkConfig msg;
+            if(Codec::Decode(parser, msg))
+            {
+                link_history.Configure(msg.value);
+                SendDebug(link_history.IsEnabled() ? "Link: CRC framing on" : "Link: CRC framing off");
+            }
+            break;
         }
 
-        // Encoder click: Toggle overdub/replace mode
-        if(hw.encoder.RisingEdge())
+        case Protocol::CMD_LINK_NAK:
         {
-            sequencer.SetOverdubMode(!sequencer.IsOverdubMode());
-            SendDebug(sequencer.IsOverdubMode() ? "Mode: Overdub" : "Mode: Replace");
+            Codec::LinkNak msg;
+            if(link_history.IsEnabled() && Codec::Decode(parser, msg))
+            {
+                HandleLinkNak(msg.seqs, msg.count);
+            }
+            break;
         }
 
-        // Send TICK message at ~5fps (every 200ms) - reduced to free USB bandwidth
-        if(now - last_tick_send >= 200)
+        case Protocol::CMD_TELEMETRY_CONFIG:
         {
-            last_tick_send = now;
-            SendTick();
+            Codec::TelemetryConfig msg;
+            if(Codec::Decode(parser, msg))
+            {
+                telemetry.Configure(msg.flags, msg.interval_ms, msg.decimation);
+                QueueEngineCommand(EngineCommand::Type::TELEMETRY,
+                                   telemetry.IsEnabled() ? 1 : 0,
+                                   telemetry.GetDecimation());
+                char buf[40];
+                sprintf(buf, "Telemetry: %s, %lu ms", telemetry.IsEnabled() ? "on" : "off",
+                        telemetry.GetIntervalMs());
+                SendDebug(buf);
+            }
+            break;
         }
 
-        // Staggered pattern dump - send one track at a time to avoid USB overflow
-        if(pending_dump_track < Sequencer::NUM_TOTAL_TRACKS)
+        case Protocol::CMD_SMF_IMPORT:
         {
-            if(now - last_dump_time >= DUMP_INTERVAL_MS)
+            Codec::SmfImport msg;
+            if(Codec::Decode(parser, msg))
             {
-                SendPatternDump(pending_dump_track);
-                pending_dump_track++;
-                last_dump_time = now;
-
-                // Log completion
-                if(pending_dump_track >= Sequencer::NUM_TOTAL_TRACKS)
-                {
-                    pending_dump_track = 0xFF;  // Done
-                    SendDebug("Pattern sync complete");
-                }
+                HandleSmfImport(msg);
             }
+            break;
         }
 
-        // Send RESOURCES message at ~1fps (every 1000ms) - CPU meter updates
-        if(now - last_resources_send >= 1000)
+        case Protocol::CMD_SMF_EXPORT:
         {
-            last_resources_send = now;
-            SendResources();
+            Codec::SmfExport msg;
+            if(Codec::Decode(parser, msg))
+            {
+                HandleSmfExport(msg.offset);
+            }
+            break;
         }
 
-        // Send TRANSPORT message on state change from audio callback
-        if(send_transport_update)
+        case Protocol::CMD_AUDIO_CONFIG:
         {
-            send_transport_update = false;
-            SendTransport();
+            Codec::AudioConfigCmd msg;
+            if(Codec::Decode(parser, msg))
+            {
+                HandleAudioConfig(msg);
+            }
+            break;
         }
 
-        // Send VOICES message on count change
-        if(send_voices_update)
-        {
-            send_voices_update = false;
-            SendVoices();
-        }
+        case Protocol::CMD_AUDIO_BENCH:
+            StartAudioBench();
+            break;
 
-        // Send TRACK_STATE and RESOURCES after freeze state changes
-        if(send_track_state_update)
+        case Protocol::CMD_STATE_ACK:
         {
-            send_track_state_update = false;
-            SendTrackState();
-            SendResources();
-            SendDebug("Track state updated");
+            Codec::StateAck msg;
+            if(Codec::Decode(parser, msg))
+            {
+                state_sync.Ack(msg.version);
+            }
+            break;
         }
 
-        // Periodic synth diagnostics (every 2 seconds)
-        static uint32_t last_diag_send = 0;
-        if(now - last_diag_send >= 2000)
-        {
-            last_diag_send = now;
-
-            // Send voice state dump
-            char diag[128];
-            synth.GetVoiceDiagString(diag, sizeof(diag));
-            SendDebug(diag);
+        default:
+            SendDebug("CMD: Unknown");
+            break;
+    }
+}
 
-            // Send CPU load (>80% = concern, >95% = audio dropouts)
-            char cpu_buf[32];
-            sprintf(cpu_buf, "CPU: %d%%", (int)(cpu_meter.GetAvgCpuLoad() * 100.0f));
-            SendDebug(cpu_buf);
+// Handle a text line received outside protocol frames (for testing)
+void ProcessTextLine()
+{
+    if(MatchCommand("PING"))
+    {
+        UsbSendText("PONG\r\n");
+    }
+    else if(MatchCommand("STATUS"))
+    {
+        const Transport::Position& pos = transport.GetPosition();
+        char buf[96];
+        sprintf(buf, "STATUS: %s BPM=%d Bar=%d Beat=%d Tick=%lu\r\n",
+                transport.IsRecording() ? "REC" :
+                transport.IsPlaying() ? "PLAY" : "STOP",
+                transport.GetBpm(),
+                pos.bar,
+                pos.beat,
+                pos.tick);
+        UsbSendText(buf);
+    }
+}
 
-            // Send automation point count (if any recorded)
-            uint16_t auto_points = automation.GetTotalPointCount();
-            if(auto_points > 0)
+// Collect text bytes into lines
+void FeedText(const uint8_t* data, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        char c = static_cast<char>(data[i]);
+        if(c == '\r' || c == '\n')
+        {
+            if(text_len > 0)
             {
-                char auto_buf[48];
-                sprintf(auto_buf, "Auto: %d pts, Blend: %s",
-                        auto_points,
-                        automation.IsBlendEnabled() ? "ON" : "OFF");
-                SendDebug(auto_buf);
+                ProcessTextLine();
             }
+            text_len = 0;
+        }
+        else if(text_len < sizeof(text_line))
+        {
+            text_line[text_len++] = c;
+        }
+    }
+}
 
-            // Report anomalies
-            if(synth.HadNaN())
-            {
-                SendDebug("WARN: NaN detected, voice reset");
-            }
-            if(synth.HadStuckVoice())
+// Drain the USB receive ring through the protocol parser
+void ProcessUsbRx()
+{
+    const uint8_t* data;
+    uint32_t       avail;
+    while((avail = usb_rx.Peek(data)) > 0)
+    {
+        // Each frame queues at most one engine command; leave the rest in
+        // the ring rather than overflow the command queue
+        if(parser.IsIdle() && engine_queue.Size() >= EngineCommand::QUEUE_SIZE - 1)
+            break;
+
+        size_t used;
+        if(parser.IsIdle() && data[0] != Protocol::SYNC_BYTE)
+        {
+            // Bytes between frames are text
+            const void* sync = memchr(data, Protocol::SYNC_BYTE, avail);
+            used = sync ? static_cast<const uint8_t*>(sync) - data : avail;
+            FeedText(data, used);
+        }
+        else
+        {
+            bool complete;
+            used = parser.Feed(data, avail, complete);
+            if(complete)
             {
-                SendDebug("WARN: Stuck voice killed after 3s");
+                ProcessBinaryCommand();
             }
         }
+        usb_rx.Consume(used);
+    }
+}
+
+// ============================================================================
+// Session snapshot (see session.h)
+
+/**
+ * Encode one session chunk from the live engines (main loop)
+ */
+size_t EncodeSessionChunk(uint8_t id, uint8_t* out)
+{
+    using namespace Session;
 
-        // Also send TRANSPORT periodically (every 500ms) for sync
-        if(now - last_transport_send >= 500)
+    Codec::Writer w(out);
+    if(id == CHUNK_TRANSPORT)
+    {
+        w.U16(transport.GetBpm());
+        w.U8((sequencer.IsOverdubMode() ? TRANSPORT_OVERDUB : 0)
+             | (automation.IsBlendEnabled() ? TRANSPORT_BLEND : 0));
+    }
+    else if(id == CHUNK_MIXER)
+    {
+        for(uint8_t i = 0; i < NUM_DRUMS; i++)
+            w.F32(sampler.GetLevel(i));
+        for(uint8_t i = 0; i < NUM_DRUMS; i++)
+            w.F32(sampler.GetPan(i));
+        w.F32(sampler.GetMasterLevel());
+        w.F32(cc_engine.GetMasterOutput());
+    }
+    else if(id == CHUNK_SYNTH)
+    {
+        w.U8(Synth::PARAM_COUNT);
+        for(uint8_t i = 0; i < Synth::PARAM_COUNT; i++)
+            w.F32(synth.GetParam(static_cast<Synth::ParamId>(i)));
+    }
+    else if(id < CHUNK_AUTO)
+    {
+        // Recording can insert events while this runs; the result is
+        // written only once two scans agree
+        uint8_t  track = id - CHUNK_PATTERN;
+        uint16_t count = sequencer.GetTrackEventCount(track);
+        uint32_t tick  = 0;
+        w.Varint(count);
+        for(uint16_t i = 0; i < count; i++)
         {
-            last_transport_send = now;
-            SendTransport();
+            const Sequencer::MidiEvent& ev = sequencer.GetTrackEvent(track, i);
+            PutTick(w, tick, ev.tick);
+            w.U8(ev.status);
+            w.U8(ev.data1);
+            w.U8(ev.data2);
         }
+    }
+    else if(id < CHUNK_TRACKS)
+    {
+        uint8_t                      lane  = id - CHUNK_AUTO;
+        const Automation::AutoTrack& track = automation.GetTrack(lane);
+        uint16_t                     count = track.point_count;
+        uint32_t                     tick  = 0;
+        w.U8(Automation::AUTO_CCS[lane]);
+        w.Varint(count);
+        for(uint16_t i = 0; i < count; i++)
+        {
+            PutTick(w, tick, track.points[i].tick);
+            w.U8(track.points[i].value);
+        }
+    }
+    else if(id == CHUNK_TRACKS)
+    {
+        // Pending and rendering tracks count as frozen
+        w.U8(NUM_SYNTH_TRACKS);
+        for(uint8_t i = 0; i < NUM_SYNTH_TRACKS; i++)
+            w.U8(audio_track_manager.GetTrackState(i).status != AudioTrack::Status::MIDI ? 1 : 0);
+    }
+    else if(id == CHUNK_AUDIO)
+    {
+        w.U32(audio_settings.rate);
+        w.U16(audio_settings.block);
+    }
+    return w.pos;
+}
 
-        // Note: UI now updates from CC events via MSG_MIDI_IN
-        // No need for periodic SendMixerState/SendSynthState
+void SessionErase(uint32_t offset)
+{
+    hw.seed.qspi.Erase(offset, offset + Session::SECTOR_SIZE);
+}
+
+void SessionProgram(uint32_t offset, const uint8_t* data, size_t len)
+{
+    hw.seed.qspi.Write(offset, len, const_cast<uint8_t*>(data));
+}
 
-        // Process MIDI input
-        hw.midi.Listen();
+// Background save: not while recording (patterns are in flux); an erase
+// blocks the main loop for tens of ms, which the audio callback never sees
+void TaskSession(uint32_t now)
+{
+    session_saver.Step(now, SESSION_BUDGET_US, !transport.IsRecording());
+}
 
-        while(hw.midi.HasEvents())
-        {
-            MidiEvent e = hw.midi.PopEvent();
+// Main-loop tasks (see task_scheduler.h)
+// ============================================================================
 
-            // Build status byte from type and channel
-            uint8_t status = 0;
-            uint8_t data1  = 0;
-            uint8_t data2  = 0;
+static TaskScheduler::Scheduler main_tasks;
+static_assert(TaskScheduler::MAX_TASKS <= Codec::TaskStats::MAX_TASKS, "Tasks do not fit MSG_TASK_STATS");
 
-            switch(e.type)
-            {
-                case NoteOn:
-                {
-                    NoteOnEvent n = e.AsNoteOn();
-                    bool recording = transport.IsRecording();
-                    uint32_t tick = transport.GetPosition().tick;
-
-                    // Per MIDI spec: NoteOn with velocity=0 is NoteOff
-                    if(n.velocity == 0)
-                    {
-                        status = 0x80 | (e.channel & 0x0F);  // NoteOff
-
-                        // Route through router (handles synth NoteOff)
-                        midi_router.RouteNoteOff(e.channel, n.note,
-                                                 MidiRouter::Source::LIVE_INPUT,
-                                                 recording, tick);
-                    }
-                    else
-                    {
-                        status     = 0x90 | (e.channel & 0x0F);  // NoteOn
-                        midi_flash = true;  // Flash LED on note on
-
-                        // Route through router (handles sampler, synth, recording)
-                        midi_router.RouteNoteOn(e.channel, n.note, n.velocity,
-                                                MidiRouter::Source::LIVE_INPUT,
-                                                recording, tick);
-                    }
-                    data1 = n.note;
-                    data2 = n.velocity;
-                    break;
-                }
-                case NoteOff:
-                {
-                    NoteOffEvent n = e.AsNoteOff();
-                    status         = 0x80 | (e.channel & 0x0F);
-                    data1          = n.note;
-                    data2          = n.velocity;
-
-                    // Route through router (handles synth NoteOff + recording)
-                    midi_router.RouteNoteOff(e.channel, n.note,
-                                             MidiRouter::Source::LIVE_INPUT,
-                                             transport.IsRecording(),
-                                             transport.GetPosition().tick);
-                    break;
-                }
-                case ControlChange:
-                {
-                    ControlChangeEvent cc = e.AsControlChange();
-                    status                = 0xB0 | (e.channel & 0x0F);
-                    data1                 = cc.control_number;
-                    data2                 = cc.value;
-
-                    // Route through bank-aware CC engine
-                    uint8_t out_value;
-                    CCMap::ParamTarget target = cc_engine.ProcessCC(cc.control_number, cc.value, out_value);
-
-                    if(target != CCMap::TARGET_NONE)
-                    {
-                        // Apply the routed parameter
-                        ApplyParamTarget(target, out_value);
-                    }
-
-                    // Check for bank change immediately (more reliable than flag-based check)
-                    if(cc_engine.BankChanged())
-                    {
-                        SendCCBank();
-                        SendFaderState();
-                        SendDebug("Bank changed via CC");
-                    }
-
-                    // Forward CC to companion for MIDI monitor
-                    SendMidiIn(status, data1, data2);
-
-                    // Automation: record CC if automated and in record mode
-                    if(e.channel == Synth::SYNTH_CHANNEL &&
-                       automation.IsAutomatedCC(cc.control_number))
-                    {
-                        // Always update current value for blend tracking
-                        automation.UpdateCurrentValue(cc.control_number, cc.value);
-
-                        // Record if in record mode
-                        if(transport.IsRecording())
-                        {
-                            automation.RecordCC(transport.GetPosition().tick,
-                                                cc.control_number, cc.value);
-                        }
-                    }
-                    break;
-                }
-                case PitchBend:
-                {
-                    // PitchBend is 14-bit, send as two 7-bit values
-                    status = 0xE0 | (e.channel & 0x0F);
-                    data1  = e.data[0] & 0x7F;  // LSB
-                    data2  = e.data[1] & 0x7F;  // MSB
-                    break;
-                }
-                case ChannelPressure:
-                {
-                    status = 0xD0 | (e.channel & 0x0F);
-                    data1  = e.data[0];
-                    data2  = 0;
-                    break;
-                }
-                case PolyphonicKeyPressure:
-                {
-                    status = 0xA0 | (e.channel & 0x0F);
-                    data1  = e.data[0];  // Note
-                    data2  = e.data[1];  // Pressure
-                    break;
-                }
-                default:
-                    // Skip system messages for now
-                    continue;
-            }
+// Main-loop state shared between tasks
+static uint32_t last_stop_time = 0;      // Double-stop detection for reset
+static uint32_t flash_start    = 0;
+static bool     midi_flash     = false;  // Live note on seen (LED flash)
 
-            // Forward non-routed events to companion
-            // (NoteOn/NoteOff/CC are already sent by the router)
-            if(e.type != NoteOn && e.type != NoteOff && e.type != ControlChange)
-            {
-                SendMidiIn(status, data1, data2);
-            }
-        }
+// Pod buttons and encoder
+void TaskControls(uint32_t now)
+{
+    hw.ProcessAllControls();
 
-        // Process playback queue (sequencer events -> MIDI Monitor)
-        while(playback_queue_tail != playback_queue_head)
+    // Button 1: Play/Stop toggle
+    if(hw.button1.RisingEdge())
+    {
+        if(transport.IsPlaying() || transport.IsRecording())
         {
-            // Copy values BEFORE incrementing tail to avoid race
-            uint8_t status = playback_queue[playback_queue_tail].status;
-            uint8_t data1 = playback_queue[playback_queue_tail].data1;
-            uint8_t data2 = playback_queue[playback_queue_tail].data2;
-            playback_queue_tail = (playback_queue_tail + 1) % PLAYBACK_QUEUE_SIZE;
-            SendMidiIn(status, data1, data2);
+            // First stop - just stop
+            QueueEngineCommand(EngineCommand::Type::STOP);
+            last_stop_time = now;
+            SendDebug("Transport: Stop");
         }
-
-        // Process received USB data
-        if(rx_ready)
+        else
         {
-            // Null-terminate for text commands
-            rx_buffer[rx_len] = '\0';
-
-            // First check if it's a text command (for testing)
-            if(MatchCommand("PING"))
-            {
-                UsbSendText("PONG\r\n");
-            }
-            else if(MatchCommand("STATUS"))
+            // Stopped: check for double-click to reset
+            if(now - last_stop_time < 500)
             {
-                const Transport::Position& pos = transport.GetPosition();
-                char buf[96];
-                sprintf(buf, "STATUS: %s BPM=%d Bar=%d Beat=%d Tick=%lu\r\n",
-                        transport.IsRecording() ? "REC" :
-                        transport.IsPlaying() ? "PLAY" : "STOP",
-                        transport.GetBpm(),
-                        pos.bar,
-                        pos.beat,
-                        pos.tick);
-                UsbSendText(buf);
+                // Cleared a track per step over the next few blocks
+                QueueEngineCommand(EngineCommand::Type::RESET_AND_CLEAR);
+                SendDebug("Transport: Reset + Clear");
             }
             else
             {
-                // Try to parse as binary protocol
-                for(uint32_t i = 0; i < rx_len; i++)
-                {
-                    if(parser.Feed(rx_buffer[i]))
-                    {
-                        ProcessBinaryCommand();
-                    }
-                }
+                // Starting playback (base values captured by the command)
+                QueueEngineCommand(EngineCommand::Type::PLAY);
+                SendDebug("Transport: Play");
             }
+        }
+    }
+
+    // Button 2: Record toggle
+    if(hw.button2.RisingEdge())
+    {
+        // State is read before the toggle is applied
+        bool entering = !transport.IsRecording();
+        QueueEngineCommand(EngineCommand::Type::TOGGLE_RECORD);
+        SendDebug(entering ? "Transport: Record ON" : "Transport: Record OFF");
+    }
 
-            rx_ready = false;
+    // Encoder rotation: Adjust tempo
+    int32_t enc_inc = hw.encoder.Increment();
+    if(enc_inc != 0)
+    {
+        QueueEngineCommand(EngineCommand::Type::ADJUST_BPM, 0, static_cast<float>(enc_inc));
+        // Expected value - the command is applied at the next block
+        int bpm = transport.GetBpm() + enc_inc;
+        bpm = bpm < (int)Transport::MIN_BPM ? Transport::MIN_BPM : bpm;
+        bpm = bpm > (int)Transport::MAX_BPM ? Transport::MAX_BPM : bpm;
+        char buf[32];
+        sprintf(buf, "BPM: %d", bpm);
+        SendDebug(buf);
+    }
+
+    // Encoder click: Toggle overdub/replace mode
+    if(hw.encoder.RisingEdge())
+    {
+        bool overdub = !sequencer.IsOverdubMode();
+        QueueEngineCommand(EngineCommand::Type::SET_OVERDUB, overdub ? 1 : 0);
+        SendDebug(overdub ? "Mode: Overdub" : "Mode: Replace");
+    }
+}
+
+// Everything received over USB since the last call
+void TaskUsbRx(uint32_t now)
+{
+    (void)now;
+    ProcessUsbRx();
+}
+
+// Report state changes posted by the audio callback
+void TaskNotifications(uint32_t now)
+{
+    (void)now;
+    if(session_loaded.exchange(false, std::memory_order_acquire))
+    {
+        // Saving starts only now, so the empty boot state never
+        // overwrites the stored session
+        char buf[40];
+        sprintf(buf, "Session restored (%u chunks)",
+                static_cast<unsigned>(session_dir.GetValidCount()));
+        SendDebug(buf);
+        session_saver.Enable();
+    }
+
+    uint32_t pending = notify_pending.exchange(0, std::memory_order_acquire);
+    if(pending & NotifyBit(Notify::TRACK_STATE))
+    {
+        // Track state goes out with the state sync; memory use changed too
+        SendResources();
+        SendDebug("Track state updated");
+    }
+    if(pending & NotifyBit(Notify::CC_BANK))
+    {
+        char buf[32];
+        sprintf(buf, "Bank: %s", cc_engine.GetBankName());
+        SendDebug(buf);
+    }
+    if(pending & NotifyBit(Notify::LIVE_NOTE))
+    {
+        midi_flash = true;
+    }
+
+    FreezeResult result;
+    while(freeze_queue.Pop(result))
+    {
+        if(result.freeze)
+            SendDebug(result.ok ? "CMD: FREEZE started" : "CMD: FREEZE failed (no slots)");
+        else
+            SendDebug(result.ok ? "CMD: UNFREEZE done" : "CMD: UNFREEZE failed");
+        if(result.ok)
+        {
+            SendResources();
         }
+    }
+}
+
+// Once per frame: MIDI Monitor events (one batched message however many
+// arrived) and whatever companion-visible state changed
+void TaskFrame(uint32_t now)
+{
+    SendMidiBatch();
+    CaptureState();
+    SendStateSync(now);
+    SendClockSync(now);
+}
+
+// CPU meter and memory use for the resource view; also paces the audio
+// benchmark, which needs the meter's view of each cell
+void TaskResources(uint32_t now)
+{
+    StepAudioBench(now);
+    SendResources();
+}
+
+// Voice state and CPU load for the companion's voice view (binary, no formatting)
+void TaskVoiceDiag(uint32_t now)
+{
+    (void)now;
+    SendVoiceDiag();
+}
 
-        // LED2 flash on USB receive (cyan) or MIDI note (magenta)
-        if(midi_flash)
+// Per-task run time and lateness since the last report
+void SendTaskStats()
+{
+    Codec::TaskStats msg;
+    msg.max_pass_us = Codec::Saturate16(main_tasks.GetMaxPassUs());
+    msg.count = main_tasks.GetTaskCount();
+    for(size_t i = 0; i < msg.count; i++)
+    {
+        const TaskScheduler::Task&  t = main_tasks.GetTask(i);
+        Codec::TaskStats::Entry&    e = msg.tasks[i];
+        const TaskScheduler::Stats& s = t.stats;
+        e.name        = t.name;
+        e.name_len    = strlen(t.name);
+        e.priority    = static_cast<uint8_t>(t.priority);
+        e.runs        = Codec::Saturate16(s.runs);
+        e.avg_us      = Codec::Saturate16(s.runs > 0 ? s.total_us / s.runs : 0);
+        e.max_us      = Codec::Saturate16(s.max_us);
+        e.max_late_ms = Codec::Saturate16(s.max_late_ms);
+        e.overruns    = s.overruns > 0xFF ? 0xFF : s.overruns;
+        e.deferred    = s.deferred > 0xFF ? 0xFF : s.deferred;
+    }
+    Send(msg);
+    main_tasks.ResetStats();
+}
+
+// Periodic diagnostics (every 2 seconds; text only for anomalies)
+void TaskDiagnostics(uint32_t now)
+{
+    (void)now;
+    SendTaskStats();
+
+#if PROFILE_DRUM_STALLS
+    // Worst sampler block since last report (trigger bursts show up here)
+    char drum_buf[48];
+    uint32_t ticks_per_us = System::GetTickFreq() / 1000000;
+    sprintf(drum_buf, "Drum: max %lu us/blk (cache %s)",
+            drum_ticks_max / ticks_per_us,
+            SAMPLER_ATTACK_CACHE ? "ON" : "OFF");
+    drum_ticks_max = 0;
+    SendDebug(drum_buf);
+#endif
+
+    // Automation point count, when it or the blend mode changed
+    static uint16_t last_auto_points = 0;
+    static bool     last_auto_blend  = false;
+    uint16_t auto_points = automation.GetTotalPointCount();
+    bool     auto_blend  = automation.IsBlendEnabled();
+    if(auto_points != last_auto_points || auto_blend != last_auto_blend)
+    {
+        last_auto_points = auto_points;
+        last_auto_blend  = auto_blend;
+        char auto_buf[48];
+        sprintf(auto_buf, "Auto: %d pts, Blend: %s",
+                auto_points,
+                auto_blend ? "ON" : "OFF");
+        SendDebug(auto_buf);
+    }
+
+    // Report anomalies
+    if(synth.HadNaN())
+    {
+        SendDebug("WARN: NaN detected, voice reset");
+    }
+    if(synth.HadStuckVoice())
+    {
+        SendDebug("WARN: Stuck voice killed after 3s");
+    }
+    static uint32_t last_midi_dropped = 0;
+    static uint32_t last_monitor_dropped = 0;
+    static uint32_t last_freeze_dropped = 0;
+    static uint32_t last_command_dropped = 0;
+    ReportQueueOverflow("Live MIDI", midi_in_queue.GetOverflows(), last_midi_dropped);
+    ReportQueueOverflow("Monitor", monitor_queue.GetOverflows(), last_monitor_dropped);
+    ReportQueueOverflow("Freeze", freeze_queue.GetOverflows(), last_freeze_dropped);
+    ReportQueueOverflow("Command", engine_queue.GetOverflows(), last_command_dropped);
+    static uint32_t last_telemetry_dropped = 0;
+    ReportQueueOverflow("Telemetry", telemetry_tap.GetOverflows(), last_telemetry_dropped);
+
+    // USB backpressure since last report (drops are reported like queue overflows)
+    static uint32_t last_usb_dropped = 0;
+    static uint32_t last_usb_busy    = 0;
+    const UsbTx::Stats& tx = usb_tx.GetStats();
+    if(tx.busy != last_usb_busy)
+    {
+        char tx_buf[64];
+        sprintf(tx_buf, "USB TX: %lu busy, %lu xfers, peak %lu/%lu B",
+                tx.busy - last_usb_busy,
+                tx.transfers,
+                tx.high_water,
+                UsbTx::RING_SIZE);
+        last_usb_busy = tx.busy;
+        SendDebug(tx_buf);
+    }
+    ReportQueueOverflow("USB TX", tx.drops, last_usb_dropped);
+    static uint32_t last_usb_rx_dropped = 0;
+    ReportQueueOverflow("USB RX", usb_rx.GetOverflows(), last_usb_rx_dropped);
+
+    // Link errors since last report: bad frames received, bulk retransmits
+    static uint32_t last_rx_errors   = 0;
+    static uint32_t last_retransmits = 0;
+    const ReliableLink::Stats& link = link_history.GetStats();
+    if(parser.errors != last_rx_errors || link.retransmits != last_retransmits)
+    {
+        char link_buf[64];
+        sprintf(link_buf, "Link: %lu bad RX, %lu resent, %lu lost",
+                parser.errors - last_rx_errors,
+                link.retransmits - last_retransmits,
+                link.gaps);
+        last_rx_errors   = parser.errors;
+        last_retransmits = link.retransmits;
+        SendDebug(link_buf);
+    }
+
+    // Command work since last report (budget: EngineCommand::BLOCK_BUDGET units/block)
+    if(engine_executor.GetMaxUnits() > 0)
+    {
+        char cmd_buf[48];
+        sprintf(cmd_buf, "Cmd: max %lu/%lu units/blk, %lu deferred",
+                engine_executor.GetMaxUnits(),
+                EngineCommand::BLOCK_BUDGET,
+                engine_executor.GetDeferredCount());
+        engine_executor.ResetMaxUnits();
+        SendDebug(cmd_buf);
+    }
+}
+
+// LED2 flashes on USB receive or MIDI note; LED1 shows transport with beat pulse
+void TaskLeds(uint32_t now)
+{
+    // LED2 flash on USB receive (cyan) or MIDI note (magenta)
+    if(midi_flash)
+    {
+        hw.led2.Set(1.0f, 0.0f, 1.0f);  // Magenta for MIDI
+        flash_start = now;
+        midi_flash  = false;
+    }
+    else if(flash_led)
+    {
+        hw.led2.Set(0.0f, 1.0f, 1.0f);  // Cyan for USB
+        flash_start = now;
+        flash_led   = false;
+    }
+    else if(now - flash_start > 100)
+    {
+        hw.led2.Set(0.0f, 0.0f, 0.0f);
+    }
+
+    // LED1 shows transport state with beat pulse
+    {
+        const Transport::Position& pos = transport.GetPosition();
+        bool on_beat = (pos.pulse < 12);  // Flash for first ~12 ticks of beat
+
+        if(transport.IsRecording())
         {
-            hw.led2.Set(1.0f, 0.0f, 1.0f);  // Magenta for MIDI
-            flash_start = now;
-            midi_flash  = false;
+            // Red for recording, pulse on beat
+            hw.led1.Set(on_beat ? 1.0f : 0.3f, 0.0f, 0.0f);
         }
-        else if(flash_led)
+        else if(transport.IsPlaying())
         {
-            hw.led2.Set(0.0f, 1.0f, 1.0f);  // Cyan for USB
-            flash_start = now;
-            flash_led   = false;
+            // Green for playing, pulse on beat
+            hw.led1.Set(0.0f, on_beat ? 1.0f : 0.3f, 0.0f);
         }
-        else if(now - flash_start > 100)
+        else
         {
-            hw.led2.Set(0.0f, 0.0f, 0.0f);
+            // Dim blue for stopped
+            hw.led1.Set(0.0f, 0.0f, 0.15f);
         }
+    }
+}
 
-        // LED1 shows transport state with beat pulse
-        {
-            const Transport::Position& pos = transport.GetPosition();
-            bool on_beat = (pos.pulse < 12);  // Flash for first ~12 ticks of beat
+int main(void)
+{
+    // Initialize hardware
+    hw.Init();
 
-            if(transport.IsRecording())
-            {
-                // Red for recording, pulse on beat
-                hw.led1.Set(on_beat ? 1.0f : 0.3f, 0.0f, 0.0f);
-            }
-            else if(transport.IsPlaying())
-            {
-                // Green for playing, pulse on beat
-                hw.led1.Set(0.0f, on_beat ? 1.0f : 0.3f, 0.0f);
-            }
-            else
-            {
-                // Dim blue for stopped
-                hw.led1.Set(0.0f, 0.0f, 0.15f);
-            }
-        }
+    // Enable FPU Flush-to-Zero mode to prevent denormalized float slowdowns
+    // This is critical for audio DSP - denormals can cause 10-100x slowdown
+    uint32_t fpscr = __get_FPSCR();
+    fpscr |= (1 << 24);  // Set FZ (Flush-to-Zero) bit
+    __set_FPSCR(fpscr);
+
+    // The session (memory-mapped QSPI) picks the sample rate and block size,
+    // so it is scanned before anything is tuned to them
+    session_dir.Scan(static_cast<const uint8_t*>(hw.seed.qspi.GetData(Session::FLASH_OFFSET)),
+                     Session::REGION_SIZE);
+    audio_settings = StoredAudioSettings();
+    audio_running  = audio_settings;
+    hw.SetAudioSampleRate(SaiRate(audio_settings.rate));
+    hw.SetAudioBlockSize(audio_settings.block);
+
+    // Initialize USB CDC
+    usb_rx.Init();
+    hw.seed.usb_handle.Init(UsbHandle::FS_INTERNAL);
+    hw.seed.usb_handle.SetReceiveCallback(UsbReceiveCallback,
+                                          UsbHandle::FS_INTERNAL);
+    usb_tx.Init(UsbTransmit);
+    pattern_sender.Init();
+    link_history.Init();
+    state_sync.Init();
+    clock_publisher.Init();
+    clock_scheduler.Init(hw.AudioSampleRate(), Transport::PPQN);
+    telemetry_tap.Init();
+    telemetry.Init(hw.AudioSampleRate());
+
+    // Live MIDI queue and sample clock must be ready before the audio callback runs
+    midi_parser.Reset();
+    midi_in_queue.Init();
+    monitor_queue.Init();
+    freeze_queue.Init();
+    engine_queue.Init();
+    import_queue.Init();
+    engine_executor.Init(ApplyEngineCommand);
+    cc_coalescer.Init(ApplyParamTarget);
+    midi_clock.Init(hw.AudioSampleRate(), System::GetTickFreq());
+
+    // Initialize CPU load meter for diagnostics
+    cpu_meter.Init(hw.AudioSampleRate(), hw.AudioBlockSize());
+
+    // Initialize transport engine with audio sample rate
+    transport.Init(hw.AudioSampleRate());
+
+    // Initialize sequencer with pattern length from transport
+    sequencer.Init(transport.GetPatternTicks());
+
+    // Initialize automation with same pattern length
+    automation.Init(transport.GetPatternTicks());
+
+    // Initialize sampler and generate samples
+    sampler.Init();
+    sampler.SetSampleRate(hw.AudioSampleRate());
+    sample_bank.Generate(hw.AudioSampleRate());
+
+    // Initialize synth engine
+    synth.Init(hw.AudioSampleRate());
+
+    // Initialize MIDI router (connects sampler, synth, and companion)
+    // Live events reach the companion through the monitor queue
+    midi_router.Init(&sampler, &synth, QueueMonitorEvent);
+    midi_router.SetRecordCallback(RouterRecordCallback);
+
+    // Initialize CC mapping engine (4-bank system)
+    cc_engine.Init();
+
+    // Initialize audio track manager for freeze/unfreeze
+    InitAudioTracks();
+
+    // Connect sequencer playback to callback (for unified routing)
+    sequencer.SetPlaybackCallback(SequencerPlaybackCallback);
+
+    // Load samples into sampler slots (pads 0-7 = notes 36-43)
+    LoadDrumSamples();
+
+    // Start ADC and Audio (required for full hardware init). Only now: the
+    // callback renders every engine above, and their Init() must have run
+    // (the synth reads its parameters through a pointer Init() sets).
+    hw.StartAdc();
+    hw.StartAudio(AudioCallback);
+
+    // Initialize MIDI input (UART on D14), parsed in the receive ISR
+    UartHandler::Config midi_uart_cfg;
+    midi_uart_cfg.periph        = UartHandler::Config::Peripheral::USART_1;
+    midi_uart_cfg.mode          = UartHandler::Config::Mode::RX;
+    midi_uart_cfg.baudrate      = 31250;
+    midi_uart_cfg.pin_config.rx = seed::D14;
+    midi_uart_cfg.pin_config.tx = seed::D13;
+    midi_uart.Init(midi_uart_cfg);
+    midi_uart.DmaListenStart(midi_rx_dma, sizeof(midi_rx_dma), MidiUartRxCallback, nullptr);
+
+    // Initialize parser
+    parser.Reset();
+
+    // Give USB time to enumerate
+    System::Delay(500);
+
+    // Send startup message (as DEBUG)
+    SendDebug("GroovyDaisy v1.0 - Synth + Drums");
+
+    // Send initial state
+    state_sync.RequestSnapshot();
+    SendResources();
+    SendAudioConfig(Protocol::AudioState::OK);
+
+    // Restore the stored session (scanned above) straight from QSPI. Saving
+    // starts once it has been applied (session_loaded), or now if there is
+    // nothing to restore.
+    session_saver.Init(session_dir, EncodeSessionChunk, SessionErase, SessionProgram, System::GetUs);
+    if(session_dir.GetValidCount() == 0 || !QueueEngineCommand(EngineCommand::Type::LOAD_SESSION))
+    {
+        session_saver.Enable();
+    }
+
+    // Main-loop tasks. Input runs every pass and between all other tasks;
+    // bulk work only starts while the pass is within its budget.
+    using TaskScheduler::Priority;
+    main_tasks.Init(System::GetUs);
+    main_tasks.Add("controls", TaskControls, Priority::INPUT, 1, 100);
+    main_tasks.Add("usb_rx", TaskUsbRx, Priority::INPUT, 0, 200);
+    main_tasks.Add("notify", TaskNotifications, Priority::INPUT, 0, 100);
+    main_tasks.Add("frame", TaskFrame, Priority::REALTIME, MONITOR_FRAME_MS, 300);
+    main_tasks.Add("leds", TaskLeds, Priority::NORMAL, 5, 20);
+    main_tasks.Add("voices", TaskVoiceDiag, Priority::NORMAL, VOICE_DIAG_MS, 100);
+    main_tasks.Add("resource", TaskResources, Priority::NORMAL, 1000, 100);
+    main_tasks.Add("smf", TaskSmf, Priority::NORMAL, 0, 100);
+    main_tasks.Add("diag", TaskDiagnostics, Priority::NORMAL, 2000, 500);
+    main_tasks.Add("pattern", ServicePatternSync, Priority::BULK, 0, 500);
+    main_tasks.Add("telem", SendTelemetry, Priority::BULK, MONITOR_FRAME_MS, 500);
+    main_tasks.Add("session", TaskSession, Priority::BULK, 0, SESSION_BUDGET_US);
+
+    // Main loop
+    while(1)
+    {
+        main_tasks.RunPass(System::GetNow());
+
+        // Everything queued this pass goes out as one USB transfer
+        usb_tx.Flush();
 
         hw.UpdateLeds();
         System::Delay(1);
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef GROOVYDAISY_AUDIO_CONFIG_H
+#define GROOVYDAISY_AUDIO_CONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * GroovyDaisy Audio Configuration
+ *
+ * Sample rate and block size are chosen per session (Session CHUNK_AUDIO)
+ * and can be changed at run time (CMD_AUDIO_CONFIG). The main loop applies
+ * a change with audio stopped: codec and DMA are reprogrammed, the drum
+ * samples are regenerated at the new rate and every rate-dependent engine
+ * is retuned (see ApplyAudioConfig in GroovyDaisy.cpp). Patterns, presets
+ * and mixer settings are kept; sounding voices are cut and frozen tracks
+ * are re-rendered on the next loop.
+ *
+ * Live MIDI reaches the speaker two blocks after it arrives: it is applied
+ * in the block after the one it arrived in (midi_input.h), and a block
+ * plays out while the next one renders. Higher rates and smaller blocks
+ * cost CPU; the benchmark matrix (CMD_AUDIO_BENCH on the device,
+ * render_tool -bench on the host) measures the load of every combination
+ * so a show can pick its trade-off.
+ */
+
+namespace AudioConfig
+{
+
+// Codec rates the SAI can run (Hz)
+constexpr uint32_t RATES[]   = {32000, 48000, 96000};
+constexpr size_t   NUM_RATES = sizeof(RATES) / sizeof(RATES[0]);
+
+constexpr uint32_t DEFAULT_RATE = 48000;
+constexpr uint32_t MAX_RATE     = 96000;  // Sizes the drum sample bank
+constexpr uint16_t DEFAULT_BLOCK = 64;
+constexpr uint16_t MIN_BLOCK     = 16;
+constexpr uint16_t MAX_BLOCK     = 256;   // libDaisy's DMA buffer limit
+
+// Block sizes swept by the benchmark (any power of two in range is valid)
+constexpr uint16_t BENCH_BLOCKS[]   = {16, 32, 64, 128, 256};
+constexpr size_t   NUM_BENCH_BLOCKS = sizeof(BENCH_BLOCKS) / sizeof(BENCH_BLOCKS[0]);
+constexpr size_t   NUM_BENCH_CELLS  = NUM_RATES * NUM_BENCH_BLOCKS;
+
+struct Settings
+{
+    uint32_t rate;   // Hz
+    uint16_t block;  // Frames per callback
+};
+
+constexpr Settings DEFAULTS = {DEFAULT_RATE, DEFAULT_BLOCK};
+
+inline bool IsValidRate(uint32_t rate)
+{
+    for(size_t i = 0; i < NUM_RATES; i++)
+    {
+        if(RATES[i] == rate)
+            return true;
+    }
+    return false;
+}
+
+inline bool IsValidBlock(uint32_t block)
+{
+    return block >= MIN_BLOCK && block <= MAX_BLOCK && (block & (block - 1)) == 0;
+}
+
+inline bool IsValid(const Settings& s)
+{
+    return IsValidRate(s.rate) && IsValidBlock(s.block);
+}
+
+/**
+ * Live MIDI in to audio out, excluding UART and codec (microseconds)
+ */
+inline uint32_t LatencyUs(const Settings& s)
+{
+    return static_cast<uint32_t>(2ull * s.block * 1000000ull / s.rate);
+}
+
+/**
+ * Benchmark matrix cell (rate-major)
+ */
+inline Settings BenchCell(size_t index)
+{
+    Settings s;
+    s.rate  = RATES[(index / NUM_BENCH_BLOCKS) % NUM_RATES];
+    s.block = BENCH_BLOCKS[index % NUM_BENCH_BLOCKS];
+    return s;
+}
+
+} // namespace AudioConfig
+
+#endif // GROOVYDAISY_AUDIO_CONFIG_H
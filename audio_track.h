@@ -35,6 +35,7 @@ enum class Status : uint8_t
 
 // Maximum audio buffer size per track
 // 32 seconds @ 48kHz stereo = 1,536,000 samples per channel
+// (about 48 s at 32 kHz, 16 s at 96 kHz: the buffers are fixed)
 constexpr size_t MAX_TRACK_SAMPLES = 48000 * 32;
 
 // Number of frozen track slots (limited by SDRAM)
@@ -123,53 +123,21 @@ class Engine
         if(idx >= NUM_AUTO_CCS)
             return;
 
-        AutoTrack& track = tracks_[idx];
-
         // Update current value (for blend calculation)
         current_values_[idx] = value;
 
-        // Thinning: skip if too close to last point AND value hasn't changed much
-        if(track.point_count > 0)
-        {
-            uint32_t tick_diff  = tick - track.last_recorded_tick;
-            int      value_diff = abs(static_cast<int>(value) -
-                                      static_cast<int>(track.last_recorded_value));
-
-            if(tick_diff < MIN_RECORD_INTERVAL && value_diff < MIN_VALUE_CHANGE)
-            {
-                return;  // Skip this point
-            }
-        }
-
-        // Check capacity
-        if(track.point_count >= MAX_AUTO_POINTS)
-            return;
-
-        // Find insertion point (maintain sorted order)
-        uint16_t insert_pos = track.point_count;
-        for(uint16_t i = 0; i < track.point_count; i++)
-        {
-            if(track.points[i].tick > tick)
-            {
-                insert_pos = i;
-                break;
-            }
-        }
-
-        // Shift points to make room
-        for(uint16_t i = track.point_count; i > insert_pos; i--)
-        {
-            track.points[i] = track.points[i - 1];
-        }
-
-        // Insert new point
-        track.points[insert_pos].tick  = tick;
-        track.points[insert_pos].value = value;
-        track.point_count++;
+        AddPoint(idx, tick, value);
+    }
 
-        // Update last recorded
-        track.last_recorded_tick  = tick;
-        track.last_recorded_value = value;
+    /**
+     * Add a CC value from an imported file (smf.h)
+     * Thinned like RecordCC; the live knob position is left alone.
+     * Returns false if the CC is not automated or its lane is full.
+     */
+    bool ImportCC(uint32_t tick, uint8_t cc, uint8_t value)
+    {
+        uint8_t idx = GetCCIndex(cc);
+        return idx < NUM_AUTO_CCS && AddPoint(idx, tick, value);
     }
 
     /**
@@ -401,6 +369,74 @@ class Engine
         return 0;
     }
 
+    /**
+     * Get the automation track for a lane (index into AUTO_CCS)
+     */
+    const AutoTrack& GetTrack(uint8_t idx) const { return tracks_[idx % NUM_AUTO_CCS]; }
+
+    /**
+     * Append a point to the end of a lane (session load)
+     * Points must arrive in tick order. Returns false when the lane is full.
+     */
+    bool AppendPoint(uint8_t idx, uint32_t tick, uint8_t value)
+    {
+        if(idx >= NUM_AUTO_CCS || tracks_[idx].point_count >= MAX_AUTO_POINTS)
+            return false;
+        AutoTrack& track = tracks_[idx];
+        track.points[track.point_count].tick  = tick;
+        track.points[track.point_count].value = value;
+        track.point_count++;
+        track.last_recorded_tick  = tick;
+        track.last_recorded_value = value;
+        return true;
+    }
+
+  private:
+    /**
+     * Insert a point in tick order unless thinning skips it
+     * Returns false only when the lane is full.
+     */
+    bool AddPoint(uint8_t idx, uint32_t tick, uint8_t value)
+    {
+        AutoTrack& track = tracks_[idx];
+
+        // Thinning: skip if too close to last point AND value hasn't changed much
+        if(track.point_count > 0)
+        {
+            uint32_t tick_diff  = tick - track.last_recorded_tick;
+            int      value_diff = abs(static_cast<int>(value) -
+                                      static_cast<int>(track.last_recorded_value));
+
+            if(tick_diff < MIN_RECORD_INTERVAL && value_diff < MIN_VALUE_CHANGE)
+            {
+                return true;  // Skip this point
+            }
+        }
+
+        // Check capacity
+        if(track.point_count >= MAX_AUTO_POINTS)
+            return false;
+
+        // Find insertion point (maintain sorted order); scanning from the
+        // end makes in-order recording and import O(1)
+        uint16_t insert_pos = track.point_count;
+        while(insert_pos > 0 && track.points[insert_pos - 1].tick > tick)
+        {
+            track.points[insert_pos] = track.points[insert_pos - 1];
+            insert_pos--;
+        }
+
+        // Insert new point
+        track.points[insert_pos].tick  = tick;
+        track.points[insert_pos].value = value;
+        track.point_count++;
+
+        // Update last recorded
+        track.last_recorded_tick  = tick;
+        track.last_recorded_value = value;
+        return true;
+    }
+
   private:
     AutoTrack tracks_[NUM_AUTO_CCS];
     uint8_t   base_values_[NUM_AUTO_CCS];     // Captured at playback start
@@ -0,0 +1,307 @@
+#pragma once
+#ifndef GROOVYDAISY_CC_BANKS_H
+#define GROOVYDAISY_CC_BANKS_H
+
+#include <stdint.h>
+
+// Generated by tools/gen_cc_map.py - do not edit, run `make cc-tables`
+
+/**
+ * GroovyDaisy CC Bank Tables
+ *
+ * Hardware CC layout, parameter targets and bank maps. The companion's
+ * ccBanks.generated.ts is produced from the same source.
+ */
+
+namespace CCMap
+{
+
+// Bank switch CCs
+constexpr uint8_t CC_BANK_NEXT = 1;   // Part 1 / Next button
+constexpr uint8_t CC_BANK_PREV = 2;   // Part 2 / Prev button
+
+// Hardware CC numbers
+constexpr uint8_t NUM_ENCODERS = 9;
+constexpr uint8_t NUM_FADERS = 9;
+
+// Encoder CCs (in physical order L->R)
+constexpr uint8_t ENCODER_CCS[NUM_ENCODERS] = {74, 71, 76, 77, 93, 18, 19, 16, 17};
+
+// Fader CCs (in physical order L->R)
+constexpr uint8_t FADER_CCS[NUM_FADERS] = {73, 75, 79, 72, 80, 81, 82, 83, 85};
+
+// CC value -> parameter value conversion
+enum Curve : uint8_t
+{
+    CURVE_NONE,  // No conversion (unmapped)
+    CURVE_NORM,  // 0.0-1.0 linear
+    CURVE_FREQ,  // 20-20000 Hz logarithmic
+    CURVE_TIME,  // 0.001-5.0 s logarithmic
+    CURVE_WAVE,  // Waveform index 0-3
+    CURVE_SEMI,  // -24 to +24 semitones
+    CURVE_PAN,   // -1.0 to +1.0
+    CURVE_RATE,  // 0.05-20 Hz logarithmic (LFO)
+    CURVE_ROUTE, // Mod matrix route 0-23
+    CURVE_AMOUNT, // -1.0 to +1.0 (mod amount)
+};
+
+// Parameter types for routing
+enum ParamTarget : uint8_t
+{
+    TARGET_NONE = 0,
+    TARGET_SYNTH_OSC1_WAVE,
+    TARGET_SYNTH_OSC2_WAVE,
+    TARGET_SYNTH_OSC1_LEVEL,
+    TARGET_SYNTH_OSC2_LEVEL,
+    TARGET_SYNTH_OSC2_DETUNE,
+    TARGET_SYNTH_FILTER_CUTOFF,
+    TARGET_SYNTH_FILTER_RES,
+    TARGET_SYNTH_FILTER_ENV_AMT,
+    TARGET_SYNTH_AMP_ATTACK,
+    TARGET_SYNTH_AMP_DECAY,
+    TARGET_SYNTH_AMP_SUSTAIN,
+    TARGET_SYNTH_AMP_RELEASE,
+    TARGET_SYNTH_FILT_ATTACK,
+    TARGET_SYNTH_FILT_DECAY,
+    TARGET_SYNTH_FILT_SUSTAIN,
+    TARGET_SYNTH_FILT_RELEASE,
+    TARGET_SYNTH_VEL_TO_AMP,
+    TARGET_SYNTH_VEL_TO_FILTER,
+    TARGET_SYNTH_LEVEL,
+    TARGET_SYNTH_PAN,
+    TARGET_SYNTH_MASTER_LEVEL,
+    TARGET_SYNTH_LFO1_RATE,
+    TARGET_SYNTH_LFO1_WAVE,
+    TARGET_SYNTH_LFO2_RATE,
+    TARGET_SYNTH_LFO2_WAVE,
+    TARGET_SYNTH_LFO_DEPTH,
+    TARGET_SYNTH_MOD1_ROUTE,
+    TARGET_SYNTH_MOD1_AMOUNT,
+    TARGET_SYNTH_MOD2_ROUTE,
+    TARGET_SYNTH_MOD2_AMOUNT,
+    TARGET_SYNTH_MOD3_ROUTE,
+    TARGET_SYNTH_MOD3_AMOUNT,
+    TARGET_DRUM_1_LEVEL,
+    TARGET_DRUM_2_LEVEL,
+    TARGET_DRUM_3_LEVEL,
+    TARGET_DRUM_4_LEVEL,
+    TARGET_DRUM_5_LEVEL,
+    TARGET_DRUM_6_LEVEL,
+    TARGET_DRUM_7_LEVEL,
+    TARGET_DRUM_8_LEVEL,
+    TARGET_DRUM_1_PAN,
+    TARGET_DRUM_2_PAN,
+    TARGET_DRUM_3_PAN,
+    TARGET_DRUM_4_PAN,
+    TARGET_DRUM_5_PAN,
+    TARGET_DRUM_6_PAN,
+    TARGET_DRUM_7_PAN,
+    TARGET_DRUM_8_PAN,
+    TARGET_DRUM_MASTER_LEVEL,
+    TARGET_MASTER_OUTPUT,
+    TARGET_COUNT
+};
+
+// Value curve of each target
+constexpr Curve TARGET_CURVES[TARGET_COUNT] = {
+    CURVE_NONE,  // NONE
+    CURVE_WAVE,  // SYNTH_OSC1_WAVE
+    CURVE_WAVE,  // SYNTH_OSC2_WAVE
+    CURVE_NORM,  // SYNTH_OSC1_LEVEL
+    CURVE_NORM,  // SYNTH_OSC2_LEVEL
+    CURVE_SEMI,  // SYNTH_OSC2_DETUNE
+    CURVE_FREQ,  // SYNTH_FILTER_CUTOFF
+    CURVE_NORM,  // SYNTH_FILTER_RES
+    CURVE_NORM,  // SYNTH_FILTER_ENV_AMT
+    CURVE_TIME,  // SYNTH_AMP_ATTACK
+    CURVE_TIME,  // SYNTH_AMP_DECAY
+    CURVE_NORM,  // SYNTH_AMP_SUSTAIN
+    CURVE_TIME,  // SYNTH_AMP_RELEASE
+    CURVE_TIME,  // SYNTH_FILT_ATTACK
+    CURVE_TIME,  // SYNTH_FILT_DECAY
+    CURVE_NORM,  // SYNTH_FILT_SUSTAIN
+    CURVE_TIME,  // SYNTH_FILT_RELEASE
+    CURVE_NORM,  // SYNTH_VEL_TO_AMP
+    CURVE_NORM,  // SYNTH_VEL_TO_FILTER
+    CURVE_NORM,  // SYNTH_LEVEL
+    CURVE_PAN,  // SYNTH_PAN
+    CURVE_NORM,  // SYNTH_MASTER_LEVEL
+    CURVE_RATE,  // SYNTH_LFO1_RATE
+    CURVE_WAVE,  // SYNTH_LFO1_WAVE
+    CURVE_RATE,  // SYNTH_LFO2_RATE
+    CURVE_WAVE,  // SYNTH_LFO2_WAVE
+    CURVE_NORM,  // SYNTH_LFO_DEPTH
+    CURVE_ROUTE,  // SYNTH_MOD1_ROUTE
+    CURVE_AMOUNT,  // SYNTH_MOD1_AMOUNT
+    CURVE_ROUTE,  // SYNTH_MOD2_ROUTE
+    CURVE_AMOUNT,  // SYNTH_MOD2_AMOUNT
+    CURVE_ROUTE,  // SYNTH_MOD3_ROUTE
+    CURVE_AMOUNT,  // SYNTH_MOD3_AMOUNT
+    CURVE_NORM,  // DRUM_1_LEVEL
+    CURVE_NORM,  // DRUM_2_LEVEL
+    CURVE_NORM,  // DRUM_3_LEVEL
+    CURVE_NORM,  // DRUM_4_LEVEL
+    CURVE_NORM,  // DRUM_5_LEVEL
+    CURVE_NORM,  // DRUM_6_LEVEL
+    CURVE_NORM,  // DRUM_7_LEVEL
+    CURVE_NORM,  // DRUM_8_LEVEL
+    CURVE_PAN,  // DRUM_1_PAN
+    CURVE_PAN,  // DRUM_2_PAN
+    CURVE_PAN,  // DRUM_3_PAN
+    CURVE_PAN,  // DRUM_4_PAN
+    CURVE_PAN,  // DRUM_5_PAN
+    CURVE_PAN,  // DRUM_6_PAN
+    CURVE_PAN,  // DRUM_7_PAN
+    CURVE_PAN,  // DRUM_8_PAN
+    CURVE_NORM,  // DRUM_MASTER_LEVEL
+    CURVE_NORM,  // MASTER_OUTPUT
+};
+
+/**
+ * Mapping entry: what a control does in a specific bank
+ */
+struct ControlMapping
+{
+    ParamTarget target;
+    const char* name;
+};
+
+/**
+ * Bank mappings - what each encoder/fader does per bank
+ */
+struct BankMappings
+{
+    const char* bank_name;
+    ControlMapping encoders[NUM_ENCODERS];
+    ControlMapping faders[NUM_FADERS];
+};
+
+// Bank definitions
+enum Bank : uint8_t
+{
+    BANK_GENERAL = 0,
+    BANK_MIX = 1,
+    BANK_SYNTH = 2,
+    BANK_SAMPLER = 3,
+    NUM_BANKS = 4
+};
+
+// Bank 0: General (Master Controls + Modulation)
+constexpr BankMappings BANK_GENERAL_MAP = {
+    "General",
+    {
+        {TARGET_SYNTH_LFO1_RATE, "LFO1Rt"},
+        {TARGET_SYNTH_LFO1_WAVE, "LFO1Wv"},
+        {TARGET_SYNTH_LFO2_RATE, "LFO2Rt"},
+        {TARGET_SYNTH_LFO2_WAVE, "LFO2Wv"},
+        {TARGET_SYNTH_MOD1_AMOUNT, "Mod1"},
+        {TARGET_SYNTH_MOD2_AMOUNT, "Mod2"},
+        {TARGET_SYNTH_MOD3_AMOUNT, "Mod3"},
+        {TARGET_NONE, "---"},
+        {TARGET_NONE, "---"},
+    },
+    {
+        {TARGET_DRUM_MASTER_LEVEL, "DrumMst"},
+        {TARGET_SYNTH_MASTER_LEVEL, "SynthMst"},
+        {TARGET_NONE, "---"},
+        {TARGET_SYNTH_LFO_DEPTH, "LFO Dep"},
+        {TARGET_NONE, "---"},
+        {TARGET_NONE, "---"},
+        {TARGET_SYNTH_VEL_TO_AMP, "Vel>Amp"},
+        {TARGET_SYNTH_VEL_TO_FILTER, "Vel>Flt"},
+        {TARGET_MASTER_OUTPUT, "Master"},
+    },
+};
+
+// Bank 1: Mix (Individual Levels + Pan)
+constexpr BankMappings BANK_MIX_MAP = {
+    "Mix",
+    {
+        {TARGET_DRUM_1_PAN, "D1 Pan"},
+        {TARGET_DRUM_2_PAN, "D2 Pan"},
+        {TARGET_DRUM_3_PAN, "D3 Pan"},
+        {TARGET_DRUM_4_PAN, "D4 Pan"},
+        {TARGET_DRUM_5_PAN, "D5 Pan"},
+        {TARGET_DRUM_6_PAN, "D6 Pan"},
+        {TARGET_DRUM_7_PAN, "D7 Pan"},
+        {TARGET_DRUM_8_PAN, "D8 Pan"},
+        {TARGET_SYNTH_PAN, "Syn Pan"},
+    },
+    {
+        {TARGET_DRUM_1_LEVEL, "D1 Lvl"},
+        {TARGET_DRUM_2_LEVEL, "D2 Lvl"},
+        {TARGET_DRUM_3_LEVEL, "D3 Lvl"},
+        {TARGET_DRUM_4_LEVEL, "D4 Lvl"},
+        {TARGET_DRUM_5_LEVEL, "D5 Lvl"},
+        {TARGET_DRUM_6_LEVEL, "D6 Lvl"},
+        {TARGET_DRUM_7_LEVEL, "D7 Lvl"},
+        {TARGET_DRUM_8_LEVEL, "D8 Lvl"},
+        {TARGET_SYNTH_LEVEL, "Syn Lvl"},
+    },
+};
+
+// Bank 2: Synth (Sound Design)
+constexpr BankMappings BANK_SYNTH_MAP = {
+    "Synth",
+    {
+        {TARGET_SYNTH_FILTER_CUTOFF, "Cutoff"},
+        {TARGET_SYNTH_FILT_ATTACK, "FltAtk"},
+        {TARGET_SYNTH_FILT_DECAY, "FltDcy"},
+        {TARGET_SYNTH_OSC2_DETUNE, "Detune"},
+        {TARGET_SYNTH_AMP_ATTACK, "AmpAtk"},
+        {TARGET_SYNTH_AMP_DECAY, "AmpDcy"},
+        {TARGET_SYNTH_AMP_RELEASE, "AmpRel"},
+        {TARGET_SYNTH_OSC1_WAVE, "Wave1"},
+        {TARGET_SYNTH_OSC2_WAVE, "Wave2"},
+    },
+    {
+        {TARGET_SYNTH_OSC1_LEVEL, "Osc1"},
+        {TARGET_SYNTH_OSC2_LEVEL, "Osc2"},
+        {TARGET_SYNTH_FILTER_RES, "Reso"},
+        {TARGET_SYNTH_FILTER_ENV_AMT, "FltEnv"},
+        {TARGET_SYNTH_AMP_SUSTAIN, "AmpSus"},
+        {TARGET_SYNTH_FILT_SUSTAIN, "FltSus"},
+        {TARGET_SYNTH_FILT_RELEASE, "FltRel"},
+        {TARGET_SYNTH_LFO_DEPTH, "LFO Dep"},
+        {TARGET_SYNTH_LEVEL, "Syn Lvl"},
+    },
+};
+
+// Bank 3: Sampler (Per-Drum Sound Design - future)
+constexpr BankMappings BANK_SAMPLER_MAP = {
+    "Sampler",
+    {
+        {TARGET_NONE, "Pitch"},
+        {TARGET_NONE, "Decay"},
+        {TARGET_NONE, "Filter"},
+        {TARGET_NONE, "FltRes"},
+        {TARGET_NONE, "Swing"},
+        {TARGET_NONE, "---"},
+        {TARGET_NONE, "---"},
+        {TARGET_NONE, "---"},
+        {TARGET_NONE, "---"},
+    },
+    {
+        {TARGET_DRUM_1_LEVEL, "D1 Lvl"},
+        {TARGET_DRUM_2_LEVEL, "D2 Lvl"},
+        {TARGET_DRUM_3_LEVEL, "D3 Lvl"},
+        {TARGET_DRUM_4_LEVEL, "D4 Lvl"},
+        {TARGET_DRUM_5_LEVEL, "D5 Lvl"},
+        {TARGET_DRUM_6_LEVEL, "D6 Lvl"},
+        {TARGET_DRUM_7_LEVEL, "D7 Lvl"},
+        {TARGET_DRUM_8_LEVEL, "D8 Lvl"},
+        {TARGET_DRUM_MASTER_LEVEL, "DrumMst"},
+    },
+};
+
+// All bank mappings array
+constexpr const BankMappings* ALL_BANKS[NUM_BANKS] = {
+    &BANK_GENERAL_MAP,
+    &BANK_MIX_MAP,
+    &BANK_SYNTH_MAP,
+    &BANK_SAMPLER_MAP
+};
+
+} // namespace CCMap
+
+#endif // GROOVYDAISY_CC_BANKS_H
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <cmath>
 #include "synth.h"
+#include "cc_banks.h"
 
 /**
  * GroovyDaisy CC Mapping with 4-Bank System
@@ -21,24 +22,6 @@
 namespace CCMap
 {
 
-// Bank definitions
-enum Bank : uint8_t
-{
-    BANK_GENERAL = 0,   // Master controls
-    BANK_MIX = 1,       // Individual levels + pan
-    BANK_SYNTH = 2,     // Sound design
-    BANK_SAMPLER = 3,   // Per-drum parameters
-    NUM_BANKS = 4
-};
-
-// Bank switch CCs
-constexpr uint8_t CC_BANK_NEXT = 1;   // Part 1 / Next button
-constexpr uint8_t CC_BANK_PREV = 2;   // Part 2 / Prev button
-
-// Hardware CC numbers
-constexpr uint8_t NUM_ENCODERS = 9;
-constexpr uint8_t NUM_FADERS = 9;
-
 // CC number constants (for automation, router compatibility)
 constexpr uint8_t FILTER_CUTOFF = 74;  // Encoder 1
 constexpr uint8_t FILTER_RES    = 71;  // Encoder 2
@@ -60,209 +43,95 @@ constexpr uint8_t DRUM_3_LEVEL  = 82;  // Fader 7
 constexpr uint8_t DRUM_4_LEVEL  = 83;  // Fader 8
 constexpr uint8_t SYNTH_LEVEL   = 85;  // Fader 9
 
-constexpr uint8_t MOD_WHEEL     = 1;   // Mod wheel (shared with bank next)
+constexpr uint8_t MOD_WHEEL     = 11;  // Mod matrix wheel source (set the KeyLab user map's wheel to it)
+constexpr uint8_t GM_MOD_WHEEL  = 1;   // Standard mod wheel; bank next on the KeyLab, so files only
 constexpr uint8_t SUSTAIN       = 64;  // Sustain pedal
 
-// Encoder CCs (in physical order L->R)
-constexpr uint8_t ENCODER_CCS[NUM_ENCODERS] = {74, 71, 76, 77, 93, 18, 19, 16, 17};
-
-// Fader CCs (in physical order L->R)
-constexpr uint8_t FADER_CCS[NUM_FADERS] = {73, 75, 79, 72, 80, 81, 82, 83, 85};
-
 // Pickup tolerance (±3 CC values)
 constexpr uint8_t PICKUP_TOLERANCE = 3;
 
-// Parameter types for routing
-enum ParamTarget : uint8_t
+// CC smoothing: blocks to glide towards a new CC value (0 = jump, last value wins)
+#ifndef CC_SMOOTHING_BLOCKS
+#define CC_SMOOTHING_BLOCKS 0
+#endif
+
+// What a CC number is on the KeyLab
+enum ControlKind : uint8_t
 {
-    TARGET_NONE = 0,
-    // Synth params (match Synth::ParamId)
-    TARGET_SYNTH_OSC1_WAVE,
-    TARGET_SYNTH_OSC2_WAVE,
-    TARGET_SYNTH_OSC1_LEVEL,
-    TARGET_SYNTH_OSC2_LEVEL,
-    TARGET_SYNTH_OSC2_DETUNE,
-    TARGET_SYNTH_FILTER_CUTOFF,
-    TARGET_SYNTH_FILTER_RES,
-    TARGET_SYNTH_FILTER_ENV_AMT,
-    TARGET_SYNTH_AMP_ATTACK,
-    TARGET_SYNTH_AMP_DECAY,
-    TARGET_SYNTH_AMP_SUSTAIN,
-    TARGET_SYNTH_AMP_RELEASE,
-    TARGET_SYNTH_FILT_ATTACK,
-    TARGET_SYNTH_FILT_DECAY,
-    TARGET_SYNTH_FILT_SUSTAIN,
-    TARGET_SYNTH_FILT_RELEASE,
-    TARGET_SYNTH_VEL_TO_AMP,
-    TARGET_SYNTH_VEL_TO_FILTER,
-    TARGET_SYNTH_LEVEL,
-    TARGET_SYNTH_PAN,
-    TARGET_SYNTH_MASTER_LEVEL,
-    // Drum params
-    TARGET_DRUM_1_LEVEL,
-    TARGET_DRUM_2_LEVEL,
-    TARGET_DRUM_3_LEVEL,
-    TARGET_DRUM_4_LEVEL,
-    TARGET_DRUM_5_LEVEL,
-    TARGET_DRUM_6_LEVEL,
-    TARGET_DRUM_7_LEVEL,
-    TARGET_DRUM_8_LEVEL,
-    TARGET_DRUM_1_PAN,
-    TARGET_DRUM_2_PAN,
-    TARGET_DRUM_3_PAN,
-    TARGET_DRUM_4_PAN,
-    TARGET_DRUM_5_PAN,
-    TARGET_DRUM_6_PAN,
-    TARGET_DRUM_7_PAN,
-    TARGET_DRUM_8_PAN,
-    TARGET_DRUM_MASTER_LEVEL,
-    // Global params
-    TARGET_MASTER_OUTPUT,
-    TARGET_COUNT
+    CONTROL_NONE = 0,
+    CONTROL_ENCODER,
+    CONTROL_FADER,
+    CONTROL_BANK_NEXT,
+    CONTROL_BANK_PREV,
 };
 
 /**
- * Mapping entry: what a control does in a specific bank
+ * Resolved CC: everything ProcessCC needs in one 4-byte entry
  */
-struct ControlMapping
+struct CCDispatch
 {
-    ParamTarget target;
-    const char* name;
+    ControlKind kind;
+    uint8_t     index;   // Encoder or fader index
+    ParamTarget target;  // Target in this bank
+    Curve       curve;   // Value curve of the target
 };
 
 /**
- * Bank mappings - what each encoder/fader does per bank
+ * [bank][cc] dispatch table, built at compile time from the bank maps
  */
-struct BankMappings
+struct DispatchTable
 {
-    const char* bank_name;
-    ControlMapping encoders[NUM_ENCODERS];
-    ControlMapping faders[NUM_FADERS];
+    CCDispatch entries[NUM_BANKS][128];
 };
 
-// Bank 0: General (Master Controls)
-constexpr BankMappings BANK_GENERAL_MAP = {
-    "General",
-    // Encoders (mostly unused in General)
-    {
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-    },
-    // Faders
+constexpr DispatchTable BuildDispatchTable()
+{
+    DispatchTable t = {};
+    for(uint8_t b = 0; b < NUM_BANKS; b++)
     {
-        {TARGET_DRUM_MASTER_LEVEL, "DrumMst"},
-        {TARGET_SYNTH_MASTER_LEVEL, "SynthMst"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_SYNTH_VEL_TO_AMP, "Vel>Amp"},
-        {TARGET_SYNTH_VEL_TO_FILTER, "Vel>Flt"},
-        {TARGET_MASTER_OUTPUT, "Master"},
+        t.entries[b][CC_BANK_NEXT] = CCDispatch{CONTROL_BANK_NEXT, 0, TARGET_NONE, CURVE_NONE};
+        t.entries[b][CC_BANK_PREV] = CCDispatch{CONTROL_BANK_PREV, 0, TARGET_NONE, CURVE_NONE};
+        for(uint8_t i = 0; i < NUM_ENCODERS; i++)
+        {
+            ParamTarget target = ALL_BANKS[b]->encoders[i].target;
+            t.entries[b][ENCODER_CCS[i]] = CCDispatch{CONTROL_ENCODER, i, target, TARGET_CURVES[target]};
+        }
+        for(uint8_t i = 0; i < NUM_FADERS; i++)
+        {
+            ParamTarget target = ALL_BANKS[b]->faders[i].target;
+            t.entries[b][FADER_CCS[i]] = CCDispatch{CONTROL_FADER, i, target, TARGET_CURVES[target]};
+        }
     }
-};
+    return t;
+}
 
-// Bank 1: Mix (Individual Levels + Pan)
-constexpr BankMappings BANK_MIX_MAP = {
-    "Mix",
-    // Encoders (Pan)
-    {
-        {TARGET_DRUM_1_PAN, "D1 Pan"},
-        {TARGET_DRUM_2_PAN, "D2 Pan"},
-        {TARGET_DRUM_3_PAN, "D3 Pan"},
-        {TARGET_DRUM_4_PAN, "D4 Pan"},
-        {TARGET_DRUM_5_PAN, "D5 Pan"},
-        {TARGET_DRUM_6_PAN, "D6 Pan"},
-        {TARGET_DRUM_7_PAN, "D7 Pan"},
-        {TARGET_DRUM_8_PAN, "D8 Pan"},
-        {TARGET_SYNTH_PAN, "Syn Pan"},
-    },
-    // Faders (Levels)
-    {
-        {TARGET_DRUM_1_LEVEL, "D1 Lvl"},
-        {TARGET_DRUM_2_LEVEL, "D2 Lvl"},
-        {TARGET_DRUM_3_LEVEL, "D3 Lvl"},
-        {TARGET_DRUM_4_LEVEL, "D4 Lvl"},
-        {TARGET_DRUM_5_LEVEL, "D5 Lvl"},
-        {TARGET_DRUM_6_LEVEL, "D6 Lvl"},
-        {TARGET_DRUM_7_LEVEL, "D7 Lvl"},
-        {TARGET_DRUM_8_LEVEL, "D8 Lvl"},
-        {TARGET_SYNTH_LEVEL, "Syn Lvl"},
-    }
-};
+constexpr DispatchTable CC_DISPATCH = BuildDispatchTable();
 
-// Bank 2: Synth (Sound Design)
-constexpr BankMappings BANK_SYNTH_MAP = {
-    "Synth",
-    // Encoders
-    {
-        {TARGET_SYNTH_FILTER_CUTOFF, "Cutoff"},
-        {TARGET_SYNTH_FILT_ATTACK, "FltAtk"},
-        {TARGET_SYNTH_FILT_DECAY, "FltDcy"},
-        {TARGET_SYNTH_OSC2_DETUNE, "Detune"},
-        {TARGET_SYNTH_AMP_ATTACK, "AmpAtk"},
-        {TARGET_SYNTH_AMP_DECAY, "AmpDcy"},
-        {TARGET_SYNTH_AMP_RELEASE, "AmpRel"},
-        {TARGET_SYNTH_OSC1_WAVE, "Wave1"},
-        {TARGET_SYNTH_OSC2_WAVE, "Wave2"},
-    },
-    // Faders
-    {
-        {TARGET_SYNTH_OSC1_LEVEL, "Osc1"},
-        {TARGET_SYNTH_OSC2_LEVEL, "Osc2"},
-        {TARGET_SYNTH_FILTER_RES, "Reso"},
-        {TARGET_SYNTH_FILTER_ENV_AMT, "FltEnv"},
-        {TARGET_SYNTH_AMP_SUSTAIN, "AmpSus"},
-        {TARGET_SYNTH_FILT_SUSTAIN, "FltSus"},
-        {TARGET_SYNTH_FILT_RELEASE, "FltRel"},
-        {TARGET_NONE, "---"},
-        {TARGET_SYNTH_LEVEL, "Syn Lvl"},
-    }
-};
+static_assert(CC_DISPATCH.entries[BANK_SYNTH][74].target == TARGET_SYNTH_FILTER_CUTOFF,
+              "CC dispatch table out of sync with bank maps");
 
-// Bank 3: Sampler (Per-Drum Sound Design - future)
-constexpr BankMappings BANK_SAMPLER_MAP = {
-    "Sampler",
-    // Encoders (per-drum params - future expansion)
-    {
-        {TARGET_NONE, "Pitch"},      // Future: selected drum pitch
-        {TARGET_NONE, "Decay"},      // Future: selected drum decay
-        {TARGET_NONE, "Filter"},     // Future: selected drum filter
-        {TARGET_NONE, "FltRes"},     // Future: selected drum filter res
-        {TARGET_NONE, "Swing"},      // Future: swing amount
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-        {TARGET_NONE, "---"},
-    },
-    // Faders (drum levels for reference)
+/**
+ * True if a CC is not a bank control, encoder or fader in any bank
+ */
+constexpr bool IsFreeCC(uint8_t cc)
+{
+    for(uint8_t b = 0; b < NUM_BANKS; b++)
     {
-        {TARGET_DRUM_1_LEVEL, "D1 Lvl"},
-        {TARGET_DRUM_2_LEVEL, "D2 Lvl"},
-        {TARGET_DRUM_3_LEVEL, "D3 Lvl"},
-        {TARGET_DRUM_4_LEVEL, "D4 Lvl"},
-        {TARGET_DRUM_5_LEVEL, "D5 Lvl"},
-        {TARGET_DRUM_6_LEVEL, "D6 Lvl"},
-        {TARGET_DRUM_7_LEVEL, "D7 Lvl"},
-        {TARGET_DRUM_8_LEVEL, "D8 Lvl"},
-        {TARGET_DRUM_MASTER_LEVEL, "DrumMst"},
+        if(CC_DISPATCH.entries[b][cc].kind != CONTROL_NONE)
+            return false;
     }
-};
+    return true;
+}
 
-// All bank mappings array
-constexpr const BankMappings* ALL_BANKS[NUM_BANKS] = {
-    &BANK_GENERAL_MAP,
-    &BANK_MIX_MAP,
-    &BANK_SYNTH_MAP,
-    &BANK_SAMPLER_MAP
-};
+static_assert(IsFreeCC(MOD_WHEEL), "Mod wheel CC clashes with a bank control, encoder or fader");
+
+/**
+ * Resolve a CC in a bank (one table load)
+ */
+inline const CCDispatch& LookupCC(Bank bank, uint8_t cc)
+{
+    return CC_DISPATCH.entries[bank][cc & 0x7F];
+}
 
 /**
  * Fader state for pickup mode
@@ -398,13 +267,14 @@ class Engine
         // Just trigger on any CC 1/2 event regardless of value
         (void)value;  // Unused - KeyLab always sends 0
 
-        if(cc == CC_BANK_NEXT)
+        ControlKind kind = LookupCC(current_bank_, cc).kind;
+        if(kind == CONTROL_BANK_NEXT)
         {
             uint8_t next = (current_bank_ + 1) % NUM_BANKS;
             SetBank(static_cast<Bank>(next));
             return true;
         }
-        else if(cc == CC_BANK_PREV)
+        else if(kind == CONTROL_BANK_PREV)
         {
             uint8_t prev = (current_bank_ + NUM_BANKS - 1) % NUM_BANKS;
             SetBank(static_cast<Bank>(prev));
@@ -462,12 +332,8 @@ class Engine
      */
     uint8_t FindEncoderIndex(uint8_t cc) const
     {
-        for(uint8_t i = 0; i < NUM_ENCODERS; i++)
-        {
-            if(ENCODER_CCS[i] == cc)
-                return i;
-        }
-        return NUM_ENCODERS;
+        const CCDispatch& d = LookupCC(current_bank_, cc);
+        return d.kind == CONTROL_ENCODER ? d.index : NUM_ENCODERS;
     }
 
     /**
@@ -476,12 +342,8 @@ class Engine
      */
     uint8_t FindFaderIndex(uint8_t cc) const
     {
-        for(uint8_t i = 0; i < NUM_FADERS; i++)
-        {
-            if(FADER_CCS[i] == cc)
-                return i;
-        }
-        return NUM_FADERS;
+        const CCDispatch& d = LookupCC(current_bank_, cc);
+        return d.kind == CONTROL_FADER ? d.index : NUM_FADERS;
     }
 
     /**
@@ -490,37 +352,30 @@ class Engine
      */
     ParamTarget ProcessCC(uint8_t cc, uint8_t value, uint8_t& out_value)
     {
-        // Check for bank switch
-        if(HandleBankSwitch(cc, value))
-        {
-            return TARGET_NONE;
-        }
-
-        // Check if it's an encoder
-        uint8_t enc_idx = FindEncoderIndex(cc);
-        if(enc_idx < NUM_ENCODERS)
+        const CCDispatch& d = LookupCC(current_bank_, cc);
+        switch(d.kind)
         {
-            encoder_values_[enc_idx] = value;
-            const ControlMapping& mapping = GetEncoderMapping(enc_idx);
-            out_value = value;
-            return mapping.target;
+            case CONTROL_ENCODER:
+                encoder_values_[d.index] = value;
+                out_value = value;
+                return d.target;
+
+            case CONTROL_FADER:
+                if(fader_states_[d.index].Update(value))
+                {
+                    out_value = fader_states_[d.index].param_value;
+                    return d.target;
+                }
+                return TARGET_NONE;  // Fader not picked up
+
+            case CONTROL_BANK_NEXT:
+            case CONTROL_BANK_PREV:
+                HandleBankSwitch(cc, value);
+                return TARGET_NONE;
+
+            default:
+                return TARGET_NONE;
         }
-
-        // Check if it's a fader
-        uint8_t fader_idx = FindFaderIndex(cc);
-        if(fader_idx < NUM_FADERS)
-        {
-            FaderState& state = fader_states_[fader_idx];
-            if(state.Update(value))
-            {
-                const ControlMapping& mapping = GetFaderMapping(fader_idx);
-                out_value = state.param_value;
-                return mapping.target;
-            }
-            return TARGET_NONE;  // Fader not picked up
-        }
-
-        return TARGET_NONE;
     }
 
     /**
@@ -596,6 +451,25 @@ inline float CCToPan(uint8_t value)
     return (static_cast<float>(value) - 64.0f) / 64.0f;
 }
 
+// Convert CC value to LFO rate (0.05-20 Hz, logarithmic)
+inline float CCToLfoRate(uint8_t value)
+{
+    float norm = CCToNorm(value);
+    return ModMatrix::LFO_MIN_HZ * powf(ModMatrix::LFO_MAX_HZ / ModMatrix::LFO_MIN_HZ, norm);
+}
+
+// Convert CC value to mod matrix route (0-23)
+inline uint8_t CCToRoute(uint8_t value)
+{
+    return (value * ModMatrix::NUM_ROUTES) / 128;
+}
+
+// Convert CC value to mod amount (-1.0 to +1.0, 64 = none, 127 = +1.0)
+inline float CCToAmount(uint8_t value)
+{
+    return fmaxf((static_cast<float>(value) - 64.0f) / 63.0f, -1.0f);
+}
+
 // Convert pan (-1.0 to +1.0) to CC value
 inline uint8_t PanToCC(float pan)
 {
@@ -603,68 +477,158 @@ inline uint8_t PanToCC(float pan)
 }
 
 /**
- * Legacy: Handle a CC message and apply to synth
- * Returns true if the CC was handled
- * (Kept for backwards compatibility with midi_router)
+ * Convert a CC value along a target's curve
  */
-inline bool HandleSynthCC(uint8_t cc, uint8_t value, Synth::Engine& synth)
+inline float ApplyCurve(Curve curve, uint8_t value)
 {
-    switch(cc)
+    switch(curve)
     {
-        // Encoders
-        case FILTER_CUTOFF:
-            synth.SetParam(Synth::PARAM_FILTER_CUTOFF, CCToFreq(value));
-            return true;
+        case CURVE_NORM: return CCToNorm(value);
+        case CURVE_FREQ: return CCToFreq(value);
+        case CURVE_TIME: return CCToTime(value);
+        case CURVE_WAVE: return CCToWave(value);
+        case CURVE_SEMI: return CCToSemitones(value);
+        case CURVE_PAN: return CCToPan(value);
+        case CURVE_RATE: return CCToLfoRate(value);
+        case CURVE_ROUTE: return CCToRoute(value);
+        case CURVE_AMOUNT: return CCToAmount(value);
+        default: return static_cast<float>(value);
+    }
+}
 
-        case FILTER_RES:
-            synth.SetParam(Synth::PARAM_FILTER_RES, CCToNorm(value));
-            return true;
+/**
+ * Synth targets map 1:1 onto Synth::ParamId (target = param id + 1)
+ */
+inline bool IsSynthTarget(ParamTarget target)
+{
+    return target >= TARGET_SYNTH_OSC1_WAVE && target <= TARGET_SYNTH_MOD3_AMOUNT;
+}
 
-        case OSC1_WAVE:
-            synth.SetParam(Synth::PARAM_OSC1_WAVE, CCToWave(value));
-            return true;
+inline Synth::ParamId ToSynthParam(ParamTarget target)
+{
+    return static_cast<Synth::ParamId>(target - TARGET_SYNTH_OSC1_WAVE);
+}
 
-        case OSC2_WAVE:
-            synth.SetParam(Synth::PARAM_OSC2_WAVE, CCToWave(value));
-            return true;
+static_assert(TARGET_SYNTH_MOD3_AMOUNT - TARGET_SYNTH_OSC1_WAVE + 1 == Synth::PARAM_COUNT,
+              "Synth targets must match Synth::ParamId");
 
-        case AMP_ATTACK:
-            synth.SetParam(Synth::PARAM_AMP_ATTACK, CCToTime(value));
-            return true;
+/**
+ * Apply a synth target to a synth instance
+ */
+inline void ApplySynthTarget(ParamTarget target, uint8_t value, Synth::Engine& synth)
+{
+    synth.SetParam(ToSynthParam(target), ApplyCurve(TARGET_CURVES[target], value));
+}
 
-        case AMP_DECAY:
-            synth.SetParam(Synth::PARAM_AMP_DECAY, CCToTime(value));
-            return true;
+/**
+ * Handle a CC message and apply to a synth instance (no banks, no pickup)
+ * Uses the Synth bank layout from the dispatch table; the mod wheel goes
+ * to the synth's mod matrix. With no bank buttons here, the standard CC 1
+ * wheel in MIDI files counts as the mod wheel too.
+ * Returns true if the CC was handled
+ */
+inline bool HandleSynthCC(uint8_t cc, uint8_t value, Synth::Engine& synth)
+{
+    if(cc == MOD_WHEEL || cc == GM_MOD_WHEEL)
+    {
+        synth.SetModWheel(CCToNorm(value));
+        return true;
+    }
+    const CCDispatch& d = LookupCC(BANK_SYNTH, cc);
+    if(!IsSynthTarget(d.target))
+        return false;
+    synth.SetParam(ToSynthParam(d.target), ApplyCurve(d.curve, value));
+    return true;
+}
 
-        case AMP_SUSTAIN:
-            synth.SetParam(Synth::PARAM_AMP_SUSTAIN, CCToNorm(value));
-            return true;
+/**
+ * Per-block CC coalescing
+ *
+ * CCs resolved by Engine::ProcessCC are recorded per target instead of being
+ * applied immediately. Flush() runs once per audio block and applies each
+ * changed target once with its latest value, so a fader sweep delivering
+ * several CCs per block costs one parameter update per target per block.
+ *
+ * With smoothing enabled, continuous targets glide towards the latest value
+ * over about smooth_blocks blocks (one step per block, CC resolution).
+ * Discrete targets (waveforms) always jump.
+ */
+class Coalescer
+{
+  public:
+    typedef void (*ApplyFn)(ParamTarget target, uint8_t value);
 
-        case AMP_RELEASE:
-            synth.SetParam(Synth::PARAM_AMP_RELEASE, CCToTime(value));
-            return true;
+    void Init(ApplyFn apply, uint8_t smooth_blocks = CC_SMOOTHING_BLOCKS)
+    {
+        apply_       = apply;
+        smooth_coef_ = smooth_blocks > 1 ? 1.0f / static_cast<float>(smooth_blocks) : 1.0f;
+        dirty_       = 0;
+        for(uint8_t i = 0; i < TARGET_COUNT; i++)
+        {
+            target_[i]  = 0;
+            current_[i] = -1.0f;  // Unknown - first value jumps
+        }
+    }
 
-        // Faders
-        case OSC1_LEVEL:
-            synth.SetParam(Synth::PARAM_OSC1_LEVEL, CCToNorm(value));
-            return true;
+    /**
+     * Record the latest value for a target (audio callback context)
+     */
+    void Set(ParamTarget target, uint8_t value)
+    {
+        if(target == TARGET_NONE || target >= TARGET_COUNT)
+            return;
+        target_[target] = value;
+        dirty_ |= Bit(target);
+    }
 
-        case OSC2_LEVEL:
-            synth.SetParam(Synth::PARAM_OSC2_LEVEL, CCToNorm(value));
-            return true;
+    /**
+     * Apply every changed target once (call at block end)
+     */
+    void Flush()
+    {
+        uint64_t pending = dirty_;
+        dirty_           = 0;
+        while(pending)
+        {
+            uint8_t t = static_cast<uint8_t>(__builtin_ctzll(pending));
+            pending &= pending - 1;
 
-        case FILT_ENV_AMT:
-            synth.SetParam(Synth::PARAM_FILTER_ENV_AMT, CCToNorm(value));
-            return true;
+            ParamTarget target = static_cast<ParamTarget>(t);
+            float       want   = static_cast<float>(target_[t]);
+            float&      cur    = current_[t];
 
-        case SYNTH_LEVEL:
-            synth.SetParam(Synth::PARAM_LEVEL, CCToNorm(value));
-            return true;
+            if(smooth_coef_ >= 1.0f || cur < 0.0f || !IsContinuous(target))
+            {
+                cur = want;
+            }
+            else
+            {
+                cur += (want - cur) * smooth_coef_;
+                if(fabsf(want - cur) < 0.5f)
+                    cur = want;
+                else
+                    dirty_ |= Bit(target);  // Keep gliding next block
+            }
+            apply_(target, static_cast<uint8_t>(cur + 0.5f));
+        }
+    }
 
-        default:
-            return false;
+  private:
+    static_assert(TARGET_COUNT <= 64, "Coalescer dirty mask holds 64 targets");
+
+    static uint64_t Bit(ParamTarget target) { return 1ULL << static_cast<uint8_t>(target); }
+
+    static bool IsContinuous(ParamTarget target)
+    {
+        return TARGET_CURVES[target] != CURVE_WAVE && TARGET_CURVES[target] != CURVE_ROUTE;
     }
-}
+
+    ApplyFn  apply_;
+    float    smooth_coef_;
+    uint64_t dirty_;
+    uint8_t  target_[TARGET_COUNT];   // Latest received value
+    float    current_[TARGET_COUNT];  // Last applied value (smoothing state)
+};
 
 } // namespace CCMap
 
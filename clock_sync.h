@@ -0,0 +1,181 @@
+#pragma once
+#ifndef GROOVYDAISY_CLOCK_SYNC_H
+#define GROOVYDAISY_CLOCK_SYNC_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * GroovyDaisy Transport Clock Sync
+ *
+ * Instead of streaming the playhead tick, the firmware sends MSG_CLOCK_SYNC
+ * anchors: audio sample counter, tick (+ fractional phase), BPM, pattern
+ * length and sample rate. The companion extrapolates the playhead locally
+ * from the latest anchor and only needs a new one when the extrapolation
+ * would go wrong:
+ *   - transport started/stopped, tempo or pattern length changed
+ *   - the position jumped (rewind) or drifted more than DRIFT_TICKS from
+ *     where the last anchor predicts
+ *   - HEARTBEAT_MS passed (bounds crystal vs. browser clock drift)
+ *   - an explicit request (connect, CMD_REQ_STATE)
+ *
+ * The audio callback publishes a snapshot at the end of every block
+ * (seqlock; the main loop retries a read the callback interrupted, and the
+ * callback never waits for the main loop); the main loop reads it
+ * once per frame and asks the Scheduler whether to send.
+ */
+
+namespace ClockSync
+{
+
+constexpr uint32_t HEARTBEAT_MS = 2000;
+constexpr float    DRIFT_TICKS  = 0.5f;
+
+/**
+ * Transport state at one audio sample
+ */
+struct Snapshot
+{
+    uint32_t sample;         // Audio sample counter (wraps)
+    uint32_t tick;           // Pattern tick at that sample
+    uint16_t phase;          // Fraction of the way to the next tick (Q16)
+    uint16_t bpm;
+    uint32_t pattern_ticks;  // Loop length
+    bool     running;        // Playing or recording
+};
+
+/**
+ * Audio callback -> main loop snapshot (single writer, seqlock)
+ */
+class Publisher
+{
+  public:
+    void Init()
+    {
+        seq_.store(0, std::memory_order_relaxed);
+        snap_ = Snapshot();
+    }
+
+    /**
+     * Audio callback, end of block
+     */
+    void Publish(const Snapshot& s)
+    {
+        seq_.fetch_add(1, std::memory_order_acq_rel);
+        snap_ = s;
+        std::atomic_thread_fence(std::memory_order_release);  // Snapshot stores before the even sequence
+        seq_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * Main loop: consistent copy of the latest snapshot
+     */
+    Snapshot Read() const
+    {
+        Snapshot s;
+        uint32_t seq;
+        do
+        {
+            seq = seq_.load(std::memory_order_acquire);
+            s   = snap_;
+            std::atomic_thread_fence(std::memory_order_acquire);  // Copy before the re-check
+        } while((seq & 1) || seq != seq_.load(std::memory_order_acquire));
+        return s;
+    }
+
+  private:
+    Snapshot              snap_;
+    std::atomic<uint32_t> seq_;
+};
+
+/**
+ * Decides when the companion needs a new anchor (main loop)
+ */
+class Scheduler
+{
+  public:
+    void Init(float sample_rate, uint32_t ppqn)
+    {
+        sample_rate_ = sample_rate;
+        ppqn_        = ppqn;
+        have_sent_   = false;
+        forced_      = true;
+        last_ms_     = 0;
+        sent_count_  = 0;
+    }
+
+    /**
+     * Send an anchor at the next check regardless of drift
+     */
+    void RequestSync() { forced_ = true; }
+
+    bool Due(const Snapshot& s, uint32_t now_ms) const
+    {
+        if(forced_ || !have_sent_)
+            return true;
+        if(s.running != last_.running || s.bpm != last_.bpm
+           || s.pattern_ticks != last_.pattern_ticks)
+            return true;
+        if(!s.running)
+            return s.tick != last_.tick;  // Rewound while stopped
+        if(now_ms - last_ms_ >= HEARTBEAT_MS)
+            return true;
+        return Drift(s) > DRIFT_TICKS;
+    }
+
+    void Sent(const Snapshot& s, uint32_t now_ms)
+    {
+        last_      = s;
+        last_ms_   = now_ms;
+        have_sent_ = true;
+        forced_    = false;
+        sent_count_++;
+    }
+
+    /**
+     * Where the last anchor says the playhead is at a given sample (ticks)
+     */
+    float Predict(uint32_t sample) const
+    {
+        float pos = last_.tick + last_.phase / 65536.0f;
+        if(last_.running && last_.bpm > 0)
+        {
+            float ticks_per_sample = (last_.bpm * ppqn_) / (60.0f * sample_rate_);
+            pos += static_cast<float>(sample - last_.sample) * ticks_per_sample;
+        }
+        if(last_.pattern_ticks > 0)
+        {
+            float len = static_cast<float>(last_.pattern_ticks);
+            pos -= len * static_cast<float>(static_cast<uint32_t>(pos / len));
+        }
+        return pos;
+    }
+
+    uint32_t GetSentCount() const { return sent_count_; }
+
+  private:
+    // Circular distance between the actual and predicted position (ticks)
+    float Drift(const Snapshot& s) const
+    {
+        float actual = s.tick + s.phase / 65536.0f;
+        float diff   = actual - Predict(s.sample);
+        float len    = static_cast<float>(s.pattern_ticks);
+        if(diff < 0)
+            diff = -diff;
+        if(len > 0 && diff > len * 0.5f)
+            diff = len - diff;
+        return diff;
+    }
+
+    float    sample_rate_;
+    uint32_t ppqn_;
+    Snapshot last_;
+    uint32_t last_ms_;
+    uint32_t sent_count_;
+    bool     have_sent_;
+    bool     forced_;
+};
+
+} // namespace ClockSync
+
+#endif // GROOVYDAISY_CLOCK_SYNC_H
@@ -1,8 +1,13 @@
-import { useState, useRef, useCallback } from 'react'
+import { useState, useRef, useCallback, useEffect } from 'react'
 import ConnectionStatus from './components/ConnectionStatus'
 import TransportBar, { type TransportState } from './components/TransportBar'
 import MidiMonitor, { type MidiLogEntry } from './components/MidiMonitor'
 import EngineState from './components/EngineState'
+import TelemetryPanel from './components/TelemetryPanel'
+import VoiceDiagPanel from './components/VoiceDiagPanel'
+import TaskStatsPanel from './components/TaskStatsPanel'
+import AudioConfigPanel from './components/AudioConfigPanel'
+import SmfPanel from './components/SmfPanel'
 import RawLog from './components/RawLog'
 import SynthPanel from './components/SynthPanel'
 import PresetManager from './components/PresetManager'
@@ -16,6 +21,12 @@ import {
   SynthParamId,
   PatternEvent,
   TrackStatus,
+  TelemetryMessage,
+  VoiceDiagMessage,
+  TaskStatsMessage,
+  AudioConfigMessage,
+  AudioBenchMessage,
+  SmfState,
   MSG_TICK,
   MSG_DEBUG,
   MSG_TRANSPORT,
@@ -28,7 +39,29 @@ import {
   MSG_TRACK_STATE,
   MSG_PATTERN_DUMP,
   MSG_PATTERN_CLEAR,
+  MSG_PATTERN_BULK,
   MSG_RESOURCES,
+  MSG_STATE_DELTA,
+  MSG_LINK_GAP,
+  MSG_CLOCK_SYNC,
+  MSG_TELEMETRY,
+  MSG_VOICE_DIAG,
+  MSG_TASK_STATS,
+  MSG_SMF_DATA,
+  MSG_SMF_STATUS,
+  MSG_AUDIO_CONFIG,
+  MSG_AUDIO_BENCH,
+  SMF_OP_IMPORT,
+  PatternBulkDecoder,
+  buildBulkConfigCommand,
+  buildBulkAckCommand,
+  buildStateAckCommand,
+  buildLinkConfigCommand,
+  buildLinkNakCommand,
+  buildTelemetryConfigCommand,
+  buildAudioConfigCommand,
+  buildAudioBenchCommand,
+  buildRequestPatternCommand,
   getMessageTypeName,
   buildSetBankCommand,
   buildMessage,
@@ -38,6 +71,12 @@ import {
   buildFreezeTrackCommand,
   buildUnfreezeTrackCommand,
   getDefaultSynthParams,
+  getDefaultModParams,
+  NUM_MOD_SLOTS,
+  MOD_SOURCES,
+  MOD_DESTS,
+  LFO_MIN_HZ,
+  LFO_MAX_HZ,
   CMD_PLAY,
   CMD_STOP,
   CMD_RECORD,
@@ -47,6 +86,10 @@ import {
 import TabBar, { type TabId } from './components/global/TabBar'
 import ArrangeView from './components/arrange/ArrangeView'
 import { parseMidiMessage } from './core/midi-utils'
+import { StateMirror } from './core/stateSync'
+import { LinkReceiver } from './core/link'
+import { PlayheadClock } from './core/clockSync'
+import { SmfTransfer, SmfTransferState, downloadMidiFile } from './core/smf'
 
 // CC value converters (CC 0-127 to parameter value)
 function ccToNorm(cc: number): number { return cc / 127 }
@@ -54,6 +97,9 @@ function ccToFreq(cc: number): number { return 20 * Math.pow(1000, cc / 127) }
 function ccToTime(cc: number): number { return 0.001 * Math.pow(5000, cc / 127) }
 function ccToWave(cc: number): number { return Math.floor((cc * 4) / 128) }
 function ccToSemi(cc: number): number { return Math.round(((cc - 64) * 24) / 64) }
+function ccToRate(cc: number): number { return LFO_MIN_HZ * Math.pow(LFO_MAX_HZ / LFO_MIN_HZ, cc / 127) }
+function ccToRoute(cc: number): number { return Math.floor((cc * MOD_SOURCES.length * MOD_DESTS.length) / 128) }
+function ccToAmount(cc: number): number { return Math.max(-1, (cc - 64) / 63) }
 
 export interface LogEntry {
   direction: '>' | '<'
@@ -103,6 +149,13 @@ function App() {
 
   // Resources (memory + CPU)
   const [resources, setResources] = useState({ memoryUsed: 0, memoryTotal: 64 * 1024 * 1024, cpuLoad: 0 })
+  const [telemetry, setTelemetry] = useState<TelemetryMessage | null>(null)
+  const [telemetryEnabled, setTelemetryEnabled] = useState(false)
+  const [voiceDiag, setVoiceDiag] = useState<VoiceDiagMessage | null>(null)
+  const [taskStats, setTaskStats] = useState<TaskStatsMessage | null>(null)
+  const [smfState, setSmfState] = useState<SmfTransferState>({ kind: 'idle' })
+  const [audioConfig, setAudioConfig] = useState<AudioConfigMessage | null>(null)
+  const [audioBench, setAudioBench] = useState<AudioBenchMessage[]>([])
 
   // Track states for synth tracks (index 8-11 in sequencer)
   const [synthTrackStates, setSynthTrackStates] = useState<Array<{ status: TrackStatus; frozenSlot: number }>>(
@@ -122,6 +175,20 @@ function App() {
 
   const serialRef = useRef<WebSerialPort | null>(null)
   const parserRef = useRef<ProtocolParser | null>(null)
+  const bulkDecoderRef = useRef(new PatternBulkDecoder())
+  const stateMirrorRef = useRef(new StateMirror())
+  const linkRef = useRef(new LinkReceiver())
+  const clockRef = useRef(new PlayheadClock())
+  const clockSyncedRef = useRef(false)  // Older firmware only sends MSG_TICK
+  const smfRef = useRef(new SmfTransfer(
+    (msg) => { serialRef.current?.send(msg) },
+    (state) => {
+      setSmfState(state)
+      if (state.kind === 'exported') {
+        downloadMidiFile(state.file)
+      }
+    }
+  ))
   const currentBankRef = useRef<Bank>(currentBank)
   currentBankRef.current = currentBank  // Keep ref in sync with state
   const transportRef = useRef<TransportState>(transport)
@@ -154,6 +221,10 @@ function App() {
       case MSG_TICK:
         setTickCounter(msg.tick)
         break
+      case MSG_CLOCK_SYNC:
+        clockRef.current.update(msg, performance.now())
+        clockSyncedRef.current = true
+        break
       case MSG_DEBUG:
         setDebugMessages((prev) => {
           const newMsgs = [...prev, { text: msg.text, timestamp: Date.now() }]
@@ -294,6 +365,27 @@ function App() {
                     case ParamTarget.SYNTH_FILT_RELEASE: next.filtRelease = ccToTime(ccVal); break
                     case ParamTarget.SYNTH_VEL_TO_AMP: next.velToAmp = ccToNorm(ccVal); break
                     case ParamTarget.SYNTH_VEL_TO_FILTER: next.velToFilter = ccToNorm(ccVal); break
+                    case ParamTarget.SYNTH_LFO1_RATE: next.mod = { ...prev.mod, lfo1Rate: ccToRate(ccVal) }; break
+                    case ParamTarget.SYNTH_LFO1_WAVE: next.mod = { ...prev.mod, lfo1Wave: ccToWave(ccVal) }; break
+                    case ParamTarget.SYNTH_LFO2_RATE: next.mod = { ...prev.mod, lfo2Rate: ccToRate(ccVal) }; break
+                    case ParamTarget.SYNTH_LFO2_WAVE: next.mod = { ...prev.mod, lfo2Wave: ccToWave(ccVal) }; break
+                    case ParamTarget.SYNTH_LFO_DEPTH: next.mod = { ...prev.mod, lfoDepth: ccToNorm(ccVal) }; break
+                    case ParamTarget.SYNTH_MOD1_ROUTE:
+                    case ParamTarget.SYNTH_MOD2_ROUTE:
+                    case ParamTarget.SYNTH_MOD3_ROUTE: {
+                      const routes = [...prev.mod.routes]
+                      routes[(target - ParamTarget.SYNTH_MOD1_ROUTE) / 2] = ccToRoute(ccVal)
+                      next.mod = { ...prev.mod, routes }
+                      break
+                    }
+                    case ParamTarget.SYNTH_MOD1_AMOUNT:
+                    case ParamTarget.SYNTH_MOD2_AMOUNT:
+                    case ParamTarget.SYNTH_MOD3_AMOUNT: {
+                      const amounts = [...prev.mod.amounts]
+                      amounts[(target - ParamTarget.SYNTH_MOD1_AMOUNT) / 2] = ccToAmount(ccVal)
+                      next.mod = { ...prev.mod, amounts }
+                      break
+                    }
                     default: return prev  // No change for mixer params here
                   }
                   return next
@@ -334,6 +426,32 @@ function App() {
           masterOut: msg.masterOut,
         })
         break
+      case MSG_TELEMETRY:
+        setTelemetry(msg)
+        break
+      case MSG_VOICE_DIAG:
+        setVoiceDiag(msg)
+        break
+      case MSG_TASK_STATS:
+        setTaskStats(msg)
+        break
+      case MSG_SMF_STATUS:
+        smfRef.current.handleStatus(msg)
+        if (msg.op === SMF_OP_IMPORT && msg.state === SmfState.DONE) {
+          // Show what was imported
+          serialRef.current?.send(buildRequestPatternCommand())
+        }
+        break
+      case MSG_SMF_DATA:
+        smfRef.current.handleData(msg)
+        break
+      case MSG_AUDIO_CONFIG:
+        setAudioConfig(msg)
+        break
+      case MSG_AUDIO_BENCH:
+        // Cell 0 starts a new run
+        setAudioBench(prev => (msg.index === 0 ? [msg] : [...prev, msg]))
+        break
       case MSG_RESOURCES:
         setResources({
           memoryUsed: msg.memoryUsed,
@@ -372,6 +490,22 @@ function App() {
           })
         }
         break
+      case MSG_PATTERN_BULK: {
+        // Return the credit right away so the next chunk can be sent
+        serialRef.current?.send(buildBulkAckCommand())
+        const tracks = bulkDecoderRef.current.push(msg)
+        if (tracks) {
+          // Whole pattern arrived - replace every track at once
+          setPatternData(prev => prev.map((events, i) => tracks[i] ?? events))
+          setPendingEvents(prev => prev.map((events, i) => (tracks[i] ? [] : events)))
+        }
+        break
+      }
+      case MSG_LINK_GAP:
+        // A bulk message was lost for good - fetch the whole pattern again
+        addLog('>', 'LINK_GAP: bulk message lost, re-requesting pattern')
+        serialRef.current?.send(buildRequestPatternCommand())
+        break
       case MSG_PATTERN_CLEAR:
         // Clear a track's pattern data
         setPatternData(prev => {
@@ -385,8 +519,15 @@ function App() {
     }
   }, [addLog])
 
-  const handleChecksumError = useCallback(() => {
+  const handleChecksumError = useCallback((framed: boolean) => {
     setChecksumErrors((prev) => prev + 1)
+    if (framed) {
+      // Corrupted bulk frame: ask for it (and anything else outstanding) again
+      const nak = linkRef.current.corrupted()
+      if (nak.length > 0) {
+        serialRef.current?.send(buildLinkNakCommand(nak))
+      }
+    }
   }, [])
 
   // Transport command helpers
@@ -430,6 +571,37 @@ function App() {
     }
   }, [])
 
+  const handleTelemetryToggle = useCallback((enabled: boolean) => {
+    if (serialRef.current) {
+      serialRef.current.send(buildTelemetryConfigCommand(enabled))
+      setTelemetryEnabled(enabled)
+      if (!enabled) {
+        setTelemetry(null)
+      }
+    }
+  }, [])
+
+  const handleAudioConfig = useCallback((rate: number, block: number) => {
+    serialRef.current?.send(buildAudioConfigCommand(rate, block))
+  }, [])
+
+  const handleAudioBench = useCallback(() => {
+    setAudioBench([])
+    serialRef.current?.send(buildAudioBenchCommand())
+  }, [])
+
+  const handleSmfImport = useCallback((file: Uint8Array) => {
+    smfRef.current.startImport(file)
+  }, [])
+
+  const handleSmfExport = useCallback(() => {
+    smfRef.current.startExport()
+  }, [])
+
+  const handleSmfCancel = useCallback(() => {
+    smfRef.current.cancel()
+  }, [])
+
   const handleBankChange = useCallback((bank: Bank) => {
     if (serialRef.current) {
       const msg = buildSetBankCommand(bank)
@@ -477,6 +649,22 @@ function App() {
         [SynthParamId.LEVEL, params.level],
       ]
 
+      // Presets saved before the mod matrix get its defaults
+      const mod = params.mod ?? getDefaultModParams()
+      paramMap.push(
+        [SynthParamId.LFO1_RATE, mod.lfo1Rate],
+        [SynthParamId.LFO1_WAVE, mod.lfo1Wave],
+        [SynthParamId.LFO2_RATE, mod.lfo2Rate],
+        [SynthParamId.LFO2_WAVE, mod.lfo2Wave],
+        [SynthParamId.LFO_DEPTH, mod.lfoDepth],
+      )
+      for (let i = 0; i < NUM_MOD_SLOTS; i++) {
+        paramMap.push(
+          [SynthParamId.MOD1_ROUTE + i * 2, mod.routes[i]],
+          [SynthParamId.MOD1_AMOUNT + i * 2, mod.amounts[i]],
+        )
+      }
+
       // Send each param - they'll be processed quickly on the Daisy side
       for (const [paramId, value] of paramMap) {
         const msg = buildSynthParamCommand(paramId, value)
@@ -485,6 +673,23 @@ function App() {
     }
   }, [])
 
+  // Drive the playhead from the local clock; state only changes (and the UI
+  // only re-renders) when the integer tick does
+  useEffect(() => {
+    if (!connected) {
+      return
+    }
+    let frame = 0
+    const step = () => {
+      if (clockSyncedRef.current) {
+        setTickCounter(Math.floor(clockRef.current.tickAt(performance.now())))
+      }
+      frame = requestAnimationFrame(step)
+    }
+    frame = requestAnimationFrame(step)
+    return () => cancelAnimationFrame(frame)
+  }, [connected])
+
   const handleConnect = async () => {
     if (connected && serialRef.current) {
       await serialRef.current.disconnect()
@@ -498,7 +703,32 @@ function App() {
     }
 
     // Create parser for this connection
-    const parser = new ProtocolParser(handleMessage, handleChecksumError)
+    // State deltas go through the mirror and come out as the per-area messages
+    // Framed bulk messages are put back in order by the link receiver first
+    stateMirrorRef.current.reset()
+    clockRef.current.reset()
+    clockSyncedRef.current = false
+    const parser: ProtocolParser = new ProtocolParser(
+      (msg) => {
+        if (msg.type !== MSG_STATE_DELTA) {
+          handleMessage(msg)
+          return
+        }
+        const { ack, messages } = stateMirrorRef.current.apply(msg)
+        if (ack !== null) {
+          serialRef.current?.send(buildStateAckCommand(ack))
+        }
+        messages.forEach(handleMessage)
+      },
+      handleChecksumError,
+      (seq, type, payload) => {
+        const { deliver, nak } = linkRef.current.receive(seq, type, payload)
+        if (nak.length > 0) {
+          serialRef.current?.send(buildLinkNakCommand(nak))
+        }
+        deliver.forEach((frame) => parser.dispatch(frame.type, frame.payload))
+      }
+    )
     parserRef.current = parser
 
     const serial = new WebSerialPort({
@@ -522,16 +752,29 @@ function App() {
         setCurrentBank(Bank.SYNTH)
         setFaderStates(Array(9).fill({ pickedUp: true, needsPickup: false }))
         setMixerState(getDefaultMixerState())
+        setTelemetry(null)
+        setVoiceDiag(null)
+        setTaskStats(null)
+        setSmfState({ kind: 'idle' })
+        setAudioConfig(null)
+        setAudioBench([])
+        setTelemetryEnabled(false)  // Firmware starts with telemetry off
         addLog('<', '-- Connected --')
         // Request initial state from Daisy
         setTimeout(() => {
+          linkRef.current.reset()  // Firmware restarts its sequence on LINK_CONFIG
+          serial.send(buildLinkConfigCommand())
+          serial.send(buildBulkConfigCommand())
+          serial.send(buildTelemetryConfigCommand(false))
           serial.send(buildMessage(CMD_REQ_STATE))
           serial.send(buildRequestSynthCommand())
+          serial.send(buildAudioConfigCommand())
         }, 100)
       },
       onDisconnect: () => {
         setConnected(false)
         parserRef.current?.reset()
+        smfRef.current.cancel()
         addLog('<', '-- Disconnected --')
       },
       onError: (error) => {
@@ -588,25 +831,34 @@ function App() {
       <main className="flex-1 p-4 space-y-4 overflow-y-auto">
         {/* Arrange Tab */}
         {activeTab === 'arrange' && (
-          <ArrangeView
-            memoryUsed={resources.memoryUsed}
-            memoryTotal={resources.memoryTotal}
-            cpuLoad={resources.cpuLoad}
-            synthTracks={synthTrackStates.map((state, i) => ({
-              id: i + 8,  // Track IDs 8-11 for synth
-              status: state.status,
-              frozenSlot: state.frozenSlot,
-              events: patternData[i + 8] || [],
-              pendingEvents: pendingEvents[i + 8] || [],
-            }))}
-            drumEvents={patternData.slice(0, 8)}
-            pendingDrumEvents={pendingEvents.slice(0, 8)}
-            playheadTick={tickCounter}
-            playing={transport.playing}
-            connected={connected}
-            onFreezeTrack={handleFreezeTrack}
-            onUnfreezeTrack={handleUnfreezeTrack}
-          />
+          <>
+            <SmfPanel
+              state={smfState}
+              connected={connected}
+              onImport={handleSmfImport}
+              onExport={handleSmfExport}
+              onCancel={handleSmfCancel}
+            />
+            <ArrangeView
+              memoryUsed={resources.memoryUsed}
+              memoryTotal={resources.memoryTotal}
+              cpuLoad={resources.cpuLoad}
+              synthTracks={synthTrackStates.map((state, i) => ({
+                id: i + 8,  // Track IDs 8-11 for synth
+                status: state.status,
+                frozenSlot: state.frozenSlot,
+                events: patternData[i + 8] || [],
+                pendingEvents: pendingEvents[i + 8] || [],
+              }))}
+              drumEvents={patternData.slice(0, 8)}
+              pendingDrumEvents={pendingEvents.slice(0, 8)}
+              playheadTick={tickCounter}
+              playing={transport.playing}
+              connected={connected}
+              onFreezeTrack={handleFreezeTrack}
+              onUnfreezeTrack={handleUnfreezeTrack}
+            />
+          </>
         )}
 
         {/* Synth Tab */}
@@ -656,6 +908,25 @@ function App() {
               />
             </div>
 
+            <VoiceDiagPanel diag={voiceDiag} />
+
+            <TaskStatsPanel stats={taskStats} />
+
+            <AudioConfigPanel
+              config={audioConfig}
+              bench={audioBench}
+              connected={connected}
+              onChange={handleAudioConfig}
+              onBench={handleAudioBench}
+            />
+
+            <TelemetryPanel
+              telemetry={telemetry}
+              enabled={telemetryEnabled}
+              onToggle={handleTelemetryToggle}
+              connected={connected}
+            />
+
             {/* Debug Messages */}
             {debugMessages.length > 0 && (
               <div className="bg-groove-panel border border-groove-border rounded-lg">
@@ -0,0 +1,93 @@
+import {
+  AudioConfigMessage,
+  AudioBenchMessage,
+  AudioState,
+  AUDIO_RATES,
+  AUDIO_BLOCKS,
+} from '../core/protocol'
+
+interface AudioConfigPanelProps {
+  config: AudioConfigMessage | null
+  bench: AudioBenchMessage[]
+  connected: boolean
+  onChange: (rate: number, block: number) => void
+  onBench: () => void
+}
+
+function loadClass(percent: number): string {
+  if (percent >= 90) return 'text-groove-red'
+  if (percent >= 70) return 'text-groove-yellow'
+  return ''
+}
+
+export default function AudioConfigPanel({ config, bench, connected, onChange, onBench }: AudioConfigPanelProps) {
+  const running = bench.length > 0 && bench[bench.length - 1].index + 1 < bench[bench.length - 1].count
+  const disabled = !connected || !config || running
+  const select = 'bg-groove-bg border border-groove-border rounded px-2 py-1 text-sm text-groove-text disabled:opacity-50'
+
+  return (
+    <div className="bg-groove-panel border border-groove-border rounded-lg">
+      <div className="px-4 py-3 border-b border-groove-border flex items-center gap-3">
+        <h2 className="font-semibold text-groove-text">Audio</h2>
+        <select
+          value={config?.rate ?? 48000}
+          disabled={disabled}
+          onChange={(e) => config && onChange(Number(e.target.value), config.block)}
+          className={select}
+        >
+          {AUDIO_RATES.map((r) => (
+            <option key={r} value={r}>{r / 1000} kHz</option>
+          ))}
+        </select>
+        <select
+          value={config?.block ?? 64}
+          disabled={disabled}
+          onChange={(e) => config && onChange(config.rate, Number(e.target.value))}
+          className={select}
+        >
+          {AUDIO_BLOCKS.map((b) => (
+            <option key={b} value={b}>{b} frames</option>
+          ))}
+        </select>
+        <span className="text-sm font-mono text-groove-muted">
+          {config ? `${(config.latencyUs / 1000).toFixed(2)} ms latency` : ''}
+          {config?.state === AudioState.INVALID ? ' (unsupported)' : ''}
+          {config?.state === AudioState.BUSY ? ' (benchmark running)' : ''}
+        </span>
+        <button
+          onClick={onBench}
+          disabled={disabled}
+          className="ml-auto px-3 py-1 rounded text-sm transition-colors disabled:opacity-50 bg-groove-border hover:bg-groove-muted text-groove-text"
+        >
+          {running ? `Benchmark ${bench.length}/${bench[0].count}` : 'Benchmark'}
+        </button>
+      </div>
+      {bench.length > 0 && (
+        <div className="p-4">
+          <table className="w-full text-sm font-mono">
+            <thead>
+              <tr className="text-groove-muted text-left">
+                <th className="font-normal">Rate</th>
+                <th className="font-normal text-right">Block</th>
+                <th className="font-normal text-right">Latency ms</th>
+                <th className="font-normal text-right">Avg CPU</th>
+                <th className="font-normal text-right">Max CPU</th>
+              </tr>
+            </thead>
+            <tbody className="text-groove-text">
+              {bench.map((b) => (
+                <tr key={b.index}>
+                  <td>{b.rate / 1000} kHz</td>
+                  <td className="text-right">{b.block}</td>
+                  <td className="text-right">{((2 * b.block * 1000) / b.rate).toFixed(2)}</td>
+                  <td className={`text-right ${loadClass(b.avgLoad)}`}>{b.avgLoad.toFixed(1)}%</td>
+                  <td className={`text-right ${loadClass(b.maxLoad)}`}>{b.maxLoad.toFixed(1)}%</td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        </div>
+      )}
+    </div>
+  )
+}
@@ -11,7 +11,7 @@ import {
   ParamTarget,
   getDefaultMixerState,
 } from '../core/ccMappings'
-import { SynthParams } from '../core/protocol'
+import { SynthParams, MOD_SOURCES, MOD_DESTS, LFO_MIN_HZ, LFO_MAX_HZ } from '../core/protocol'
 
 export interface FaderPickupState {
   pickedUp: boolean
@@ -55,6 +55,22 @@ function semitonesToCC(semitones: number): number {
   return Math.round(64 + (semitones * 64 / 24))
 }
 
+function rateToCC(hz: number): number {
+  // Logarithmic: LFO_MIN_HZ-LFO_MAX_HZ -> 0-127
+  const norm = Math.log(hz / LFO_MIN_HZ) / Math.log(LFO_MAX_HZ / LFO_MIN_HZ)
+  return Math.round(Math.max(0, Math.min(127, norm * 127)))
+}
+
+function routeToCC(route: number): number {
+  // Route index -> CC 0-127
+  return Math.ceil((route * 128) / (MOD_SOURCES.length * MOD_DESTS.length))
+}
+
+function amountToCC(amount: number): number {
+  // -1.0 to +1.0 -> 1-127 (64 = none)
+  return Math.round(Math.max(0, Math.min(127, 64 + amount * 63)))
+}
+
 // Map ParamTarget to value (0-127) from mixerState or synthParams
 function getValueForTarget(
   target: ParamTarget,
@@ -108,6 +124,17 @@ function getValueForTarget(
     case ParamTarget.SYNTH_FILT_RELEASE: return timeToCC(synthParams.filtRelease)
     case ParamTarget.SYNTH_VEL_TO_AMP: return normToCC(synthParams.velToAmp)
     case ParamTarget.SYNTH_VEL_TO_FILTER: return normToCC(synthParams.velToFilter)
+    case ParamTarget.SYNTH_LFO1_RATE: return rateToCC(synthParams.mod.lfo1Rate)
+    case ParamTarget.SYNTH_LFO1_WAVE: return waveToCC(synthParams.mod.lfo1Wave)
+    case ParamTarget.SYNTH_LFO2_RATE: return rateToCC(synthParams.mod.lfo2Rate)
+    case ParamTarget.SYNTH_LFO2_WAVE: return waveToCC(synthParams.mod.lfo2Wave)
+    case ParamTarget.SYNTH_LFO_DEPTH: return normToCC(synthParams.mod.lfoDepth)
+    case ParamTarget.SYNTH_MOD1_ROUTE: return routeToCC(synthParams.mod.routes[0])
+    case ParamTarget.SYNTH_MOD1_AMOUNT: return amountToCC(synthParams.mod.amounts[0])
+    case ParamTarget.SYNTH_MOD2_ROUTE: return routeToCC(synthParams.mod.routes[1])
+    case ParamTarget.SYNTH_MOD2_AMOUNT: return amountToCC(synthParams.mod.amounts[1])
+    case ParamTarget.SYNTH_MOD3_ROUTE: return routeToCC(synthParams.mod.routes[2])
+    case ParamTarget.SYNTH_MOD3_AMOUNT: return amountToCC(synthParams.mod.amounts[2])
 
     // Default for unmapped
     default: return 64
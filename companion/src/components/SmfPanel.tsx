@@ -0,0 +1,73 @@
+import { useRef } from 'react'
+import { SmfTransferState } from '../core/smf'
+
+interface SmfPanelProps {
+  state: SmfTransferState
+  connected: boolean
+  onImport: (file: Uint8Array) => void
+  onExport: () => void
+  onCancel: () => void
+}
+
+function describe(state: SmfTransferState): string {
+  switch (state.kind) {
+    case 'idle':
+      return 'Type 0/1 files; importing replaces the pattern'
+    case 'importing':
+    case 'exporting': {
+      const percent = state.total > 0 ? Math.round((state.done / state.total) * 100) : 0
+      return `${state.kind === 'importing' ? 'Importing' : 'Exporting'}... ${percent}%`
+    }
+    case 'imported':
+      return `Imported ${state.notes} notes, ${state.points} automation points` +
+        (state.dropped > 0 ? ` (${state.dropped} dropped)` : '')
+    case 'exported':
+      return `Exported ${state.file.length} bytes`
+    case 'error':
+      return state.message
+  }
+}
+
+export default function SmfPanel({ state, connected, onImport, onExport, onCancel }: SmfPanelProps) {
+  const inputRef = useRef<HTMLInputElement>(null)
+  const busy = state.kind === 'importing' || state.kind === 'exporting'
+
+  const handleFile = async (e: React.ChangeEvent<HTMLInputElement>) => {
+    const file = e.target.files?.[0]
+    e.target.value = ''  // Same file can be picked again
+    if (file) {
+      onImport(new Uint8Array(await file.arrayBuffer()))
+    }
+  }
+
+  const button = 'px-3 py-1 rounded text-sm transition-colors disabled:opacity-50'
+
+  return (
+    <div className="bg-groove-panel border border-groove-border rounded-lg px-4 py-3 flex items-center gap-3">
+      <h2 className="font-semibold text-groove-text">MIDI File</h2>
+      <input ref={inputRef} type="file" accept=".mid,.midi,audio/midi" className="hidden" onChange={handleFile} />
+      <button
+        onClick={() => inputRef.current?.click()}
+        disabled={!connected || busy}
+        className={`${button} bg-groove-accent hover:bg-blue-500 text-white`}
+      >
+        Import
+      </button>
+      <button
+        onClick={onExport}
+        disabled={!connected || busy}
+        className={`${button} bg-groove-border hover:bg-groove-muted text-groove-text`}
+      >
+        Export
+      </button>
+      {busy && (
+        <button onClick={onCancel} className={`${button} text-groove-muted hover:text-groove-text`}>
+          Cancel
+        </button>
+      )}
+      <span className={`text-sm ${state.kind === 'error' ? 'text-groove-red' : 'text-groove-muted'}`}>
+        {describe(state)}
+      </span>
+    </div>
+  )
+}
@@ -3,6 +3,12 @@ import {
   SynthParams,
   SynthParamId,
   WAVEFORM_NAMES,
+  NUM_MOD_SLOTS,
+  MOD_SOURCES,
+  MOD_DESTS,
+  LFO_MIN_HZ,
+  LFO_MAX_HZ,
+  modRoute,
 } from '../core/protocol'
 
 interface SynthPanelProps {
@@ -115,6 +121,64 @@ function WaveformSelect({
   )
 }
 
+// Mod matrix slot: source, destination and bipolar amount
+function ModSlot({
+  label,
+  route,
+  amount,
+  onRouteChange,
+  onAmountChange,
+  disabled,
+}: {
+  label: string
+  route: number
+  amount: number
+  onRouteChange: (value: number) => void
+  onAmountChange: (value: number) => void
+  disabled?: boolean
+}) {
+  const source = Math.floor(route / MOD_DESTS.length)
+  const dest = route % MOD_DESTS.length
+  const select = 'flex-1 bg-groove-bg border border-groove-border rounded px-1 py-1 text-xs text-groove-text disabled:opacity-50'
+
+  return (
+    <div className="flex flex-col gap-1">
+      <div className="flex gap-1 items-center">
+        <span className="text-xs text-groove-muted w-10">{label}</span>
+        <select
+          value={source}
+          disabled={disabled}
+          onChange={(e) => onRouteChange(modRoute(Number(e.target.value), dest))}
+          className={select}
+        >
+          {MOD_SOURCES.map((name, i) => (
+            <option key={i} value={i}>{name}</option>
+          ))}
+        </select>
+        <span className="text-xs text-groove-muted">→</span>
+        <select
+          value={dest}
+          disabled={disabled || source === 0}
+          onChange={(e) => onRouteChange(modRoute(source, Number(e.target.value)))}
+          className={select}
+        >
+          {MOD_DESTS.map((name, i) => (
+            <option key={i} value={i}>{name}</option>
+          ))}
+        </select>
+      </div>
+      <ParamSlider
+        label="Amount"
+        value={amount}
+        min={-1}
+        max={1}
+        onChange={onAmountChange}
+        disabled={disabled || source === 0}
+      />
+    </div>
+  )
+}
+
 // Section header
 function Section({ title, children }: { title: string; children: React.ReactNode }) {
   return (
@@ -340,6 +404,69 @@ export default function SynthPanel({ params, onParamChange, connected }: SynthPa
             />
           </div>
         </Section>
+
+        {/* LFOs */}
+        <Section title="LFOs">
+          <div className="space-y-3">
+            <ParamSlider
+              label="LFO 1 Rate (per voice)"
+              value={params.mod.lfo1Rate}
+              min={LFO_MIN_HZ}
+              max={LFO_MAX_HZ}
+              unit=" Hz"
+              logarithmic
+              onChange={handleChange(SynthParamId.LFO1_RATE)}
+              disabled={!connected}
+            />
+            <WaveformSelect
+              label="LFO 1 Wave"
+              value={params.mod.lfo1Wave}
+              onChange={handleChange(SynthParamId.LFO1_WAVE)}
+              disabled={!connected}
+            />
+            <ParamSlider
+              label="LFO 2 Rate (global)"
+              value={params.mod.lfo2Rate}
+              min={LFO_MIN_HZ}
+              max={LFO_MAX_HZ}
+              unit=" Hz"
+              logarithmic
+              onChange={handleChange(SynthParamId.LFO2_RATE)}
+              disabled={!connected}
+            />
+            <WaveformSelect
+              label="LFO 2 Wave"
+              value={params.mod.lfo2Wave}
+              onChange={handleChange(SynthParamId.LFO2_WAVE)}
+              disabled={!connected}
+            />
+            <ParamSlider
+              label="LFO Depth"
+              value={params.mod.lfoDepth}
+              min={0}
+              max={1}
+              onChange={handleChange(SynthParamId.LFO_DEPTH)}
+              disabled={!connected}
+            />
+          </div>
+        </Section>
+
+        {/* Mod matrix */}
+        <Section title="Mod Matrix">
+          <div className="space-y-3">
+            {Array.from({ length: NUM_MOD_SLOTS }, (_, i) => (
+              <ModSlot
+                key={i}
+                label={`Mod ${i + 1}`}
+                route={params.mod.routes[i]}
+                amount={params.mod.amounts[i]}
+                onRouteChange={handleChange(SynthParamId.MOD1_ROUTE + i * 2)}
+                onAmountChange={handleChange(SynthParamId.MOD1_AMOUNT + i * 2)}
+                disabled={!connected}
+              />
+            ))}
+          </div>
+        </Section>
       </div>
     </div>
   )
@@ -0,0 +1,56 @@
+import { TaskStatsMessage, TASK_PRIORITY_NAMES } from '../core/protocol'
+
+interface TaskStatsPanelProps {
+  stats: TaskStatsMessage | null
+}
+
+export default function TaskStatsPanel({ stats }: TaskStatsPanelProps) {
+  const maxPassUs = stats?.maxPassUs ?? 0
+
+  return (
+    <div className="bg-groove-panel border border-groove-border rounded-lg">
+      <div className="px-4 py-3 border-b border-groove-border flex items-center justify-between">
+        <h2 className="font-semibold text-groove-text">Main Loop Tasks</h2>
+        <span
+          className={`text-sm font-mono ${maxPassUs > 1000 ? 'text-groove-yellow' : 'text-groove-muted'}`}
+        >
+          worst pass {maxPassUs} us
+        </span>
+      </div>
+      <div className="p-4">
+        {!stats ? (
+          <p className="text-groove-muted text-sm">No task data yet</p>
+        ) : (
+          <table className="w-full text-sm font-mono">
+            <thead>
+              <tr className="text-groove-muted text-left">
+                <th className="font-normal">Task</th>
+                <th className="font-normal">Priority</th>
+                <th className="font-normal text-right">Runs</th>
+                <th className="font-normal text-right">Avg us</th>
+                <th className="font-normal text-right">Max us</th>
+                <th className="font-normal text-right">Late ms</th>
+                <th className="font-normal text-right">Over</th>
+                <th className="font-normal text-right">Deferred</th>
+              </tr>
+            </thead>
+            <tbody className="text-groove-text">
+              {stats.tasks.map((t) => (
+                <tr key={t.name}>
+                  <td>{t.name}</td>
+                  <td className="text-groove-muted">{TASK_PRIORITY_NAMES[t.priority] ?? t.priority}</td>
+                  <td className="text-right">{t.runs}</td>
+                  <td className="text-right">{t.avgUs}</td>
+                  <td className="text-right">{t.maxUs}</td>
+                  <td className="text-right">{t.maxLateMs}</td>
+                  <td className={`text-right ${t.overruns > 0 ? 'text-groove-yellow' : ''}`}>{t.overruns}</td>
+                  <td className={`text-right ${t.deferred > 0 ? 'text-groove-yellow' : ''}`}>{t.deferred}</td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        )}
+      </div>
+    </div>
+  )
+}
@@ -0,0 +1,141 @@
+import { useEffect, useState } from 'react'
+import { TelemetryMessage, TELEMETRY_BUSES } from '../core/protocol'
+
+interface TelemetryPanelProps {
+  telemetry: TelemetryMessage | null
+  enabled: boolean
+  onToggle: (enabled: boolean) => void
+  connected: boolean
+}
+
+// Meter range (dBFS)
+const METER_MIN_DB = -60
+const METER_MAX_DB = 6
+
+const SCOPE_WIDTH = 256
+const SCOPE_HEIGHT = 80
+
+function meterPercent(db: number): number {
+  const clamped = Math.min(METER_MAX_DB, Math.max(METER_MIN_DB, db))
+  return ((clamped - METER_MIN_DB) / (METER_MAX_DB - METER_MIN_DB)) * 100
+}
+
+function formatDb(db: number): string {
+  return db <= -100 ? '-inf' : db.toFixed(1)
+}
+
+export default function TelemetryPanel({
+  telemetry,
+  enabled,
+  onToggle,
+  connected,
+}: TelemetryPanelProps) {
+  // Clip indicators latch until clicked
+  const [clipped, setClipped] = useState<boolean[]>(TELEMETRY_BUSES.map(() => false))
+
+  useEffect(() => {
+    if (telemetry && telemetry.clip.some((c) => c)) {
+      setClipped((prev) => prev.map((c, b) => c || telemetry.clip[b]))
+    }
+  }, [telemetry])
+
+  const scopePoints = telemetry?.scope
+    ?.map((v, i, all) => {
+      const x = (i / Math.max(1, all.length - 1)) * SCOPE_WIDTH
+      const y = ((1 - v) / 2) * SCOPE_HEIGHT
+      return `${x.toFixed(1)},${y.toFixed(1)}`
+    })
+    .join(' ')
+
+  return (
+    <div className="bg-groove-panel border border-groove-border rounded-lg">
+      <div className="px-4 py-3 border-b border-groove-border flex items-center justify-between">
+        <h2 className="font-semibold text-groove-text">Output Telemetry</h2>
+        <button
+          onClick={() => onToggle(!enabled)}
+          disabled={!connected}
+          className={`text-xs px-2 py-1 rounded ${
+            enabled ? 'bg-groove-accent text-white' : 'bg-groove-border text-groove-muted'
+          } disabled:opacity-50`}
+        >
+          {enabled ? 'On' : 'Off'}
+        </button>
+      </div>
+      <div className="p-4 space-y-4">
+        {/* Bus meters: bar = peak, marker = RMS */}
+        <div className="space-y-2">
+          {TELEMETRY_BUSES.map((name, b) => {
+            const peak = telemetry?.peakDb[b] ?? -100
+            const rms = telemetry?.rmsDb[b] ?? -100
+            return (
+              <div key={name} className="flex items-center gap-2 text-sm">
+                <span className="w-14 text-groove-muted">{name}</span>
+                <div className="relative flex-1 h-3 bg-groove-border rounded overflow-hidden">
+                  <div
+                    className={`h-full ${
+                      peak >= 0 ? 'bg-groove-red' : peak > -6 ? 'bg-groove-yellow' : 'bg-groove-green'
+                    }`}
+                    style={{ width: `${meterPercent(peak)}%` }}
+                  />
+                  <div
+                    className="absolute top-0 h-full w-0.5 bg-groove-text"
+                    style={{ left: `${meterPercent(rms)}%` }}
+                  />
+                </div>
+                <span className="w-24 text-right font-mono text-xs text-groove-muted">
+                  {formatDb(peak)} / {formatDb(rms)}
+                </span>
+                <button
+                  onClick={() => setClipped((prev) => prev.map((c, i) => (i === b ? false : c)))}
+                  title="Reached full scale (click to reset)"
+                  className={`w-3 h-3 rounded-full ${clipped[b] ? 'bg-groove-red' : 'bg-groove-border'}`}
+                />
+              </div>
+            )
+          })}
+        </div>
+
+        {/* Scope */}
+        <div>
+          <span className="text-groove-muted text-sm">Master scope</span>
+          <svg
+            viewBox={`0 0 ${SCOPE_WIDTH} ${SCOPE_HEIGHT}`}
+            className="w-full h-20 bg-groove-bg rounded mt-1"
+            preserveAspectRatio="none"
+          >
+            <line
+              x1={0}
+              y1={SCOPE_HEIGHT / 2}
+              x2={SCOPE_WIDTH}
+              y2={SCOPE_HEIGHT / 2}
+              className="stroke-groove-border"
+              strokeWidth={1}
+            />
+            {scopePoints && (
+              <polyline
+                points={scopePoints}
+                fill="none"
+                className="stroke-groove-accent"
+                strokeWidth={1.5}
+              />
+            )}
+          </svg>
+        </div>
+
+        {/* Spectrum */}
+        <div>
+          <span className="text-groove-muted text-sm">Master spectrum</span>
+          <div className="flex items-end gap-px h-20 bg-groove-bg rounded mt-1 p-1">
+            {(telemetry?.bands ?? []).map((db, i) => (
+              <div
+                key={i}
+                className="flex-1 bg-groove-accent"
+                style={{ height: `${meterPercent(db)}%` }}
+              />
+            ))}
+          </div>
+        </div>
+      </div>
+    </div>
+  )
+}
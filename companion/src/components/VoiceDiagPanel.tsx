@@ -0,0 +1,69 @@
+import { VoiceDiagMessage, VOICE_STAGE_NAMES } from '../core/protocol'
+import { noteToName } from '../core/midi-utils'
+
+interface VoiceDiagPanelProps {
+  diag: VoiceDiagMessage | null
+}
+
+function formatAge(ms: number): string {
+  if (ms >= 65535) return '>65s'
+  return ms >= 1000 ? `${(ms / 1000).toFixed(1)}s` : `${ms}ms`
+}
+
+export default function VoiceDiagPanel({ diag }: VoiceDiagPanelProps) {
+  const cpuLoad = diag?.cpuLoad ?? 0
+
+  return (
+    <div className="bg-groove-panel border border-groove-border rounded-lg">
+      <div className="px-4 py-3 border-b border-groove-border flex items-center justify-between">
+        <h2 className="font-semibold text-groove-text">Synth Voices</h2>
+        <span
+          className={`text-sm font-mono ${
+            cpuLoad > 80 ? 'text-groove-red' : cpuLoad > 60 ? 'text-groove-yellow' : 'text-groove-muted'
+          }`}
+        >
+          CPU {cpuLoad}%
+        </span>
+      </div>
+      <div className="p-4">
+        {!diag ? (
+          <p className="text-groove-muted text-sm">No voice data yet</p>
+        ) : (
+          <table className="w-full text-sm font-mono">
+            <thead>
+              <tr className="text-groove-muted text-left">
+                <th className="font-normal">#</th>
+                <th className="font-normal">Note</th>
+                <th className="font-normal">Stage</th>
+                <th className="font-normal w-1/4">Env</th>
+                <th className="font-normal text-right">Age</th>
+                <th className="font-normal text-right">Release</th>
+                <th className="font-normal text-right">Cutoff</th>
+              </tr>
+            </thead>
+            <tbody>
+              {diag.voices.map((v, i) => (
+                <tr key={i} className={v.active ? 'text-groove-text' : 'text-groove-border'}>
+                  <td>{i}</td>
+                  <td>
+                    {v.active ? noteToName(v.note) : '-'}
+                    {v.gate && <span className="ml-1 text-groove-green">G</span>}
+                  </td>
+                  <td>{v.active ? VOICE_STAGE_NAMES[v.stage] ?? v.stage : ''}</td>
+                  <td>
+                    <div className="h-2 bg-groove-border rounded-full overflow-hidden">
+                      <div className="h-full bg-groove-accent" style={{ width: `${v.env * 100}%` }} />
+                    </div>
+                  </td>
+                  <td className="text-right">{v.active ? formatAge(v.ageMs) : ''}</td>
+                  <td className="text-right">{v.active && !v.gate ? v.releaseSamples : ''}</td>
+                  <td className="text-right">{v.active ? `${v.cutoffHz} Hz` : ''}</td>
+                </tr>
+              ))}
+            </tbody>
+          </table>
+        )}
+      </div>
+    </div>
+  )
+}
@@ -0,0 +1,251 @@
+/**
+ * CC bank tables for KeyLab Essential 61
+ *
+ * Generated by tools/gen_cc_map.py - do not edit, run `make cc-tables`
+ * (same source as the firmware's cc_banks.h)
+ */
+
+export const CC_BANK_NEXT = 1
+export const CC_BANK_PREV = 2
+
+// Hardware CC numbers (in physical order L->R)
+export const ENCODER_CCS = [74, 71, 76, 77, 93, 18, 19, 16, 17] as const
+export const FADER_CCS = [73, 75, 79, 72, 80, 81, 82, 83, 85] as const
+
+// CC value -> parameter value conversion (matches cc_banks.h Curve)
+export enum Curve {
+  NONE,  // No conversion (unmapped)
+  NORM,  // 0.0-1.0 linear
+  FREQ,  // 20-20000 Hz logarithmic
+  TIME,  // 0.001-5.0 s logarithmic
+  WAVE,  // Waveform index 0-3
+  SEMI,  // -24 to +24 semitones
+  PAN,  // -1.0 to +1.0
+  RATE,  // 0.05-20 Hz logarithmic (LFO)
+  ROUTE,  // Mod matrix route 0-23
+  AMOUNT,  // -1.0 to +1.0 (mod amount)
+}
+
+// Parameter target types (matches cc_banks.h ParamTarget enum)
+export enum ParamTarget {
+  NONE = 0,
+  SYNTH_OSC1_WAVE,
+  SYNTH_OSC2_WAVE,
+  SYNTH_OSC1_LEVEL,
+  SYNTH_OSC2_LEVEL,
+  SYNTH_OSC2_DETUNE,
+  SYNTH_FILTER_CUTOFF,
+  SYNTH_FILTER_RES,
+  SYNTH_FILTER_ENV_AMT,
+  SYNTH_AMP_ATTACK,
+  SYNTH_AMP_DECAY,
+  SYNTH_AMP_SUSTAIN,
+  SYNTH_AMP_RELEASE,
+  SYNTH_FILT_ATTACK,
+  SYNTH_FILT_DECAY,
+  SYNTH_FILT_SUSTAIN,
+  SYNTH_FILT_RELEASE,
+  SYNTH_VEL_TO_AMP,
+  SYNTH_VEL_TO_FILTER,
+  SYNTH_LEVEL,
+  SYNTH_PAN,
+  SYNTH_MASTER_LEVEL,
+  SYNTH_LFO1_RATE,
+  SYNTH_LFO1_WAVE,
+  SYNTH_LFO2_RATE,
+  SYNTH_LFO2_WAVE,
+  SYNTH_LFO_DEPTH,
+  SYNTH_MOD1_ROUTE,
+  SYNTH_MOD1_AMOUNT,
+  SYNTH_MOD2_ROUTE,
+  SYNTH_MOD2_AMOUNT,
+  SYNTH_MOD3_ROUTE,
+  SYNTH_MOD3_AMOUNT,
+  DRUM_1_LEVEL,
+  DRUM_2_LEVEL,
+  DRUM_3_LEVEL,
+  DRUM_4_LEVEL,
+  DRUM_5_LEVEL,
+  DRUM_6_LEVEL,
+  DRUM_7_LEVEL,
+  DRUM_8_LEVEL,
+  DRUM_1_PAN,
+  DRUM_2_PAN,
+  DRUM_3_PAN,
+  DRUM_4_PAN,
+  DRUM_5_PAN,
+  DRUM_6_PAN,
+  DRUM_7_PAN,
+  DRUM_8_PAN,
+  DRUM_MASTER_LEVEL,
+  MASTER_OUTPUT,
+}
+
+// Value curve of each target, indexed by ParamTarget
+export const TARGET_CURVES: readonly Curve[] = [
+  Curve.NONE,  // NONE
+  Curve.WAVE,  // SYNTH_OSC1_WAVE
+  Curve.WAVE,  // SYNTH_OSC2_WAVE
+  Curve.NORM,  // SYNTH_OSC1_LEVEL
+  Curve.NORM,  // SYNTH_OSC2_LEVEL
+  Curve.SEMI,  // SYNTH_OSC2_DETUNE
+  Curve.FREQ,  // SYNTH_FILTER_CUTOFF
+  Curve.NORM,  // SYNTH_FILTER_RES
+  Curve.NORM,  // SYNTH_FILTER_ENV_AMT
+  Curve.TIME,  // SYNTH_AMP_ATTACK
+  Curve.TIME,  // SYNTH_AMP_DECAY
+  Curve.NORM,  // SYNTH_AMP_SUSTAIN
+  Curve.TIME,  // SYNTH_AMP_RELEASE
+  Curve.TIME,  // SYNTH_FILT_ATTACK
+  Curve.TIME,  // SYNTH_FILT_DECAY
+  Curve.NORM,  // SYNTH_FILT_SUSTAIN
+  Curve.TIME,  // SYNTH_FILT_RELEASE
+  Curve.NORM,  // SYNTH_VEL_TO_AMP
+  Curve.NORM,  // SYNTH_VEL_TO_FILTER
+  Curve.NORM,  // SYNTH_LEVEL
+  Curve.PAN,  // SYNTH_PAN
+  Curve.NORM,  // SYNTH_MASTER_LEVEL
+  Curve.RATE,  // SYNTH_LFO1_RATE
+  Curve.WAVE,  // SYNTH_LFO1_WAVE
+  Curve.RATE,  // SYNTH_LFO2_RATE
+  Curve.WAVE,  // SYNTH_LFO2_WAVE
+  Curve.NORM,  // SYNTH_LFO_DEPTH
+  Curve.ROUTE,  // SYNTH_MOD1_ROUTE
+  Curve.AMOUNT,  // SYNTH_MOD1_AMOUNT
+  Curve.ROUTE,  // SYNTH_MOD2_ROUTE
+  Curve.AMOUNT,  // SYNTH_MOD2_AMOUNT
+  Curve.ROUTE,  // SYNTH_MOD3_ROUTE
+  Curve.AMOUNT,  // SYNTH_MOD3_AMOUNT
+  Curve.NORM,  // DRUM_1_LEVEL
+  Curve.NORM,  // DRUM_2_LEVEL
+  Curve.NORM,  // DRUM_3_LEVEL
+  Curve.NORM,  // DRUM_4_LEVEL
+  Curve.NORM,  // DRUM_5_LEVEL
+  Curve.NORM,  // DRUM_6_LEVEL
+  Curve.NORM,  // DRUM_7_LEVEL
+  Curve.NORM,  // DRUM_8_LEVEL
+  Curve.PAN,  // DRUM_1_PAN
+  Curve.PAN,  // DRUM_2_PAN
+  Curve.PAN,  // DRUM_3_PAN
+  Curve.PAN,  // DRUM_4_PAN
+  Curve.PAN,  // DRUM_5_PAN
+  Curve.PAN,  // DRUM_6_PAN
+  Curve.PAN,  // DRUM_7_PAN
+  Curve.PAN,  // DRUM_8_PAN
+  Curve.NORM,  // DRUM_MASTER_LEVEL
+  Curve.NORM,  // MASTER_OUTPUT
+]
+
+export interface BankTableEntry {
+  target: ParamTarget
+  name: string
+}
+
+export interface BankTable {
+  bankName: string
+  encoders: BankTableEntry[]
+  faders: BankTableEntry[]
+}
+
+export const BANK_TABLES: BankTable[] = [
+  {
+    bankName: 'General',
+    encoders: [
+      { target: ParamTarget.SYNTH_LFO1_RATE, name: 'LFO1 Rate' },
+      { target: ParamTarget.SYNTH_LFO1_WAVE, name: 'LFO1 Wave' },
+      { target: ParamTarget.SYNTH_LFO2_RATE, name: 'LFO2 Rate' },
+      { target: ParamTarget.SYNTH_LFO2_WAVE, name: 'LFO2 Wave' },
+      { target: ParamTarget.SYNTH_MOD1_AMOUNT, name: 'Mod 1' },
+      { target: ParamTarget.SYNTH_MOD2_AMOUNT, name: 'Mod 2' },
+      { target: ParamTarget.SYNTH_MOD3_AMOUNT, name: 'Mod 3' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.NONE, name: '---' },
+    ],
+    faders: [
+      { target: ParamTarget.DRUM_MASTER_LEVEL, name: 'Drum Mst' },
+      { target: ParamTarget.SYNTH_MASTER_LEVEL, name: 'Synth Mst' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.SYNTH_LFO_DEPTH, name: 'LFO Depth' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.SYNTH_VEL_TO_AMP, name: 'Vel>Amp' },
+      { target: ParamTarget.SYNTH_VEL_TO_FILTER, name: 'Vel>Flt' },
+      { target: ParamTarget.MASTER_OUTPUT, name: 'Master' },
+    ],
+  },
+  {
+    bankName: 'Mix',
+    encoders: [
+      { target: ParamTarget.DRUM_1_PAN, name: 'Kick Pan' },
+      { target: ParamTarget.DRUM_2_PAN, name: 'Snare Pan' },
+      { target: ParamTarget.DRUM_3_PAN, name: 'HH-C Pan' },
+      { target: ParamTarget.DRUM_4_PAN, name: 'HH-O Pan' },
+      { target: ParamTarget.DRUM_5_PAN, name: 'Clap Pan' },
+      { target: ParamTarget.DRUM_6_PAN, name: 'TomL Pan' },
+      { target: ParamTarget.DRUM_7_PAN, name: 'TomM Pan' },
+      { target: ParamTarget.DRUM_8_PAN, name: 'Rim Pan' },
+      { target: ParamTarget.SYNTH_PAN, name: 'Synth Pan' },
+    ],
+    faders: [
+      { target: ParamTarget.DRUM_1_LEVEL, name: 'Kick' },
+      { target: ParamTarget.DRUM_2_LEVEL, name: 'Snare' },
+      { target: ParamTarget.DRUM_3_LEVEL, name: 'HH-C' },
+      { target: ParamTarget.DRUM_4_LEVEL, name: 'HH-O' },
+      { target: ParamTarget.DRUM_5_LEVEL, name: 'Clap' },
+      { target: ParamTarget.DRUM_6_LEVEL, name: 'Tom L' },
+      { target: ParamTarget.DRUM_7_LEVEL, name: 'Tom M' },
+      { target: ParamTarget.DRUM_8_LEVEL, name: 'Rim' },
+      { target: ParamTarget.SYNTH_LEVEL, name: 'Synth' },
+    ],
+  },
+  {
+    bankName: 'Synth',
+    encoders: [
+      { target: ParamTarget.SYNTH_FILTER_CUTOFF, name: 'Cutoff' },
+      { target: ParamTarget.SYNTH_FILT_ATTACK, name: 'Flt Atk' },
+      { target: ParamTarget.SYNTH_FILT_DECAY, name: 'Flt Dcy' },
+      { target: ParamTarget.SYNTH_OSC2_DETUNE, name: 'Detune' },
+      { target: ParamTarget.SYNTH_AMP_ATTACK, name: 'Amp Atk' },
+      { target: ParamTarget.SYNTH_AMP_DECAY, name: 'Amp Dcy' },
+      { target: ParamTarget.SYNTH_AMP_RELEASE, name: 'Amp Rel' },
+      { target: ParamTarget.SYNTH_OSC1_WAVE, name: 'Wave 1' },
+      { target: ParamTarget.SYNTH_OSC2_WAVE, name: 'Wave 2' },
+    ],
+    faders: [
+      { target: ParamTarget.SYNTH_OSC1_LEVEL, name: 'Osc 1' },
+      { target: ParamTarget.SYNTH_OSC2_LEVEL, name: 'Osc 2' },
+      { target: ParamTarget.SYNTH_FILTER_RES, name: 'Reso' },
+      { target: ParamTarget.SYNTH_FILTER_ENV_AMT, name: 'Flt Env' },
+      { target: ParamTarget.SYNTH_AMP_SUSTAIN, name: 'Amp Sus' },
+      { target: ParamTarget.SYNTH_FILT_SUSTAIN, name: 'Flt Sus' },
+      { target: ParamTarget.SYNTH_FILT_RELEASE, name: 'Flt Rel' },
+      { target: ParamTarget.SYNTH_LFO_DEPTH, name: 'LFO Depth' },
+      { target: ParamTarget.SYNTH_LEVEL, name: 'Level' },
+    ],
+  },
+  {
+    bankName: 'Sampler',
+    encoders: [
+      { target: ParamTarget.NONE, name: 'Pitch' },
+      { target: ParamTarget.NONE, name: 'Decay' },
+      { target: ParamTarget.NONE, name: 'Filter' },
+      { target: ParamTarget.NONE, name: 'Flt Res' },
+      { target: ParamTarget.NONE, name: 'Swing' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.NONE, name: '---' },
+      { target: ParamTarget.NONE, name: '---' },
+    ],
+    faders: [
+      { target: ParamTarget.DRUM_1_LEVEL, name: 'Kick' },
+      { target: ParamTarget.DRUM_2_LEVEL, name: 'Snare' },
+      { target: ParamTarget.DRUM_3_LEVEL, name: 'HH-C' },
+      { target: ParamTarget.DRUM_4_LEVEL, name: 'HH-O' },
+      { target: ParamTarget.DRUM_5_LEVEL, name: 'Clap' },
+      { target: ParamTarget.DRUM_6_LEVEL, name: 'Tom L' },
+      { target: ParamTarget.DRUM_7_LEVEL, name: 'Tom M' },
+      { target: ParamTarget.DRUM_8_LEVEL, name: 'Rim' },
+      { target: ParamTarget.DRUM_MASTER_LEVEL, name: 'Drum Mst' },
+    ],
+  },
+]
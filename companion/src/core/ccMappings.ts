@@ -1,9 +1,21 @@
 /**
  * CC Mappings for KeyLab Essential 61
  *
- * Mirrors the 4-bank CC mapping system from cc_map.h
+ * Mirrors the 4-bank CC mapping system from cc_map.h. The bank tables are
+ * generated (ccBanks.generated.ts) from the same source as the firmware's.
  */
 
+import {
+  ENCODER_CCS,
+  FADER_CCS,
+  ParamTarget,
+  Curve,
+  TARGET_CURVES,
+  BANK_TABLES,
+  type BankTableEntry,
+} from './ccBanks.generated'
+import { MOD_SOURCES, MOD_DESTS, LFO_MIN_HZ, LFO_MAX_HZ } from './protocol'
+
 // Bank definitions
 export enum Bank {
   GENERAL = 0,
@@ -12,61 +24,13 @@ export enum Bank {
   SAMPLER = 3,
 }
 
-export const BANK_NAMES = ['General', 'Mix', 'Synth', 'Sampler'] as const
-
-export const NUM_ENCODERS = 9
-export const NUM_FADERS = 9
+export const BANK_NAMES = BANK_TABLES.map((b) => b.bankName)
 
-// Hardware CC numbers (in physical order L->R)
-export const ENCODER_CCS = [74, 71, 76, 77, 93, 18, 19, 16, 17] as const
-export const FADER_CCS = [73, 75, 79, 72, 80, 81, 82, 83, 85] as const
+export const NUM_ENCODERS = ENCODER_CCS.length
+export const NUM_FADERS = FADER_CCS.length
 
-// Parameter target types (matches cc_map.h ParamTarget enum)
-export enum ParamTarget {
-  NONE = 0,
-  // Synth params
-  SYNTH_OSC1_WAVE,
-  SYNTH_OSC2_WAVE,
-  SYNTH_OSC1_LEVEL,
-  SYNTH_OSC2_LEVEL,
-  SYNTH_OSC2_DETUNE,
-  SYNTH_FILTER_CUTOFF,
-  SYNTH_FILTER_RES,
-  SYNTH_FILTER_ENV_AMT,
-  SYNTH_AMP_ATTACK,
-  SYNTH_AMP_DECAY,
-  SYNTH_AMP_SUSTAIN,
-  SYNTH_AMP_RELEASE,
-  SYNTH_FILT_ATTACK,
-  SYNTH_FILT_DECAY,
-  SYNTH_FILT_SUSTAIN,
-  SYNTH_FILT_RELEASE,
-  SYNTH_VEL_TO_AMP,
-  SYNTH_VEL_TO_FILTER,
-  SYNTH_LEVEL,
-  SYNTH_PAN,
-  SYNTH_MASTER_LEVEL,
-  // Drum params
-  DRUM_1_LEVEL,
-  DRUM_2_LEVEL,
-  DRUM_3_LEVEL,
-  DRUM_4_LEVEL,
-  DRUM_5_LEVEL,
-  DRUM_6_LEVEL,
-  DRUM_7_LEVEL,
-  DRUM_8_LEVEL,
-  DRUM_1_PAN,
-  DRUM_2_PAN,
-  DRUM_3_PAN,
-  DRUM_4_PAN,
-  DRUM_5_PAN,
-  DRUM_6_PAN,
-  DRUM_7_PAN,
-  DRUM_8_PAN,
-  DRUM_MASTER_LEVEL,
-  // Global
-  MASTER_OUTPUT,
-}
+// Hardware CCs, targets and bank tables come from tools/gen_cc_map.py
+export { ENCODER_CCS, FADER_CCS, ParamTarget, Curve }
 
 // Control mapping entry
 export interface ControlMapping {
@@ -110,121 +74,44 @@ const formatSemi = (v: number) => {
   return semi >= 0 ? `+${semi}` : `${semi}`
 }
 
-// Bank 0: General (Master Controls)
-const BANK_GENERAL_MAPPINGS: BankMappings = {
-  bankName: 'General',
-  encoders: [
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-  ],
-  faders: [
-    { target: ParamTarget.DRUM_MASTER_LEVEL, name: 'Drum Mst', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_MASTER_LEVEL, name: 'Synth Mst', formatValue: formatPercent },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.SYNTH_VEL_TO_AMP, name: 'Vel>Amp', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_VEL_TO_FILTER, name: 'Vel>Flt', formatValue: formatPercent },
-    { target: ParamTarget.MASTER_OUTPUT, name: 'Master', formatValue: formatPercent },
-  ],
+const formatRate = (v: number) => {
+  const hz = LFO_MIN_HZ * Math.pow(LFO_MAX_HZ / LFO_MIN_HZ, v / 127)
+  return hz >= 10 ? `${Math.round(hz)}` : hz.toFixed(hz >= 1 ? 1 : 2)
 }
-
-// Bank 1: Mix (Individual Levels + Pan)
-const BANK_MIX_MAPPINGS: BankMappings = {
-  bankName: 'Mix',
-  encoders: [
-    { target: ParamTarget.DRUM_1_PAN, name: 'Kick Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_2_PAN, name: 'Snare Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_3_PAN, name: 'HH-C Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_4_PAN, name: 'HH-O Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_5_PAN, name: 'Clap Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_6_PAN, name: 'TomL Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_7_PAN, name: 'TomM Pan', formatValue: formatPan },
-    { target: ParamTarget.DRUM_8_PAN, name: 'Rim Pan', formatValue: formatPan },
-    { target: ParamTarget.SYNTH_PAN, name: 'Synth Pan', formatValue: formatPan },
-  ],
-  faders: [
-    { target: ParamTarget.DRUM_1_LEVEL, name: 'Kick', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_2_LEVEL, name: 'Snare', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_3_LEVEL, name: 'HH-C', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_4_LEVEL, name: 'HH-O', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_5_LEVEL, name: 'Clap', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_6_LEVEL, name: 'Tom L', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_7_LEVEL, name: 'Tom M', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_8_LEVEL, name: 'Rim', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_LEVEL, name: 'Synth', formatValue: formatPercent },
-  ],
+const formatRoute = (v: number) => {
+  const route = Math.floor((v * MOD_SOURCES.length * MOD_DESTS.length) / 128)
+  const source = Math.floor(route / MOD_DESTS.length)
+  return source === 0 ? 'Off' : `${MOD_SOURCES[source]}>${MOD_DESTS[route % MOD_DESTS.length]}`
+}
+const formatAmount = (v: number) => {
+  const amount = Math.max(-100, Math.round(((v - 64) * 100) / 63))
+  return amount > 0 ? `+${amount}%` : `${amount}%`
 }
 
-// Bank 2: Synth (Sound Design)
-const BANK_SYNTH_MAPPINGS: BankMappings = {
-  bankName: 'Synth',
-  encoders: [
-    { target: ParamTarget.SYNTH_FILTER_CUTOFF, name: 'Cutoff', formatValue: formatFreq, unit: 'Hz' },
-    { target: ParamTarget.SYNTH_FILT_ATTACK, name: 'Flt Atk', formatValue: formatTime },
-    { target: ParamTarget.SYNTH_FILT_DECAY, name: 'Flt Dcy', formatValue: formatTime },
-    { target: ParamTarget.SYNTH_OSC2_DETUNE, name: 'Detune', formatValue: formatSemi, unit: 'st' },
-    { target: ParamTarget.SYNTH_AMP_ATTACK, name: 'Amp Atk', formatValue: formatTime },
-    { target: ParamTarget.SYNTH_AMP_DECAY, name: 'Amp Dcy', formatValue: formatTime },
-    { target: ParamTarget.SYNTH_AMP_RELEASE, name: 'Amp Rel', formatValue: formatTime },
-    { target: ParamTarget.SYNTH_OSC1_WAVE, name: 'Wave 1', formatValue: formatWave },
-    { target: ParamTarget.SYNTH_OSC2_WAVE, name: 'Wave 2', formatValue: formatWave },
-  ],
-  faders: [
-    { target: ParamTarget.SYNTH_OSC1_LEVEL, name: 'Osc 1', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_OSC2_LEVEL, name: 'Osc 2', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_FILTER_RES, name: 'Reso', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_FILTER_ENV_AMT, name: 'Flt Env', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_AMP_SUSTAIN, name: 'Amp Sus', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_FILT_SUSTAIN, name: 'Flt Sus', formatValue: formatPercent },
-    { target: ParamTarget.SYNTH_FILT_RELEASE, name: 'Flt Rel', formatValue: formatTime },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.SYNTH_LEVEL, name: 'Level', formatValue: formatPercent },
-  ],
+// Display formatter and unit for each curve
+const CURVE_FORMATS: Record<Curve, { formatValue?: (value: number) => string; unit?: string }> = {
+  [Curve.NONE]: {},
+  [Curve.NORM]: { formatValue: formatPercent },
+  [Curve.FREQ]: { formatValue: formatFreq, unit: 'Hz' },
+  [Curve.TIME]: { formatValue: formatTime },
+  [Curve.WAVE]: { formatValue: formatWave },
+  [Curve.SEMI]: { formatValue: formatSemi, unit: 'st' },
+  [Curve.PAN]: { formatValue: formatPan },
+  [Curve.RATE]: { formatValue: formatRate, unit: 'Hz' },
+  [Curve.ROUTE]: { formatValue: formatRoute },
+  [Curve.AMOUNT]: { formatValue: formatAmount },
 }
 
-// Bank 3: Sampler (Per-Drum Sound Design - future)
-const BANK_SAMPLER_MAPPINGS: BankMappings = {
-  bankName: 'Sampler',
-  encoders: [
-    { target: ParamTarget.NONE, name: 'Pitch' },
-    { target: ParamTarget.NONE, name: 'Decay' },
-    { target: ParamTarget.NONE, name: 'Filter' },
-    { target: ParamTarget.NONE, name: 'Flt Res' },
-    { target: ParamTarget.NONE, name: 'Swing' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-    { target: ParamTarget.NONE, name: '---' },
-  ],
-  faders: [
-    { target: ParamTarget.DRUM_1_LEVEL, name: 'Kick', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_2_LEVEL, name: 'Snare', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_3_LEVEL, name: 'HH-C', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_4_LEVEL, name: 'HH-O', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_5_LEVEL, name: 'Clap', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_6_LEVEL, name: 'Tom L', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_7_LEVEL, name: 'Tom M', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_8_LEVEL, name: 'Rim', formatValue: formatPercent },
-    { target: ParamTarget.DRUM_MASTER_LEVEL, name: 'Drum Mst', formatValue: formatPercent },
-  ],
+function toControlMapping(entry: BankTableEntry): ControlMapping {
+  return { target: entry.target, name: entry.name, ...CURVE_FORMATS[TARGET_CURVES[entry.target]] }
 }
 
 // All bank mappings
-export const ALL_BANKS: BankMappings[] = [
-  BANK_GENERAL_MAPPINGS,
-  BANK_MIX_MAPPINGS,
-  BANK_SYNTH_MAPPINGS,
-  BANK_SAMPLER_MAPPINGS,
-]
+export const ALL_BANKS: BankMappings[] = BANK_TABLES.map((bank) => ({
+  bankName: bank.bankName,
+  encoders: bank.encoders.map(toControlMapping),
+  faders: bank.faders.map(toControlMapping),
+}))
 
 // Get bank mappings by bank index
 export function getBankMappings(bank: Bank): BankMappings {
@@ -0,0 +1,108 @@
+/**
+ * Local playhead driven by MSG_CLOCK_SYNC anchors (see clock_sync.h)
+ *
+ * Each anchor says "at device sample S the playhead was at tick T, running
+ * at B bpm". Device samples are mapped to local time with the smallest
+ * offset seen over the last few anchors (the anchor that waited least in
+ * USB/serial buffers), and the playhead is extrapolated from there. When a
+ * new anchor disagrees slightly with the running estimate the difference is
+ * slewed out over SLEW_MS instead of jumping; big differences (rewind,
+ * tempo change, start/stop) snap.
+ */
+
+import { ClockSyncMessage } from './protocol'
+
+const PPQN = 96
+const OFFSET_WINDOW = 8  // Anchors used for the offset estimate
+const SNAP_TICKS = 6     // Larger corrections jump instead of slewing
+const SLEW_MS = 250
+
+export class PlayheadClock {
+  private anchor: ClockSyncMessage | null = null
+  private anchorLocalMs = 0
+  private deviceMs = 0        // Unwrapped device time of the latest anchor
+  private offsets: number[] = []
+  private correction = 0      // Ticks still to slew out
+  private correctionStart = 0
+
+  reset(): void {
+    this.anchor = null
+    this.offsets = []
+    this.correction = 0
+  }
+
+  update(msg: ClockSyncMessage, nowMs: number): void {
+    const rate = msg.sampleRate > 0 ? msg.sampleRate : 48000
+    if (this.anchor && this.anchor.sampleRate === msg.sampleRate) {
+      // Sample counter wraps at 2^32 (about a day at 48 kHz)
+      const delta = (msg.sample - this.anchor.sample) >>> 0
+      this.deviceMs += (delta / rate) * 1000
+    } else {
+      this.deviceMs = (msg.sample / rate) * 1000
+      this.offsets = []
+    }
+
+    this.offsets.push(nowMs - this.deviceMs)
+    if (this.offsets.length > OFFSET_WINDOW) {
+      this.offsets.shift()
+    }
+    const offset = Math.min(...this.offsets)
+
+    const before = this.anchor ? this.tickAt(nowMs) : null
+    const wasRunning = this.anchor?.running ?? false
+    this.anchor = msg
+    this.anchorLocalMs = this.deviceMs + offset
+    this.correction = 0
+
+    if (before !== null && wasRunning && msg.running) {
+      const error = this.wrapDistance(before - this.predict(nowMs))
+      if (Math.abs(error) <= SNAP_TICKS) {
+        this.correction = error
+        this.correctionStart = nowMs
+      }
+    }
+  }
+
+  /**
+   * Fractional playhead tick at a local time (performance.now() ms)
+   */
+  tickAt(nowMs: number): number {
+    if (!this.anchor) {
+      return 0
+    }
+    let pos = this.predict(nowMs)
+    if (this.correction !== 0) {
+      const left = 1 - (nowMs - this.correctionStart) / SLEW_MS
+      if (left > 0) {
+        pos += this.correction * left
+      } else {
+        this.correction = 0
+      }
+    }
+    return this.wrap(pos)
+  }
+
+  private predict(nowMs: number): number {
+    const a = this.anchor!
+    let pos = a.tick + a.phase
+    if (a.running) {
+      pos += (Math.max(0, nowMs - this.anchorLocalMs) * a.bpm * PPQN) / 60000
+    }
+    return this.wrap(pos)
+  }
+
+  private wrap(pos: number): number {
+    const len = this.anchor?.patternTicks ?? 0
+    return len > 0 ? ((pos % len) + len) % len : pos
+  }
+
+  // Shortest signed distance around the loop
+  private wrapDistance(diff: number): number {
+    const len = this.anchor?.patternTicks ?? 0
+    if (len > 0) {
+      if (diff > len / 2) return diff - len
+      if (diff < -len / 2) return diff + len
+    }
+    return diff
+  }
+}
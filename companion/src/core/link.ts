@@ -0,0 +1,80 @@
+/**
+ * Receive side of the reliable bulk link (see reliable_link.h)
+ *
+ * Framed messages carry an 8-bit sequence number. Frames are delivered in
+ * sequence order: anything that arrives after a gap is held back, the
+ * missing numbers are NAKed, and the held frames are released once the
+ * retransmits fill the gap. A MSG_LINK_GAP retransmit means the firmware no
+ * longer had the message; it is delivered like any other frame so the
+ * consumer can re-request the data.
+ */
+
+export interface Frame {
+  type: number
+  payload: Uint8Array
+}
+
+export interface LinkResult {
+  deliver: Frame[]  // Frames now in order, oldest first
+  nak: number[]     // Sequence numbers to request again
+}
+
+// Further ahead than this is treated as a stale duplicate
+const MAX_AHEAD = 128
+
+export class LinkReceiver {
+  private expected = 0  // The firmware restarts at 0 on CMD_LINK_CONFIG
+  private held = new Map<number, Frame>()
+  private missing = new Set<number>()
+
+  /**
+   * Start over (send CMD_LINK_CONFIG at the same time)
+   */
+  reset(): void {
+    this.expected = 0
+    this.held.clear()
+    this.missing.clear()
+  }
+
+  receive(seq: number, type: number, payload: Uint8Array): LinkResult {
+    const result: LinkResult = { deliver: [], nak: [] }
+    const ahead = (seq - this.expected) & 0xff
+    if (ahead >= MAX_AHEAD || this.held.has(seq)) {
+      return result  // Duplicate
+    }
+
+    this.missing.delete(seq)
+    this.held.set(seq, { type, payload })
+
+    // Everything between the expected frame and this one was lost
+    for (let s = this.expected; s !== seq; s = (s + 1) & 0xff) {
+      if (!this.held.has(s) && !this.missing.has(s)) {
+        this.missing.add(s)
+        result.nak.push(s)
+      }
+    }
+
+    // Release whatever is now contiguous
+    let next = this.held.get(this.expected)
+    while (next) {
+      result.deliver.push(next)
+      this.held.delete(this.expected)
+      this.expected = (this.expected + 1) & 0xff
+      next = this.held.get(this.expected)
+    }
+    return result
+  }
+
+  /**
+   * A framed message failed its CRC: ask again for everything outstanding,
+   * including the next expected frame (the corrupted one may have been it)
+   */
+  corrupted(): number[] {
+    const nak = new Set(this.missing)
+    if (!this.held.has(this.expected)) {
+      nak.add(this.expected)
+      this.missing.add(this.expected)
+    }
+    return Array.from(nak)
+  }
+}
@@ -8,10 +8,15 @@
  * LEN:      16-bit payload length (little-endian)
  * PAYLOAD:  Variable length data
  * CHECKSUM: XOR of all bytes from TYPE through PAYLOAD
+ *
+ * Framed format (bulk messages after CMD_LINK_CONFIG, see link.ts):
+ *   [SYNC_FRAMED][TYPE][SEQ][LEN_LO][LEN_HI][PAYLOAD...][CRC_LO][CRC_HI]
+ *   CRC-16/CCITT-FALSE over TYPE through PAYLOAD
  */
 
-// Sync byte
+// Sync bytes
 export const SYNC_BYTE = 0xaa
+export const SYNC_FRAMED = 0xab  // CRC-16 + sequence number framing
 
 // Message types: Daisy -> Companion
 export const MSG_TICK = 0x01
@@ -24,9 +29,21 @@ export const MSG_CC_BANK = 0x07
 export const MSG_FADER_STATE = 0x08
 export const MSG_MIXER_STATE = 0x09
 export const MSG_TRACK_STATE = 0x0a    // Track freeze status
+export const MSG_MIDI_BATCH = 0x0b     // Batched MIDI_IN events (one per frame)
 export const MSG_PATTERN_DUMP = 0x10   // Pattern events dump
 export const MSG_PATTERN_CLEAR = 0x11  // Track was cleared
 export const MSG_RESOURCES = 0x12      // Memory + CPU stats
+export const MSG_PATTERN_BULK = 0x13   // Bulk pattern stream chunk
+export const MSG_STATE_DELTA = 0x14    // Versioned state change-set (see stateSync.ts)
+export const MSG_LINK_GAP = 0x15       // Framed only: NAKed message is gone for good
+export const MSG_CLOCK_SYNC = 0x16     // Playhead anchor (see clockSync.ts)
+export const MSG_TELEMETRY = 0x17      // Bus levels, scope, spectrum
+export const MSG_VOICE_DIAG = 0x18     // Per-voice synth diagnostics
+export const MSG_TASK_STATS = 0x19     // Main-loop task timing
+export const MSG_SMF_DATA = 0x1a       // Exported MIDI file chunk
+export const MSG_SMF_STATUS = 0x1b     // MIDI file import/export progress
+export const MSG_AUDIO_CONFIG = 0x1c   // Sample rate, block size, latency
+export const MSG_AUDIO_BENCH = 0x1d    // Benchmark matrix cell result
 export const MSG_DEBUG = 0xff
 
 // Message types: Companion -> Daisy
@@ -43,6 +60,57 @@ export const CMD_UNFREEZE_TRACK = 0x89  // Unfreeze track
 export const CMD_REQ_STATE = 0x90
 export const CMD_REQ_PATTERN = 0x91     // Request pattern dump
 export const CMD_REQ_SYNTH = 0x92
+export const CMD_BULK_ACK = 0x93        // Return bulk transfer credits
+export const CMD_BULK_CONFIG = 0x94     // Negotiate bulk chunk size / window
+export const CMD_STATE_ACK = 0x95       // Acknowledge a state version
+export const CMD_LINK_CONFIG = 0x96     // Enable/disable CRC framing
+export const CMD_LINK_NAK = 0x97        // Request framed retransmits
+export const CMD_TELEMETRY_CONFIG = 0x98  // Audio telemetry on/off, rate
+export const CMD_SMF_IMPORT = 0x99      // MIDI file chunk to import
+export const CMD_SMF_EXPORT = 0x9a      // Request an exported MIDI file chunk
+export const CMD_AUDIO_CONFIG = 0x9b    // Change (or query) rate / block size
+export const CMD_AUDIO_BENCH = 0x9c     // Run the audio benchmark matrix
+
+// CMD_LINK_CONFIG flags
+export const LINK_FLAG_FRAMED = 0x01
+
+// CMD_TELEMETRY_CONFIG / MSG_TELEMETRY flags (see telemetry.h)
+export const TELEMETRY_FLAG_ENABLE = 0x01
+export const TELEMETRY_FLAG_SCOPE = 0x02
+export const TELEMETRY_FLAG_SPECTRUM = 0x04
+export const TELEMETRY_BUSES = ['Synth', 'Frozen', 'Drums', 'Master']
+
+// MIDI file transfer (see smf.h and core/smf.ts)
+export const SMF_CHUNK_SIZE = 240       // File bytes per CMD_SMF_IMPORT
+export const SMF_OP_IMPORT = 1
+export const SMF_OP_EXPORT = 2
+export enum SmfState {
+  OK = 0,        // Chunk accepted, continue at offset
+  DONE = 1,
+  FORMAT = 2,    // Not a type 0/1 MIDI file
+  BUSY = 3,      // Try again later
+  SEQUENCE = 4,  // Wrong offset; offset is the expected one
+}
+
+// Audio configuration (see audio_config.h)
+export const AUDIO_RATES = [32000, 48000, 96000]
+export const AUDIO_BLOCKS = [16, 32, 64, 128, 256]
+export enum AudioState {
+  OK = 0,
+  INVALID = 1,  // Unsupported settings, nothing changed
+  BUSY = 2,     // Benchmark running, nothing changed
+}
+
+// Bulk pattern transfer (see pattern_transfer.h)
+export const BULK_CHUNK_SIZE = 1024     // Chunk payload we ask for
+export const BULK_WINDOW = 8            // Chunks in flight
+const BULK_FLAG_FIRST = 0x01
+const BULK_FLAG_LAST = 0x02
+const BULK_STREAM_VERSION = 1
+
+// State delta flags (see state_sync.h)
+const STATE_FLAG_SNAPSHOT = 0x01
+const STATE_FLAG_MORE = 0x02
 
 // Track status enum
 export enum TrackStatus {
@@ -76,11 +144,36 @@ export enum SynthParamId {
   VEL_TO_AMP,
   VEL_TO_FILTER,
   LEVEL,
+  PAN,
+  MASTER_LEVEL,
+  LFO1_RATE,
+  LFO1_WAVE,
+  LFO2_RATE,
+  LFO2_WAVE,
+  LFO_DEPTH,
+  MOD1_ROUTE,
+  MOD1_AMOUNT,
+  MOD2_ROUTE,
+  MOD2_AMOUNT,
+  MOD3_ROUTE,
+  MOD3_AMOUNT,
 }
 
 // Waveform names
 export const WAVEFORM_NAMES = ['Sine', 'Triangle', 'Saw', 'Square']
 
+// Mod matrix (see mod_matrix.h): route = source * MOD_DESTS.length + dest,
+// source 0 (None) is off
+export const NUM_MOD_SLOTS = 3
+export const MOD_SOURCES = ['None', 'LFO 1', 'LFO 2', 'Filter Env', 'Velocity', 'Mod Wheel']
+export const MOD_DESTS = ['Cutoff', 'Pitch', 'Level', 'Pan']
+export const LFO_MIN_HZ = 0.05
+export const LFO_MAX_HZ = 20
+
+export function modRoute(source: number, dest: number): number {
+  return source * MOD_DESTS.length + dest
+}
+
 // Factory preset names
 export const FACTORY_PRESETS = ['Init Patch', 'Warm Pad', 'Pluck Lead', 'Bass']
 
@@ -168,6 +261,130 @@ export interface PatternClearMessage {
   trackId: number
 }
 
+export interface PatternBulkMessage {
+  type: typeof MSG_PATTERN_BULK
+  seq: number
+  first: boolean        // Start of a new stream
+  last: boolean         // Stream complete
+  data: Uint8Array      // Next bytes of the encoded stream
+}
+
+export interface StateDeltaMessage {
+  type: typeof MSG_STATE_DELTA
+  version: number       // 16-bit state version
+  base: number          // Version the changes are relative to
+  snapshot: boolean     // Full table (resets the mirror)
+  more: boolean         // Another message with the same version follows
+  entries: Array<{ field: number; value: number }>  // value = raw 32 bits
+}
+
+export interface LinkGapMessage {
+  type: typeof MSG_LINK_GAP
+}
+
+export interface ClockSyncMessage {
+  type: typeof MSG_CLOCK_SYNC
+  sample: number        // Device audio sample counter at the anchor (wraps at 2^32)
+  tick: number          // Pattern tick at that sample
+  phase: number         // Fraction of the way to the next tick (0-1)
+  bpm: number
+  patternTicks: number  // Loop length in ticks
+  sampleRate: number    // Hz
+  running: boolean
+}
+
+export interface TelemetryMessage {
+  type: typeof MSG_TELEMETRY
+  clip: boolean[]        // Per bus: reached full scale since the last message
+  peakDb: number[]       // Per bus, dBFS (-100 = silence)
+  rmsDb: number[]
+  decimation: number     // Scope sample = decimation device samples
+  scope: number[] | null // -1..1, starts at a rising zero crossing
+  bands: number[] | null // dBFS, log-spaced 40 Hz..Nyquist of the decimated rate
+}
+
+// Amp envelope segments reported in MSG_VOICE_DIAG (daisysp ADSR_SEG_*)
+export const VOICE_STAGE_NAMES: Record<number, string> = {
+  0: 'idle',
+  1: 'attack',
+  2: 'decay',
+  4: 'release',
+}
+
+export interface VoiceDiag {
+  note: number
+  velocity: number
+  active: boolean
+  gate: boolean
+  stage: number          // See VOICE_STAGE_NAMES
+  env: number            // Amp envelope 0-1
+  ageMs: number          // Since note on (saturates at 65535)
+  releaseSamples: number // Since gate off
+  cutoffHz: number
+}
+
+export interface VoiceDiagMessage {
+  type: typeof MSG_VOICE_DIAG
+  cpuLoad: number        // 0-100 percent
+  activeCount: number
+  voices: VoiceDiag[]
+}
+
+// Main-loop task priorities (task_scheduler.h)
+export const TASK_PRIORITY_NAMES = ['input', 'realtime', 'normal', 'bulk']
+
+export interface TaskStat {
+  name: string
+  priority: number       // See TASK_PRIORITY_NAMES
+  runs: number
+  avgUs: number
+  maxUs: number
+  maxLateMs: number
+  overruns: number       // Runs over the task's budget
+  deferred: number       // Passes a bulk task waited for budget
+}
+
+export interface TaskStatsMessage {
+  type: typeof MSG_TASK_STATS
+  maxPassUs: number
+  tasks: TaskStat[]
+}
+
+export interface SmfDataMessage {
+  type: typeof MSG_SMF_DATA
+  offset: number
+  total: number
+  data: Uint8Array
+}
+
+export interface SmfStatusMessage {
+  type: typeof MSG_SMF_STATUS
+  op: number             // SMF_OP_IMPORT / SMF_OP_EXPORT
+  state: SmfState
+  offset: number
+  notes: number          // Import: events added to tracks
+  points: number         // Import: automation points
+  dropped: number        // Import: past the pattern end or no room
+}
+
+export interface AudioConfigMessage {
+  type: typeof MSG_AUDIO_CONFIG
+  rate: number           // Hz
+  block: number          // Frames per audio callback
+  latencyUs: number      // Live MIDI in to audio out
+  state: AudioState
+}
+
+export interface AudioBenchMessage {
+  type: typeof MSG_AUDIO_BENCH
+  index: number
+  count: number
+  rate: number
+  block: number
+  avgLoad: number        // 0-100+ percent of the block period
+  maxLoad: number
+}
+
 export interface ResourcesMessage {
   type: typeof MSG_RESOURCES
   memoryUsed: number    // bytes
@@ -201,6 +418,18 @@ export interface SynthParams {
   velToFilter: number
 
   level: number
+
+  mod: ModParams
+}
+
+export interface ModParams {
+  lfo1Rate: number   // Hz, per voice
+  lfo1Wave: number
+  lfo2Rate: number   // Hz, global
+  lfo2Wave: number
+  lfoDepth: number   // 0-1, scales LFO routes
+  routes: number[]   // NUM_MOD_SLOTS x modRoute()
+  amounts: number[]  // NUM_MOD_SLOTS x -1..+1
 }
 
 export interface SynthStateMessage {
@@ -222,19 +451,34 @@ export type ParsedMessage =
   | TrackStateMessage
   | PatternDumpMessage
   | PatternClearMessage
+  | PatternBulkMessage
+  | StateDeltaMessage
+  | LinkGapMessage
+  | ClockSyncMessage
+  | TelemetryMessage
+  | VoiceDiagMessage
+  | TaskStatsMessage
+  | SmfDataMessage
+  | SmfStatusMessage
+  | AudioConfigMessage
+  | AudioBenchMessage
   | ResourcesMessage
 
 // Parser state
 enum ParserState {
   WAIT_SYNC,
   WAIT_TYPE,
+  WAIT_SEQ,
   WAIT_LEN_LO,
   WAIT_LEN_HI,
   WAIT_PAYLOAD,
   WAIT_CHECKSUM,
+  WAIT_CRC_LO,
+  WAIT_CRC_HI,
 }
 
-const MAX_PAYLOAD = 256
+// Largest payload accepted (bulk pattern chunks are the biggest messages)
+const MAX_PAYLOAD = BULK_CHUNK_SIZE
 
 /**
  * Calculate XOR checksum over a buffer
@@ -247,6 +491,26 @@ function calculateChecksum(data: Uint8Array): number {
   return sum
 }
 
+// CRC-16/CCITT-FALSE table (poly 0x1021)
+const CRC16_TABLE = (() => {
+  const table = new Uint16Array(256)
+  for (let i = 0; i < 256; i++) {
+    let crc = i << 8
+    for (let bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? ((crc << 1) ^ 0x1021) & 0xffff : (crc << 1) & 0xffff
+    }
+    table[i] = crc
+  }
+  return table
+})()
+
+/**
+ * Continue a CRC-16/CCITT-FALSE over one byte (start with 0xffff)
+ */
+export function crc16Update(crc: number, byte: number): number {
+  return ((crc << 8) & 0xffff) ^ CRC16_TABLE[((crc >> 8) ^ byte) & 0xff]
+}
+
 /**
  * Read a little-endian float from a buffer at the given offset
  */
@@ -303,9 +567,14 @@ export function buildSynthParamCommand(paramId: SynthParamId, value: number): Ui
 
 /**
  * Build a load preset command
+ * morphMs > 0 morphs from the current sound to the preset over that time.
  */
-export function buildLoadPresetCommand(presetIndex: number): Uint8Array {
-  return buildMessage(CMD_LOAD_PRESET, new Uint8Array([presetIndex]))
+export function buildLoadPresetCommand(presetIndex: number, morphMs = 0): Uint8Array {
+  if (morphMs <= 0) {
+    return buildMessage(CMD_LOAD_PRESET, new Uint8Array([presetIndex]))
+  }
+  const ms = Math.min(Math.round(morphMs), 0xffff)
+  return buildMessage(CMD_LOAD_PRESET, new Uint8Array([presetIndex, ms & 0xff, ms >> 8]))
 }
 
 /**
@@ -347,6 +616,104 @@ export function buildRequestPatternCommand(trackId?: number): Uint8Array {
   return buildMessage(CMD_REQ_PATTERN)
 }
 
+/**
+ * Build a bulk transfer config command (sent once on connect)
+ */
+export function buildBulkConfigCommand(chunkSize = BULK_CHUNK_SIZE, window = BULK_WINDOW): Uint8Array {
+  return buildMessage(CMD_BULK_CONFIG, new Uint8Array([chunkSize & 0xff, chunkSize >> 8, window]))
+}
+
+/**
+ * Build a bulk credit return (one credit per chunk consumed)
+ */
+export function buildBulkAckCommand(credits = 1): Uint8Array {
+  return buildMessage(CMD_BULK_ACK, new Uint8Array([credits]))
+}
+
+/**
+ * Build a state acknowledgement (after each complete MSG_STATE_DELTA)
+ */
+export function buildStateAckCommand(version: number): Uint8Array {
+  return buildMessage(CMD_STATE_ACK, new Uint8Array([version & 0xff, (version >> 8) & 0xff]))
+}
+
+/**
+ * Build a link config command (CRC framing for bulk messages on/off)
+ */
+export function buildLinkConfigCommand(framed = true): Uint8Array {
+  return buildMessage(CMD_LINK_CONFIG, new Uint8Array([framed ? LINK_FLAG_FRAMED : 0]))
+}
+
+/**
+ * Build an audio telemetry request (intervalMs is a minimum; the firmware
+ * stretches it to stay within its CPU budget)
+ */
+export function buildTelemetryConfigCommand(
+  enabled: boolean,
+  intervalMs = 100,
+  scope = true,
+  spectrum = true,
+  decimation = 2
+): Uint8Array {
+  const flags =
+    (enabled ? TELEMETRY_FLAG_ENABLE : 0) |
+    (scope ? TELEMETRY_FLAG_SCOPE : 0) |
+    (spectrum ? TELEMETRY_FLAG_SPECTRUM : 0)
+  return buildMessage(
+    CMD_TELEMETRY_CONFIG,
+    new Uint8Array([flags, intervalMs & 0xff, (intervalMs >> 8) & 0xff, decimation])
+  )
+}
+
+/**
+ * Build a MIDI file import chunk (offset 0 starts a new file)
+ */
+export function buildSmfImportCommand(offset: number, total: number, data: Uint8Array): Uint8Array {
+  const payload = new Uint8Array(8 + data.length)
+  const view = new DataView(payload.buffer)
+  view.setUint32(0, offset, true)
+  view.setUint32(4, total, true)
+  payload.set(data, 8)
+  return buildMessage(CMD_SMF_IMPORT, payload)
+}
+
+/**
+ * Build a MIDI file export request (offset 0 starts a new export)
+ */
+export function buildSmfExportCommand(offset: number): Uint8Array {
+  const payload = new Uint8Array(4)
+  new DataView(payload.buffer).setUint32(0, offset, true)
+  return buildMessage(CMD_SMF_EXPORT, payload)
+}
+
+/**
+ * Build an audio rate / block size change; no arguments just asks for MSG_AUDIO_CONFIG
+ */
+export function buildAudioConfigCommand(rate?: number, block?: number): Uint8Array {
+  if (rate === undefined || block === undefined) {
+    return buildMessage(CMD_AUDIO_CONFIG)
+  }
+  const payload = new Uint8Array(6)
+  const view = new DataView(payload.buffer)
+  view.setUint32(0, rate, true)
+  view.setUint16(4, block, true)
+  return buildMessage(CMD_AUDIO_CONFIG, payload)
+}
+
+/**
+ * Build a request to run the rate x block benchmark matrix
+ */
+export function buildAudioBenchCommand(): Uint8Array {
+  return buildMessage(CMD_AUDIO_BENCH)
+}
+
+/**
+ * Build a retransmit request for the given framed sequence numbers
+ */
+export function buildLinkNakCommand(seqs: number[]): Uint8Array {
+  return buildMessage(CMD_LINK_NAK, new Uint8Array(seqs))
+}
+
 /**
  * Get default synth params (matches Init Patch)
  */
@@ -376,9 +743,71 @@ export function getDefaultSynthParams(): SynthParams {
     velToFilter: 0.3,
 
     level: 0.7,
+
+    mod: getDefaultModParams(),
+  }
+}
+
+/**
+ * Get default modulation params (matches SynthParams::InitMod)
+ */
+export function getDefaultModParams(): ModParams {
+  return {
+    lfo1Rate: 5,
+    lfo1Wave: 0, // Sine
+    lfo2Rate: 0.5,
+    lfo2Wave: 1, // Triangle
+    lfoDepth: 1,
+    routes: Array(NUM_MOD_SLOTS).fill(0),
+    amounts: Array(NUM_MOD_SLOTS).fill(0),
   }
 }
 
+// Half-dB steps above -100 dBFS
+function decodeDb(code: number): number {
+  return code / 2 - 100
+}
+
+/**
+ * MSG_TELEMETRY: [flags:1][clip:1][peak:1 x4][rms:1 x4]
+ *   + scope:    [decimation:1][count:1][int8 x count]
+ *   + spectrum: [count:1][band:1 x count]
+ */
+function parseTelemetry(payload: Uint8Array): TelemetryMessage | null {
+  const buses = TELEMETRY_BUSES.length
+  if (payload.length < 2 + 2 * buses) {
+    return null
+  }
+  const flags = payload[0]
+  const msg: TelemetryMessage = {
+    type: MSG_TELEMETRY,
+    clip: TELEMETRY_BUSES.map((_, b) => (payload[1] & (1 << b)) !== 0),
+    peakDb: Array.from(payload.subarray(2, 2 + buses), decodeDb),
+    rmsDb: Array.from(payload.subarray(2 + buses, 2 + 2 * buses), decodeDb),
+    decimation: 0,
+    scope: null,
+    bands: null,
+  }
+  let pos = 2 + 2 * buses
+  if (flags & TELEMETRY_FLAG_SCOPE) {
+    if (pos + 2 > payload.length || pos + 2 + payload[pos + 1] > payload.length) {
+      return null
+    }
+    msg.decimation = payload[pos]
+    const count = payload[pos + 1]
+    const samples = new Int8Array(payload.buffer, payload.byteOffset + pos + 2, count)
+    msg.scope = Array.from(samples, (v) => v / 127)
+    pos += 2 + count
+  }
+  if (flags & TELEMETRY_FLAG_SPECTRUM) {
+    if (pos + 1 > payload.length || pos + 1 + payload[pos] > payload.length) {
+      return null
+    }
+    msg.bands = Array.from(payload.subarray(pos + 1, pos + 1 + payload[pos]), decodeDb)
+  }
+  return msg
+}
+
 /**
  * Parse a message payload into a typed message object
  */
@@ -467,6 +896,9 @@ function parsePayload(type: number, payload: Uint8Array): ParsedMessage | null {
 
           // Master level
           level: (idx += 4, readFloat(payload, idx)),
+
+          // Not in the legacy dump
+          mod: getDefaultModParams(),
         }
 
         idx += 4
@@ -586,6 +1018,175 @@ function parsePayload(type: number, payload: Uint8Array): ParsedMessage | null {
       }
       break
 
+    case MSG_PATTERN_BULK:
+      // [seq:1][flags:1][stream...]
+      if (payload.length >= 2) {
+        return {
+          type: MSG_PATTERN_BULK,
+          seq: payload[0],
+          first: (payload[1] & BULK_FLAG_FIRST) !== 0,
+          last: (payload[1] & BULK_FLAG_LAST) !== 0,
+          data: payload.slice(2),
+        }
+      }
+      break
+
+    case MSG_STATE_DELTA:
+      // [version:2][base:2][flags:1] then [field:1][value:4] per entry
+      if (payload.length >= 5) {
+        const entries = []
+        for (let i = 5; i + 5 <= payload.length; i += 5) {
+          const value =
+            payload[i + 1] | (payload[i + 2] << 8) | (payload[i + 3] << 16) | (payload[i + 4] << 24)
+          entries.push({ field: payload[i], value: value >>> 0 })
+        }
+        return {
+          type: MSG_STATE_DELTA,
+          version: payload[0] | (payload[1] << 8),
+          base: payload[2] | (payload[3] << 8),
+          snapshot: (payload[4] & STATE_FLAG_SNAPSHOT) !== 0,
+          more: (payload[4] & STATE_FLAG_MORE) !== 0,
+          entries,
+        }
+      }
+      break
+
+    case MSG_LINK_GAP:
+      return { type: MSG_LINK_GAP }
+
+    case MSG_CLOCK_SYNC:
+      // [sample:4][tick:4][phase:2][bpm:2][pattern_ticks:4][sample_rate:4][flags:1]
+      if (payload.length >= 21) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        return {
+          type: MSG_CLOCK_SYNC,
+          sample: view.getUint32(0, true),
+          tick: view.getUint32(4, true),
+          phase: view.getUint16(8, true) / 65536,
+          bpm: view.getUint16(10, true),
+          patternTicks: view.getUint32(12, true),
+          sampleRate: view.getUint32(16, true),
+          running: (payload[20] & 0x01) !== 0,
+        }
+      }
+      break
+
+    case MSG_TELEMETRY:
+      return parseTelemetry(payload)
+
+    case MSG_VOICE_DIAG:
+      // [cpu:1][active:1][count:1] + count x
+      // [note][velocity][state][env][age_ms:2][release_samples:4][cutoff_hz:2]
+      if (payload.length >= 3 && payload.length >= 3 + payload[2] * 12) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        const voices: VoiceDiag[] = []
+        for (let i = 0, pos = 3; i < payload[2]; i++, pos += 12) {
+          const state = payload[pos + 2]
+          voices.push({
+            note: payload[pos],
+            velocity: payload[pos + 1],
+            active: (state & 0x01) !== 0,
+            gate: (state & 0x02) !== 0,
+            stage: (state >> 4) & 0x07,
+            env: payload[pos + 3] / 255,
+            ageMs: view.getUint16(pos + 4, true),
+            releaseSamples: view.getUint32(pos + 6, true),
+            cutoffHz: view.getUint16(pos + 10, true),
+          })
+        }
+        return { type: MSG_VOICE_DIAG, cpuLoad: payload[0], activeCount: payload[1], voices }
+      }
+      break
+
+    case MSG_TASK_STATS:
+      // [max_pass_us:2][count:1] + count x [name_len:1][name][priority:1]
+      // [runs:2][avg_us:2][max_us:2][max_late_ms:2][overruns:1][deferred:1]
+      if (payload.length >= 3) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        const tasks: TaskStat[] = []
+        let pos = 3
+        for (let i = 0; i < payload[2]; i++) {
+          const nameLen = pos < payload.length ? payload[pos] : 0
+          if (pos + 1 + nameLen + 11 > payload.length) {
+            return null
+          }
+          const name = String.fromCharCode(...payload.slice(pos + 1, pos + 1 + nameLen))
+          pos += 1 + nameLen
+          tasks.push({
+            name,
+            priority: payload[pos],
+            runs: view.getUint16(pos + 1, true),
+            avgUs: view.getUint16(pos + 3, true),
+            maxUs: view.getUint16(pos + 5, true),
+            maxLateMs: view.getUint16(pos + 7, true),
+            overruns: payload[pos + 9],
+            deferred: payload[pos + 10],
+          })
+          pos += 11
+        }
+        return { type: MSG_TASK_STATS, maxPassUs: view.getUint16(0, true), tasks }
+      }
+      break
+
+    case MSG_SMF_DATA:
+      // [offset:4][total:4][bytes...]
+      if (payload.length >= 8) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        return {
+          type: MSG_SMF_DATA,
+          offset: view.getUint32(0, true),
+          total: view.getUint32(4, true),
+          data: payload.slice(8),
+        }
+      }
+      break
+
+    case MSG_SMF_STATUS:
+      // [op:1][state:1][offset:4][notes:2][points:2][dropped:2]
+      if (payload.length >= 12) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        return {
+          type: MSG_SMF_STATUS,
+          op: payload[0],
+          state: payload[1] as SmfState,
+          offset: view.getUint32(2, true),
+          notes: view.getUint16(6, true),
+          points: view.getUint16(8, true),
+          dropped: view.getUint16(10, true),
+        }
+      }
+      break
+
+    case MSG_AUDIO_CONFIG:
+      // [rate:4][block:2][latency_us:4][state:1]
+      if (payload.length >= 11) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        return {
+          type: MSG_AUDIO_CONFIG,
+          rate: view.getUint32(0, true),
+          block: view.getUint16(4, true),
+          latencyUs: view.getUint32(6, true),
+          state: payload[10] as AudioState,
+        }
+      }
+      break
+
+    case MSG_AUDIO_BENCH:
+      // [index:1][count:1][rate:4][block:2][avg_load:2][max_load:2], loads in 0.01%
+      if (payload.length >= 12) {
+        const view = new DataView(payload.buffer, payload.byteOffset, payload.byteLength)
+        return {
+          type: MSG_AUDIO_BENCH,
+          index: payload[0],
+          count: payload[1],
+          rate: view.getUint32(2, true),
+          block: view.getUint16(6, true),
+          avgLoad: view.getUint16(8, true) / 100,
+          maxLoad: view.getUint16(10, true) / 100,
+        }
+      }
+      break
+
     case MSG_RESOURCES:
       // [mem_used:4][mem_total:4][cpu:1]
       if (payload.length >= 9) {
@@ -606,25 +1207,134 @@ function parsePayload(type: number, payload: Uint8Array): ParsedMessage | null {
   return null
 }
 
+/**
+ * Split a MIDI_BATCH payload into MIDI_IN messages (3 bytes per event)
+ */
+export function parseMidiBatch(payload: Uint8Array): MidiInMessage[] {
+  const events: MidiInMessage[] = []
+  for (let i = 0; i + 3 <= payload.length; i += 3) {
+    events.push({
+      type: MSG_MIDI_IN,
+      status: payload[i],
+      data1: payload[i + 1],
+      data2: payload[i + 2],
+    })
+  }
+  return events
+}
+
+/**
+ * Decode a complete bulk pattern stream in one pass
+ * Returns events per track (index = track id), or null if malformed.
+ */
+export function decodePatternStream(data: Uint8Array): PatternEvent[][] | null {
+  let pos = 0
+  const varint = (): number => {
+    let value = 0
+    let shift = 0
+    while (pos < data.length) {
+      const b = data[pos++]
+      value += (b & 0x7f) * 2 ** shift
+      if ((b & 0x80) === 0) return value
+      shift += 7
+    }
+    throw new RangeError('truncated varint')
+  }
+
+  try {
+    if (data.length < 2 || data[0] !== BULK_STREAM_VERSION) return null
+    const trackCount = data[1]
+    pos = 2
+    const tracks: PatternEvent[][] = []
+    for (let t = 0; t < trackCount; t++) {
+      const trackId = data[pos++]
+      const count = varint()
+      const events: PatternEvent[] = new Array(count)
+      let tick = 0
+      for (let i = 0; i < count; i++) {
+        tick += varint()
+        if (pos + 3 > data.length) return null
+        events[i] = { tick, status: data[pos], data1: data[pos + 1], data2: data[pos + 2] }
+        pos += 3
+      }
+      tracks[trackId] = events
+    }
+    return tracks
+  } catch {
+    return null
+  }
+}
+
+/**
+ * Reassembles MSG_PATTERN_BULK chunks into a stream
+ */
+export class PatternBulkDecoder {
+  private chunks: Uint8Array[] = []
+  private size = 0
+  private nextSeq = -1
+
+  /**
+   * Add a chunk; returns decoded tracks when the stream completes
+   */
+  push(msg: PatternBulkMessage): PatternEvent[][] | null {
+    if (msg.first) {
+      this.chunks = []
+      this.size = 0
+    } else if (msg.seq !== this.nextSeq) {
+      // Lost a chunk (or joined mid-stream): drop it, wait for the next sync
+      this.chunks = []
+      this.size = 0
+      this.nextSeq = -1
+      return null
+    }
+    this.nextSeq = (msg.seq + 1) & 0xff
+    this.chunks.push(msg.data)
+    this.size += msg.data.length
+    if (!msg.last) return null
+
+    const stream = new Uint8Array(this.size)
+    let offset = 0
+    for (const c of this.chunks) {
+      stream.set(c, offset)
+      offset += c.length
+    }
+    this.chunks = []
+    this.size = 0
+    this.nextSeq = -1
+    return decodePatternStream(stream)
+  }
+}
+
 /**
  * Streaming protocol parser
+ *
+ * Accepts both the plain (XOR) and the framed (CRC-16, sequenced) format.
+ * Framed messages go to onFrame when set, so a LinkReceiver can put them
+ * back in order before they are dispatched.
  */
 export class ProtocolParser {
   private state: ParserState = ParserState.WAIT_SYNC
   private type: number = 0
+  private framed: boolean = false
+  private seq: number = 0
   private payloadLen: number = 0
   private payloadIdx: number = 0
   private payload: Uint8Array = new Uint8Array(MAX_PAYLOAD)
   private runningChecksum: number = 0
+  private runningCrc: number = 0xffff
+  private crcLo: number = 0
   private onMessage: (msg: ParsedMessage) => void
-  private onChecksumError: (() => void) | null = null
+  private onChecksumError: ((framed: boolean) => void) | null = null
+  private onFrame: ((seq: number, type: number, payload: Uint8Array) => void) | null = null
 
   constructor(
     onMessage: (msg: ParsedMessage) => void,
-    onChecksumError?: () => void
+    onChecksumError?: (framed: boolean) => void,
+    onFrame?: (seq: number, type: number, payload: Uint8Array) => void
   ) {
     this.onMessage = onMessage
     this.onChecksumError = onChecksumError ?? null
+    this.onFrame = onFrame ?? null
   }
 
   /**
@@ -633,9 +1343,11 @@ export class ProtocolParser {
   reset(): void {
     this.state = ParserState.WAIT_SYNC
     this.type = 0
+    this.framed = false
     this.payloadLen = 0
     this.payloadIdx = 0
     this.runningChecksum = 0
+    this.runningCrc = 0xffff
   }
 
   /**
@@ -647,21 +1359,49 @@ export class ProtocolParser {
     }
   }
 
+  /**
+   * Parse and deliver one message payload
+   */
+  dispatch(type: number, payload: Uint8Array): void {
+    if (type === MSG_MIDI_BATCH) {
+      // Expand into individual MIDI_IN messages
+      for (const msg of parseMidiBatch(payload)) {
+        this.onMessage(msg)
+      }
+    } else {
+      const msg = parsePayload(type, payload)
+      if (msg) {
+        this.onMessage(msg)
+      }
+    }
+  }
+
   /**
    * Feed a single byte to the parser
    */
   private feedByte(byte: number): void {
+    if (this.state !== ParserState.WAIT_SYNC && this.state < ParserState.WAIT_CHECKSUM) {
+      this.runningCrc = crc16Update(this.runningCrc, byte)
+    }
+
     switch (this.state) {
       case ParserState.WAIT_SYNC:
-        if (byte === SYNC_BYTE) {
+        if (byte === SYNC_BYTE || byte === SYNC_FRAMED) {
           this.state = ParserState.WAIT_TYPE
+          this.framed = byte === SYNC_FRAMED
           this.runningChecksum = 0
+          this.runningCrc = 0xffff
         }
         break
 
       case ParserState.WAIT_TYPE:
         this.type = byte
         this.runningChecksum ^= byte
+        this.state = this.framed ? ParserState.WAIT_SEQ : ParserState.WAIT_LEN_LO
+        break
+
+      case ParserState.WAIT_SEQ:
+        this.seq = byte
         this.state = ParserState.WAIT_LEN_LO
         break
 
@@ -680,7 +1420,7 @@ export class ProtocolParser {
           // Invalid length, reset
           this.reset()
         } else if (this.payloadLen === 0) {
-          this.state = ParserState.WAIT_CHECKSUM
+          this.state = this.endState()
         } else {
           this.state = ParserState.WAIT_PAYLOAD
         }
@@ -691,26 +1431,45 @@ export class ProtocolParser {
         this.runningChecksum ^= byte
 
         if (this.payloadIdx >= this.payloadLen) {
-          this.state = ParserState.WAIT_CHECKSUM
+          this.state = this.endState()
         }
         break
 
       case ParserState.WAIT_CHECKSUM:
         if (byte === this.runningChecksum) {
           // Valid message - parse and dispatch
+          this.dispatch(this.type, this.payload.slice(0, this.payloadLen))
+        } else {
+          // Checksum mismatch
+          this.onChecksumError?.(false)
+        }
+        this.reset()
+        break
+
+      case ParserState.WAIT_CRC_LO:
+        this.crcLo = byte
+        this.state = ParserState.WAIT_CRC_HI
+        break
+
+      case ParserState.WAIT_CRC_HI:
+        if ((this.crcLo | (byte << 8)) === this.runningCrc) {
           const payloadSlice = this.payload.slice(0, this.payloadLen)
-          const msg = parsePayload(this.type, payloadSlice)
-          if (msg) {
-            this.onMessage(msg)
+          if (this.onFrame) {
+            this.onFrame(this.seq, this.type, payloadSlice)
+          } else {
+            this.dispatch(this.type, payloadSlice)
           }
         } else {
-          // Checksum mismatch
-          this.onChecksumError?.()
+          this.onChecksumError?.(true)
         }
         this.reset()
         break
     }
   }
+
+  private endState(): ParserState {
+    return this.framed ? ParserState.WAIT_CRC_LO : ParserState.WAIT_CHECKSUM
+  }
 }
 
 /**
@@ -726,6 +1485,8 @@ export function getMessageTypeName(type: number): string {
       return 'VOICES'
     case MSG_MIDI_IN:
       return 'MIDI_IN'
+    case MSG_MIDI_BATCH:
+      return 'MIDI_BATCH'
     case MSG_CC_STATE:
       return 'CC_STATE'
     case MSG_SYNTH_STATE:
@@ -744,6 +1505,28 @@ export function getMessageTypeName(type: number): string {
       return 'PATTERN_CLEAR'
     case MSG_RESOURCES:
       return 'RESOURCES'
+    case MSG_PATTERN_BULK:
+      return 'PATTERN_BULK'
+    case MSG_STATE_DELTA:
+      return 'STATE_DELTA'
+    case MSG_LINK_GAP:
+      return 'LINK_GAP'
+    case MSG_CLOCK_SYNC:
+      return 'CLOCK_SYNC'
+    case MSG_TELEMETRY:
+      return 'TELEMETRY'
+    case MSG_VOICE_DIAG:
+      return 'VOICE_DIAG'
+    case MSG_TASK_STATS:
+      return 'TASK_STATS'
+    case MSG_SMF_DATA:
+      return 'SMF_DATA'
+    case MSG_SMF_STATUS:
+      return 'SMF_STATUS'
+    case MSG_AUDIO_CONFIG:
+      return 'AUDIO_CONFIG'
+    case MSG_AUDIO_BENCH:
+      return 'AUDIO_BENCH'
     case MSG_DEBUG:
       return 'DEBUG'
     default:
@@ -0,0 +1,180 @@
+/**
+ * MIDI file import/export over the serial link (see smf.h)
+ *
+ * Import sends the file SMF_CHUNK_SIZE bytes at a time; the firmware answers
+ * each chunk with MSG_SMF_STATUS once it has room for the next, so only one
+ * is ever in flight. Export pulls the file the same way, one CMD_SMF_EXPORT
+ * per MSG_SMF_DATA. A request with no answer within RETRY_MS is repeated:
+ * a repeated import chunk gets SEQUENCE with the offset the firmware wants,
+ * a repeated export request gets the same chunk again.
+ */
+
+import {
+  SmfDataMessage,
+  SmfStatusMessage,
+  SmfState,
+  SMF_CHUNK_SIZE,
+  SMF_OP_IMPORT,
+  SMF_OP_EXPORT,
+  buildSmfImportCommand,
+  buildSmfExportCommand,
+} from './protocol'
+
+const RETRY_MS = 1000
+const BUSY_RETRY_MS = 100
+const MAX_RETRIES = 5
+
+export type SmfTransferState =
+  | { kind: 'idle' }
+  | { kind: 'importing' | 'exporting'; done: number; total: number }
+  | { kind: 'imported'; notes: number; points: number; dropped: number }
+  | { kind: 'exported'; file: Uint8Array }
+  | { kind: 'error'; message: string }
+
+export class SmfTransfer {
+  private op = 0
+  private file = new Uint8Array(0)
+  private offset = 0
+  private timer: ReturnType<typeof setTimeout> | null = null
+  private retries = 0
+
+  constructor(
+    private send: (msg: Uint8Array) => void,
+    private onChange: (state: SmfTransferState) => void
+  ) {}
+
+  get busy(): boolean {
+    return this.op !== 0
+  }
+
+  startImport(file: Uint8Array): void {
+    this.begin(SMF_OP_IMPORT, file)
+    this.request()
+  }
+
+  startExport(): void {
+    this.begin(SMF_OP_EXPORT, new Uint8Array(0))
+    this.request()
+  }
+
+  cancel(): void {
+    this.finish({ kind: 'idle' })
+  }
+
+  handleStatus(msg: SmfStatusMessage): void {
+    if (msg.op !== this.op) {
+      return
+    }
+    switch (msg.state) {
+      case SmfState.OK:
+      case SmfState.SEQUENCE:
+        // Continue (or restart) wherever the firmware says
+        this.offset = msg.offset
+        this.request()
+        break
+      case SmfState.DONE:
+        if (this.op === SMF_OP_IMPORT) {
+          this.finish({ kind: 'imported', notes: msg.notes, points: msg.points, dropped: msg.dropped })
+        }
+        break  // Export completes with its last MSG_SMF_DATA
+      case SmfState.BUSY:
+        if (this.op === SMF_OP_EXPORT) {
+          this.finish({ kind: 'error', message: 'Stop recording to export' })
+        } else {
+          this.arm(BUSY_RETRY_MS)
+        }
+        break
+      case SmfState.FORMAT:
+        this.finish({ kind: 'error', message: 'Not a type 0/1 MIDI file' })
+        break
+    }
+  }
+
+  handleData(msg: SmfDataMessage): void {
+    if (this.op !== SMF_OP_EXPORT || msg.offset !== this.offset) {
+      return
+    }
+    if (msg.offset === 0) {
+      this.file = new Uint8Array(msg.total)
+    }
+    if (msg.total !== this.file.length || (msg.data.length === 0 && this.offset < msg.total)) {
+      this.finish({ kind: 'error', message: 'Export interrupted, try again' })
+      return
+    }
+    this.file.set(msg.data, msg.offset)
+    this.offset += msg.data.length
+    if (this.offset >= this.file.length) {
+      this.finish({ kind: 'exported', file: this.file })
+    } else {
+      this.request()
+    }
+  }
+
+  private begin(op: number, file: Uint8Array): void {
+    this.clearTimer()
+    this.op = op
+    this.file = file
+    this.offset = 0
+  }
+
+  // Send the chunk / request for the current offset and wait for the answer
+  private request(): void {
+    if (!this.op) {
+      return
+    }
+    this.retries = 0
+    this.transmit()
+    this.onChange({
+      kind: this.op === SMF_OP_IMPORT ? 'importing' : 'exporting',
+      done: this.offset,
+      total: this.file.length,
+    })
+  }
+
+  private transmit(): void {
+    if (this.op === SMF_OP_IMPORT) {
+      const end = Math.min(this.offset + SMF_CHUNK_SIZE, this.file.length)
+      this.send(buildSmfImportCommand(this.offset, this.file.length, this.file.subarray(this.offset, end)))
+    } else {
+      this.send(buildSmfExportCommand(this.offset))
+    }
+    this.arm(RETRY_MS)
+  }
+
+  private arm(ms: number): void {
+    this.clearTimer()
+    this.timer = setTimeout(() => {
+      this.timer = null
+      if (++this.retries > MAX_RETRIES) {
+        this.finish({ kind: 'error', message: 'No answer from the device' })
+      } else {
+        this.transmit()
+      }
+    }, ms)
+  }
+
+  private clearTimer(): void {
+    if (this.timer !== null) {
+      clearTimeout(this.timer)
+      this.timer = null
+    }
+  }
+
+  private finish(state: SmfTransferState): void {
+    this.clearTimer()
+    this.op = 0
+    this.onChange(state)
+  }
+}
+
+/**
+ * Save an exported file through the browser's download
+ */
+export function downloadMidiFile(file: Uint8Array, name = 'groovydaisy.mid'): void {
+  const url = URL.createObjectURL(new Blob([file], { type: 'audio/midi' }))
+  const a = document.createElement('a')
+  a.href = url
+  a.download = name
+  a.click()
+  URL.revokeObjectURL(url)
+}
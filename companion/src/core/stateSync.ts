@@ -0,0 +1,224 @@
+/**
+ * Mirror of the firmware's delta-synced state table (see state_sync.h)
+ *
+ * MSG_STATE_DELTA carries (field, value) pairs. The mirror applies them to
+ * its copy of the table, tells the caller which version to acknowledge, and
+ * turns the touched field groups back into the per-area messages the UI
+ * already handles (TRANSPORT, VOICES, SYNTH_STATE, ...).
+ */
+
+import {
+  MSG_TRANSPORT,
+  MSG_VOICES,
+  MSG_CC_BANK,
+  MSG_FADER_STATE,
+  MSG_MIXER_STATE,
+  MSG_SYNTH_STATE,
+  MSG_TRACK_STATE,
+  ParsedMessage,
+  StateDeltaMessage,
+  SynthParams,
+  ModParams,
+  NUM_MOD_SLOTS,
+  TrackStatus,
+} from './protocol'
+
+// Field layout - must match state_sync.h
+const TRANSPORT_PLAYING = 0
+const TRANSPORT_RECORDING = 1
+const TRANSPORT_BPM = 2
+const VOICES_SYNTH = 3
+const VOICES_DRUMS = 4
+const CC_BANK = 5
+const FADER_FIRST = 6
+const NUM_FADER_FIELDS = 9
+const MIXER_FIRST = FADER_FIRST + NUM_FADER_FIELDS
+const NUM_MIXER_FIELDS = 21
+const SYNTH_FIRST = MIXER_FIRST + NUM_MIXER_FIELDS
+const NUM_SYNTH_FIELDS = 19
+const SYNTH_PRESET = SYNTH_FIRST + NUM_SYNTH_FIELDS
+const TRACK_FIRST = SYNTH_PRESET + 1
+const NUM_TRACK_FIELDS = 8
+const MOD_FIRST = TRACK_FIRST + NUM_TRACK_FIELDS
+const NUM_MOD_FIELDS = 11
+const FIELD_COUNT = MOD_FIRST + NUM_MOD_FIELDS
+
+// Field groups, one per synthesized message
+enum Group {
+  TRANSPORT,
+  VOICES,
+  BANK,
+  FADERS,
+  MIXER,
+  SYNTH,
+  TRACKS,
+}
+
+function groupOf(field: number): Group {
+  if (field <= TRANSPORT_BPM) return Group.TRANSPORT
+  if (field <= VOICES_DRUMS) return Group.VOICES
+  if (field === CC_BANK) return Group.BANK
+  if (field < MIXER_FIRST) return Group.FADERS
+  if (field < SYNTH_FIRST) return Group.MIXER
+  if (field <= SYNTH_PRESET) return Group.SYNTH
+  if (field < MOD_FIRST) return Group.TRACKS
+  return Group.SYNTH
+}
+
+export interface StateDeltaResult {
+  ack: number | null          // Version to acknowledge (null = nothing to ack yet)
+  messages: ParsedMessage[]   // Per-area messages for the groups that changed
+}
+
+export class StateMirror {
+  private values = new Uint32Array(FIELD_COUNT)
+  private floatView = new DataView(new ArrayBuffer(4))
+  private version = 0
+  private synced = false
+  private touched = new Set<Group>()
+
+  /**
+   * Forget everything (new connection); deltas are ignored until a snapshot
+   */
+  reset(): void {
+    this.values.fill(0)
+    this.version = 0
+    this.synced = false
+    this.touched.clear()
+  }
+
+  apply(msg: StateDeltaMessage): StateDeltaResult {
+    if (msg.snapshot) {
+      this.synced = true
+    } else if (!this.synced || this.isNewer(msg.base, this.version)) {
+      // No snapshot yet, or relative to a version we never saw
+      return { ack: null, messages: [] }
+    }
+
+    for (const { field, value } of msg.entries) {
+      if (field < FIELD_COUNT) {
+        this.values[field] = value
+        this.touched.add(groupOf(field))
+      }
+    }
+
+    // A change-set split over several messages is acknowledged once
+    if (msg.more) {
+      return { ack: null, messages: [] }
+    }
+    this.version = msg.version
+    const messages = this.buildMessages()
+    this.touched.clear()
+    return { ack: msg.version, messages }
+  }
+
+  private isNewer(a: number, b: number): boolean {
+    return ((a - b) & 0xffff) !== 0 && ((a - b) & 0xffff) < 0x8000
+  }
+
+  private float(field: number): number {
+    this.floatView.setUint32(0, this.values[field], true)
+    return this.floatView.getFloat32(0, true)
+  }
+
+  // ParamId order from LFO1_RATE (synth.h)
+  private modParams(): ModParams {
+    const f = (i: number) => this.float(MOD_FIRST + i)
+    const routes = []
+    const amounts = []
+    for (let i = 0; i < NUM_MOD_SLOTS; i++) {
+      routes.push(Math.round(f(5 + i * 2)))
+      amounts.push(f(6 + i * 2))
+    }
+    return {
+      lfo1Rate: f(0),
+      lfo1Wave: Math.round(f(1)),
+      lfo2Rate: f(2),
+      lfo2Wave: Math.round(f(3)),
+      lfoDepth: f(4),
+      routes,
+      amounts,
+    }
+  }
+
+  private buildMessages(): ParsedMessage[] {
+    const v = this.values
+    const out: ParsedMessage[] = []
+
+    if (this.touched.has(Group.TRANSPORT)) {
+      out.push({
+        type: MSG_TRANSPORT,
+        playing: v[TRANSPORT_PLAYING] !== 0,
+        recording: v[TRANSPORT_RECORDING] !== 0,
+        bpm: v[TRANSPORT_BPM],
+      })
+    }
+    if (this.touched.has(Group.VOICES)) {
+      out.push({ type: MSG_VOICES, synth: v[VOICES_SYNTH], drums: v[VOICES_DRUMS] })
+    }
+    if (this.touched.has(Group.BANK)) {
+      out.push({ type: MSG_CC_BANK, bank: v[CC_BANK] })
+    }
+    if (this.touched.has(Group.FADERS)) {
+      const states = []
+      for (let i = 0; i < NUM_FADER_FIELDS; i++) {
+        const bits = v[FADER_FIRST + i]
+        states.push({ pickedUp: (bits & 0x01) !== 0, needsPickup: (bits & 0x02) !== 0 })
+      }
+      out.push({ type: MSG_FADER_STATE, states })
+    }
+    if (this.touched.has(Group.MIXER)) {
+      const m = Array.from(v.slice(MIXER_FIRST, MIXER_FIRST + NUM_MIXER_FIELDS))
+      out.push({
+        type: MSG_MIXER_STATE,
+        drumLevels: m.slice(0, 8),
+        drumPans: m.slice(8, 16),
+        drumMaster: m[16],
+        synthLevel: m[17],
+        synthPan: m[18],
+        synthMaster: m[19],
+        masterOut: m[20],
+      })
+    }
+    if (this.touched.has(Group.SYNTH)) {
+      // ParamId order (synth.h)
+      const f = (i: number) => this.float(SYNTH_FIRST + i)
+      const params: SynthParams = {
+        osc1Wave: Math.round(f(0)),
+        osc2Wave: Math.round(f(1)),
+        osc1Level: f(2),
+        osc2Level: f(3),
+        osc2Detune: Math.round(f(4)),
+        filterCutoff: f(5),
+        filterRes: f(6),
+        filterEnvAmt: f(7),
+        ampAttack: f(8),
+        ampDecay: f(9),
+        ampSustain: f(10),
+        ampRelease: f(11),
+        filtAttack: f(12),
+        filtDecay: f(13),
+        filtSustain: f(14),
+        filtRelease: f(15),
+        velToAmp: f(16),
+        velToFilter: f(17),
+        level: f(18),
+        mod: this.modParams(),
+      }
+      out.push({ type: MSG_SYNTH_STATE, params, presetIndex: v[SYNTH_PRESET] })
+    }
+    if (this.touched.has(Group.TRACKS)) {
+      const tracks = []
+      for (let i = 0; i < NUM_TRACK_FIELDS / 2; i++) {
+        tracks.push({
+          id: i + 8,  // Synth tracks are 8-11
+          status: v[TRACK_FIRST + i * 2] as TrackStatus,
+          frozenSlot: v[TRACK_FIRST + i * 2 + 1],
+          sourceTrack: i,
+        })
+      }
+      out.push({ type: MSG_TRACK_STATE, tracks })
+    }
+    return out
+  }
+}
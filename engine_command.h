@@ -0,0 +1,148 @@
+#pragma once
+#ifndef GROOVYDAISY_ENGINE_COMMAND_H
+#define GROOVYDAISY_ENGINE_COMMAND_H
+
+#include <stdint.h>
+#include "spsc_queue.h"
+
+/**
+ * GroovyDaisy Engine Commands
+ *
+ * Every engine mutation requested by the main loop (USB commands, Pod
+ * buttons, encoder) is queued as a Command and applied by the audio
+ * callback at block start, so the engines never change mid-block.
+ *
+ * Work is metered in units (roughly one cheap state change each). The
+ * executor spends at most BLOCK_BUDGET units per block; anything left waits
+ * for the next block. Large operations are split into steps - the command
+ * stays at the head of the queue and its handler is called again with the
+ * next step number until it reports completion.
+ */
+
+namespace EngineCommand
+{
+
+// Queue capacity (power of two)
+constexpr uint32_t QUEUE_SIZE = 32;
+
+// Work units the audio callback may spend on commands per block
+constexpr uint32_t BLOCK_BUDGET = 8;
+
+enum class Type : uint8_t
+{
+    PLAY,             // Start playback (captures automation base values)
+    STOP,             // Stop, release notes, rewind playback (arg 1 = also frozen playheads)
+    RESET_AND_CLEAR,  // Stop at zero and clear all tracks and automation (chunked)
+    TOGGLE_RECORD,    // Toggle record (starts a new record pass when entering)
+    SET_BPM,          // value = BPM
+    ADJUST_BPM,       // value = BPM delta
+    SET_OVERDUB,      // arg = 1 overdub, 0 replace
+    SYNTH_PARAM,      // arg = Synth::ParamId, value = parameter value
+    LOAD_PRESET,      // arg = preset index, value = morph time in ms (0 = swap)
+    SET_BANK,         // arg = CCMap::Bank
+    FREEZE_TRACK,     // arg = synth track (0-3)
+    UNFREEZE_TRACK,   // arg = synth track (0-3)
+    TELEMETRY,        // arg = 1 enable / 0 disable, value = decimation factor
+    LOAD_SESSION,     // Stop and apply the stored session, a bounded part of a chunk per step
+};
+
+struct Command
+{
+    Type    type;
+    uint8_t arg;
+    float   value;
+};
+
+/**
+ * Work units for one step of a command
+ */
+inline uint8_t StepCost(Type type)
+{
+    switch(type)
+    {
+        case Type::LOAD_PRESET: return 2;  // Copies a full parameter set
+        case Type::STOP: return 2;         // Releases all voices
+        case Type::LOAD_SESSION: return 2; // Up to Session::LOAD_STEP_EVENTS events from flash
+        default: return 1;
+    }
+}
+
+using Queue = Spsc::Queue<Command, QUEUE_SIZE>;
+
+/**
+ * Handler for one step of a command (audio callback context)
+ * Returns true when the command is complete.
+ */
+typedef bool (*ApplyFn)(const Command& cmd, uint16_t step);
+
+/**
+ * Drains the command queue at block start within the per-block budget
+ */
+class Executor
+{
+  public:
+    void Init(ApplyFn apply)
+    {
+        apply_          = apply;
+        step_           = 0;
+        max_units_      = 0;
+        deferred_count_ = 0;
+    }
+
+    /**
+     * Apply queued commands until the queue is empty or the budget is spent
+     * Returns the work units spent this block.
+     */
+    uint32_t Run(Queue& queue)
+    {
+        uint32_t spent = 0;
+        Command  cmd;
+        while(queue.Peek(cmd))
+        {
+            uint8_t cost = StepCost(cmd.type);
+            if(spent + cost > BLOCK_BUDGET && spent > 0)
+            {
+                deferred_count_++;  // Continue next block
+                break;
+            }
+            spent += cost;
+
+            if(apply_(cmd, step_))
+            {
+                queue.Drop();
+                step_ = 0;
+            }
+            else
+            {
+                step_++;
+            }
+        }
+
+        if(spent > max_units_)
+        {
+            max_units_ = spent;
+        }
+        return spent;
+    }
+
+    /**
+     * Most work units spent in one block (reset by the reader)
+     */
+    uint32_t GetMaxUnits() const { return max_units_; }
+    void     ResetMaxUnits() { max_units_ = 0; }
+
+    /**
+     * Blocks that ended with commands still waiting
+     */
+    uint32_t GetDeferredCount() const { return deferred_count_; }
+
+  private:
+    ApplyFn           apply_;
+    uint16_t          step_;  // Next step of the command at the queue head
+    volatile uint32_t max_units_;
+    volatile uint32_t deferred_count_;
+};
+
+} // namespace EngineCommand
+
+#endif // GROOVYDAISY_ENGINE_COMMAND_H
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef GROOVYDAISY_MEMORY_MAP_H
+#define GROOVYDAISY_MEMORY_MAP_H
+
+#include <stddef.h>
+
+/**
+ * GroovyDaisy Memory Placement
+ *
+ * The STM32H750 has three RAM regions we care about, fastest first:
+ *
+ * - DTCM (128 KB @ 0x20000000): zero-wait-state, CPU-only (not reachable by
+ *   DMA), never cached so never misses. The main stack also lives at the top.
+ *   Use for state touched every sample: voices, transport, mix state.
+ * - AXI SRAM (512 KB @ 0x24000000): cached internal RAM. This is where the
+ *   default .bss lands with the flash linker script. Use for bulk engine
+ *   storage touched per tick or per event: sequencer events, automation.
+ * - SDRAM (64 MB @ 0xC0000000): external, cached but slow on a miss. Only
+ *   cold or very large audio belongs here: sample data and frozen tracks.
+ *
+ * Placement macros are applied at the global definitions in GroovyDaisy.cpp.
+ * `make memory-report` lists where each object actually landed.
+ */
+
+// libDaisy provides these in daisy_core.h; fall back to plain storage on host builds
+#ifndef DTCM_MEM_SECTION
+#define DTCM_MEM_SECTION
+#endif
+#ifndef DSY_SDRAM_BSS
+#define DSY_SDRAM_BSS
+#endif
+
+// Per-sample state (voices, transport, mixer) -> DTCM
+#define HOT_STATE_DTCM DTCM_MEM_SECTION
+
+// Bulk event/automation storage -> AXI SRAM (default .bss in the flash linker script)
+#define BULK_STATE_AXI
+
+// Cold or large audio buffers -> SDRAM
+#define COLD_AUDIO_SDRAM DSY_SDRAM_BSS
+
+namespace MemoryMap
+{
+
+// Region sizes (bytes)
+constexpr size_t DTCM_SIZE     = 128 * 1024;
+constexpr size_t AXI_SRAM_SIZE = 512 * 1024;
+constexpr size_t SDRAM_SIZE    = 64 * 1024 * 1024;
+
+// Budget for hot state in DTCM - the remainder is left for the main stack
+constexpr size_t DTCM_HOT_BUDGET = 64 * 1024;
+
+// Budget for bulk engine state in AXI SRAM - the remainder is code-adjacent
+// data, libDaisy internals and USB/protocol buffers
+constexpr size_t AXI_BULK_BUDGET = 256 * 1024;
+
+} // namespace MemoryMap
+
+#endif // GROOVYDAISY_MEMORY_MAP_H
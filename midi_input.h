@@ -0,0 +1,238 @@
+#pragma once
+#ifndef GROOVYDAISY_MIDI_INPUT_H
+#define GROOVYDAISY_MIDI_INPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "spsc_queue.h"
+
+/**
+ * GroovyDaisy Timestamped MIDI Input
+ *
+ * Live UART MIDI is parsed byte-by-byte in the UART receive interrupt and
+ * pushed into a lock-free queue, stamped with the audio sample clock.
+ * The audio callback pops everything that arrived during the previous block
+ * and applies each event at its own sample offset in the current block.
+ *
+ * Input-to-sound latency is therefore one audio block plus UART transfer
+ * time, with no jitter, and does not depend on what the main loop is doing.
+ */
+
+namespace MidiInput
+{
+
+// Queue capacity (power of two). 31250 baud delivers at most ~1000
+// three-byte messages per second, so this covers several blocks of backlog.
+constexpr uint32_t QUEUE_SIZE = 128;
+
+// Maximum events applied in one audio block (rest wait for the next block)
+constexpr size_t MAX_EVENTS_PER_BLOCK = 32;
+
+/**
+ * Channel message with audio sample timestamp
+ */
+struct TimedEvent
+{
+    uint32_t sample_time;  // Audio sample clock when the last byte arrived
+    uint8_t  status;       // Status byte including channel
+    uint8_t  data1;
+    uint8_t  data2;
+};
+
+/**
+ * Byte-level MIDI parser with running status
+ *
+ * Only channel voice messages are produced. System real-time bytes are
+ * ignored without disturbing a message in progress; SysEx and system
+ * common messages are skipped.
+ */
+struct Parser
+{
+    uint8_t running_status;
+    uint8_t data[2];
+    uint8_t data_count;
+    bool    in_sysex;
+
+    void Reset()
+    {
+        running_status = 0;
+        data_count     = 0;
+        in_sysex       = false;
+    }
+
+    /**
+     * Number of data bytes that follow a channel status byte
+     */
+    static uint8_t DataLength(uint8_t status)
+    {
+        uint8_t type = status & 0xF0;
+        return (type == 0xC0 || type == 0xD0) ? 1 : 2;
+    }
+
+    /**
+     * Feed a byte
+     * Returns true when a complete channel message is in status/data1/data2
+     */
+    bool Feed(uint8_t byte, uint8_t& status, uint8_t& data1, uint8_t& data2)
+    {
+        // Real-time messages (clock, start, stop...) may appear anywhere
+        if(byte >= 0xF8)
+            return false;
+
+        if(byte & 0x80)
+        {
+            if(byte == 0xF0)
+            {
+                in_sysex       = true;
+                running_status = 0;
+            }
+            else if(byte >= 0xF0)
+            {
+                // System common (and SysEx end) cancel running status
+                in_sysex       = false;
+                running_status = 0;
+            }
+            else
+            {
+                in_sysex       = false;
+                running_status = byte;
+            }
+            data_count = 0;
+            return false;
+        }
+
+        // Data byte
+        if(in_sysex || running_status == 0)
+            return false;
+
+        data[data_count++] = byte;
+        if(data_count < DataLength(running_status))
+            return false;
+
+        status     = running_status;
+        data1      = data[0];
+        data2      = data_count > 1 ? data[1] : 0;
+        data_count = 0;
+        return true;
+    }
+};
+
+/**
+ * UART ISR (producer) -> audio callback (consumer)
+ */
+using EventQueue = Spsc::Queue<TimedEvent, QUEUE_SIZE>;
+
+/**
+ * Audio sample clock shared between the audio callback and the UART ISR
+ *
+ * The audio callback publishes the sample index and timer tick of each
+ * block start. The ISR converts "now" into a sample index by adding the
+ * elapsed time since that block started.
+ *
+ * The ISR can interrupt the callback at any point, so it must never wait
+ * for it. Each block's anchor is written into the slot the ISR is not
+ * reading and then published with a single index store; the ISR always
+ * sees a complete anchor, either the new one or the previous one. A slot
+ * is reused only one block later, long after any stamp that read it.
+ */
+class SampleClock
+{
+  public:
+    /**
+     * @param sample_rate Audio sample rate
+     * @param tick_freq   Frequency of the tick source passed to BeginBlock/Stamp
+     */
+    void Init(float sample_rate, uint32_t tick_freq)
+    {
+        samples_per_tick_ = sample_rate / static_cast<float>(tick_freq);
+        for(uint8_t i = 0; i < 2; i++)
+        {
+            anchors_[i].start = 0;
+            anchors_[i].tick  = 0;
+            anchors_[i].size  = 0;
+        }
+        next_start_ = 0;
+        current_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Follow a sample rate change (audio stopped; the ISR may still stamp)
+     * The sample count carries on, so queued events stay in order.
+     */
+    void SetSampleRate(float sample_rate, uint32_t tick_freq)
+    {
+        samples_per_tick_ = sample_rate / static_cast<float>(tick_freq);
+    }
+
+    /**
+     * Audio callback, at block start
+     * Returns the start of the previous block: events stamped from there up
+     * to (but not including) the new block start are due in this block, at
+     * offset stamp - returned value.
+     */
+    uint32_t BeginBlock(size_t size, uint32_t now_tick)
+    {
+        uint8_t  index        = current_.load(std::memory_order_relaxed);
+        uint32_t window_start = anchors_[index].start;
+
+        // Fill the idle slot, then publish it in one store
+        index ^= 1;
+        anchors_[index].start = next_start_;
+        anchors_[index].tick  = now_tick;
+        anchors_[index].size  = static_cast<uint32_t>(size);
+        current_.store(index, std::memory_order_release);
+
+        next_start_ += static_cast<uint32_t>(size);
+        return window_start;
+    }
+
+    /**
+     * First sample of the block currently being rendered
+     * (events stamped before this are due)
+     */
+    uint32_t GetBlockStart() const
+    {
+        return anchors_[current_.load(std::memory_order_relaxed)].start;
+    }
+
+    /**
+     * UART ISR: convert the current tick into an audio sample index
+     */
+    uint32_t Stamp(uint32_t now_tick) const
+    {
+        const Anchor& anchor = anchors_[current_.load(std::memory_order_acquire)];
+
+        uint32_t elapsed = static_cast<uint32_t>((now_tick - anchor.tick) * samples_per_tick_);
+        if(anchor.size > 0 && elapsed >= anchor.size)
+        {
+            elapsed = anchor.size - 1;  // Callback is late; keep the event in this window
+        }
+        return anchor.start + elapsed;
+    }
+
+  private:
+    struct Anchor
+    {
+        uint32_t start;  // Sample index of the block start
+        uint32_t tick;   // Timer tick at the block start
+        uint32_t size;   // Block size in samples
+    };
+
+    float                samples_per_tick_;
+    Anchor               anchors_[2];
+    uint32_t             next_start_;
+    std::atomic<uint8_t> current_;  // Slot of the published anchor
+};
+
+/**
+ * Wrap-safe "a is before b" for 32-bit sample clocks
+ */
+inline bool IsBefore(uint32_t a, uint32_t b)
+{
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+} // namespace MidiInput
+
+#endif // GROOVYDAISY_MIDI_INPUT_H
@@ -14,11 +14,19 @@
  * - Live MIDI and sequencer playback go through the same path
  * - All events can be forwarded to companion app (MIDI Monitor)
  * - Easy to add MIDI output for external gear later
+ *
+ * Routing is table-driven: each of the 16 channels has a Route (engine,
+ * instance, note range, transpose). Compile() resolves the table into a
+ * dispatch array holding engine pointers, so routing an event is a single
+ * indexed lookup. Several synth instances can sit on different channels.
  */
 
 namespace MidiRouter
 {
 
+constexpr uint8_t NUM_CHANNELS = 16;
+constexpr uint8_t MAX_SYNTHS   = 4;   // Synth instances that can be registered
+
 // Event source (for diagnostics/filtering)
 enum class Source : uint8_t
 {
@@ -26,6 +34,26 @@ enum class Source : uint8_t
     SEQUENCER,     // From sequencer playback
 };
 
+// Engine a channel is routed to
+enum class Target : uint8_t
+{
+    NONE,      // Ignored (still forwarded to companion / recorded)
+    SAMPLER,   // Drum sampler (pad notes 36-43 after transpose)
+    SYNTH,     // Synth instance
+};
+
+/**
+ * Per-channel routing entry
+ */
+struct Route
+{
+    Target  target;
+    uint8_t instance;   // Synth instance (0 to MAX_SYNTHS-1)
+    uint8_t note_low;   // Lowest note accepted (before transpose)
+    uint8_t note_high;  // Highest note accepted (before transpose)
+    int8_t  transpose;  // Semitones added before the engine sees the note
+};
+
 // Callback type for companion notification (SendMidiIn)
 typedef void (*MidiOutCallback)(uint8_t status, uint8_t data1, uint8_t data2);
 
@@ -35,10 +63,10 @@ typedef void (*RecordCallback)(uint32_t tick, uint8_t status, uint8_t data1, uin
 /**
  * Unified MIDI Router
  *
- * Routes MIDI events to appropriate destinations:
- * - Sampler (drum notes on channel 10)
- * - Synth (notes/CCs on channel 1)
- * - Companion app (all events for MIDI Monitor)
+ * Default table:
+ * - Channel 10 -> sampler (drum pads)
+ * - Channel 1  -> synth instance 0
+ * - Everything else -> not routed (companion/recording only)
  */
 class Router
 {
@@ -48,9 +76,77 @@ class Router
               MidiOutCallback companion_cb)
     {
         sampler_ = sampler;
-        synth_ = synth;
         companion_cb_ = companion_cb;
         record_cb_ = nullptr;
+
+        for(uint8_t i = 0; i < MAX_SYNTHS; i++)
+        {
+            synths_[i] = nullptr;
+        }
+        synths_[0] = synth;
+
+        for(uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+        {
+            table_[ch] = {Target::NONE, 0, 0, 127, 0};
+        }
+        table_[Sampler::DRUM_CHANNEL] = {Target::SAMPLER, 0, 0, 127, 0};
+        table_[Synth::SYNTH_CHANNEL]  = {Target::SYNTH, 0, 0, 127, 0};
+
+        Compile();
+    }
+
+    /**
+     * Register an additional synth instance (call Compile() afterwards)
+     */
+    void SetSynth(uint8_t instance, Synth::Engine* synth)
+    {
+        if(instance < MAX_SYNTHS)
+        {
+            synths_[instance] = synth;
+        }
+    }
+
+    /**
+     * Change a channel's route (call Compile() afterwards)
+     */
+    void SetRoute(uint8_t channel, const Route& route)
+    {
+        if(channel < NUM_CHANNELS)
+        {
+            table_[channel] = route;
+        }
+    }
+
+    const Route& GetRoute(uint8_t channel) const { return table_[channel & 0x0F]; }
+
+    /**
+     * Resolve the routing table into the dispatch array
+     * Routes to unregistered synth instances become NONE.
+     */
+    void Compile()
+    {
+        for(uint8_t ch = 0; ch < NUM_CHANNELS; ch++)
+        {
+            const Route& r = table_[ch];
+            Dispatch&    d = dispatch_[ch];
+
+            d.target    = r.target;
+            d.synth     = nullptr;
+            d.note_low  = r.note_low;
+            d.note_high = r.note_high;
+            d.transpose = r.transpose;
+
+            if(r.target == Target::SYNTH)
+            {
+                d.synth = r.instance < MAX_SYNTHS ? synths_[r.instance] : nullptr;
+                if(d.synth == nullptr)
+                    d.target = Target::NONE;
+            }
+            else if(r.target == Target::SAMPLER && sampler_ == nullptr)
+            {
+                d.target = Target::NONE;
+            }
+        }
     }
 
     /**
@@ -58,6 +154,23 @@ class Router
      */
     void SetRecordCallback(RecordCallback cb) { record_cb_ = cb; }
 
+    /**
+     * Route any channel voice message (note on/off, CC)
+     * Other message types are ignored.
+     */
+    void RouteEvent(uint8_t status, uint8_t data1, uint8_t data2,
+                    Source source, bool record = false, uint32_t tick = 0)
+    {
+        uint8_t channel = status & 0x0F;
+        switch(status & 0xF0)
+        {
+            case 0x90: RouteNoteOn(channel, data1, data2, source, record, tick); break;
+            case 0x80: RouteNoteOff(channel, data1, source, record, tick); break;
+            case 0xB0: RouteCC(channel, data1, data2, source); break;
+            default: break;
+        }
+    }
+
     /**
      * Route a Note On event
      *
@@ -74,31 +187,33 @@ class Router
         // Handle velocity 0 as note off (per MIDI spec)
         if(velocity == 0)
         {
-            RouteNoteOff(channel, note, source);
+            RouteNoteOff(channel, note, source, record, tick);
             return;
         }
 
-        // Route to sampler (drum channel)
-        if(channel == Sampler::DRUM_CHANNEL)
-        {
-            sampler_->TriggerMidi(channel, note, velocity);
-        }
-
-        // Route to synth (synth channel)
-        if(channel == Synth::SYNTH_CHANNEL)
+        const Dispatch& d = dispatch_[channel & 0x0F];
+        uint8_t         mapped;
+        if(MapNote(d, note, mapped))
         {
-            synth_->NoteOn(note, velocity);
+            if(d.target == Target::SAMPLER)
+            {
+                sampler_->TriggerNote(mapped, velocity);
+            }
+            else if(d.target == Target::SYNTH)
+            {
+                d.synth->NoteOn(mapped, velocity);
+            }
         }
 
         // Forward to companion (MIDI Monitor) - only for live input
-        // Sequencer events are queued separately to avoid audio callback USB calls
+        // Sequencer events are queued separately by the playback callback
         if(source == Source::LIVE_INPUT && companion_cb_ != nullptr)
         {
             uint8_t status = 0x90 | (channel & 0x0F);
             companion_cb_(status, note, velocity);
         }
 
-        // Record if enabled
+        // Record if enabled (untransposed, as played)
         if(record && record_cb_ != nullptr)
         {
             uint8_t status = 0x90 | (channel & 0x0F);
@@ -113,11 +228,11 @@ class Router
                       bool record = false, uint32_t tick = 0)
     {
         // Sampler doesn't need NoteOff (one-shot samples)
-
-        // Route to synth (synth channel)
-        if(channel == Synth::SYNTH_CHANNEL)
+        const Dispatch& d = dispatch_[channel & 0x0F];
+        uint8_t         mapped;
+        if(d.target == Target::SYNTH && MapNote(d, note, mapped))
         {
-            synth_->NoteOff(note);
+            d.synth->NoteOff(mapped);
         }
 
         // Forward to companion (MIDI Monitor)
@@ -127,8 +242,8 @@ class Router
             companion_cb_(status, note, 0);
         }
 
-        // Record NoteOff for synth (needed for proper playback)
-        if(record && record_cb_ != nullptr && channel == Synth::SYNTH_CHANNEL)
+        // Record NoteOff for synth channels (needed for proper playback)
+        if(record && record_cb_ != nullptr && d.target == Target::SYNTH)
         {
             uint8_t status = 0x80 | (channel & 0x0F);
             record_cb_(tick, status, note, 0);
@@ -140,10 +255,11 @@ class Router
      */
     void RouteCC(uint8_t channel, uint8_t cc, uint8_t value, Source source)
     {
-        // Route synth CCs
-        if(channel == Synth::SYNTH_CHANNEL)
+        // Route synth CCs to the channel's instance
+        const Dispatch& d = dispatch_[channel & 0x0F];
+        if(d.target == Target::SYNTH)
         {
-            CCMap::HandleSynthCC(cc, value, *synth_);
+            CCMap::HandleSynthCC(cc, value, *d.synth);
         }
 
         // Forward to companion (MIDI Monitor)
@@ -155,10 +271,39 @@ class Router
     }
 
   private:
+    /**
+     * Compiled routing entry (engine pointer resolved)
+     */
+    struct Dispatch
+    {
+        Target         target;
+        uint8_t        note_low;
+        uint8_t        note_high;
+        int8_t         transpose;
+        Synth::Engine* synth;
+    };
+
+    /**
+     * Apply note range and transpose
+     * Returns false if the note is outside the range or transposes out of 0-127
+     */
+    static bool MapNote(const Dispatch& d, uint8_t note, uint8_t& out)
+    {
+        if(note < d.note_low || note > d.note_high)
+            return false;
+        int16_t n = static_cast<int16_t>(note) + d.transpose;
+        if(n < 0 || n > 127)
+            return false;
+        out = static_cast<uint8_t>(n);
+        return true;
+    }
+
+    Dispatch         dispatch_[NUM_CHANNELS];
+    Route            table_[NUM_CHANNELS];
     Sampler::Engine* sampler_;
-    Synth::Engine* synth_;
-    MidiOutCallback companion_cb_;
-    RecordCallback record_cb_;
+    Synth::Engine*   synths_[MAX_SYNTHS];
+    MidiOutCallback  companion_cb_;
+    RecordCallback   record_cb_;
 };
 
 } // namespace MidiRouter
@@ -0,0 +1,358 @@
+#pragma once
+#ifndef GROOVYDAISY_MOD_MATRIX_H
+#define GROOVYDAISY_MOD_MATRIX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cmath>
+
+/**
+ * GroovyDaisy Modulation Matrix
+ *
+ * Control-rate modulation for the synth: a per-voice LFO (restarted at
+ * note on), a global free-running LFO, and NUM_SLOTS source->destination
+ * routes. Sources are the two LFOs, the filter envelope, note velocity
+ * and the mod wheel; destinations are filter cutoff, pitch, level and pan.
+ *
+ * The matrix runs once per audio block (Evaluate, from Synth::Engine::
+ * Update). Sources and results are kept as [row][voice] arrays so each
+ * route is one multiply-add over the voices. For every destination it
+ * leaves a linear ramp per voice from the value reached at the end of the
+ * previous block to the new one, and the voice loop reads the ramp with
+ * At(): modulation costs a multiply-add per sample instead of an LFO and
+ * a matrix pass. A destination no route points at stays inactive and the
+ * voice loop skips it entirely.
+ *
+ * Routes and amounts are synth parameters (Synth::PARAM_MOD1_ROUTE...),
+ * so they are part of presets, morphs, sessions and CC control.
+ */
+
+namespace ModMatrix
+{
+
+enum Source : uint8_t
+{
+    SRC_NONE = 0,
+    SRC_LFO1,       // Per voice, -1..+1
+    SRC_LFO2,       // Global, -1..+1
+    SRC_FILT_ENV,   // Voice filter envelope, 0..1
+    SRC_VELOCITY,   // Note velocity, 0..1
+    SRC_MOD_WHEEL,  // CCMap::MOD_WHEEL on the synth channel, 0..1
+    SRC_COUNT
+};
+
+enum Dest : uint8_t
+{
+    DEST_CUTOFF = 0,  // Filter cutoff, CUTOFF_OCTAVES at full scale
+    DEST_PITCH,       // Both oscillators, PITCH_SEMITONES at full scale
+    DEST_LEVEL,       // Voice gain, +/-100% at full scale
+    DEST_PAN,         // Voice position, added to the synth pan
+    DEST_COUNT
+};
+
+// LFO shapes (same order as Synth::Waveform)
+enum LfoWave : uint8_t
+{
+    LFO_SIN = 0,
+    LFO_TRI,
+    LFO_SAW,
+    LFO_SQUARE,
+    LFO_WAVE_COUNT
+};
+
+constexpr uint8_t NUM_SLOTS  = 3;
+constexpr uint8_t NUM_LFOS   = 2;
+constexpr uint8_t NUM_ROUTES = SRC_COUNT * DEST_COUNT;  // Routes 0-3 (SRC_NONE) are off
+
+constexpr float LFO_MIN_HZ      = 0.05f;
+constexpr float LFO_MAX_HZ      = 20.0f;
+constexpr float CUTOFF_OCTAVES  = 4.0f;
+constexpr float PITCH_SEMITONES = 12.0f;
+
+/**
+ * Route number for a source/destination pair (one parameter per slot)
+ */
+constexpr uint8_t Route(Source src, Dest dest)
+{
+    return static_cast<uint8_t>(src * DEST_COUNT + dest);
+}
+
+inline Source RouteSource(uint8_t route)
+{
+    return route < NUM_ROUTES ? static_cast<Source>(route / DEST_COUNT) : SRC_NONE;
+}
+
+inline Dest RouteDest(uint8_t route)
+{
+    return static_cast<Dest>(route % DEST_COUNT);
+}
+
+struct Slot
+{
+    uint8_t route;   // Route()
+    float   amount;  // -1.0 to +1.0
+};
+
+/**
+ * Everything the matrix reads from the synth parameters
+ */
+struct Config
+{
+    float   lfo_rate[NUM_LFOS];  // Hz
+    uint8_t lfo_wave[NUM_LFOS];  // LfoWave
+    float   lfo_depth;           // 0.0-1.0, scales every LFO route
+    Slot    slots[NUM_SLOTS];
+};
+
+/**
+ * LFO value at a phase (0..1)
+ */
+inline float LfoShape(uint8_t wave, float phase)
+{
+    switch(wave)
+    {
+        case LFO_TRI: return phase < 0.5f ? 4.0f * phase - 1.0f : 3.0f - 4.0f * phase;
+        case LFO_SAW: return 2.0f * phase - 1.0f;
+        case LFO_SQUARE: return phase < 0.5f ? 1.0f : -1.0f;
+        default: return sinf(6.2831853f * phase);
+    }
+}
+
+template <uint8_t NUM_VOICES>
+class Matrix
+{
+  public:
+    void Init(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        mod_wheel_   = 0.0f;
+        lfo2_phase_  = 0.0f;
+        num_used_    = 0;
+        for(uint8_t l = 0; l < NUM_LFOS; l++)
+        {
+            rate_[l] = 1.0f;
+            wave_[l] = LFO_SIN;
+            inc_[l]  = rate_[l] / sample_rate_;
+        }
+        for(uint8_t d = 0; d < DEST_COUNT; d++)
+        {
+            routed_[d]     = false;
+            was_routed_[d] = false;
+            active_[d]     = false;
+            for(uint8_t v = 0; v < NUM_VOICES; v++)
+            {
+                start_[d][v] = Neutral(d);
+                end_[d][v]   = Neutral(d);
+                step_[d][v]  = 0.0f;
+            }
+        }
+        for(uint8_t s = 0; s < SRC_COUNT; s++)
+        {
+            for(uint8_t v = 0; v < NUM_VOICES; v++)
+            {
+                src_[s][v] = 0.0f;
+            }
+        }
+        for(uint8_t v = 0; v < NUM_VOICES; v++)
+        {
+            lfo1_phase_[v] = 0.0f;
+        }
+    }
+
+    /**
+     * Retune the LFOs for a new sample rate (rates in Hz are kept)
+     */
+    void SetSampleRate(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        for(uint8_t l = 0; l < NUM_LFOS; l++)
+        {
+            inc_[l] = rate_[l] / sample_rate_;
+        }
+    }
+
+    /**
+     * Take new LFO settings and routes (audio callback, at a block boundary)
+     * Slots that are off or have no amount are dropped here, so Evaluate
+     * only walks live routes.
+     */
+    void SetConfig(const Config& c)
+    {
+        for(uint8_t l = 0; l < NUM_LFOS; l++)
+        {
+            rate_[l] = c.lfo_rate[l];
+            wave_[l] = c.lfo_wave[l] % LFO_WAVE_COUNT;
+            inc_[l]  = rate_[l] / sample_rate_;
+        }
+        for(uint8_t d = 0; d < DEST_COUNT; d++)
+        {
+            routed_[d] = false;
+        }
+        num_used_ = 0;
+        for(uint8_t i = 0; i < NUM_SLOTS; i++)
+        {
+            Source src    = RouteSource(c.slots[i].route);
+            float  amount = c.slots[i].amount;
+            if(src == SRC_LFO1 || src == SRC_LFO2)
+                amount *= c.lfo_depth;
+            if(src == SRC_NONE || amount == 0.0f)
+                continue;
+            Used& u  = used_[num_used_++];
+            u.src    = src;
+            u.dest   = RouteDest(c.slots[i].route);
+            u.amount = amount;
+            routed_[u.dest] = true;
+        }
+    }
+
+    void SetModWheel(float value) { mod_wheel_ = value; }
+
+    /**
+     * Note on: restart the voice's LFO and jump its ramps to the new note's
+     * values, so a stolen voice does not glide from the old note
+     */
+    void Trigger(uint8_t voice, uint8_t velocity)
+    {
+        lfo1_phase_[voice]         = 0.0f;
+        src_[SRC_LFO1][voice]      = LfoShape(wave_[0], 0.0f);
+        src_[SRC_LFO2][voice]      = LfoShape(wave_[1], lfo2_phase_);
+        src_[SRC_FILT_ENV][voice]  = 0.0f;
+        src_[SRC_VELOCITY][voice]  = velocity / 127.0f;
+        src_[SRC_MOD_WHEEL][voice] = mod_wheel_;
+
+        float sum[DEST_COUNT] = {};
+        for(uint8_t i = 0; i < num_used_; i++)
+        {
+            sum[used_[i].dest] += used_[i].amount * src_[used_[i].src][voice];
+        }
+        for(uint8_t d = 0; d < DEST_COUNT; d++)
+        {
+            float value      = routed_[d] ? Convert(d, sum[d]) : Neutral(d);
+            start_[d][voice] = value;
+            end_[d][voice]   = value;
+            step_[d][voice]  = 0.0f;
+        }
+    }
+
+    /**
+     * Advance the LFOs by a block and set up the ramps towards the values
+     * at its end (audio callback, once per block)
+     *
+     * @param block_size Samples in the block about to be rendered (0 = jump)
+     * @param filt_env   Filter envelope of each voice
+     */
+    void Evaluate(size_t block_size, const float* filt_env)
+    {
+        float samples = static_cast<float>(block_size);
+
+        // Source rows
+        lfo2_phase_    = Wrap(lfo2_phase_ + inc_[1] * samples);
+        float lfo2     = LfoShape(wave_[1], lfo2_phase_);
+        float lfo1_inc = inc_[0] * samples;
+        for(uint8_t v = 0; v < NUM_VOICES; v++)
+        {
+            lfo1_phase_[v]         = Wrap(lfo1_phase_[v] + lfo1_inc);
+            src_[SRC_LFO1][v]      = LfoShape(wave_[0], lfo1_phase_[v]);
+            src_[SRC_LFO2][v]      = lfo2;
+            src_[SRC_FILT_ENV][v]  = filt_env[v];
+            src_[SRC_MOD_WHEEL][v] = mod_wheel_;
+        }
+
+        // Routes
+        float sum[DEST_COUNT][NUM_VOICES] = {};
+        for(uint8_t i = 0; i < num_used_; i++)
+        {
+            const Used&  u   = used_[i];
+            const float* src = src_[u.src];
+            float*       out = sum[u.dest];
+            for(uint8_t v = 0; v < NUM_VOICES; v++)
+            {
+                out[v] += u.amount * src[v];
+            }
+        }
+
+        // Ramps. A destination whose last route went away glides back to
+        // neutral for one block, then goes idle.
+        float inv = block_size > 0 ? 1.0f / samples : 0.0f;
+        for(uint8_t d = 0; d < DEST_COUNT; d++)
+        {
+            bool glide     = !routed_[d] && was_routed_[d];
+            was_routed_[d] = routed_[d];
+            active_[d]     = routed_[d] || glide;
+            if(!active_[d])
+                continue;
+            for(uint8_t v = 0; v < NUM_VOICES; v++)
+            {
+                float target = routed_[d] ? Convert(d, sum[d][v]) : Neutral(d);
+                start_[d][v] = block_size > 0 ? end_[d][v] : target;
+                step_[d][v]  = (target - start_[d][v]) * inv;
+                end_[d][v]   = target;
+            }
+        }
+    }
+
+    /**
+     * True if the voice loop has to apply a destination this block
+     */
+    bool IsActive(Dest dest) const { return active_[dest]; }
+
+    /**
+     * Destination value for a voice, pos samples into the block (1..block
+     * size; the last sample reaches the value evaluated for the block end)
+     * Cutoff and pitch are frequency ratios, level a gain and pan an offset.
+     */
+    float At(Dest dest, uint8_t voice, float pos) const
+    {
+        return start_[dest][voice] + step_[dest][voice] * pos;
+    }
+
+  private:
+    struct Used
+    {
+        Source src;
+        Dest   dest;
+        float  amount;
+    };
+
+    static float Neutral(uint8_t dest) { return dest == DEST_PAN ? 0.0f : 1.0f; }
+
+    static float Wrap(float phase) { return phase - floorf(phase); }
+
+    /**
+     * Summed route amounts to the unit the voice loop applies
+     */
+    static float Convert(uint8_t dest, float sum)
+    {
+        switch(dest)
+        {
+            case DEST_CUTOFF: return exp2f(sum * CUTOFF_OCTAVES);
+            case DEST_PITCH: return exp2f(sum * (PITCH_SEMITONES / 12.0f));
+            case DEST_LEVEL: return fminf(fmaxf(1.0f + sum, 0.0f), 2.0f);
+            default: return fminf(fmaxf(sum, -2.0f), 2.0f);
+        }
+    }
+
+    float   sample_rate_;
+    float   rate_[NUM_LFOS];
+    uint8_t wave_[NUM_LFOS];
+    float   inc_[NUM_LFOS];              // Phase per sample
+    float   lfo1_phase_[NUM_VOICES];
+    float   lfo2_phase_;
+    float   mod_wheel_;
+
+    Used    used_[NUM_SLOTS];            // Live routes
+    uint8_t num_used_;
+    bool    routed_[DEST_COUNT];         // Some route points here
+    bool    was_routed_[DEST_COUNT];     // routed_ at the last Evaluate
+    bool    active_[DEST_COUNT];         // Routed, or gliding back this block
+
+    // [row][voice]
+    float src_[SRC_COUNT][NUM_VOICES];
+    float start_[DEST_COUNT][NUM_VOICES];
+    float step_[DEST_COUNT][NUM_VOICES];
+    float end_[DEST_COUNT][NUM_VOICES];
+};
+
+} // namespace ModMatrix
+
+#endif // GROOVYDAISY_MOD_MATRIX_H
@@ -0,0 +1,261 @@
+#pragma once
+#ifndef GROOVYDAISY_PATTERN_TRANSFER_H
+#define GROOVYDAISY_PATTERN_TRANSFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sequencer.h"
+
+/**
+ * GroovyDaisy Bulk Pattern Transfer
+ *
+ * Sends every sequencer track to the companion as one compact byte stream,
+ * split into MSG_PATTERN_BULK chunks.
+ *
+ * Stream:
+ *   [version:1][track_count:1]
+ *   per track: [track_id:1][event_count:varint]
+ *              per event: [delta_tick:varint][status:1][data1:1][data2:1]
+ *   delta_tick is relative to the previous event of the same track (events
+ *   are kept sorted), so most events take 4 bytes instead of 7.
+ *
+ * Flow control is credit based: each chunk uses one credit and the
+ * companion returns credits (CMD_BULK_ACK) as it consumes chunks. The
+ * companion can raise the chunk size and window with CMD_BULK_CONFIG. If no
+ * credit arrives for CREDIT_TIMEOUT_MS the transfer is abandoned.
+ */
+
+namespace PatternTransfer
+{
+
+constexpr uint8_t  STREAM_VERSION    = 1;
+constexpr uint16_t DEFAULT_CHUNK     = 256;   // Chunk payload until negotiated
+constexpr uint16_t MAX_CHUNK         = 1024;  // Largest negotiable chunk payload
+constexpr uint8_t  DEFAULT_WINDOW    = 4;     // Credits until negotiated
+constexpr uint8_t  MAX_WINDOW        = 16;
+constexpr uint32_t CREDIT_TIMEOUT_MS = 500;
+
+// Chunk header: [seq:1][flags:1]
+constexpr uint8_t CHUNK_HEADER = 2;
+constexpr uint8_t FLAG_FIRST   = 0x01;  // Start of stream (discard anything partial)
+constexpr uint8_t FLAG_LAST    = 0x02;  // End of stream (decode now)
+
+// Largest encoded item: varint tick (5) + 3 bytes
+constexpr uint8_t MAX_ITEM = 8;
+
+/**
+ * Write a LEB128 varint, returns bytes written (1-5)
+ */
+inline uint8_t PutVarint(uint8_t* out, uint32_t value)
+{
+    uint8_t n = 0;
+    while(value >= 0x80)
+    {
+        out[n++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+/**
+ * Incremental encoder: produces the stream a chunk at a time
+ */
+class Encoder
+{
+  public:
+    void Begin(const Sequencer::Engine* sequencer)
+    {
+        sequencer_ = sequencer;
+        stage_     = STREAM_HEADER;
+        track_     = 0;
+        index_     = 0;
+        count_     = 0;
+        prev_tick_ = 0;
+    }
+
+    bool Done() const { return stage_ == DONE; }
+
+    /**
+     * Encode as many whole items as fit, returns bytes written
+     */
+    size_t Fill(uint8_t* out, size_t max)
+    {
+        size_t len = 0;
+        while(stage_ != DONE && max - len >= MAX_ITEM)
+        {
+            len += EncodeItem(&out[len]);
+        }
+        return len;
+    }
+
+  private:
+    enum Stage
+    {
+        STREAM_HEADER,
+        TRACK_HEADER,
+        EVENTS,
+        DONE
+    };
+
+    size_t EncodeItem(uint8_t* out)
+    {
+        switch(stage_)
+        {
+            case STREAM_HEADER:
+                out[0] = STREAM_VERSION;
+                out[1] = Sequencer::NUM_TOTAL_TRACKS;
+                stage_ = TRACK_HEADER;
+                return 2;
+
+            case TRACK_HEADER:
+            {
+                // Count is fixed here; recording that lands mid-transfer is
+                // picked up by the next sync
+                count_     = sequencer_->GetTrackEventCount(track_);
+                index_     = 0;
+                prev_tick_ = 0;
+                out[0]     = track_;
+                size_t n   = 1 + PutVarint(&out[1], count_);
+                stage_     = count_ > 0 ? EVENTS : NextTrack();
+                return n;
+            }
+
+            case EVENTS:
+            {
+                const Sequencer::MidiEvent& ev = sequencer_->GetTrackEvent(track_, index_);
+                uint32_t delta = ev.tick >= prev_tick_ ? ev.tick - prev_tick_ : 0;
+                prev_tick_     = ev.tick >= prev_tick_ ? ev.tick : prev_tick_;
+                uint8_t n      = PutVarint(out, delta);
+                out[n++]       = ev.status;
+                out[n++]       = ev.data1;
+                out[n++]       = ev.data2;
+                if(++index_ >= count_)
+                {
+                    stage_ = NextTrack();
+                }
+                return n;
+            }
+
+            default: return 0;
+        }
+    }
+
+    Stage NextTrack()
+    {
+        track_++;
+        return track_ < Sequencer::NUM_TOTAL_TRACKS ? TRACK_HEADER : DONE;
+    }
+
+    const Sequencer::Engine* sequencer_;
+    Stage                    stage_;
+    uint8_t                  track_;
+    uint16_t                 index_;
+    uint16_t                 count_;
+    uint32_t                 prev_tick_;
+};
+
+/**
+ * Transfer state: chunking, sequence numbers and credits
+ */
+class Sender
+{
+  public:
+    void Init()
+    {
+        chunk_   = DEFAULT_CHUNK;
+        window_  = DEFAULT_WINDOW;
+        active_  = false;
+        credits_ = 0;
+        seq_     = 0;
+    }
+
+    /**
+     * Apply the companion's limits (CMD_BULK_CONFIG)
+     */
+    void Configure(uint16_t chunk, uint8_t window)
+    {
+        chunk_  = chunk < 64 ? 64 : (chunk > MAX_CHUNK ? MAX_CHUNK : chunk);
+        window_ = window < 1 ? 1 : (window > MAX_WINDOW ? MAX_WINDOW : window);
+    }
+
+    /**
+     * Start (or restart) a full-pattern transfer
+     */
+    void Start(const Sequencer::Engine* sequencer, uint32_t now)
+    {
+        encoder_.Begin(sequencer);
+        active_      = true;
+        first_       = true;
+        credits_     = window_;
+        last_credit_ = now;
+    }
+
+    /**
+     * Credits returned by the companion (CMD_BULK_ACK)
+     */
+    void AddCredits(uint8_t credits, uint32_t now)
+    {
+        if(!active_)
+            return;
+        credits_ += credits;
+        if(credits_ > window_)
+        {
+            credits_ = window_;
+        }
+        last_credit_ = now;
+    }
+
+    /**
+     * Build the next chunk payload if a credit is available
+     * Returns the payload length, or 0 if there is nothing to send now.
+     * out must hold ChunkSize() bytes.
+     */
+    size_t NextChunk(uint8_t* out)
+    {
+        if(!active_ || credits_ == 0)
+            return 0;
+
+        size_t len = CHUNK_HEADER + encoder_.Fill(&out[CHUNK_HEADER], chunk_ - CHUNK_HEADER);
+        out[0]     = seq_++;
+        out[1]     = (first_ ? FLAG_FIRST : 0) | (encoder_.Done() ? FLAG_LAST : 0);
+        first_     = false;
+        credits_--;
+        if(encoder_.Done())
+        {
+            active_ = false;
+        }
+        return len;
+    }
+
+    /**
+     * Abandon a transfer that ran out of credits
+     * Returns true if it timed out on this call.
+     */
+    bool CheckTimeout(uint32_t now)
+    {
+        if(active_ && credits_ == 0 && now - last_credit_ >= CREDIT_TIMEOUT_MS)
+        {
+            active_ = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool     IsActive() const { return active_; }
+    uint16_t ChunkSize() const { return chunk_; }
+
+  private:
+    Encoder  encoder_;
+    uint16_t chunk_;        // Chunk payload size (header included)
+    uint8_t  window_;       // Credits granted at start and cap on returns
+    uint8_t  credits_;
+    uint8_t  seq_;
+    bool     active_;
+    bool     first_;
+    uint32_t last_credit_;  // Time of start or last credit (ms)
+};
+
+} // namespace PatternTransfer
+
+#endif // GROOVYDAISY_PATTERN_TRANSFER_H
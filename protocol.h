@@ -16,6 +16,17 @@
  * PAYLOAD:  Variable length data
  * CHECKSUM: XOR of all bytes from TYPE through PAYLOAD
  *
+ * Framed format (bulk messages once CMD_LINK_CONFIG enables it):
+ *   [SYNC_FRAMED][TYPE][SEQ][LEN_LO][LEN_HI][PAYLOAD...][CRC_LO][CRC_HI]
+ *
+ * SYNC_FRAMED: 0xAB
+ * SEQ:         Per-message sequence number (wraps), used for NAKs
+ * CRC:         CRC-16/CCITT-FALSE over TYPE through PAYLOAD
+ *
+ * The receiver NAKs the sequence numbers it missed (gaps, CRC failures) and
+ * the sender retransmits them from its history (see reliable_link.h). The
+ * parser accepts both formats in either direction.
+ *
  * Daisy -> Companion (state updates):
  *   0x01 MSG_TICK      - Playhead position [tick:4]
  *   0x02 MSG_TRANSPORT - Transport state [playing:1][recording:1][bpm:2]
@@ -27,9 +38,21 @@
  *   0x08 MSG_FADER_STATE - Fader pickup states [9 bytes: picked_up flags]
  *   0x09 MSG_MIXER_STATE - Mixer state (levels/pans, see below)
  *   0x0A MSG_TRACK_STATE - Track status [id:1][status:1][frozen_slot:1][source:1] × 4 synth tracks
+ *   0x0B MSG_MIDI_BATCH - MIDI Monitor events for one frame [status:1][data1:1][data2:1] × n
  *   0x10 MSG_PATTERN_DUMP - Pattern events [track_id:1][offset:2][count:2][events:7*count]
  *   0x11 MSG_PATTERN_CLEAR - Track was cleared [track_id:1]
  *   0x12 MSG_RESOURCES - Memory/CPU stats [mem_used:4][mem_total:4][cpu:1]
+ *   0x13 MSG_PATTERN_BULK - Full-pattern stream chunk [seq:1][flags:1][stream...]
+ *   0x14 MSG_STATE_DELTA - Changed state fields [version:2][base:2][flags:1][field:1][value:4]...
+ *   0x15 MSG_LINK_GAP  - Framed only: NAKed message no longer in history []
+ *   0x16 MSG_CLOCK_SYNC - Playhead anchor (see below and clock_sync.h)
+ *   0x17 MSG_TELEMETRY - Bus levels, scope and spectrum (see protocol_codec.h)
+ *   0x18 MSG_VOICE_DIAG - Per-voice synth diagnostics (see below)
+ *   0x19 MSG_TASK_STATS - Main-loop task timing (see below)
+ *   0x1A MSG_SMF_DATA  - Exported MIDI file chunk [offset:4][total:4][bytes...]
+ *   0x1B MSG_SMF_STATUS - MIDI file transfer progress (see below)
+ *   0x1C MSG_AUDIO_CONFIG - Sample rate / block size (see below)
+ *   0x1D MSG_AUDIO_BENCH - One benchmark matrix cell (see below)
  *   0xFF MSG_DEBUG     - Debug text [string...]
  *
  * MSG_MIXER_STATE payload:
@@ -43,6 +66,63 @@
  *   [events...]  - Each event: [tick:4][status:1][data1:1][data2:1] = 7 bytes
  *   Max ~36 events per message (256 byte payload limit)
  *
+ * MSG_PATTERN_BULK payload (see pattern_transfer.h for the stream format):
+ *   [seq:1]   - Chunk sequence number (wraps)
+ *   [flags:1] - bit0 = first chunk of a stream, bit1 = last chunk
+ *   [stream...] - Next bytes of the encoded pattern
+ *   Chunks may exceed MAX_PAYLOAD (up to the size set by CMD_BULK_CONFIG).
+ *
+ * MSG_STATE_DELTA payload (field table and flags in state_sync.h):
+ *   Replaces MSG_TRANSPORT / VOICES / SYNTH_STATE / CC_BANK / FADER_STATE /
+ *   MIXER_STATE / TRACK_STATE, which the firmware no longer sends. The
+ *   companion acknowledges each version with CMD_STATE_ACK.
+ *
+ * MSG_CLOCK_SYNC payload:
+ *   [sample:4][tick:4][phase:2][bpm:2][pattern_ticks:4][sample_rate:4][flags:1]
+ *   sample: audio sample counter at the anchor; phase: Q16 fraction of a tick
+ *   flags: bit0 = running. Sent on tempo/state changes, drift and a slow
+ *   heartbeat; the companion extrapolates in between. Replaces MSG_TICK.
+ *
+ * MSG_VOICE_DIAG payload:
+ *   [cpu:1][active:1][count:1] + count x
+ *   [note:1][velocity:1][state:1][env:1][age_ms:2][release_samples:4][cutoff_hz:2]
+ *   state: bit0 active, bit1 gate, bits 4-6 amp envelope segment
+ *   (0 idle, 1 attack, 2 decay/sustain, 4 release); env: 0-255.
+ *   Replaces the periodic "V: ..." / "CPU: ..." debug strings.
+ *
+ * MSG_TASK_STATS payload (every 2 s, covers the time since the last one):
+ *   [max_pass_us:2][count:1] + count x
+ *   [name_len:1][name][priority:1][runs:2][avg_us:2][max_us:2][max_late_ms:2]
+ *   [overruns:1][deferred:1]
+ *   See task_scheduler.h; 16-bit values saturate.
+ *
+ * Standard MIDI File transfer (see smf.h), offsets are file byte offsets:
+ *   Import: the companion sends CMD_SMF_IMPORT chunks in order, each after
+ *   the MSG_SMF_STATUS for the previous one. Offset 0 stops the transport,
+ *   clears every track and starts a new file. A chunk at the wrong offset
+ *   gets state SEQUENCE with the expected offset and is ignored.
+ *   Export: the companion requests CMD_SMF_EXPORT [offset:4] and gets one
+ *   MSG_SMF_DATA per request (offset 0 snapshots the pattern). Refused
+ *   with state BUSY while recording.
+ *   MSG_SMF_STATUS: [op:1][state:1][offset:4][notes:2][points:2][dropped:2]
+ *   op: 1 import, 2 export; state: 0 OK (next offset), 1 DONE, 2 FORMAT
+ *   (not a type 0/1 file), 3 BUSY, 4 SEQUENCE; notes/points: events added
+ *   to tracks / automation lanes; dropped: past the pattern end or no room.
+ *
+ * Audio configuration (see audio_config.h):
+ *   MSG_AUDIO_CONFIG: [rate:4][block:2][latency_us:4][state:1]
+ *   Sent at boot and in answer to every CMD_AUDIO_CONFIG. state: 0 OK,
+ *   1 INVALID (unsupported rate/block, nothing changed), 2 BUSY (benchmark
+ *   running, nothing changed).
+ *   MSG_AUDIO_BENCH: [index:1][count:1][rate:4][block:2][avg_load:2][max_load:2]
+ *   One per matrix cell, about a second apart; loads are in 0.01% of the
+ *   block period (10000 = 100%). The settings in use before the run are
+ *   restored (and reported with MSG_AUDIO_CONFIG) after the last cell.
+ *
+ * MSG_MIDI_BATCH payload:
+ *   Same 3-byte events as MSG_MIDI_IN, oldest first; count = length / 3.
+ *   Up to MAX_BATCH_EVENTS per message, sent once per monitor frame.
+ *
  * MSG_TRACK_STATE payload:
  *   4 synth tracks × [id:1][status:1][frozen_slot:1][source:1]
  *   status: 0=MIDI, 1=PENDING, 2=RENDERING, 3=AUDIO
@@ -55,20 +135,32 @@
  *   0x83 CMD_TEMPO     - Set tempo [bpm:2]
  *   0x84 CMD_PATTERN   - Select pattern [num:1]
  *   0x85 CMD_SYNTH_PARAM - Set synth param [param_id:1][value:4 float LE]
- *   0x86 CMD_LOAD_PRESET - Load preset [preset_index:1]
+ *   0x86 CMD_LOAD_PRESET - Load preset [preset_index:1][morph_ms:2 LE, optional]
  *   0x87 CMD_SET_BANK  - Set CC bank [bank:1]
  *   0x88 CMD_FREEZE_TRACK - Start freeze [track_id:1]
  *   0x89 CMD_UNFREEZE_TRACK - Unfreeze track [track_id:1]
  *   0x90 CMD_REQ_STATE - Request full state dump []
  *   0x91 CMD_REQ_PATTERN - Request pattern dump [track_id:1] or [] for all
  *   0x92 CMD_REQ_SYNTH - Request synth state []
+ *   0x93 CMD_BULK_ACK    - Return bulk transfer credits [credits:1]
+ *   0x94 CMD_BULK_CONFIG - Bulk chunk size and window [max_chunk:2 LE][window:1]
+ *   0x95 CMD_STATE_ACK   - State version received [version:2 LE]
+ *   0x96 CMD_LINK_CONFIG - Link options [flags:1] (bit0 = CRC framing for bulk messages)
+ *   0x97 CMD_LINK_NAK    - Retransmit framed messages [seq:1]...
+ *   0x98 CMD_TELEMETRY_CONFIG - Audio telemetry [flags:1][interval_ms:2 LE][decimation:1]
+ *                          flags: bit0 enable, bit1 scope, bit2 spectrum
+ *   0x99 CMD_SMF_IMPORT  - MIDI file chunk [offset:4 LE][total:4 LE][bytes...]
+ *   0x9A CMD_SMF_EXPORT  - Request MIDI file chunk [offset:4 LE]
+ *   0x9B CMD_AUDIO_CONFIG - Set rate/block [rate:4 LE][block:2 LE], [] to query
+ *   0x9C CMD_AUDIO_BENCH - Run the rate × block benchmark matrix []
  */
 
 namespace Protocol
 {
 
-// Sync byte
-constexpr uint8_t SYNC_BYTE = 0xAA;
+// Sync bytes
+constexpr uint8_t SYNC_BYTE   = 0xAA;
+constexpr uint8_t SYNC_FRAMED = 0xAB;  // CRC-16 + sequence number framing
 
 // Message types: Daisy -> Companion
 constexpr uint8_t MSG_TICK          = 0x01;
@@ -81,9 +173,21 @@ constexpr uint8_t MSG_CC_BANK       = 0x07;
 constexpr uint8_t MSG_FADER_STATE   = 0x08;
 constexpr uint8_t MSG_MIXER_STATE   = 0x09;
 constexpr uint8_t MSG_TRACK_STATE   = 0x0A;  // Track freeze status
+constexpr uint8_t MSG_MIDI_BATCH    = 0x0B;  // Batched MIDI_IN events
 constexpr uint8_t MSG_PATTERN_DUMP  = 0x10;  // Pattern events dump
 constexpr uint8_t MSG_PATTERN_CLEAR = 0x11;  // Track was cleared
 constexpr uint8_t MSG_RESOURCES     = 0x12;  // Memory + CPU stats
+constexpr uint8_t MSG_PATTERN_BULK  = 0x13;  // Bulk pattern stream chunk
+constexpr uint8_t MSG_STATE_DELTA   = 0x14;  // Versioned state change-set / snapshot
+constexpr uint8_t MSG_LINK_GAP      = 0x15;  // Retransmit impossible, message lost
+constexpr uint8_t MSG_CLOCK_SYNC    = 0x16;  // Playhead anchor for local extrapolation
+constexpr uint8_t MSG_TELEMETRY     = 0x17;  // Bus levels, scope, spectrum
+constexpr uint8_t MSG_VOICE_DIAG    = 0x18;  // Per-voice synth diagnostics
+constexpr uint8_t MSG_TASK_STATS    = 0x19;  // Main-loop task run time / lateness
+constexpr uint8_t MSG_SMF_DATA      = 0x1A;  // Exported MIDI file chunk
+constexpr uint8_t MSG_SMF_STATUS    = 0x1B;  // MIDI file import/export progress
+constexpr uint8_t MSG_AUDIO_CONFIG  = 0x1C;  // Sample rate, block size, latency
+constexpr uint8_t MSG_AUDIO_BENCH   = 0x1D;  // Benchmark matrix cell result
 constexpr uint8_t MSG_DEBUG         = 0xFF;
 
 // Message types: Companion -> Daisy
@@ -100,6 +204,39 @@ constexpr uint8_t CMD_UNFREEZE_TRACK = 0x89;  // Unfreeze track
 constexpr uint8_t CMD_REQ_STATE      = 0x90;
 constexpr uint8_t CMD_REQ_PATTERN    = 0x91;  // Request pattern dump
 constexpr uint8_t CMD_REQ_SYNTH      = 0x92;
+constexpr uint8_t CMD_BULK_ACK       = 0x93;  // Return bulk transfer credits
+constexpr uint8_t CMD_BULK_CONFIG    = 0x94;  // Negotiate bulk chunk size / window
+constexpr uint8_t CMD_STATE_ACK      = 0x95;  // Acknowledge a state version
+constexpr uint8_t CMD_LINK_CONFIG    = 0x96;  // Enable/disable CRC framing
+constexpr uint8_t CMD_LINK_NAK       = 0x97;  // Request framed retransmits
+constexpr uint8_t CMD_TELEMETRY_CONFIG = 0x98;  // Audio telemetry stream on/off, rate
+constexpr uint8_t CMD_SMF_IMPORT     = 0x99;  // MIDI file chunk to import
+constexpr uint8_t CMD_SMF_EXPORT     = 0x9A;  // Request an exported MIDI file chunk
+constexpr uint8_t CMD_AUDIO_CONFIG   = 0x9B;  // Change (or query) rate / block size
+constexpr uint8_t CMD_AUDIO_BENCH    = 0x9C;  // Run the audio benchmark matrix
+
+// CMD_LINK_CONFIG flags
+constexpr uint8_t LINK_FLAG_FRAMED = 0x01;
+
+// MSG_SMF_STATUS operation and state
+constexpr uint8_t SMF_OP_IMPORT = 1;
+constexpr uint8_t SMF_OP_EXPORT = 2;
+enum class SmfState : uint8_t
+{
+    OK       = 0,  // Chunk accepted, send/request the next offset
+    DONE     = 1,  // Whole file converted
+    FORMAT   = 2,  // Not a usable SMF (import aborted)
+    BUSY     = 3,  // Try again later
+    SEQUENCE = 4,  // Unexpected offset; offset field holds the expected one
+};
+
+// MSG_AUDIO_CONFIG state
+enum class AudioState : uint8_t
+{
+    OK      = 0,  // Settings in use
+    INVALID = 1,  // Requested settings unsupported, nothing changed
+    BUSY    = 2,  // Benchmark running, nothing changed
+};
 
 // Track status enum (for MSG_TRACK_STATE)
 enum class TrackStatus : uint8_t
@@ -119,6 +256,12 @@ constexpr size_t MAX_PAYLOAD = 256;
 // Message buffer (header + max payload + checksum)
 constexpr size_t MAX_MESSAGE = 4 + MAX_PAYLOAD + 1;
 
+// Framed message overhead (SYNC + TYPE + SEQ + LEN(2) + CRC(2))
+constexpr size_t FRAMED_OVERHEAD = 7;
+
+// MIDI events per MSG_MIDI_BATCH
+constexpr size_t MAX_BATCH_EVENTS = MAX_PAYLOAD / 3;
+
 /**
  * Calculate XOR checksum over a buffer
  */
@@ -132,6 +275,24 @@ inline uint8_t Checksum(const uint8_t* data, size_t len)
     return sum;
 }
 
+/**
+ * CRC-16/CCITT-FALSE (poly 0x1021), nibble table
+ * Pass the previous result as crc to continue over several blocks.
+ */
+inline uint16_t Crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for(size_t i = 0; i < len; i++)
+    {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
 /**
  * Build a message into a buffer
  * Returns total message length (including header and checksum)
@@ -156,6 +317,32 @@ inline size_t BuildMessage(uint8_t* buf, uint8_t type,
     return 5 + payload_len;  // SYNC + TYPE + LEN(2) + PAYLOAD + CHECKSUM
 }
 
+/**
+ * Build a framed (CRC-16, sequenced) message into a buffer
+ * Returns total message length (payload_len + FRAMED_OVERHEAD)
+ */
+inline size_t BuildFramedMessage(uint8_t* buf, uint8_t type, uint8_t seq,
+                                 const uint8_t* payload, uint16_t payload_len)
+{
+    buf[0] = SYNC_FRAMED;
+    buf[1] = type;
+    buf[2] = seq;
+    buf[3] = payload_len & 0xFF;
+    buf[4] = (payload_len >> 8) & 0xFF;
+
+    if(payload_len > 0 && payload != nullptr)
+    {
+        memcpy(&buf[5], payload, payload_len);
+    }
+
+    // CRC covers TYPE + SEQ + LEN + PAYLOAD
+    uint16_t crc = Crc16(&buf[1], 4 + payload_len);
+    buf[5 + payload_len] = crc & 0xFF;
+    buf[6 + payload_len] = crc >> 8;
+
+    return FRAMED_OVERHEAD + payload_len;
+}
+
 /**
  * Parse state for receiving messages
  */
@@ -165,10 +352,13 @@ struct Parser
     {
         WAIT_SYNC,
         WAIT_TYPE,
+        WAIT_SEQ,
         WAIT_LEN_LO,
         WAIT_LEN_HI,
         WAIT_PAYLOAD,
-        WAIT_CHECKSUM
+        WAIT_CHECKSUM,
+        WAIT_CRC_LO,
+        WAIT_CRC_HI
     };
 
     State    state;
@@ -177,6 +367,11 @@ struct Parser
     uint16_t payload_idx;
     uint8_t  payload[MAX_PAYLOAD];
     uint8_t  running_checksum;
+    bool     framed;       // Current message uses SYNC_FRAMED
+    uint8_t  seq;          // Sequence number of the last framed message
+    uint16_t running_crc;
+    uint8_t  crc_lo;
+    uint32_t errors;       // Messages dropped for a bad length, checksum or CRC
 
     void Reset()
     {
@@ -185,6 +380,17 @@ struct Parser
         payload_len      = 0;
         payload_idx      = 0;
         running_checksum = 0;
+        framed           = false;
+        running_crc      = 0xFFFF;
+    }
+
+    /**
+     * Drop the message in progress and count it
+     */
+    void Reject()
+    {
+        errors++;
+        Reset();
     }
 
     /**
@@ -197,38 +403,49 @@ struct Parser
         switch(state)
         {
             case WAIT_SYNC:
-                if(byte == SYNC_BYTE)
+                if(byte == SYNC_BYTE || byte == SYNC_FRAMED)
                 {
                     state            = WAIT_TYPE;
                     running_checksum = 0;
+                    running_crc      = 0xFFFF;
+                    framed           = byte == SYNC_FRAMED;
                 }
                 break;
 
             case WAIT_TYPE:
                 type             = byte;
                 running_checksum ^= byte;
-                state            = WAIT_LEN_LO;
+                running_crc      = Crc16(&byte, 1, running_crc);
+                state            = framed ? WAIT_SEQ : WAIT_LEN_LO;
+                break;
+
+            case WAIT_SEQ:
+                seq         = byte;
+                running_crc = Crc16(&byte, 1, running_crc);
+                state       = WAIT_LEN_LO;
                 break;
 
             case WAIT_LEN_LO:
                 payload_len      = byte;
                 running_checksum ^= byte;
+                running_crc      = Crc16(&byte, 1, running_crc);
                 state            = WAIT_LEN_HI;
                 break;
 
             case WAIT_LEN_HI:
                 payload_len     |= (uint16_t)byte << 8;
                 running_checksum ^= byte;
+                running_crc      = Crc16(&byte, 1, running_crc);
                 payload_idx      = 0;
 
                 if(payload_len > MAX_PAYLOAD)
                 {
-                    // Invalid length, reset
-                    Reset();
+                    // Invalid length
+                    Reject();
                 }
                 else if(payload_len == 0)
                 {
-                    state = WAIT_CHECKSUM;
+                    state = framed ? WAIT_CRC_LO : WAIT_CHECKSUM;
                 }
                 else
                 {
@@ -239,10 +456,11 @@ struct Parser
             case WAIT_PAYLOAD:
                 payload[payload_idx++] = byte;
                 running_checksum ^= byte;
+                running_crc = Crc16(&byte, 1, running_crc);
 
                 if(payload_idx >= payload_len)
                 {
-                    state = WAIT_CHECKSUM;
+                    state = framed ? WAIT_CRC_LO : WAIT_CHECKSUM;
                 }
                 break;
 
@@ -255,14 +473,88 @@ struct Parser
                 }
                 else
                 {
-                    // Checksum mismatch, reset
-                    Reset();
+                    // Checksum mismatch
+                    Reject();
+                }
+                break;
+
+            case WAIT_CRC_LO:
+                crc_lo = byte;
+                state  = WAIT_CRC_HI;
+                break;
+
+            case WAIT_CRC_HI:
+                if((crc_lo | (byte << 8)) == running_crc)
+                {
+                    state = WAIT_SYNC;
+                    return true;
+                }
+                else
+                {
+                    Reject();
                 }
                 break;
         }
 
         return false;
     }
+
+    /**
+     * Feed a block of received bytes
+     * Consumes input up to the end of the next complete message, so the
+     * caller can handle it before feeding the rest. The sync search uses
+     * memchr and payloads are copied (and checksummed) in one go rather than
+     * per byte.
+     *
+     * @param complete Set to true when a valid message is ready
+     * @return Bytes consumed
+     */
+    size_t Feed(const uint8_t* data, size_t len, bool& complete)
+    {
+        complete = false;
+        size_t i = 0;
+        while(i < len)
+        {
+            if(state == WAIT_SYNC)
+            {
+                const void* sync        = memchr(data + i, SYNC_BYTE, len - i);
+                const void* framed_sync = memchr(data + i, SYNC_FRAMED, len - i);
+                if(sync == nullptr || (framed_sync != nullptr && framed_sync < sync))
+                    sync = framed_sync;
+                if(sync == nullptr)
+                    return len;
+                i = static_cast<const uint8_t*>(sync) - data;
+            }
+            else if(state == WAIT_PAYLOAD)
+            {
+                size_t n = payload_len - payload_idx;
+                if(n > len - i)
+                    n = len - i;
+                memcpy(&payload[payload_idx], data + i, n);
+                if(framed)
+                    running_crc = Crc16(data + i, n, running_crc);
+                else
+                    running_checksum ^= Checksum(data + i, n);
+                payload_idx += n;
+                i += n;
+                if(payload_idx >= payload_len)
+                    state = framed ? WAIT_CRC_LO : WAIT_CHECKSUM;
+                continue;
+            }
+
+            if(Feed(data[i++]))
+            {
+                complete = true;
+                return i;
+            }
+        }
+        return len;
+    }
+
+    /**
+     * True between messages (waiting for a sync byte)
+     */
+    bool IsIdle() const { return state == WAIT_SYNC; }
 };
 
 } // namespace Protocol
@@ -0,0 +1,1406 @@
+#pragma once
+#ifndef GROOVYDAISY_PROTOCOL_CODEC_H
+#define GROOVYDAISY_PROTOCOL_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "protocol.h"
+
+/**
+ * GroovyDaisy Protocol Codec
+ *
+ * Typed payload structs for every MSG_ / CMD_ type in protocol.h. Each one
+ * has:
+ *   TYPE                         - message type byte
+ *   MAX_SIZE                     - largest encoded payload
+ *   size_t Encode(uint8_t* out)  - write the payload, returns its length
+ *   bool   Decode(in, len)       - read a payload, false if it is too short
+ *
+ * Framing (sync, length, checksum/CRC) stays in protocol.h; this layer only
+ * deals with payloads, so the same structs serve the firmware, host tools
+ * (tools/protocol_bench.cpp, tools/protocol_fuzz.cpp) and either framing.
+ * Variable-length payloads (MIDI batch, pattern events, bulk chunks, text)
+ * point into the caller's buffer instead of copying. All multi-byte values
+ * are little-endian. No allocation, no exceptions.
+ */
+
+namespace ProtocolCodec
+{
+
+/**
+ * Little-endian payload writer
+ */
+struct Writer
+{
+    uint8_t* out;
+    size_t   pos;
+
+    explicit Writer(uint8_t* buf) : out(buf), pos(0) {}
+
+    void U8(uint8_t v) { out[pos++] = v; }
+    void U16(uint16_t v)
+    {
+        out[pos++] = v & 0xFF;
+        out[pos++] = v >> 8;
+    }
+    void U32(uint32_t v)
+    {
+        out[pos++] = v & 0xFF;
+        out[pos++] = (v >> 8) & 0xFF;
+        out[pos++] = (v >> 16) & 0xFF;
+        out[pos++] = (v >> 24) & 0xFF;
+    }
+    void F32(float v)
+    {
+        uint32_t u;
+        memcpy(&u, &v, sizeof(u));
+        U32(u);
+    }
+    void Bytes(const uint8_t* data, size_t len)
+    {
+        if(len > 0)
+        {
+            memcpy(&out[pos], data, len);
+        }
+        pos += len;
+    }
+    // LEB128, 1-5 bytes (same encoding as the bulk pattern stream)
+    void Varint(uint32_t v)
+    {
+        while(v >= 0x80)
+        {
+            out[pos++] = static_cast<uint8_t>(v) | 0x80;
+            v >>= 7;
+        }
+        out[pos++] = static_cast<uint8_t>(v);
+    }
+};
+
+/**
+ * Bounds-checked little-endian payload reader
+ * Reads past the end return 0 and clear ok, so a decoder can read every
+ * field and check once.
+ */
+struct Reader
+{
+    const uint8_t* in;
+    size_t         len;
+    size_t         pos;
+    bool           ok;
+
+    Reader(const uint8_t* buf, size_t size) : in(buf), len(size), pos(0), ok(true) {}
+
+    bool Has(size_t n) const { return len - pos >= n; }
+
+    uint8_t U8()
+    {
+        if(!Has(1))
+        {
+            ok = false;
+            return 0;
+        }
+        return in[pos++];
+    }
+    uint16_t U16()
+    {
+        if(!Has(2))
+        {
+            ok = false;
+            return 0;
+        }
+        uint16_t v = in[pos] | (in[pos + 1] << 8);
+        pos += 2;
+        return v;
+    }
+    uint32_t U32()
+    {
+        if(!Has(4))
+        {
+            ok = false;
+            return 0;
+        }
+        uint32_t v = in[pos] | (in[pos + 1] << 8) | (in[pos + 2] << 16)
+                     | (static_cast<uint32_t>(in[pos + 3]) << 24);
+        pos += 4;
+        return v;
+    }
+    float F32()
+    {
+        uint32_t u = U32();
+        float    f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+    uint32_t Varint()
+    {
+        uint32_t v = 0;
+        for(uint8_t shift = 0; shift < 35; shift += 7)
+        {
+            uint8_t byte = U8();
+            v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if(!(byte & 0x80))
+                return v;
+        }
+        ok = false;  // Longer than 5 bytes
+        return 0;
+    }
+    const uint8_t* Span(size_t n)
+    {
+        if(!Has(n))
+        {
+            ok = false;
+            return nullptr;
+        }
+        const uint8_t* p = &in[pos];
+        pos += n;
+        return p;
+    }
+    const uint8_t* Rest(size_t& n)
+    {
+        n = len - pos;
+        const uint8_t* p = &in[pos];
+        pos = len;
+        return p;
+    }
+};
+
+inline uint16_t Saturate16(uint32_t v)
+{
+    return v > 0xFFFF ? 0xFFFF : static_cast<uint16_t>(v);
+}
+
+// Payload-less commands (CMD_PLAY, CMD_STOP, ...)
+template <uint8_t Type>
+struct Empty
+{
+    static constexpr uint8_t TYPE     = Type;
+    static constexpr size_t  MAX_SIZE = 0;
+
+    size_t Encode(uint8_t*) const { return 0; }
+    bool   Decode(const uint8_t*, size_t) { return true; }
+};
+
+// Single-byte payloads ([track_id], [bank], [credits], ...)
+template <uint8_t Type>
+struct Byte
+{
+    static constexpr uint8_t TYPE     = Type;
+    static constexpr size_t  MAX_SIZE = 1;
+
+    uint8_t value;
+
+    size_t Encode(uint8_t* out) const
+    {
+        out[0] = value;
+        return 1;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        value = r.U8();
+        return r.ok;
+    }
+};
+
+// MIDI file slice, as used by MSG_SMF_DATA and CMD_SMF_IMPORT:
+// [offset:4][total:4][bytes...]
+template <uint8_t Type>
+struct SmfChunk
+{
+    static constexpr uint8_t TYPE        = Type;
+    static constexpr size_t  HEADER_SIZE = 8;
+    static constexpr size_t  MAX_DATA    = 240;
+    static constexpr size_t  MAX_SIZE    = HEADER_SIZE + MAX_DATA;
+
+    uint32_t       offset;  // File byte offset of data[0]
+    uint32_t       total;   // File size
+    const uint8_t* data;
+    size_t         len;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(offset);
+        w.U32(total);
+        w.Bytes(data, len < MAX_DATA ? len : MAX_DATA);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t size)
+    {
+        Reader r(in, size);
+        offset = r.U32();
+        total  = r.U32();
+        data   = r.Rest(len);
+        return r.ok && len <= MAX_DATA;
+    }
+};
+
+// 3-byte MIDI event, as used by MSG_MIDI_IN and MSG_MIDI_BATCH
+struct MidiEvent
+{
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+// ============================================================================
+// Daisy -> Companion
+// ============================================================================
+
+struct Tick
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_TICK;
+    static constexpr size_t  MAX_SIZE = 4;
+
+    uint32_t tick;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(tick);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        tick = r.U32();
+        return r.ok;
+    }
+};
+
+struct TransportState
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_TRANSPORT;
+    static constexpr size_t  MAX_SIZE = 4;
+
+    bool     playing;
+    bool     recording;
+    uint16_t bpm;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(playing ? 1 : 0);
+        w.U8(recording ? 1 : 0);
+        w.U16(bpm);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        playing   = r.U8() != 0;
+        recording = r.U8() != 0;
+        bpm       = r.U16();
+        return r.ok;
+    }
+};
+
+struct Voices
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_VOICES;
+    static constexpr size_t  MAX_SIZE = 2;
+
+    uint8_t synth;
+    uint8_t drums;
+
+    size_t Encode(uint8_t* out) const
+    {
+        out[0] = synth;
+        out[1] = drums;
+        return 2;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        synth = r.U8();
+        drums = r.U8();
+        return r.ok;
+    }
+};
+
+struct MidiIn
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_MIDI_IN;
+    static constexpr size_t  MAX_SIZE = 3;
+
+    MidiEvent event;
+
+    size_t Encode(uint8_t* out) const
+    {
+        out[0] = event.status;
+        out[1] = event.data1;
+        out[2] = event.data2;
+        return 3;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        event.status = r.U8();
+        event.data1  = r.U8();
+        event.data2  = r.U8();
+        return r.ok;
+    }
+};
+
+struct CcState
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_CC_STATE;
+    static constexpr size_t  MAX_SIZE = Protocol::MAX_PAYLOAD & ~size_t(1);
+
+    const uint8_t* pairs;  // [cc][value] x count
+    size_t         count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.Bytes(pairs, count * 2);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        pairs = in;
+        count = len / 2;
+        return true;
+    }
+};
+
+/**
+ * Legacy full synth dump (superseded by MSG_STATE_DELTA, kept for old builds)
+ * [osc1_wave:1][osc2_wave:1][osc1_level:f][osc2_level:f][detune+24:1]
+ * [cutoff:f][res:f][env_amt:f][amp ADSR:4f][filter ADSR:4f]
+ * [vel_to_amp:f][vel_to_filter:f][level:f][preset:1]
+ */
+struct SynthState
+{
+    static constexpr uint8_t TYPE       = Protocol::MSG_SYNTH_STATE;
+    static constexpr size_t  MAX_SIZE   = 68;
+    static constexpr uint8_t NUM_FLOATS = 15;  // After osc2_detune, before preset
+
+    uint8_t osc1_wave;
+    uint8_t osc2_wave;
+    float   osc1_level;
+    float   osc2_level;
+    int8_t  osc2_detune;
+    float   values[NUM_FLOATS];  // ParamId order from FILTER_CUTOFF to LEVEL
+    uint8_t preset;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(osc1_wave);
+        w.U8(osc2_wave);
+        w.F32(osc1_level);
+        w.F32(osc2_level);
+        w.U8(static_cast<uint8_t>(osc2_detune + 24));
+        for(uint8_t i = 0; i < NUM_FLOATS; i++)
+        {
+            w.F32(values[i]);
+        }
+        w.U8(preset);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        osc1_wave   = r.U8();
+        osc2_wave   = r.U8();
+        osc1_level  = r.F32();
+        osc2_level  = r.F32();
+        osc2_detune = static_cast<int8_t>(r.U8() - 24);
+        for(uint8_t i = 0; i < NUM_FLOATS; i++)
+        {
+            values[i] = r.F32();
+        }
+        preset = r.U8();
+        return r.ok;
+    }
+};
+
+typedef Byte<Protocol::MSG_CC_BANK> CcBank;
+
+struct FaderState
+{
+    static constexpr uint8_t TYPE       = Protocol::MSG_FADER_STATE;
+    static constexpr uint8_t NUM_FADERS = 9;
+    static constexpr size_t  MAX_SIZE   = NUM_FADERS;
+
+    uint8_t flags[NUM_FADERS];  // bit0 picked up, bit1 needs pickup
+
+    size_t Encode(uint8_t* out) const
+    {
+        memcpy(out, flags, NUM_FADERS);
+        return NUM_FADERS;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        if(len < NUM_FADERS)
+            return false;
+        memcpy(flags, in, NUM_FADERS);
+        return true;
+    }
+};
+
+struct MixerState
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_MIXER_STATE;
+    static constexpr size_t  MAX_SIZE = 21;
+
+    uint8_t drum_levels[8];  // All 0-127, pan 64 = centre
+    uint8_t drum_pans[8];
+    uint8_t drum_master;
+    uint8_t synth_level;
+    uint8_t synth_pan;
+    uint8_t synth_master;
+    uint8_t master_out;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.Bytes(drum_levels, 8);
+        w.Bytes(drum_pans, 8);
+        w.U8(drum_master);
+        w.U8(synth_level);
+        w.U8(synth_pan);
+        w.U8(synth_master);
+        w.U8(master_out);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        if(len < MAX_SIZE)
+            return false;
+        memcpy(drum_levels, in, 8);
+        memcpy(drum_pans, in + 8, 8);
+        drum_master  = in[16];
+        synth_level  = in[17];
+        synth_pan    = in[18];
+        synth_master = in[19];
+        master_out   = in[20];
+        return true;
+    }
+};
+
+struct TrackState
+{
+    static constexpr uint8_t TYPE       = Protocol::MSG_TRACK_STATE;
+    static constexpr uint8_t NUM_TRACKS = 4;
+    static constexpr size_t  MAX_SIZE   = NUM_TRACKS * 4;
+
+    struct Track
+    {
+        uint8_t id;
+        uint8_t status;  // Protocol::TrackStatus
+        uint8_t frozen_slot;
+        uint8_t source;
+    };
+    Track tracks[NUM_TRACKS];
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        for(uint8_t i = 0; i < NUM_TRACKS; i++)
+        {
+            w.U8(tracks[i].id);
+            w.U8(tracks[i].status);
+            w.U8(tracks[i].frozen_slot);
+            w.U8(tracks[i].source);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        for(uint8_t i = 0; i < NUM_TRACKS; i++)
+        {
+            tracks[i].id          = r.U8();
+            tracks[i].status      = r.U8();
+            tracks[i].frozen_slot = r.U8();
+            tracks[i].source      = r.U8();
+        }
+        return r.ok;
+    }
+};
+
+struct MidiBatch
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_MIDI_BATCH;
+    static constexpr size_t  MAX_SIZE = Protocol::MAX_BATCH_EVENTS * 3;
+
+    const MidiEvent* events;  // Decode leaves this null; use EventAt()
+    const uint8_t*   raw;
+    size_t           count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        for(size_t i = 0; i < count; i++)
+        {
+            w.U8(events[i].status);
+            w.U8(events[i].data1);
+            w.U8(events[i].data2);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        events = nullptr;
+        raw    = in;
+        count  = len / 3;
+        return len % 3 == 0;
+    }
+    MidiEvent EventAt(size_t i) const
+    {
+        MidiEvent e = {raw[i * 3], raw[i * 3 + 1], raw[i * 3 + 2]};
+        return e;
+    }
+};
+
+/**
+ * MSG_PATTERN_DUMP: [track_id:1][offset:2][count:2] + count x [tick:4][status][d1][d2]
+ * events points at count * EVENT_SIZE bytes already in wire layout
+ * (Sequencer::Engine::GetTrackEvents writes that layout directly).
+ */
+struct PatternDump
+{
+    static constexpr uint8_t TYPE        = Protocol::MSG_PATTERN_DUMP;
+    static constexpr size_t  HEADER_SIZE = 5;
+    static constexpr size_t  EVENT_SIZE  = 7;
+    static constexpr size_t  MAX_EVENTS  = (Protocol::MAX_PAYLOAD - HEADER_SIZE) / EVENT_SIZE;
+    static constexpr size_t  MAX_SIZE    = HEADER_SIZE + MAX_EVENTS * EVENT_SIZE;
+
+    uint8_t        track_id;
+    uint16_t       offset;
+    uint16_t       count;
+    const uint8_t* events;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(track_id);
+        w.U16(offset);
+        w.U16(count);
+        if(events != &out[HEADER_SIZE])  // Already in place when built by the sequencer
+        {
+            w.Bytes(events, count * EVENT_SIZE);
+        }
+        else
+        {
+            w.pos += count * EVENT_SIZE;
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        track_id = r.U8();
+        offset   = r.U16();
+        count    = r.U16();
+        events   = r.ok ? &in[HEADER_SIZE] : nullptr;
+        return r.ok && r.Has(count * EVENT_SIZE);
+    }
+};
+
+typedef Byte<Protocol::MSG_PATTERN_CLEAR> PatternClear;
+
+struct Resources
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_RESOURCES;
+    static constexpr size_t  MAX_SIZE = 9;
+
+    uint32_t memory_used;
+    uint32_t memory_total;
+    uint8_t  cpu_percent;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(memory_used);
+        w.U32(memory_total);
+        w.U8(cpu_percent);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        memory_used  = r.U32();
+        memory_total = r.U32();
+        cpu_percent  = r.U8();
+        return r.ok;
+    }
+};
+
+/**
+ * MSG_PATTERN_BULK: [seq:1][flags:1][stream...] (stream format in pattern_transfer.h)
+ */
+struct PatternBulk
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_PATTERN_BULK;
+    static constexpr size_t  MAX_SIZE = 1024;  // PatternTransfer::MAX_CHUNK
+
+    uint8_t        seq;
+    uint8_t        flags;
+    const uint8_t* data;
+    size_t         len;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(seq);
+        w.U8(flags);
+        w.Bytes(data, len);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t size)
+    {
+        Reader r(in, size);
+        seq   = r.U8();
+        flags = r.U8();
+        data  = r.Rest(len);
+        return r.ok;
+    }
+};
+
+/**
+ * MSG_STATE_DELTA: [version:2][base:2][flags:1] + n x [field:1][value:4]
+ * (field table in state_sync.h)
+ */
+struct StateDelta
+{
+    static constexpr uint8_t TYPE        = Protocol::MSG_STATE_DELTA;
+    static constexpr size_t  HEADER_SIZE = 5;
+    static constexpr size_t  ENTRY_SIZE  = 5;
+    static constexpr size_t  MAX_SIZE    = Protocol::MAX_PAYLOAD;
+
+    struct Entry
+    {
+        uint8_t  field;
+        uint32_t value;
+    };
+
+    uint16_t       version;
+    uint16_t       base;
+    uint8_t        flags;
+    const Entry*   entries;  // Encode side
+    const uint8_t* raw;      // Decode side, see EntryAt()
+    size_t         count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U16(version);
+        w.U16(base);
+        w.U8(flags);
+        for(size_t i = 0; i < count; i++)
+        {
+            w.U8(entries[i].field);
+            w.U32(entries[i].value);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        version = r.U16();
+        base    = r.U16();
+        flags   = r.U8();
+        entries = nullptr;
+        size_t rest;
+        raw   = r.Rest(rest);
+        count = rest / ENTRY_SIZE;
+        return r.ok && rest % ENTRY_SIZE == 0;
+    }
+    Entry EntryAt(size_t i) const
+    {
+        Reader r(&raw[i * ENTRY_SIZE], ENTRY_SIZE);
+        Entry  e;
+        e.field = r.U8();
+        e.value = r.U32();
+        return e;
+    }
+};
+
+typedef Empty<Protocol::MSG_LINK_GAP> LinkGap;
+
+struct ClockSync
+{
+    static constexpr uint8_t TYPE         = Protocol::MSG_CLOCK_SYNC;
+    static constexpr size_t  MAX_SIZE     = 21;
+    static constexpr uint8_t FLAG_RUNNING = 0x01;
+
+    uint32_t sample;         // Audio sample counter at the anchor
+    uint32_t tick;
+    uint16_t phase;          // Q16 fraction towards the next tick
+    uint16_t bpm;
+    uint32_t pattern_ticks;
+    uint32_t sample_rate;    // Hz
+    uint8_t  flags;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(sample);
+        w.U32(tick);
+        w.U16(phase);
+        w.U16(bpm);
+        w.U32(pattern_ticks);
+        w.U32(sample_rate);
+        w.U8(flags);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        sample        = r.U32();
+        tick          = r.U32();
+        phase         = r.U16();
+        bpm           = r.U16();
+        pattern_ticks = r.U32();
+        sample_rate   = r.U32();
+        flags         = r.U8();
+        return r.ok;
+    }
+};
+
+/**
+ * MSG_TELEMETRY: [flags:1][clip:1][peak:1 x4][rms:1 x4]
+ *   + if FLAG_SCOPE:    [decimation:1][count:1][sample:int8 x count]
+ *   + if FLAG_SPECTRUM: [count:1][band:1 x count]
+ * Levels and bands are half-dB steps above -100 dBFS (0 = silence); see
+ * telemetry.h. scope/bands point into the caller's buffer.
+ */
+struct Telemetry
+{
+    static constexpr uint8_t TYPE          = Protocol::MSG_TELEMETRY;
+    static constexpr uint8_t NUM_BUSES     = 4;
+    static constexpr uint8_t FLAG_SCOPE    = 0x02;
+    static constexpr uint8_t FLAG_SPECTRUM = 0x04;
+    static constexpr size_t  MAX_SCOPE     = 128;
+    static constexpr size_t  MAX_BANDS     = 64;
+    static constexpr size_t  MAX_SIZE      = 2 + 2 * NUM_BUSES + 2 + MAX_SCOPE + 1 + MAX_BANDS;
+
+    uint8_t        flags;
+    uint8_t        clip;
+    uint8_t        peak[NUM_BUSES];
+    uint8_t        rms[NUM_BUSES];
+    uint8_t        decimation;
+    const int8_t*  scope;
+    size_t         scope_count;
+    const uint8_t* bands;
+    size_t         band_count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(flags);
+        w.U8(clip);
+        w.Bytes(peak, NUM_BUSES);
+        w.Bytes(rms, NUM_BUSES);
+        if(flags & FLAG_SCOPE)
+        {
+            w.U8(decimation);
+            w.U8(static_cast<uint8_t>(scope_count));
+            w.Bytes(reinterpret_cast<const uint8_t*>(scope), scope_count);
+        }
+        if(flags & FLAG_SPECTRUM)
+        {
+            w.U8(static_cast<uint8_t>(band_count));
+            w.Bytes(bands, band_count);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        flags = r.U8();
+        clip  = r.U8();
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+            peak[b] = r.U8();
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+            rms[b] = r.U8();
+        decimation  = 0;
+        scope       = nullptr;
+        scope_count = 0;
+        bands       = nullptr;
+        band_count  = 0;
+        if(r.ok && (flags & FLAG_SCOPE))
+        {
+            decimation  = r.U8();
+            scope_count = r.U8();
+            scope       = reinterpret_cast<const int8_t*>(r.Span(scope_count));
+        }
+        if(r.ok && (flags & FLAG_SPECTRUM))
+        {
+            band_count = r.U8();
+            bands      = r.Span(band_count);
+        }
+        if(!r.ok)
+        {
+            scope_count = 0;
+            band_count  = 0;
+        }
+        return r.ok;
+    }
+};
+
+struct VoiceDiag
+{
+    static constexpr uint8_t TYPE        = Protocol::MSG_VOICE_DIAG;
+    static constexpr size_t  HEADER_SIZE = 3;
+    static constexpr size_t  VOICE_SIZE  = 12;
+    static constexpr size_t  MAX_VOICES  = 8;
+    static constexpr size_t  MAX_SIZE    = HEADER_SIZE + MAX_VOICES * VOICE_SIZE;
+
+    static constexpr uint8_t STATE_ACTIVE      = 0x01;
+    static constexpr uint8_t STATE_GATE        = 0x02;
+    static constexpr uint8_t STATE_STAGE_SHIFT = 4;
+
+    struct Voice
+    {
+        uint8_t  note;
+        uint8_t  velocity;
+        uint8_t  state;
+        uint8_t  env;              // Amp envelope 0-255
+        uint16_t age_ms;           // Saturates at 65535
+        uint32_t release_samples;
+        uint16_t cutoff_hz;
+    };
+
+    uint8_t cpu_percent;
+    uint8_t active;
+    Voice   voices[MAX_VOICES];
+    size_t  count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(cpu_percent);
+        w.U8(active);
+        w.U8(static_cast<uint8_t>(count));
+        for(size_t i = 0; i < count; i++)
+        {
+            const Voice& v = voices[i];
+            w.U8(v.note);
+            w.U8(v.velocity);
+            w.U8(v.state);
+            w.U8(v.env);
+            w.U16(v.age_ms);
+            w.U32(v.release_samples);
+            w.U16(v.cutoff_hz);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        cpu_percent = r.U8();
+        active      = r.U8();
+        count       = r.U8();
+        if(count > MAX_VOICES)
+            return false;
+        for(size_t i = 0; i < count; i++)
+        {
+            Voice& v          = voices[i];
+            v.note            = r.U8();
+            v.velocity        = r.U8();
+            v.state           = r.U8();
+            v.env             = r.U8();
+            v.age_ms          = r.U16();
+            v.release_samples = r.U32();
+            v.cutoff_hz       = r.U16();
+        }
+        return r.ok;
+    }
+};
+
+struct TaskStats
+{
+    static constexpr uint8_t TYPE        = Protocol::MSG_TASK_STATS;
+    static constexpr size_t  MAX_TASKS   = 12;
+    static constexpr size_t  MAX_NAME    = 8;
+    static constexpr size_t  ENTRY_FIXED = 1 + 1 + 2 * 4 + 2;  // Everything but the name
+    static constexpr size_t  MAX_SIZE    = 3 + MAX_TASKS * (ENTRY_FIXED + MAX_NAME);
+
+    struct Entry
+    {
+        const char* name;  // Not terminated; truncated to MAX_NAME
+        size_t      name_len;
+        uint8_t     priority;
+        uint16_t    runs;
+        uint16_t    avg_us;
+        uint16_t    max_us;
+        uint16_t    max_late_ms;
+        uint8_t     overruns;
+        uint8_t     deferred;
+    };
+
+    uint16_t max_pass_us;
+    Entry    tasks[MAX_TASKS];
+    size_t   count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U16(max_pass_us);
+        w.U8(static_cast<uint8_t>(count));
+        for(size_t i = 0; i < count; i++)
+        {
+            const Entry& e   = tasks[i];
+            size_t       len = e.name_len < MAX_NAME ? e.name_len : MAX_NAME;
+            w.U8(static_cast<uint8_t>(len));
+            w.Bytes(reinterpret_cast<const uint8_t*>(e.name), len);
+            w.U8(e.priority);
+            w.U16(e.runs);
+            w.U16(e.avg_us);
+            w.U16(e.max_us);
+            w.U16(e.max_late_ms);
+            w.U8(e.overruns);
+            w.U8(e.deferred);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        max_pass_us = r.U16();
+        count       = r.U8();
+        if(count > MAX_TASKS)
+            return false;
+        for(size_t i = 0; i < count && r.ok; i++)
+        {
+            Entry& e      = tasks[i];
+            e.name_len    = r.U8();
+            e.name        = reinterpret_cast<const char*>(r.Span(e.name_len));
+            e.priority    = r.U8();
+            e.runs        = r.U16();
+            e.avg_us      = r.U16();
+            e.max_us      = r.U16();
+            e.max_late_ms = r.U16();
+            e.overruns    = r.U8();
+            e.deferred    = r.U8();
+        }
+        return r.ok;
+    }
+};
+
+typedef SmfChunk<Protocol::MSG_SMF_DATA> SmfData;
+
+/**
+ * MSG_SMF_STATUS: [op:1][state:1][offset:4][notes:2][points:2][dropped:2]
+ */
+struct SmfStatus
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_SMF_STATUS;
+    static constexpr size_t  MAX_SIZE = 12;
+
+    uint8_t            op;
+    Protocol::SmfState state;
+    uint32_t           offset;
+    uint16_t           notes;
+    uint16_t           points;
+    uint16_t           dropped;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(op);
+        w.U8(static_cast<uint8_t>(state));
+        w.U32(offset);
+        w.U16(notes);
+        w.U16(points);
+        w.U16(dropped);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        op      = r.U8();
+        state   = static_cast<Protocol::SmfState>(r.U8());
+        offset  = r.U32();
+        notes   = r.U16();
+        points  = r.U16();
+        dropped = r.U16();
+        return r.ok;
+    }
+};
+
+/**
+ * MSG_AUDIO_CONFIG: [rate:4][block:2][latency_us:4][state:1]
+ */
+struct AudioStatus
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_AUDIO_CONFIG;
+    static constexpr size_t  MAX_SIZE = 11;
+
+    uint32_t             rate;
+    uint16_t             block;
+    uint32_t             latency_us;
+    Protocol::AudioState state;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(rate);
+        w.U16(block);
+        w.U32(latency_us);
+        w.U8(static_cast<uint8_t>(state));
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        rate       = r.U32();
+        block      = r.U16();
+        latency_us = r.U32();
+        state      = static_cast<Protocol::AudioState>(r.U8());
+        return r.ok;
+    }
+};
+
+/**
+ * MSG_AUDIO_BENCH: [index:1][count:1][rate:4][block:2][avg_load:2][max_load:2]
+ * Loads in 0.01% of the block period.
+ */
+struct AudioBench
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_AUDIO_BENCH;
+    static constexpr size_t  MAX_SIZE = 12;
+
+    uint8_t  index;
+    uint8_t  count;
+    uint32_t rate;
+    uint16_t block;
+    uint16_t avg_load;
+    uint16_t max_load;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(index);
+        w.U8(count);
+        w.U32(rate);
+        w.U16(block);
+        w.U16(avg_load);
+        w.U16(max_load);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        index    = r.U8();
+        count    = r.U8();
+        rate     = r.U32();
+        block    = r.U16();
+        avg_load = r.U16();
+        max_load = r.U16();
+        return r.ok;
+    }
+};
+
+struct Debug
+{
+    static constexpr uint8_t TYPE     = Protocol::MSG_DEBUG;
+    static constexpr size_t  MAX_SIZE = Protocol::MAX_PAYLOAD;
+
+    const char* text;
+    size_t      len;
+
+    size_t Encode(uint8_t* out) const
+    {
+        size_t n = len > MAX_SIZE ? MAX_SIZE : len;
+        memcpy(out, text, n);
+        return n;
+    }
+    bool Decode(const uint8_t* in, size_t size)
+    {
+        text = reinterpret_cast<const char*>(in);
+        len  = size;
+        return true;
+    }
+};
+
+// ============================================================================
+// Companion -> Daisy
+// ============================================================================
+
+typedef Empty<Protocol::CMD_PLAY>      Play;
+typedef Empty<Protocol::CMD_STOP>      Stop;
+typedef Empty<Protocol::CMD_RECORD>    Record;
+typedef Empty<Protocol::CMD_REQ_STATE> ReqState;
+typedef Empty<Protocol::CMD_REQ_SYNTH> ReqSynth;
+
+struct Tempo
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_TEMPO;
+    static constexpr size_t  MAX_SIZE = 2;
+
+    uint16_t bpm;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U16(bpm);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        bpm = r.U16();
+        return r.ok;
+    }
+};
+
+typedef Byte<Protocol::CMD_PATTERN> SelectPattern;
+
+struct SynthParam
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_SYNTH_PARAM;
+    static constexpr size_t  MAX_SIZE = 5;
+
+    uint8_t param_id;  // Synth::ParamId
+    float   value;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(param_id);
+        w.F32(value);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        param_id = r.U8();
+        value    = r.F32();
+        return r.ok;
+    }
+};
+
+struct LoadPreset
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_LOAD_PRESET;
+    static constexpr size_t  MAX_SIZE = 3;
+
+    uint8_t  preset;
+    uint16_t morph_ms;  // 0 = switch instantly (field omitted on the wire)
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(preset);
+        if(morph_ms > 0)
+        {
+            w.U16(morph_ms);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        preset   = r.U8();
+        morph_ms = r.Has(2) ? r.U16() : 0;
+        return r.ok;
+    }
+};
+
+typedef Byte<Protocol::CMD_SET_BANK>       SetBank;
+typedef Byte<Protocol::CMD_FREEZE_TRACK>   FreezeTrack;
+typedef Byte<Protocol::CMD_UNFREEZE_TRACK> UnfreezeTrack;
+typedef Byte<Protocol::CMD_BULK_ACK>       BulkAck;
+typedef Byte<Protocol::CMD_LINK_CONFIG>    LinkConfig;
+
+struct ReqPattern
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_REQ_PATTERN;
+    static constexpr size_t  MAX_SIZE = 1;
+
+    bool    all_tracks;  // No track id: every track as one bulk stream
+    uint8_t track_id;
+
+    size_t Encode(uint8_t* out) const
+    {
+        if(all_tracks)
+            return 0;
+        out[0] = track_id;
+        return 1;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        all_tracks = len == 0;
+        track_id   = all_tracks ? 0 : in[0];
+        return true;
+    }
+};
+
+struct BulkConfig
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_BULK_CONFIG;
+    static constexpr size_t  MAX_SIZE = 3;
+
+    uint16_t max_chunk;
+    uint8_t  window;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U16(max_chunk);
+        w.U8(window);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        max_chunk = r.U16();
+        window    = r.U8();
+        return r.ok;
+    }
+};
+
+struct StateAck
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_STATE_ACK;
+    static constexpr size_t  MAX_SIZE = 2;
+
+    uint16_t version;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U16(version);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        version = r.U16();
+        return r.ok;
+    }
+};
+
+struct LinkNak
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_LINK_NAK;
+    static constexpr size_t  MAX_SIZE = Protocol::MAX_PAYLOAD;
+
+    const uint8_t* seqs;
+    size_t         count;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.Bytes(seqs, count);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        seqs  = in;
+        count = len;
+        return true;
+    }
+};
+
+/**
+ * CMD_TELEMETRY_CONFIG: [flags:1][interval_ms:2][decimation:1]
+ * flags: bit0 enable, bit1 scope, bit2 spectrum
+ */
+struct TelemetryConfig
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_TELEMETRY_CONFIG;
+    static constexpr size_t  MAX_SIZE = 4;
+
+    uint8_t  flags;
+    uint16_t interval_ms;
+    uint8_t  decimation;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U8(flags);
+        w.U16(interval_ms);
+        w.U8(decimation);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        flags       = r.U8();
+        interval_ms = r.U16();
+        decimation  = r.U8();
+        return r.ok;
+    }
+};
+
+typedef SmfChunk<Protocol::CMD_SMF_IMPORT> SmfImport;
+
+struct SmfExport
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_SMF_EXPORT;
+    static constexpr size_t  MAX_SIZE = 4;
+
+    uint32_t offset;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        w.U32(offset);
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        offset = r.U32();
+        return r.ok;
+    }
+};
+
+/**
+ * CMD_AUDIO_CONFIG: [rate:4][block:2], or [] to report the current settings
+ */
+struct AudioConfigCmd
+{
+    static constexpr uint8_t TYPE     = Protocol::CMD_AUDIO_CONFIG;
+    static constexpr size_t  MAX_SIZE = 6;
+
+    bool     query;  // No payload: just answer with MSG_AUDIO_CONFIG
+    uint32_t rate;
+    uint16_t block;
+
+    size_t Encode(uint8_t* out) const
+    {
+        Writer w(out);
+        if(!query)
+        {
+            w.U32(rate);
+            w.U16(block);
+        }
+        return w.pos;
+    }
+    bool Decode(const uint8_t* in, size_t len)
+    {
+        Reader r(in, len);
+        query = len == 0;
+        rate  = 0;
+        block = 0;
+        if(query)
+            return true;
+        rate  = r.U32();
+        block = r.U16();
+        return r.ok;
+    }
+};
+
+typedef Empty<Protocol::CMD_AUDIO_BENCH> AudioBenchCmd;
+
+/**
+ * Decode the parser's current message into M
+ * Returns false if the type does not match or the payload is short.
+ */
+template <typename M>
+bool Decode(const Protocol::Parser& parser, M& msg)
+{
+    return parser.type == M::TYPE && msg.Decode(parser.payload, parser.payload_len);
+}
+
+} // namespace ProtocolCodec
+
+#endif // GROOVYDAISY_PROTOCOL_CODEC_H
@@ -0,0 +1,146 @@
+#pragma once
+#ifndef GROOVYDAISY_RELIABLE_LINK_H
+#define GROOVYDAISY_RELIABLE_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "protocol.h"
+
+/**
+ * GroovyDaisy Reliable Bulk Link
+ *
+ * Once the companion enables it (CMD_LINK_CONFIG), bulk messages (pattern
+ * dumps and bulk pattern chunks) go out in the framed format: CRC-16 plus a
+ * per-message sequence number. Each framed message is also kept in a small
+ * history so that a CMD_LINK_NAK for a lost or corrupted one can be
+ * answered with an exact retransmit rather than restarting the transfer.
+ *
+ * A NAK for a message that has already left the history is answered with
+ * MSG_LINK_GAP under the same sequence number, so the receiver's in-order
+ * delivery can continue and the owner of the data can re-request it.
+ *
+ * Main loop only.
+ */
+
+namespace ReliableLink
+{
+
+// Messages kept for retransmit (power of two, covers the largest bulk window twice)
+constexpr uint8_t HISTORY_SIZE = 32;
+
+// Largest framed payload kept in the history (bulk chunks are the biggest)
+constexpr uint16_t MAX_FRAMED_PAYLOAD = 1024;
+
+/**
+ * Message types sent framed when the link is enabled
+ */
+inline bool IsBulkType(uint8_t type)
+{
+    return type == Protocol::MSG_PATTERN_BULK || type == Protocol::MSG_PATTERN_DUMP;
+}
+
+struct Stats
+{
+    uint32_t framed;       // Framed messages sent (first transmission)
+    uint32_t retransmits;  // Messages resent after a NAK
+    uint32_t gaps;         // NAKs for messages no longer in the history
+};
+
+class History
+{
+  public:
+    void Init()
+    {
+        enabled_  = false;
+        next_seq_ = 0;
+        for(uint8_t i = 0; i < HISTORY_SIZE; i++)
+        {
+            entries_[i].valid = false;
+        }
+        stats_ = Stats();
+    }
+
+    /**
+     * Turn framing on/off (CMD_LINK_CONFIG); either way starts a fresh sequence
+     */
+    void Configure(uint8_t flags)
+    {
+        enabled_  = (flags & Protocol::LINK_FLAG_FRAMED) != 0;
+        next_seq_ = 0;
+        for(uint8_t i = 0; i < HISTORY_SIZE; i++)
+        {
+            entries_[i].valid = false;
+        }
+    }
+
+    bool ShouldFrame(uint8_t type) const { return enabled_ && IsBulkType(type); }
+
+    /**
+     * Record a message about to be sent framed; returns its sequence number
+     */
+    uint8_t Store(uint8_t type, const uint8_t* payload, uint16_t len)
+    {
+        uint8_t seq = next_seq_++;
+        Entry&  e   = entries_[seq & (HISTORY_SIZE - 1)];
+        e.valid     = len <= MAX_FRAMED_PAYLOAD;
+        e.seq       = seq;
+        e.type      = type;
+        e.len       = len;
+        if(e.valid && len > 0)
+        {
+            memcpy(e.payload, payload, len);
+        }
+        stats_.framed++;
+        return seq;
+    }
+
+    /**
+     * Look up a NAKed message
+     * Returns false (and counts a gap) if it is no longer held.
+     */
+    bool Find(uint8_t seq, uint8_t& type, const uint8_t*& payload, uint16_t& len)
+    {
+        const Entry& e = entries_[seq & (HISTORY_SIZE - 1)];
+        // Only sequence numbers handed out since the last Configure() are valid
+        if(!e.valid || e.seq != seq || static_cast<uint8_t>(next_seq_ - seq - 1) >= HISTORY_SIZE)
+        {
+            stats_.gaps++;
+            return false;
+        }
+        type    = e.type;
+        payload = e.payload;
+        len     = e.len;
+        stats_.retransmits++;
+        return true;
+    }
+
+    /**
+     * True for a sequence number not handed out yet (NAKed ahead of time
+     * after a corrupted frame); such NAKs are ignored rather than answered
+     * with a gap
+     */
+    bool IsUnsent(uint8_t seq) const { return static_cast<uint8_t>(seq - next_seq_) < 128; }
+
+    bool         IsEnabled() const { return enabled_; }
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct Entry
+    {
+        uint8_t  payload[MAX_FRAMED_PAYLOAD];
+        uint16_t len;
+        uint8_t  seq;
+        uint8_t  type;
+        bool     valid;
+    };
+
+    Entry   entries_[HISTORY_SIZE];
+    uint8_t next_seq_;
+    bool    enabled_;
+    Stats   stats_;
+};
+
+} // namespace ReliableLink
+
+#endif // GROOVYDAISY_RELIABLE_LINK_H
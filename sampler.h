@@ -4,14 +4,25 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <math.h>
 
 /**
  * GroovyDaisy Sample-Based Drum Engine
  *
  * 8-voice polyphonic sample playback engine for drum sounds.
  * Samples are stored in SDRAM as float arrays.
+ *
+ * Attack cache: the first ATTACK_CACHE_SAMPLES of every loaded sample are
+ * mirrored into the engine (internal RAM). A trigger reads the transient
+ * from there while the SDRAM continuation is prefetched, so simultaneous
+ * hits don't all stall on SDRAM cache misses at the same moment.
  */
 
+// Set to 0 to read everything from SDRAM (for before/after stall measurement)
+#ifndef SAMPLER_ATTACK_CACHE
+#define SAMPLER_ATTACK_CACHE 1
+#endif
+
 namespace Sampler
 {
 
@@ -21,20 +32,34 @@ constexpr uint8_t FIRST_PAD_NOTE = 36;  // KeyLab pads start at note 36
 constexpr uint8_t LAST_PAD_NOTE = 43;   // 8 pads: 36-43
 constexpr uint8_t DRUM_CHANNEL = 9;     // Channel 10 (0-indexed = 9)
 
+// Decay rates are given per sample at this rate (see Engine::SetSampleRate)
+constexpr float REFERENCE_RATE = 48000.0f;
+
+// Attack cache: 5 ms at 48 kHz mirrored in internal RAM per slot
+constexpr size_t ATTACK_CACHE_SAMPLES = 240;
+
+// SDRAM prefetch: one 32-byte cache line (8 floats) per step, two lines ahead
+constexpr size_t PREFETCH_STRIDE = 8;
+constexpr size_t PREFETCH_AHEAD  = 16;
+
 /**
  * Sample slot - points to sample data in SDRAM
  */
 struct Sample
 {
-    const float* data;     // Pointer to sample data
-    size_t       length;   // Length in samples
-    const char*  name;     // Sample name (for debugging)
+    const float* data;           // Pointer to sample data
+    size_t       length;         // Length in samples
+    const char*  name;           // Sample name (for debugging)
+    const float* attack;         // Cached prefix in internal RAM (or nullptr)
+    size_t       attack_length;  // Samples available in the cached prefix
 
     void Clear()
     {
-        data   = nullptr;
-        length = 0;
-        name   = nullptr;
+        data          = nullptr;
+        length        = 0;
+        name          = nullptr;
+        attack        = nullptr;
+        attack_length = 0;
     }
 };
 
@@ -45,6 +70,8 @@ struct DrumVoice
 {
     const float* sample_data;    // Pointer to sample data
     size_t       sample_length;  // Length in samples
+    const float* attack_data;    // Cached prefix in internal RAM
+    size_t       attack_length;  // Length of cached prefix
     size_t       play_head;      // Current position
     float        amplitude;      // Current envelope level
     float        decay;          // Envelope decay rate (per sample)
@@ -58,6 +85,8 @@ struct DrumVoice
     {
         sample_data   = nullptr;
         sample_length = 0;
+        attack_data   = nullptr;
+        attack_length = 0;
         play_head     = 0;
         amplitude     = 0.0f;
         decay         = 0.9999f;  // Long decay by default
@@ -75,10 +104,18 @@ struct DrumVoice
     {
         sample_data   = sample.data;
         sample_length = sample.length;
+        attack_data   = sample.attack;
+        attack_length = sample.attack != nullptr ? sample.attack_length : 0;
         play_head     = 0;
         amplitude     = 1.0f;
         velocity      = vel;
         playing       = true;
+
+        // Start pulling the SDRAM continuation in while the cached prefix plays
+        if(attack_length < sample_length)
+        {
+            __builtin_prefetch(&sample_data[attack_length]);
+        }
     }
 
     /**
@@ -96,14 +133,25 @@ struct DrumVoice
         size_t idx      = static_cast<size_t>(pos);
         float  frac     = pos - static_cast<float>(idx);
 
+        // Read the transient from the attack cache, the rest from SDRAM
+        const float* src = sample_data;
+        if(idx + 1 < attack_length)
+        {
+            src = attack_data;
+        }
+        else if(idx % PREFETCH_STRIDE == 0 && idx + PREFETCH_AHEAD < sample_length)
+        {
+            __builtin_prefetch(&sample_data[idx + PREFETCH_AHEAD]);
+        }
+
         float out = 0.0f;
         if(idx < sample_length)
         {
-            out = sample_data[idx];
+            out = src[idx];
             // Interpolate with next sample if available
             if(idx + 1 < sample_length)
             {
-                out += frac * (sample_data[idx + 1] - out);
+                out += frac * (src[idx + 1] - out);
             }
         }
 
@@ -141,9 +189,27 @@ class Engine
         {
             voices_[i].Init();
             samples_[i].Clear();
+            decay_[i] = voices_[i].decay;
         }
         active_count_ = 0;
         master_level_ = 1.0f;
+        rate_scale_   = 1.0f;
+    }
+
+    /**
+     * Retune the per-sample decay envelopes for a sample rate
+     * Samples themselves are generated at the new rate (drums.h). Call with
+     * audio stopped, before reloading the samples.
+     */
+    void SetSampleRate(float sample_rate)
+    {
+        rate_scale_ = REFERENCE_RATE / sample_rate;
+        for(uint8_t i = 0; i < NUM_VOICES; i++)
+        {
+            voices_[i].playing = false;
+            voices_[i].decay   = powf(decay_[i], rate_scale_);
+        }
+        active_count_ = 0;
     }
 
     /**
@@ -157,6 +223,17 @@ class Engine
         samples_[slot].data   = data;
         samples_[slot].length = length;
         samples_[slot].name   = name;
+
+#if SAMPLER_ATTACK_CACHE
+        // Mirror the transient into internal RAM (call from main loop, not audio)
+        size_t cached = length < ATTACK_CACHE_SAMPLES ? length : ATTACK_CACHE_SAMPLES;
+        for(size_t i = 0; i < cached; i++)
+        {
+            attack_cache_[slot][i] = data[i];
+        }
+        samples_[slot].attack        = attack_cache_[slot];
+        samples_[slot].attack_length = cached;
+#endif
     }
 
     /**
@@ -185,6 +262,15 @@ class Engine
         if(channel != DRUM_CHANNEL)
             return false;
 
+        return TriggerNote(note, velocity);
+    }
+
+    /**
+     * Trigger by pad note (36-43) regardless of channel (used by MidiRouter)
+     * Returns true if note was handled
+     */
+    bool TriggerNote(uint8_t note, uint8_t velocity)
+    {
         // Only respond to pad notes
         if(note < FIRST_PAD_NOTE || note > LAST_PAD_NOTE)
             return false;
@@ -279,13 +365,14 @@ class Engine
     }
 
     /**
-     * Set per-voice decay rate
+     * Set per-voice decay rate (per sample at REFERENCE_RATE)
      */
     void SetDecay(uint8_t voice, float decay)
     {
         if(voice < NUM_VOICES)
         {
-            voices_[voice].decay = decay;
+            decay_[voice]        = decay;
+            voices_[voice].decay = powf(decay, rate_scale_);
         }
     }
 
@@ -356,8 +443,13 @@ class Engine
   private:
     DrumVoice        voices_[NUM_VOICES];
     Sample           samples_[NUM_VOICES];
+#if SAMPLER_ATTACK_CACHE
+    float            attack_cache_[NUM_VOICES][ATTACK_CACHE_SAMPLES];
+#endif
     volatile uint8_t active_count_;
     float            master_level_;
+    float            decay_[NUM_VOICES];  // At REFERENCE_RATE
+    float            rate_scale_;         // REFERENCE_RATE / sample rate
 };
 
 } // namespace Sampler
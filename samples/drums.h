@@ -8,13 +8,15 @@
  * Simple synthesized drum sounds for testing.
  * These can be replaced with real samples later.
  *
- * All samples are mono, 48kHz, normalized to -1.0 to 1.0
+ * All samples are mono, at the audio sample rate, normalized to -1.0 to 1.0
  */
 
 #include <stddef.h>
 #include <cmath>
+#include "../audio_config.h"
 
-// Sample rate for calculations
+// Rate the sample lengths below are given at (samples are generated at the
+// session's rate, see SampleBank::Generate)
 constexpr float SAMPLE_RATE = 48000.0f;
 
 // Pi constant - use different name to avoid conflict with DaisySP
@@ -24,7 +26,7 @@ constexpr float DRUM_PI = 3.14159265358979323846f;
  * Generate samples at compile time is not practical in C++,
  * so we generate them at runtime into SDRAM.
  *
- * Sample lengths (in samples at 48kHz):
+ * Sample lengths (in samples at 48kHz, scaled for other rates):
  * - Kick: ~0.3 sec = 14400 samples
  * - Snare: ~0.25 sec = 12000 samples
  * - Closed HH: ~0.1 sec = 4800 samples
@@ -67,13 +69,13 @@ inline float Noise(uint32_t& seed)
  * Generate kick drum sample
  * Low sine wave with pitch drop and amplitude decay
  */
-inline void GenerateKick(float* buffer, size_t length)
+inline void GenerateKick(float* buffer, size_t length, float sample_rate)
 {
     float phase = 0.0f;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Frequency sweep: 150Hz down to 50Hz
         float freq = 50.0f + 100.0f * expf(-t * 20.0f);
@@ -88,7 +90,7 @@ inline void GenerateKick(float* buffer, size_t length)
         }
 
         // Generate sine
-        phase += (2.0f * DRUM_PI * freq) / SAMPLE_RATE;
+        phase += (2.0f * DRUM_PI * freq) / sample_rate;
         if(phase > 2.0f * DRUM_PI)
             phase -= 2.0f * DRUM_PI;
 
@@ -100,20 +102,20 @@ inline void GenerateKick(float* buffer, size_t length)
  * Generate snare drum sample
  * Pitched body (sine) + noise (snares)
  */
-inline void GenerateSnare(float* buffer, size_t length)
+inline void GenerateSnare(float* buffer, size_t length, float sample_rate)
 {
     uint32_t seed = 12345;
     float    phase = 0.0f;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Body: 200Hz sine with fast decay
         float body_freq = 180.0f;
         float body_amp  = expf(-t * 25.0f);
 
-        phase += (2.0f * DRUM_PI * body_freq) / SAMPLE_RATE;
+        phase += (2.0f * DRUM_PI * body_freq) / sample_rate;
         if(phase > 2.0f * DRUM_PI)
             phase -= 2.0f * DRUM_PI;
 
@@ -132,13 +134,13 @@ inline void GenerateSnare(float* buffer, size_t length)
  * Generate closed hi-hat sample
  * High frequency noise with very short decay
  */
-inline void GenerateHihatClosed(float* buffer, size_t length)
+inline void GenerateHihatClosed(float* buffer, size_t length, float sample_rate)
 {
     uint32_t seed = 67890;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Very short envelope
         float amp = expf(-t * 50.0f);
@@ -151,13 +153,13 @@ inline void GenerateHihatClosed(float* buffer, size_t length)
  * Generate open hi-hat sample
  * High frequency noise with longer decay
  */
-inline void GenerateHihatOpen(float* buffer, size_t length)
+inline void GenerateHihatOpen(float* buffer, size_t length, float sample_rate)
 {
     uint32_t seed = 11111;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Longer envelope
         float amp = expf(-t * 8.0f);
@@ -170,13 +172,13 @@ inline void GenerateHihatOpen(float* buffer, size_t length)
  * Generate clap sample
  * Multiple noise bursts with smoother envelope
  */
-inline void GenerateClap(float* buffer, size_t length)
+inline void GenerateClap(float* buffer, size_t length, float sample_rate)
 {
     uint32_t seed = 22222;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Create multiple short bursts using overlapping envelopes
         float amp = 0.0f;
@@ -205,13 +207,13 @@ inline void GenerateClap(float* buffer, size_t length)
 /**
  * Generate low tom sample
  */
-inline void GenerateTomLow(float* buffer, size_t length)
+inline void GenerateTomLow(float* buffer, size_t length, float sample_rate)
 {
     float phase = 0.0f;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Frequency with slight pitch drop
         float freq = 80.0f + 40.0f * expf(-t * 10.0f);
@@ -219,7 +221,7 @@ inline void GenerateTomLow(float* buffer, size_t length)
         // Envelope
         float amp = expf(-t * 6.0f);
 
-        phase += (2.0f * DRUM_PI * freq) / SAMPLE_RATE;
+        phase += (2.0f * DRUM_PI * freq) / sample_rate;
         if(phase > 2.0f * DRUM_PI)
             phase -= 2.0f * DRUM_PI;
 
@@ -230,13 +232,13 @@ inline void GenerateTomLow(float* buffer, size_t length)
 /**
  * Generate mid tom sample
  */
-inline void GenerateTomMid(float* buffer, size_t length)
+inline void GenerateTomMid(float* buffer, size_t length, float sample_rate)
 {
     float phase = 0.0f;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Frequency with slight pitch drop
         float freq = 120.0f + 50.0f * expf(-t * 12.0f);
@@ -244,7 +246,7 @@ inline void GenerateTomMid(float* buffer, size_t length)
         // Envelope
         float amp = expf(-t * 8.0f);
 
-        phase += (2.0f * DRUM_PI * freq) / SAMPLE_RATE;
+        phase += (2.0f * DRUM_PI * freq) / sample_rate;
         if(phase > 2.0f * DRUM_PI)
             phase -= 2.0f * DRUM_PI;
 
@@ -256,20 +258,20 @@ inline void GenerateTomMid(float* buffer, size_t length)
  * Generate rim shot sample
  * Short high-pitched click
  */
-inline void GenerateRim(float* buffer, size_t length)
+inline void GenerateRim(float* buffer, size_t length, float sample_rate)
 {
     uint32_t seed  = 33333;
     float    phase = 0.0f;
 
     for(size_t i = 0; i < length; i++)
     {
-        float t = static_cast<float>(i) / SAMPLE_RATE;
+        float t = static_cast<float>(i) / sample_rate;
 
         // Very short envelope
         float amp = expf(-t * 80.0f);
 
         // Mix of high sine and noise for click
-        phase += (2.0f * DRUM_PI * 800.0f) / SAMPLE_RATE;
+        phase += (2.0f * DRUM_PI * 800.0f) / sample_rate;
         if(phase > 2.0f * DRUM_PI)
             phase -= 2.0f * DRUM_PI;
 
@@ -280,34 +282,54 @@ inline void GenerateRim(float* buffer, size_t length)
     }
 }
 
+// Bank capacity per sample, in samples at the highest supported rate
+constexpr size_t Capacity(size_t length)
+{
+    return length * AudioConfig::MAX_RATE / static_cast<uint32_t>(SAMPLE_RATE);
+}
+
 /**
  * Sample buffer structure that holds all samples in SDRAM
+ * Sized for the highest rate; Generate() fills the prefix a rate needs.
  */
 struct SampleBank
 {
-    float kick[KICK_LENGTH];
-    float snare[SNARE_LENGTH];
-    float hihat_closed[HIHAT_C_LENGTH];
-    float hihat_open[HIHAT_O_LENGTH];
-    float clap[CLAP_LENGTH];
-    float tom_low[TOM_LOW_LENGTH];
-    float tom_mid[TOM_MID_LENGTH];
-    float rim[RIM_LENGTH];
+    float kick[Capacity(KICK_LENGTH)];
+    float snare[Capacity(SNARE_LENGTH)];
+    float hihat_closed[Capacity(HIHAT_C_LENGTH)];
+    float hihat_open[Capacity(HIHAT_O_LENGTH)];
+    float clap[Capacity(CLAP_LENGTH)];
+    float tom_low[Capacity(TOM_LOW_LENGTH)];
+    float tom_mid[Capacity(TOM_MID_LENGTH)];
+    float rim[Capacity(RIM_LENGTH)];
+    float sample_rate;
+
+    /**
+     * Generate all samples at a sample rate (up to AudioConfig::MAX_RATE)
+     * Call this once after Init (in main, not in audio callback!), and
+     * again with audio stopped when the rate changes
+     */
+    void Generate(float rate = SAMPLE_RATE)
+    {
+        sample_rate = rate;
+        GenerateKick(kick, Length(KICK_LENGTH), rate);
+        GenerateSnare(snare, Length(SNARE_LENGTH), rate);
+        GenerateHihatClosed(hihat_closed, Length(HIHAT_C_LENGTH), rate);
+        GenerateHihatOpen(hihat_open, Length(HIHAT_O_LENGTH), rate);
+        GenerateClap(clap, Length(CLAP_LENGTH), rate);
+        GenerateTomLow(tom_low, Length(TOM_LOW_LENGTH), rate);
+        GenerateTomMid(tom_mid, Length(TOM_MID_LENGTH), rate);
+        GenerateRim(rim, Length(RIM_LENGTH), rate);
+    }
 
     /**
-     * Generate all samples
-     * Call this once after Init (in main, not in audio callback!)
+     * Generated length of a sample given by its *_LENGTH constant
+     * (a codec rate slightly above nominal still fits the bank)
      */
-    void Generate()
+    size_t Length(size_t length) const
     {
-        GenerateKick(kick, KICK_LENGTH);
-        GenerateSnare(snare, SNARE_LENGTH);
-        GenerateHihatClosed(hihat_closed, HIHAT_C_LENGTH);
-        GenerateHihatOpen(hihat_open, HIHAT_O_LENGTH);
-        GenerateClap(clap, CLAP_LENGTH);
-        GenerateTomLow(tom_low, TOM_LOW_LENGTH);
-        GenerateTomMid(tom_mid, TOM_MID_LENGTH);
-        GenerateRim(rim, RIM_LENGTH);
+        size_t n = length * static_cast<uint32_t>(sample_rate) / static_cast<uint32_t>(SAMPLE_RATE);
+        return n < Capacity(length) ? n : Capacity(length);
     }
 };
 
@@ -102,66 +102,30 @@ class Engine
      */
     void RecordEvent(uint32_t tick, uint8_t status, uint8_t data1, uint8_t data2)
     {
-        uint8_t channel = status & 0x0F;
-        uint8_t type = status & 0xF0;
-        Track* track = nullptr;
-
-        // Route to appropriate track
-        if(channel == DRUM_CHANNEL)
-        {
-            // Drum event - must be in pad range
-            if(data1 < FIRST_PAD_NOTE || data1 > LAST_PAD_NOTE)
-                return;
-
-            uint8_t track_idx = data1 - FIRST_PAD_NOTE;
-            track = &tracks_[track_idx];
-        }
-        else if(channel == SYNTH_CHANNEL && (type == 0x90 || type == 0x80))
-        {
-            // Synth note event - hash note to track (simple distribution)
-            uint8_t track_idx = NUM_DRUM_TRACKS + (data1 % NUM_SYNTH_TRACKS);
-            track = &tracks_[track_idx];
-        }
-        else
-        {
-            // Unknown event type - ignore
+        Track* track = Route(status, data1);
+        if(!track)
             return;
-        }
 
         // Replace mode: clear track on first note of this recording pass
+        uint8_t type = status & 0xF0;
         if(!overdub_mode_ && first_note_in_pass_ && type == 0x90 && data2 > 0)
         {
             track->Clear();
             first_note_in_pass_ = false;
         }
 
-        // Check capacity
-        if(track->event_count >= MAX_EVENTS_PER_TRACK)
-            return;
-
-        // Find insertion point (maintain sorted order by tick)
-        uint16_t insert_pos = track->event_count;
-        for(uint16_t i = 0; i < track->event_count; i++)
-        {
-            if(track->events[i].tick > tick)
-            {
-                insert_pos = i;
-                break;
-            }
-        }
-
-        // Shift events to make room
-        for(uint16_t i = track->event_count; i > insert_pos; i--)
-        {
-            track->events[i] = track->events[i - 1];
-        }
+        Insert(*track, tick, status, data1, data2);
+    }
 
-        // Insert new event
-        track->events[insert_pos].tick   = tick;
-        track->events[insert_pos].status = status;
-        track->events[insert_pos].data1  = data1;
-        track->events[insert_pos].data2  = data2;
-        track->event_count++;
+    /**
+     * Add an event from an imported file (smf.h)
+     * Same routing as RecordEvent, never clears. Returns false if the event
+     * has no track or the track is full.
+     */
+    bool ImportEvent(uint32_t tick, uint8_t status, uint8_t data1, uint8_t data2)
+    {
+        Track* track = Route(status, data1);
+        return track && Insert(*track, tick, status, data1, data2);
     }
 
     /**
@@ -330,6 +294,27 @@ class Engine
         return 0;
     }
 
+    /**
+     * Get one event of a track (index < GetTrackEventCount(track))
+     */
+    const MidiEvent& GetTrackEvent(uint8_t track, uint16_t index) const
+    {
+        return tracks_[track % NUM_TOTAL_TRACKS].events[index % MAX_EVENTS_PER_TRACK];
+    }
+
+    /**
+     * Append an event to the end of a track (session load)
+     * Events must arrive in tick order. Returns false when the track is full.
+     */
+    bool AppendEvent(uint8_t track, const MidiEvent& ev)
+    {
+        if(track >= NUM_TOTAL_TRACKS || tracks_[track].event_count >= MAX_EVENTS_PER_TRACK)
+            return false;
+        Track& t = tracks_[track];
+        t.events[t.event_count++] = ev;
+        return true;
+    }
+
     /**
      * Get events from a track for pattern dump
      * @param track Track index (0-11)
@@ -369,6 +354,53 @@ class Engine
     }
 
   private:
+    /**
+     * Track an event belongs to (routing in RecordEvent), nullptr if none
+     */
+    Track* Route(uint8_t status, uint8_t data1)
+    {
+        uint8_t channel = status & 0x0F;
+        uint8_t type    = status & 0xF0;
+
+        if(channel == DRUM_CHANNEL)
+        {
+            // Drum event - must be in pad range
+            if(data1 < FIRST_PAD_NOTE || data1 > LAST_PAD_NOTE)
+                return nullptr;
+            return &tracks_[data1 - FIRST_PAD_NOTE];
+        }
+        if(channel == SYNTH_CHANNEL && (type == 0x90 || type == 0x80))
+        {
+            // Synth note event - hash note to track (simple distribution)
+            return &tracks_[NUM_DRUM_TRACKS + (data1 % NUM_SYNTH_TRACKS)];
+        }
+        return nullptr;  // Unknown event type - ignore
+    }
+
+    /**
+     * Insert in tick order, after events at the same tick
+     * Scans from the end, so in-order recording and import append in O(1).
+     */
+    bool Insert(Track& track, uint32_t tick, uint8_t status, uint8_t data1, uint8_t data2)
+    {
+        if(track.event_count >= MAX_EVENTS_PER_TRACK)
+            return false;
+
+        uint16_t pos = track.event_count;
+        while(pos > 0 && track.events[pos - 1].tick > tick)
+        {
+            track.events[pos] = track.events[pos - 1];
+            pos--;
+        }
+
+        track.events[pos].tick   = tick;
+        track.events[pos].status = status;
+        track.events[pos].data1  = data1;
+        track.events[pos].data2  = data2;
+        track.event_count++;
+        return true;
+    }
+
     Track    tracks_[NUM_TOTAL_TRACKS];
     uint32_t pattern_length_;
     uint32_t last_tick_;
@@ -0,0 +1,460 @@
+#pragma once
+#ifndef GROOVYDAISY_SESSION_H
+#define GROOVYDAISY_SESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "protocol_codec.h"
+
+/**
+ * GroovyDaisy Session Snapshots
+ *
+ * The session (patterns, automation, synth parameters, mixer, transport,
+ * freeze state and audio settings) lives in QSPI flash as independent chunks, so an edit
+ * rewrites only the chunks it touched.
+ *
+ * Every chunk has two fixed slots (A/B), each a whole number of 4 KB erase
+ * sectors. A save goes to the slot not holding the current copy, with the
+ * next generation number, and the page holding the header is programmed
+ * last: a save cut short by power loss leaves an erased or CRC-failing slot
+ * and the previous copy still wins. Loading scans both slots of every chunk
+ * in place - memory-mapped QSPI on the device, an mmapped file on the host -
+ * and keeps the newest valid copy; nothing is copied to RAM first.
+ *
+ * Slot: [header:20][payload]
+ *   [magic:4 "GDSC"][format:1][id:1][len:2][gen:4][payload_crc:4][header_crc:4]
+ *   CRC-32 (IEEE); header_crc covers the 16 header bytes before it.
+ *
+ * Payloads (little endian, bump FORMAT_VERSION on any change):
+ *   TRANSPORT  [bpm:2][flags:1] bit0 overdub, bit1 automation blend
+ *   MIXER      [drum_level:f32 x8][drum_pan:f32 x8][drum_master:f32][master_out:f32]
+ *   SYNTH      [count:1][value:f32 x count] in Synth::ParamId order
+ *   PATTERN n  [count:varint] + count x [delta_tick:varint][status][data1][data2]
+ *   AUTO n     [cc:1][count:varint] + count x [delta_tick:varint][value]
+ *   TRACKS     [count:1][frozen:1 x count] per synth track
+ *   AUDIO      [rate:4][block:2] (audio_config.h), read at boot before audio starts
+ *   delta_tick is relative to the previous event (lists are tick sorted),
+ *   the same compact encoding as the bulk pattern stream.
+ *
+ * Saving is incremental (Saver): the main loop calls Step() with a time
+ * budget and each call either encodes one chunk and compares its CRC with
+ * the saved copy, erases one sector, or programs pages until the budget is
+ * spent. A changed chunk is written once it encodes the same on two
+ * consecutive scans, so a knob being turned is saved when it settles.
+ */
+
+namespace Session
+{
+
+constexpr uint32_t MAGIC          = 0x43534447;  // "GDSC"
+constexpr uint8_t  FORMAT_VERSION = 1;
+
+// QSPI geometry (IS25LP064A on the Daisy Seed: 8 MB, 4 KB sectors, 256 B pages).
+// The session lives in the last megabyte, clear of BOOT_QSPI application images.
+constexpr uint32_t FLASH_OFFSET = 0x00700000;
+constexpr uint32_t FLASH_LIMIT  = 0x00800000;
+constexpr uint32_t SECTOR_SIZE  = 4096;
+constexpr uint32_t PAGE_SIZE    = 256;
+
+constexpr size_t HEADER_SIZE = 20;
+
+// Engine sizes the payload limits are built from (checked in GroovyDaisy.cpp)
+constexpr uint8_t  NUM_PATTERNS       = 12;   // Sequencer::NUM_TOTAL_TRACKS
+constexpr uint16_t MAX_PATTERN_EVENTS = 512;  // Sequencer::MAX_EVENTS_PER_TRACK
+constexpr uint8_t  NUM_AUTO_LANES     = 8;    // Automation::NUM_AUTO_CCS
+constexpr uint16_t MAX_AUTO_POINTS    = 256;  // Automation::MAX_AUTO_POINTS
+constexpr uint8_t  NUM_DRUMS          = 8;
+constexpr uint8_t  MAX_SYNTH_PARAMS   = 32;
+constexpr uint8_t  NUM_SYNTH_TRACKS   = 4;
+
+// Pattern/automation events decoded per LOAD_SESSION step (audio callback)
+constexpr uint32_t LOAD_STEP_EVENTS = 32;
+
+// Lane CCs (Automation::AUTO_CCS), for host tools that build images
+// without the engine headers
+constexpr uint8_t AUTO_LANE_CCS[NUM_AUTO_LANES] = {74, 71, 93, 18, 19, 16, 79, 85};
+
+constexpr uint8_t TRANSPORT_OVERDUB = 0x01;
+constexpr uint8_t TRANSPORT_BLEND   = 0x02;
+
+enum ChunkId : uint8_t
+{
+    CHUNK_TRANSPORT = 0,
+    CHUNK_MIXER,
+    CHUNK_SYNTH,
+    CHUNK_PATTERN,                                  // + track (0-11)
+    CHUNK_AUTO   = CHUNK_PATTERN + NUM_PATTERNS,    // + lane (0-7)
+    CHUNK_TRACKS = CHUNK_AUTO + NUM_AUTO_LANES,     // Applied last: refreezes render patterns
+    CHUNK_AUDIO,                                    // Not applied by a load (see above)
+    NUM_CHUNKS
+};
+
+/**
+ * Largest payload a chunk can have
+ */
+constexpr size_t MaxPayload(uint8_t id)
+{
+    return id == CHUNK_TRANSPORT ? 3
+         : id == CHUNK_MIXER     ? 4 * (2 * NUM_DRUMS + 2)
+         : id == CHUNK_SYNTH     ? 1 + 4 * MAX_SYNTH_PARAMS
+         : id == CHUNK_TRACKS    ? 1 + NUM_SYNTH_TRACKS
+         : id == CHUNK_AUDIO     ? 4 + 2
+         : id < CHUNK_AUTO       ? 3 + MAX_PATTERN_EVENTS * (5 + 3)
+                                 : 1 + 3 + MAX_AUTO_POINTS * (5 + 1);
+}
+
+constexpr size_t MAX_PAYLOAD = MaxPayload(CHUNK_PATTERN);
+
+constexpr uint32_t SlotSize(uint8_t id)
+{
+    return (HEADER_SIZE + MaxPayload(id) + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+}
+
+/**
+ * Offset of a chunk slot (copy 0 or 1) from the start of the session region
+ */
+constexpr uint32_t SlotOffset(uint8_t id, uint8_t copy)
+{
+    uint32_t offset = 0;
+    for(uint8_t i = 0; i < id; i++)
+    {
+        offset += 2 * SlotSize(i);
+    }
+    return offset + copy * SlotSize(id);
+}
+
+constexpr uint32_t REGION_SIZE = SlotOffset(NUM_CHUNKS, 0);
+static_assert(FLASH_OFFSET + REGION_SIZE <= FLASH_LIMIT, "Session does not fit in flash");
+
+inline const char* ChunkName(uint8_t id)
+{
+    if(id == CHUNK_TRANSPORT)
+        return "transport";
+    if(id == CHUNK_MIXER)
+        return "mixer";
+    if(id == CHUNK_SYNTH)
+        return "synth";
+    if(id == CHUNK_TRACKS)
+        return "tracks";
+    if(id == CHUNK_AUDIO)
+        return "audio";
+    if(id < CHUNK_AUTO)
+        return "pattern";
+    if(id < CHUNK_TRACKS)
+        return "auto";
+    return "?";
+}
+
+/**
+ * CRC-32 (IEEE, reflected poly 0xEDB88320), nibble table
+ * Pass the previous result as crc to continue over several blocks.
+ */
+inline uint32_t Crc32(const uint8_t* data, size_t len, uint32_t crc = 0)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for(size_t i = 0; i < len; i++)
+    {
+        crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0x0F];
+        crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0x0F];
+    }
+    return ~crc;
+}
+
+// Tick-sorted event lists (PATTERN, AUTO): ticks travel as deltas
+inline void PutTick(ProtocolCodec::Writer& w, uint32_t& prev_tick, uint32_t tick)
+{
+    w.Varint(tick >= prev_tick ? tick - prev_tick : 0);
+    prev_tick = tick >= prev_tick ? tick : prev_tick;
+}
+
+inline uint32_t GetTick(ProtocolCodec::Reader& r, uint32_t& prev_tick)
+{
+    prev_tick += r.Varint();
+    return prev_tick;
+}
+
+/**
+ * One chunk as found in flash
+ */
+struct Chunk
+{
+    const uint8_t* data;  // Payload (in the mapped image)
+    uint16_t       len;
+    uint32_t       gen;
+    uint32_t       crc;   // Payload CRC
+    uint8_t        copy;  // Slot holding it (0/1)
+    bool           valid;
+};
+
+/**
+ * Build a slot header for a payload
+ */
+inline void WriteHeader(uint8_t* out, uint8_t id, uint16_t len, uint32_t gen, uint32_t crc)
+{
+    ProtocolCodec::Writer w(out);
+    w.U32(MAGIC);
+    w.U8(FORMAT_VERSION);
+    w.U8(id);
+    w.U16(len);
+    w.U32(gen);
+    w.U32(crc);
+    w.U32(Crc32(out, w.pos));
+}
+
+/**
+ * Validate one slot; fills chunk and returns true if it holds chunk id
+ */
+inline bool ReadSlot(const uint8_t* slot, uint8_t id, uint8_t copy, Chunk& chunk)
+{
+    ProtocolCodec::Reader r(slot, HEADER_SIZE);
+    uint32_t magic   = r.U32();
+    uint8_t  version = r.U8();
+    uint8_t  slot_id = r.U8();
+    uint16_t len     = r.U16();
+    uint32_t gen     = r.U32();
+    uint32_t crc     = r.U32();
+    uint32_t hcrc    = r.U32();
+    if(magic != MAGIC || version != FORMAT_VERSION || slot_id != id || len > MaxPayload(id)
+       || hcrc != Crc32(slot, HEADER_SIZE - 4)
+       || crc != Crc32(&slot[HEADER_SIZE], len))
+    {
+        return false;
+    }
+    chunk.data  = &slot[HEADER_SIZE];
+    chunk.len   = len;
+    chunk.gen   = gen;
+    chunk.crc   = crc;
+    chunk.copy  = copy;
+    chunk.valid = true;
+    return true;
+}
+
+/**
+ * Newest valid copy of every chunk in a mapped session image
+ */
+class Directory
+{
+  public:
+    /**
+     * Scan an image of REGION_SIZE bytes (or less: missing slots are empty)
+     */
+    void Scan(const uint8_t* image, size_t size)
+    {
+        for(uint8_t id = 0; id < NUM_CHUNKS; id++)
+        {
+            Chunk& best = chunks_[id];
+            best        = Chunk();
+            for(uint8_t copy = 0; copy < 2; copy++)
+            {
+                uint32_t offset = SlotOffset(id, copy);
+                Chunk    found;
+                if(offset + SlotSize(id) <= size && ReadSlot(&image[offset], id, copy, found)
+                   && (!best.valid || static_cast<int32_t>(found.gen - best.gen) > 0))
+                {
+                    best = found;
+                }
+            }
+        }
+    }
+
+    const Chunk& Get(uint8_t id) const { return chunks_[id < NUM_CHUNKS ? id : 0]; }
+
+    size_t GetValidCount() const
+    {
+        size_t count = 0;
+        for(uint8_t id = 0; id < NUM_CHUNKS; id++)
+        {
+            if(chunks_[id].valid)
+                count++;
+        }
+        return count;
+    }
+
+  private:
+    Chunk chunks_[NUM_CHUNKS];
+};
+
+// Engine and flash access supplied by the firmware
+typedef size_t (*EncodeFn)(uint8_t id, uint8_t* out);  // Payload into out, returns length
+typedef void (*EraseFn)(uint32_t offset);               // One sector (flash offset)
+typedef void (*ProgramFn)(uint32_t offset, const uint8_t* data, size_t len);  // Within one page
+typedef uint32_t (*MicrosFn)();
+
+/**
+ * Incremental background saver (main loop)
+ */
+class Saver
+{
+  public:
+    static constexpr uint32_t SCAN_MS = 1000;  // Pause between passes over the chunks
+
+    void Init(const Directory& dir, EncodeFn encode, EraseFn erase, ProgramFn program,
+              MicrosFn micros)
+    {
+        encode_  = encode;
+        erase_   = erase;
+        program_ = program;
+        micros_  = micros;
+        for(uint8_t id = 0; id < NUM_CHUNKS; id++)
+        {
+            const Chunk& c = dir.Get(id);
+            saved_[id]     = c.valid;
+            saved_crc_[id] = c.crc;
+            gen_[id]       = c.valid ? c.gen : 0;
+            copy_[id]      = c.valid ? c.copy : 1;  // First save goes to copy 0
+            seen_crc_[id]  = c.crc;
+        }
+        state_     = WAIT;
+        id_        = 0;
+        next_scan_ = 0;
+        now_ms_    = 0;
+        enabled_   = false;
+        saves_     = 0;
+        bytes_     = 0;
+    }
+
+    /**
+     * Start saving (after the stored session has been applied)
+     */
+    void Enable() { enabled_ = true; }
+
+    /**
+     * Do one budget's worth of work
+     * @param may_start false holds back new writes (one in progress finishes)
+     */
+    void Step(uint32_t now_ms, uint32_t budget_us, bool may_start)
+    {
+        if(!enabled_)
+            return;
+
+        uint32_t start = micros_();
+        now_ms_        = now_ms;
+        switch(state_)
+        {
+            case WAIT:
+                if(static_cast<int32_t>(now_ms - next_scan_) < 0)
+                    return;
+                id_    = 0;
+                state_ = SCAN;
+                // fall through
+            case SCAN: Scan(may_start); break;
+
+            case ERASE:
+                erase_(FLASH_OFFSET + SlotOffset(id_, target_) + sector_ * SECTOR_SIZE);
+                if(++sector_ >= sectors_)
+                {
+                    state_ = PROGRAM;
+                    page_  = 1;
+                }
+                break;
+
+            case PROGRAM:
+                // Payload pages first, then the header page
+                do
+                {
+                    size_t pages = (total_ + PAGE_SIZE - 1) / PAGE_SIZE;
+                    size_t p     = page_ < pages ? page_ : 0;
+                    size_t len   = total_ - p * PAGE_SIZE < PAGE_SIZE ? total_ - p * PAGE_SIZE
+                                                                      : PAGE_SIZE;
+                    program_(FLASH_OFFSET + SlotOffset(id_, target_) + p * PAGE_SIZE,
+                             &buffer_[p * PAGE_SIZE], len);
+                    bytes_ += len;
+                    if(p == 0)
+                    {
+                        Finish();
+                        break;
+                    }
+                    page_++;
+                } while(micros_() - start < budget_us);
+                break;
+        }
+    }
+
+    bool     IsBusy() const { return state_ == ERASE || state_ == PROGRAM; }
+    uint32_t GetSaveCount() const { return saves_; }
+    uint32_t GetBytesWritten() const { return bytes_; }
+
+  private:
+    enum State
+    {
+        WAIT,
+        SCAN,
+        ERASE,
+        PROGRAM,
+    };
+
+    void Scan(bool may_start)
+    {
+        uint8_t* payload = &buffer_[HEADER_SIZE];
+        size_t   len     = encode_(id_, payload);
+        uint32_t crc     = Crc32(payload, len);
+        bool     stable  = crc == seen_crc_[id_];
+        seen_crc_[id_]   = crc;
+
+        if(stable && may_start && (!saved_[id_] || crc != saved_crc_[id_]))
+        {
+            target_ = copy_[id_] ^ 1;
+            WriteHeader(buffer_, id_, static_cast<uint16_t>(len), gen_[id_] + 1, crc);
+            total_   = HEADER_SIZE + len;
+            sectors_ = static_cast<uint8_t>((total_ + SECTOR_SIZE - 1) / SECTOR_SIZE);
+            sector_  = 0;
+            state_   = ERASE;
+            return;
+        }
+        NextChunk();
+    }
+
+    void Finish()
+    {
+        ProtocolCodec::Reader r(&buffer_[8], 8);
+        gen_[id_]       = r.U32();
+        saved_crc_[id_] = r.U32();
+        saved_[id_]     = true;
+        copy_[id_]      = target_;
+        saves_++;
+        state_ = SCAN;
+        NextChunk();
+    }
+
+    void NextChunk()
+    {
+        if(++id_ >= NUM_CHUNKS)
+        {
+            state_     = WAIT;
+            next_scan_ = now_ms_ + SCAN_MS;
+        }
+    }
+
+    uint8_t   buffer_[HEADER_SIZE + MAX_PAYLOAD];  // Slot image being written
+    EncodeFn  encode_;
+    EraseFn   erase_;
+    ProgramFn program_;
+    MicrosFn  micros_;
+    bool      saved_[NUM_CHUNKS];
+    uint32_t  saved_crc_[NUM_CHUNKS];  // Payload CRC of the newest stored copy
+    uint32_t  seen_crc_[NUM_CHUNKS];   // Payload CRC at the previous scan
+    uint32_t  gen_[NUM_CHUNKS];
+    uint8_t   copy_[NUM_CHUNKS];
+    State     state_;
+    uint8_t   id_;
+    uint8_t   target_;   // Copy being written
+    uint8_t   sectors_;  // Sectors to erase
+    uint8_t   sector_;
+    size_t    page_;     // Next page to program (header page last)
+    size_t    total_;    // Header + payload bytes
+    uint32_t  next_scan_;
+    uint32_t  now_ms_;
+    bool      enabled_;
+    uint32_t  saves_;
+    uint32_t  bytes_;
+};
+
+} // namespace Session
+
+#endif // GROOVYDAISY_SESSION_H
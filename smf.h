@@ -0,0 +1,673 @@
+#pragma once
+#ifndef GROOVYDAISY_SMF_H
+#define GROOVYDAISY_SMF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * GroovyDaisy Standard MIDI File Conversion
+ *
+ * Streaming SMF reader and writer with fixed-size state, so a file of any
+ * length passes through a few hundred bytes of RAM: the device converts it
+ * chunk by chunk as it crosses USB, the host tool converts whole files.
+ *
+ * Parser (import): SMF type 0 or 1, any PPQN division (rescaled to the
+ * sequencer's 96 PPQN, rounded to the nearest tick), running status, tempo
+ * meta events; sysex and other meta events are skipped. Each channel event
+ * goes to an EventFn with its track number and rescaled absolute tick;
+ * where it lands (sequencer track, automation lane) is the caller's choice.
+ *
+ * Writer (export): SMF type 1 at 96 PPQN. Track 0 carries the tempo and
+ * 4/4 time signature, then one MTrk per non-empty source track, written
+ * with running status and ended at the pattern length. Track lengths are
+ * computed up front from the source, so output is produced a chunk at a
+ * time without buffering a track.
+ */
+
+namespace Smf
+{
+
+constexpr uint16_t PPQN             = 96;      // Transport::PPQN
+constexpr uint32_t DEFAULT_TEMPO_US = 500000;  // 120 BPM when a file has no tempo
+
+constexpr uint32_t ID_MTHD = 0x4D546864;  // "MThd"
+constexpr uint32_t ID_MTRK = 0x4D54726B;  // "MTrk"
+
+enum class Error : uint8_t
+{
+    NONE,
+    NOT_SMF,             // No MThd header
+    UNSUPPORTED_FORMAT,  // Type 2, or SMPTE time division
+    MALFORMED,           // Data byte with no running status, bad length
+};
+
+/**
+ * One channel event (tick at PPQN)
+ */
+struct Event
+{
+    uint32_t tick;
+    uint8_t  status;
+    uint8_t  data1;
+    uint8_t  data2;  // 0 for one-byte messages
+};
+
+/**
+ * Data bytes that follow a channel status byte
+ */
+inline uint8_t DataBytes(uint8_t status)
+{
+    uint8_t type = status & 0xF0;
+    return (type == 0xC0 || type == 0xD0) ? 1 : 2;
+}
+
+/**
+ * Bytes of a variable-length quantity
+ */
+inline uint8_t VlqSize(uint32_t value)
+{
+    uint8_t n = 1;
+    while(value >= 0x80 && n < 4)
+    {
+        value >>= 7;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Write a variable-length quantity (big-endian 7-bit groups), returns bytes
+ */
+inline uint8_t PutVlq(uint8_t* out, uint32_t value)
+{
+    uint8_t n = VlqSize(value);
+    for(uint8_t i = 0; i < n; i++)
+    {
+        uint8_t shift = 7 * (n - 1 - i);
+        out[i]        = ((value >> shift) & 0x7F) | (i < n - 1 ? 0x80 : 0);
+    }
+    return n;
+}
+
+typedef void (*EventFn)(uint8_t track, const Event& ev);
+typedef void (*TempoFn)(uint32_t tick, uint32_t us_per_quarter);
+
+/**
+ * Streaming SMF reader
+ */
+class Parser
+{
+  public:
+    void Init(EventFn on_event, TempoFn on_tempo)
+    {
+        on_event_    = on_event;
+        on_tempo_    = on_tempo;
+        state_       = CHUNK_ID;
+        error_       = Error::NONE;
+        position_    = 0;
+        in_chunk_    = false;
+        headers_     = 0;
+        acc_         = 0;
+        count_       = 0;
+        format_      = 0;
+        tracks_      = 0;
+        division_    = 0;
+        track_       = 0;
+        tracks_done_ = 0;
+        chunk_id_    = 0;
+        chunk_left_  = 0;
+        abs_tick_    = 0;
+        running_     = 0;
+        have_        = 0;
+        meta_type_   = 0;
+        meta_left_   = 0;
+        tempo_       = 0;
+    }
+
+    /**
+     * Feed the next bytes of the file (split anywhere)
+     * Returns false once the file is found to be invalid.
+     */
+    bool Feed(const uint8_t* data, size_t len)
+    {
+        for(size_t i = 0; i < len && state_ != FAILED && state_ != DONE; i++)
+        {
+            Byte(data[i]);
+            position_++;
+        }
+        return state_ != FAILED;
+    }
+
+    /**
+     * Header read and every declared track consumed
+     */
+    bool     IsDone() const { return state_ == DONE; }
+    Error    GetError() const { return error_; }
+    uint32_t GetPosition() const { return position_; }
+    uint16_t GetFormat() const { return format_; }
+    uint16_t GetTrackCount() const { return tracks_; }
+    uint16_t GetDivision() const { return division_; }
+
+  private:
+    enum State : uint8_t
+    {
+        CHUNK_ID,
+        CHUNK_LEN,
+        HEADER,
+        SKIP,
+        DELTA,
+        STATUS,
+        DATA,
+        META_TYPE,
+        META_LEN,
+        META_DATA,
+        SYSEX_LEN,
+        DONE,
+        FAILED,
+    };
+
+    void Fail(Error e)
+    {
+        error_ = e;
+        state_ = FAILED;
+    }
+
+    // Rescale a file tick to PPQN, rounded to nearest
+    uint32_t Scale(uint32_t tick) const
+    {
+        return static_cast<uint32_t>((static_cast<uint64_t>(tick) * PPQN + division_ / 2)
+                                     / division_);
+    }
+
+    // Accumulate a VLQ byte; true when the value is complete
+    bool Vlq(uint8_t b)
+    {
+        acc_ = (acc_ << 7) | (b & 0x7F);
+        if(!(b & 0x80))
+            return true;
+        if(++count_ >= 4)
+            Fail(Error::MALFORMED);
+        return false;
+    }
+
+    void StartVlq(State next)
+    {
+        acc_   = 0;
+        count_ = 0;
+        state_ = next;
+    }
+
+    void Byte(uint8_t b)
+    {
+        if(in_chunk_)
+            chunk_left_--;
+
+        switch(state_)
+        {
+            case CHUNK_ID:
+            case CHUNK_LEN:
+                acc_ = (acc_ << 8) | b;
+                if(++count_ < 4)
+                    return;
+                count_ = 0;
+                if(state_ == CHUNK_ID)
+                {
+                    chunk_id_ = acc_;
+                    acc_      = 0;
+                    state_    = CHUNK_LEN;
+                    if(headers_ == 0 && chunk_id_ != ID_MTHD)
+                        Fail(Error::NOT_SMF);
+                    return;
+                }
+                StartChunk(acc_);
+                return;
+
+            case HEADER:
+                header_[count_++] = b;
+                if(count_ == 6)
+                    ParseHeader();
+                break;
+
+            case SKIP: break;
+
+            case DELTA:
+                if(Vlq(b))
+                {
+                    abs_tick_ += acc_;
+                    state_ = STATUS;
+                }
+                break;
+
+            case STATUS:
+                if(b == 0xFF)
+                {
+                    state_ = META_TYPE;
+                }
+                else if(b == 0xF0 || b == 0xF7)
+                {
+                    running_   = 0;  // Sysex cancels running status
+                    meta_type_ = 0;
+                    StartVlq(SYSEX_LEN);
+                }
+                else if(b >= 0xF0)
+                {
+                    Fail(Error::MALFORMED);  // System messages don't belong in files
+                }
+                else if(b & 0x80)
+                {
+                    running_ = b;
+                    have_    = 0;
+                    state_   = DATA;
+                }
+                else if(running_ == 0)
+                {
+                    Fail(Error::MALFORMED);
+                }
+                else
+                {
+                    have_ = 0;
+                    Data(b);
+                }
+                break;
+
+            case DATA: Data(b); break;
+
+            case META_TYPE:
+                meta_type_ = b;
+                StartVlq(META_LEN);
+                break;
+
+            case META_LEN:
+            case SYSEX_LEN:
+                if(Vlq(b))
+                {
+                    meta_left_ = acc_;
+                    have_      = 0;
+                    tempo_     = 0;
+                    if(meta_left_ == 0)
+                        MetaDone();
+                    else
+                        state_ = META_DATA;
+                }
+                break;
+
+            case META_DATA:
+                if(meta_type_ == 0x51 && have_ < 3)
+                {
+                    tempo_ = (tempo_ << 8) | b;
+                    have_++;
+                }
+                if(--meta_left_ == 0)
+                    MetaDone();
+                break;
+
+            default: return;
+        }
+
+        if(state_ != FAILED && in_chunk_ && chunk_left_ == 0)
+            EndChunk();
+    }
+
+    void StartChunk(uint32_t len)
+    {
+        chunk_left_ = len;
+        in_chunk_   = len > 0;
+        acc_        = 0;
+        if(chunk_id_ == ID_MTHD && headers_ == 0)
+        {
+            headers_++;
+            if(len < 6)
+                Fail(Error::NOT_SMF);
+            else
+                state_ = HEADER;
+        }
+        else if(chunk_id_ == ID_MTRK)
+        {
+            abs_tick_ = 0;
+            running_  = 0;
+            if(len == 0)
+                EndChunk();
+            else
+                StartVlq(DELTA);
+        }
+        else
+        {
+            // Unknown chunk: skip its body
+            if(len == 0)
+                EndChunk();
+            else
+                state_ = SKIP;
+        }
+    }
+
+    void ParseHeader()
+    {
+        format_   = (header_[0] << 8) | header_[1];
+        tracks_   = (header_[2] << 8) | header_[3];
+        division_ = (header_[4] << 8) | header_[5];
+        if(format_ > 1 || (division_ & 0x8000))
+            Fail(Error::UNSUPPORTED_FORMAT);
+        else if(division_ == 0)
+            Fail(Error::MALFORMED);
+        else
+            state_ = SKIP;  // Any extra header bytes
+    }
+
+    void Data(uint8_t b)
+    {
+        data_[have_++] = b;
+        if(have_ < DataBytes(running_))
+        {
+            state_ = DATA;
+            return;
+        }
+        Event ev;
+        ev.tick   = Scale(abs_tick_);
+        ev.status = running_;
+        ev.data1  = data_[0];
+        ev.data2  = have_ > 1 ? data_[1] : 0;
+        if(on_event_)
+            on_event_(static_cast<uint8_t>(track_), ev);
+        StartVlq(DELTA);
+    }
+
+    void MetaDone()
+    {
+        if(meta_type_ == 0x51 && have_ == 3 && on_tempo_)
+            on_tempo_(Scale(abs_tick_), tempo_);
+        if(meta_type_ == 0x2F)
+            state_ = SKIP;  // End of track: ignore anything after it
+        else
+            StartVlq(DELTA);
+    }
+
+    void EndChunk()
+    {
+        in_chunk_ = false;
+        acc_      = 0;
+        count_    = 0;
+        state_    = CHUNK_ID;
+        if(chunk_id_ == ID_MTRK)
+        {
+            track_++;
+            if(++tracks_done_ >= tracks_)
+                state_ = DONE;
+        }
+    }
+
+    EventFn  on_event_;
+    TempoFn  on_tempo_;
+    State    state_;
+    Error    error_;
+    uint32_t position_;     // Bytes consumed
+    uint32_t chunk_id_;
+    uint32_t chunk_left_;   // Bytes left in the current chunk
+    bool     in_chunk_;
+    uint8_t  headers_;
+    uint8_t  header_[6];
+    uint32_t acc_;          // Field being assembled (ID, length, VLQ)
+    uint8_t  count_;        // Bytes in acc_
+    uint16_t format_;
+    uint16_t tracks_;
+    uint16_t division_;
+    uint16_t track_;        // Current MTrk index
+    uint16_t tracks_done_;
+    uint32_t abs_tick_;     // File ticks since track start
+    uint8_t  running_;      // Running status (0 = none)
+    uint8_t  data_[2];
+    uint8_t  have_;         // Data bytes collected
+    uint8_t  meta_type_;
+    uint32_t meta_left_;
+    uint32_t tempo_;
+};
+
+// Export source: events of one track, tick sorted
+typedef uint16_t (*CountFn)(uint8_t track);
+typedef void (*GetFn)(uint8_t track, uint16_t index, Event& ev);
+
+/**
+ * Streaming SMF type 1 writer
+ */
+class Writer
+{
+  public:
+    /**
+     * Start a file
+     * @param track_count Source tracks (empty ones are left out)
+     * @param end_tick    Pattern length; every track ends here
+     * @param tempo_us    Microseconds per quarter note
+     */
+    void Begin(uint8_t track_count, CountFn count, GetFn get, uint32_t end_tick,
+               uint32_t tempo_us)
+    {
+        sources_  = track_count;
+        count_fn_ = count;
+        get_fn_   = get;
+        end_tick_ = end_tick;
+        tempo_us_ = tempo_us;
+
+        // Conductor track + every non-empty source track, sizes fixed now
+        total_  = 14 + 8 + ConductorSize();
+        mtrks_  = 1;
+        for(uint8_t t = 0; t < sources_; t++)
+        {
+            if(count_fn_(t) > 0)
+            {
+                total_ += 8 + TrackSize(t);
+                mtrks_++;
+            }
+        }
+        Rewind();
+    }
+
+    uint32_t GetTotalSize() const { return total_; }
+    uint32_t GetPosition() const { return position_; }
+    bool     Done() const { return position_ >= total_; }
+
+    /**
+     * Produce up to max bytes, returns bytes written
+     */
+    size_t Fill(uint8_t* out, size_t max)
+    {
+        size_t len = 0;
+        while(len < max)
+        {
+            if(item_pos_ == item_len_ && !NextItem())
+                break;
+            size_t n = item_len_ - item_pos_;
+            if(n > max - len)
+                n = max - len;
+            for(size_t i = 0; i < n; i++)
+                out[len + i] = item_[item_pos_ + i];
+            item_pos_ += n;
+            len += n;
+        }
+        position_ += len;
+        return len;
+    }
+
+    /**
+     * Continue from a byte offset (restarts and skips when going back)
+     */
+    void Seek(uint32_t offset)
+    {
+        if(offset < position_)
+            Rewind();
+        uint8_t scratch[64];
+        while(position_ < offset && !Done())
+        {
+            uint32_t left = offset - position_;
+            Fill(scratch, left < sizeof(scratch) ? left : sizeof(scratch));
+        }
+    }
+
+  private:
+    enum Stage : uint8_t
+    {
+        FILE_HEADER,
+        CONDUCTOR,
+        TRACK_HEADER,
+        EVENTS,
+        TRACK_END,
+        FINISHED,
+    };
+
+    static size_t PutU32(uint8_t* out, uint32_t v)
+    {
+        out[0] = v >> 24;
+        out[1] = (v >> 16) & 0xFF;
+        out[2] = (v >> 8) & 0xFF;
+        out[3] = v & 0xFF;
+        return 4;
+    }
+
+    uint32_t ConductorSize() const
+    {
+        // Tempo (1+3+3), time signature (1+3+4), end of track (vlq+3)
+        return 7 + 8 + VlqSize(end_tick_) + 3;
+    }
+
+    uint32_t TrackSize(uint8_t t) const
+    {
+        uint16_t count   = count_fn_(t);
+        uint32_t size    = 0;
+        uint32_t prev    = 0;
+        uint8_t  running = 0;
+        for(uint16_t i = 0; i < count; i++)
+        {
+            Event ev;
+            get_fn_(t, i, ev);
+            uint32_t tick = ev.tick > prev ? ev.tick : prev;
+            size += VlqSize(tick - prev) + (ev.status == running ? 0 : 1) + DataBytes(ev.status);
+            running = ev.status;
+            prev    = tick;
+        }
+        return size + VlqSize(end_tick_ > prev ? end_tick_ - prev : 0) + 3;
+    }
+
+    void Rewind()
+    {
+        stage_    = FILE_HEADER;
+        track_    = 0;
+        position_ = 0;
+        item_len_ = 0;
+        item_pos_ = 0;
+    }
+
+    // Build the next item into item_; false when the file is complete
+    bool NextItem()
+    {
+        uint8_t* p = item_;
+        switch(stage_)
+        {
+            case FILE_HEADER:
+                p += PutU32(p, ID_MTHD);
+                p += PutU32(p, 6);
+                *p++  = 0;
+                *p++  = 1;  // Type 1
+                *p++  = 0;
+                *p++  = mtrks_;
+                *p++  = PPQN >> 8;
+                *p++  = PPQN & 0xFF;
+                stage_ = CONDUCTOR;
+                break;
+
+            case CONDUCTOR:
+                p += PutU32(p, ID_MTRK);
+                p += PutU32(p, ConductorSize());
+                *p++ = 0x00;
+                *p++ = 0xFF;
+                *p++ = 0x51;
+                *p++ = 0x03;
+                *p++ = (tempo_us_ >> 16) & 0xFF;
+                *p++ = (tempo_us_ >> 8) & 0xFF;
+                *p++ = tempo_us_ & 0xFF;
+                *p++ = 0x00;
+                *p++ = 0xFF;
+                *p++ = 0x58;
+                *p++ = 0x04;
+                *p++ = 4;   // 4/4
+                *p++ = 2;
+                *p++ = 24;  // MIDI clocks per metronome click
+                *p++ = 8;   // 32nds per quarter
+                p += PutVlq(p, end_tick_);
+                *p++   = 0xFF;
+                *p++   = 0x2F;
+                *p++   = 0x00;
+                stage_ = TRACK_HEADER;
+                break;
+
+            case TRACK_HEADER:
+                while(track_ < sources_ && count_fn_(track_) == 0)
+                    track_++;
+                if(track_ >= sources_)
+                {
+                    stage_ = FINISHED;
+                    return false;
+                }
+                p += PutU32(p, ID_MTRK);
+                p += PutU32(p, TrackSize(track_));
+                index_   = 0;
+                count_   = count_fn_(track_);
+                prev_    = 0;
+                running_ = 0;
+                stage_   = EVENTS;
+                break;
+
+            case EVENTS:
+            {
+                Event ev;
+                get_fn_(track_, index_, ev);
+                uint32_t tick = ev.tick > prev_ ? ev.tick : prev_;
+                p += PutVlq(p, tick - prev_);
+                if(ev.status != running_)
+                    *p++ = ev.status;
+                *p++ = ev.data1 & 0x7F;
+                if(DataBytes(ev.status) > 1)
+                    *p++ = ev.data2 & 0x7F;
+                running_ = ev.status;
+                prev_    = tick;
+                if(++index_ >= count_)
+                    stage_ = TRACK_END;
+                break;
+            }
+
+            case TRACK_END:
+                p += PutVlq(p, end_tick_ > prev_ ? end_tick_ - prev_ : 0);
+                *p++ = 0xFF;
+                *p++ = 0x2F;
+                *p++ = 0x00;
+                track_++;
+                stage_ = TRACK_HEADER;
+                break;
+
+            default: return false;
+        }
+        item_len_ = static_cast<uint8_t>(p - item_);
+        item_pos_ = 0;
+        return true;
+    }
+
+    CountFn  count_fn_;
+    GetFn    get_fn_;
+    uint8_t  sources_;
+    uint8_t  mtrks_;
+    uint32_t end_tick_;
+    uint32_t tempo_us_;
+    uint32_t total_;
+    uint32_t position_;
+    Stage    stage_;
+    uint8_t  track_;
+    uint16_t index_;
+    uint16_t count_;
+    uint32_t prev_;
+    uint8_t  running_;
+    uint8_t  item_[32];  // Current item (largest: conductor track, 30 bytes)
+    uint8_t  item_len_;
+    uint8_t  item_pos_;
+};
+
+} // namespace Smf
+
+#endif // GROOVYDAISY_SMF_H
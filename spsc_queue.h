@@ -0,0 +1,260 @@
+#pragma once
+#ifndef GROOVYDAISY_SPSC_QUEUE_H
+#define GROOVYDAISY_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+/**
+ * GroovyDaisy Lock-Free SPSC Queue
+ *
+ * Single-producer / single-consumer ring used for all traffic between
+ * execution contexts (UART ISR, USB ISR, audio callback, main loop).
+ *
+ * - Head is written only by the producer, tail only by the consumer.
+ *   Release stores publish the slot contents; acquire loads observe them.
+ * - Head, tail and the slot array sit on separate 32-byte lines (Cortex-M7
+ *   D-cache line) so the two sides never write the same line.
+ * - Each side keeps a cached copy of the other side's index and only
+ *   re-reads the shared one when the cached value says full/empty, so
+ *   polling an empty queue costs one load.
+ * - Push on a full queue drops the item and counts an overflow.
+ *
+ * N must be a power of two. Indices run freely and wrap at 2^32.
+ *
+ * ByteRing is the same scheme for byte streams: the producer copies whole
+ * chunks in, the consumer reads contiguous spans in place.
+ */
+
+namespace Spsc
+{
+
+// Cortex-M7 L1 data cache line size
+constexpr size_t CACHE_LINE = 32;
+
+template <typename T, uint32_t N>
+class Queue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Spsc::Queue size must be a power of two");
+
+  public:
+    /**
+     * Reset to empty (call before either side starts using the queue)
+     */
+    void Init()
+    {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        tail_cache_ = 0;
+        head_cache_ = 0;
+        overflows_.store(0, std::memory_order_relaxed);
+        high_water_.store(0, std::memory_order_relaxed);
+    }
+
+    // ---- Producer side ----
+
+    /**
+     * Append an item. Returns false (and counts an overflow) when full.
+     */
+    bool Push(const T& item)
+    {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if(head - tail_cache_ >= N)
+        {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if(head - tail_cache_ >= N)
+            {
+                overflows_.store(overflows_.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        items_[head & (N - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+
+        uint32_t used = head + 1 - tail_cache_;
+        if(used > high_water_.load(std::memory_order_relaxed))
+        {
+            high_water_.store(used, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // ---- Consumer side ----
+
+    /**
+     * Look at the oldest item without removing it
+     */
+    bool Peek(T& item)
+    {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if(tail == head_cache_)
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if(tail == head_cache_)
+                return false;
+        }
+        item = items_[tail & (N - 1)];
+        return true;
+    }
+
+    /**
+     * Discard the item returned by the last successful Peek()
+     */
+    void Drop()
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Remove and return the oldest item
+     */
+    bool Pop(T& item)
+    {
+        if(!Peek(item))
+            return false;
+        Drop();
+        return true;
+    }
+
+    // ---- Either side (approximate while the other side is running) ----
+
+    bool     Empty() const { return Size() == 0; }
+    uint32_t Size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    static constexpr uint32_t Capacity() { return N; }
+
+    /**
+     * Items dropped because the queue was full
+     */
+    uint32_t GetOverflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+    /**
+     * Highest fill level seen (as observed by the producer)
+     */
+    uint32_t GetHighWater() const { return high_water_.load(std::memory_order_relaxed); }
+
+  private:
+    // Producer-owned line
+    alignas(CACHE_LINE) std::atomic<uint32_t> head_;
+    uint32_t              tail_cache_;
+    std::atomic<uint32_t> overflows_;
+    std::atomic<uint32_t> high_water_;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE) std::atomic<uint32_t> tail_;
+    uint32_t head_cache_;
+
+    alignas(CACHE_LINE) T items_[N];
+};
+
+/**
+ * SPSC byte stream (e.g. USB receive ISR -> main loop)
+ */
+template <uint32_t N>
+class ByteRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Spsc::ByteRing size must be a power of two");
+
+  public:
+    void Init()
+    {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        overflows_.store(0, std::memory_order_relaxed);
+        high_water_.store(0, std::memory_order_relaxed);
+    }
+
+    // ---- Producer side ----
+
+    /**
+     * Append a chunk. All or nothing: if it does not fit it is dropped and
+     * its length added to the overflow count, so a partial chunk never
+     * splices into the stream.
+     */
+    bool Write(const uint8_t* data, uint32_t len)
+    {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t used = head - tail_.load(std::memory_order_acquire);
+        if(len > N - used)
+        {
+            overflows_.store(overflows_.load(std::memory_order_relaxed) + len,
+                             std::memory_order_relaxed);
+            return false;
+        }
+
+        uint32_t pos   = head & (N - 1);
+        uint32_t first = (len < N - pos) ? len : N - pos;
+        memcpy(&bytes_[pos], data, first);
+        memcpy(&bytes_[0], data + first, len - first);
+        head_.store(head + len, std::memory_order_release);
+
+        if(used + len > high_water_.load(std::memory_order_relaxed))
+        {
+            high_water_.store(used + len, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // ---- Consumer side ----
+
+    /**
+     * Point at the oldest unread bytes
+     * Returns the length of the contiguous span (0 when empty); the rest,
+     * if the data wraps, follows after Consume().
+     */
+    uint32_t Peek(const uint8_t*& data) const
+    {
+        uint32_t tail  = tail_.load(std::memory_order_relaxed);
+        uint32_t avail = head_.load(std::memory_order_acquire) - tail;
+        uint32_t pos   = tail & (N - 1);
+        data = &bytes_[pos];
+        return (avail < N - pos) ? avail : N - pos;
+    }
+
+    /**
+     * Release bytes read through Peek()
+     */
+    void Consume(uint32_t len)
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    // ---- Either side ----
+
+    uint32_t Size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    static constexpr uint32_t Capacity() { return N; }
+
+    /**
+     * Bytes dropped because the ring was full
+     */
+    uint32_t GetOverflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+    /**
+     * Highest fill level seen (as observed by the producer)
+     */
+    uint32_t GetHighWater() const { return high_water_.load(std::memory_order_relaxed); }
+
+  private:
+    // Producer-owned line
+    alignas(CACHE_LINE) std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> overflows_;
+    std::atomic<uint32_t> high_water_;
+
+    // Consumer-owned line
+    alignas(CACHE_LINE) std::atomic<uint32_t> tail_;
+
+    alignas(CACHE_LINE) uint8_t bytes_[N];
+};
+
+} // namespace Spsc
+
+#endif // GROOVYDAISY_SPSC_QUEUE_H
@@ -0,0 +1,239 @@
+#pragma once
+#ifndef GROOVYDAISY_STATE_SYNC_H
+#define GROOVYDAISY_STATE_SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * GroovyDaisy Delta State Sync
+ *
+ * Everything the companion mirrors (transport, voices, bank, faders, mixer,
+ * synth parameters, track states, modulation) is a flat table of 32-bit
+ * fields. The main loop captures the engines into the table once per
+ * frame; any field that differs gets the frame's version number.
+ *
+ * MSG_STATE_DELTA carries only the fields changed since the version the
+ * companion last acknowledged (CMD_STATE_ACK), so an idle frame costs
+ * nothing and a knob move costs one 5-byte entry. A full snapshot (same
+ * message, SNAPSHOT flag) goes out only on connect or request; no deltas
+ * are sent until a snapshot has been acknowledged. An unacknowledged
+ * snapshot is sent again whole after RESEND_MS, until one is acknowledged
+ * (connect is when the TX ring is most likely to drop it). An
+ * unacknowledged delta is resent, widened to everything since the last ack,
+ * after RESEND_MS.
+ *
+ * Payload: [version:2][base:2][flags:1] then [field:1][value:4 LE] per entry
+ *   base  - version the delta is relative to (ignored for snapshots)
+ *   flags - bit0 SNAPSHOT, bit1 MORE (another message with the same version
+ *           follows; acknowledge after the last one)
+ */
+
+namespace StateSync
+{
+
+// Field layout (values are integers unless noted)
+constexpr uint8_t TRANSPORT_PLAYING   = 0;
+constexpr uint8_t TRANSPORT_RECORDING = 1;
+constexpr uint8_t TRANSPORT_BPM       = 2;
+constexpr uint8_t VOICES_SYNTH        = 3;
+constexpr uint8_t VOICES_DRUMS        = 4;
+constexpr uint8_t CC_BANK             = 5;
+constexpr uint8_t FADER_FIRST         = 6;   // 9 x pickup bits (bit0 picked up, bit1 needs pickup)
+constexpr uint8_t NUM_FADER_FIELDS    = 9;
+constexpr uint8_t MIXER_FIRST         = FADER_FIRST + NUM_FADER_FIELDS;  // 21 x MSG_MIXER_STATE order, 0-127
+constexpr uint8_t NUM_MIXER_FIELDS    = 21;
+constexpr uint8_t SYNTH_FIRST         = MIXER_FIRST + NUM_MIXER_FIELDS;  // ParamId order up to LEVEL, float bits
+constexpr uint8_t NUM_SYNTH_FIELDS    = 19;
+constexpr uint8_t SYNTH_PRESET        = SYNTH_FIRST + NUM_SYNTH_FIELDS;
+constexpr uint8_t TRACK_FIRST         = SYNTH_PRESET + 1;  // 4 x [status, frozen_slot]
+constexpr uint8_t NUM_TRACK_FIELDS    = 8;
+constexpr uint8_t MOD_FIRST           = TRACK_FIRST + NUM_TRACK_FIELDS;  // ParamId order from LFO1_RATE, float bits
+constexpr uint8_t NUM_MOD_FIELDS      = 11;
+constexpr uint8_t FIELD_COUNT         = MOD_FIRST + NUM_MOD_FIELDS;
+
+// Message layout
+constexpr uint8_t HEADER_SIZE       = 5;
+constexpr uint8_t ENTRY_SIZE        = 5;
+constexpr uint8_t MAX_ENTRIES       = 50;  // Keeps a message within Protocol::MAX_PAYLOAD
+constexpr size_t  MAX_MESSAGE       = HEADER_SIZE + MAX_ENTRIES * ENTRY_SIZE;
+constexpr uint8_t FLAG_SNAPSHOT     = 0x01;
+constexpr uint8_t FLAG_MORE         = 0x02;
+constexpr uint32_t RESEND_MS        = 250;
+
+inline uint32_t FloatBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+class Tracker
+{
+  public:
+    void Init()
+    {
+        for(uint8_t i = 0; i < FIELD_COUNT; i++)
+        {
+            values_[i]  = 0;
+            changed_[i] = 1;
+        }
+        version_          = 1;  // Everything is "changed" in the first version
+        pending_          = false;
+        acked_            = 0;
+        sent_             = 0;
+        last_send_        = 0;
+        synced_           = false;
+        snapshot_         = false;
+        snapshot_unacked_ = false;
+        snapshot_version_ = 0;
+        in_progress_      = false;
+    }
+
+    /**
+     * Capture a field value (main loop, once per frame)
+     */
+    void Set(uint8_t field, uint32_t value)
+    {
+        if(field < FIELD_COUNT && values_[field] != value)
+        {
+            values_[field]  = value;
+            changed_[field] = version_ + 1;
+            pending_        = true;
+        }
+    }
+
+    void SetFloat(uint8_t field, float value) { Set(field, FloatBits(value)); }
+
+    /**
+     * Close the frame: changes captured since the last Commit() get a new version
+     */
+    void Commit()
+    {
+        if(pending_)
+        {
+            version_++;
+            pending_ = false;
+        }
+    }
+
+    /**
+     * Send everything on the next Begin() (connect / explicit request)
+     */
+    void RequestSnapshot() { snapshot_ = true; }
+
+    /**
+     * Companion acknowledged a version (CMD_STATE_ACK)
+     */
+    void Ack(uint16_t version)
+    {
+        // Map the 16-bit wire value back onto the sent range
+        uint32_t v = sent_ - static_cast<uint16_t>(static_cast<uint16_t>(sent_) - version);
+        if(v > acked_ && v <= sent_)
+        {
+            acked_ = v;
+        }
+        if(v >= snapshot_version_ && v <= sent_)
+        {
+            snapshot_unacked_ = false;
+        }
+        synced_ = true;
+    }
+
+    /**
+     * Decide whether to send this frame; if so, NextMessage() yields the messages
+     */
+    bool Begin(uint32_t now)
+    {
+        // Deltas only make sense once a companion holds a snapshot
+        bool fresh  = synced_ && version_ > sent_;
+        bool resend = synced_ && acked_ < sent_ && now - last_send_ >= RESEND_MS;
+        if(snapshot_unacked_ && now - last_send_ >= RESEND_MS)
+        {
+            snapshot_ = true;  // Snapshot (or its ack) was lost
+        }
+        if(!snapshot_ && !fresh && !resend)
+            return false;
+
+        send_snapshot_ = snapshot_;
+        snapshot_      = false;
+        if(send_snapshot_)
+        {
+            snapshot_unacked_ = true;
+            snapshot_version_ = version_;
+        }
+        cursor_        = 0;
+        in_progress_   = true;
+        sent_          = version_;
+        last_send_     = now;
+        return true;
+    }
+
+    /**
+     * Build the next message of the current send into out (MAX_MESSAGE bytes)
+     * Returns the payload length, 0 when done.
+     */
+    size_t NextMessage(uint8_t* out)
+    {
+        if(!in_progress_)
+            return 0;
+
+        uint8_t count = 0;
+        size_t  len   = HEADER_SIZE;
+        while(cursor_ < FIELD_COUNT && count < MAX_ENTRIES)
+        {
+            uint8_t f = cursor_++;
+            if(!Include(f))
+                continue;
+            uint32_t v = values_[f];
+            out[len++] = f;
+            out[len++] = v & 0xFF;
+            out[len++] = (v >> 8) & 0xFF;
+            out[len++] = (v >> 16) & 0xFF;
+            out[len++] = (v >> 24) & 0xFF;
+            count++;
+        }
+
+        bool more = false;
+        for(uint8_t f = cursor_; f < FIELD_COUNT && !more; f++)
+        {
+            more = Include(f);
+        }
+        in_progress_ = more;
+
+        if(count == 0 && !send_snapshot_)
+            return 0;  // Nothing changed after all (value went back and forth)
+
+        out[0] = sent_ & 0xFF;
+        out[1] = (sent_ >> 8) & 0xFF;
+        out[2] = acked_ & 0xFF;
+        out[3] = (acked_ >> 8) & 0xFF;
+        out[4] = (send_snapshot_ ? FLAG_SNAPSHOT : 0) | (more ? FLAG_MORE : 0);
+        return len;
+    }
+
+    uint32_t GetVersion() const { return version_; }
+
+  private:
+    bool Include(uint8_t f) const { return send_snapshot_ || changed_[f] > acked_; }
+
+    uint32_t values_[FIELD_COUNT];
+    uint32_t changed_[FIELD_COUNT];  // Version in which each field last changed
+    uint32_t version_;    // Latest committed version
+    uint32_t acked_;      // Latest version the companion confirmed
+    uint32_t sent_;       // Version of the last send
+    uint32_t last_send_;  // ms
+    uint32_t snapshot_version_;  // Version of the last snapshot sent
+    uint8_t  cursor_;     // Next field to consider in the current send
+    bool     pending_;    // Changes captured since the last Commit()
+    bool     synced_;     // Companion has acknowledged at least once
+    bool     snapshot_;   // Snapshot requested
+    bool     snapshot_unacked_;  // Last snapshot sent not acknowledged yet
+    bool     send_snapshot_;
+    bool     in_progress_;
+};
+
+} // namespace StateSync
+
+#endif // GROOVYDAISY_STATE_SYNC_H
@@ -6,6 +6,7 @@
 #include <cmath>
 #include <cstdio>
 #include "daisysp.h"
+#include "mod_matrix.h"
 
 /**
  * GroovyDaisy 6-Voice Polyphonic Synthesizer
@@ -15,6 +16,7 @@
  * - State variable filter (lowpass) with envelope
  * - ADSR envelopes for amplitude and filter
  * - Velocity sensitivity for amp and filter
+ * - Per-voice and global LFOs through a block-rate mod matrix (mod_matrix.h)
  * - Voice stealing (oldest note)
  * - Factory presets and parameter control via CC/companion
  */
@@ -64,9 +66,23 @@ enum ParamId : uint8_t
     PARAM_LEVEL,
     PARAM_PAN,
     PARAM_MASTER_LEVEL,
+    PARAM_LFO1_RATE,
+    PARAM_LFO1_WAVE,
+    PARAM_LFO2_RATE,
+    PARAM_LFO2_WAVE,
+    PARAM_LFO_DEPTH,
+    PARAM_MOD1_ROUTE,
+    PARAM_MOD1_AMOUNT,
+    PARAM_MOD2_ROUTE,
+    PARAM_MOD2_AMOUNT,
+    PARAM_MOD3_ROUTE,
+    PARAM_MOD3_AMOUNT,
     PARAM_COUNT
 };
 
+static_assert(PARAM_COUNT - PARAM_MOD1_ROUTE == 2 * ModMatrix::NUM_SLOTS,
+              "One route and one amount parameter per mod slot");
+
 /**
  * All controllable synth parameters
  */
@@ -105,6 +121,15 @@ struct SynthParams
     float pan;              // -1.0 to +1.0 (stereo position)
     float master_level;     // 0.0-1.0 (overall synth master)
 
+    // Modulation (see mod_matrix.h)
+    float lfo1_rate;        // 0.05-20 Hz, per voice, restarts at note on
+    uint8_t lfo1_wave;      // 0-3: sin, tri, saw, square
+    float lfo2_rate;        // 0.05-20 Hz, global, free running
+    uint8_t lfo2_wave;
+    float lfo_depth;        // 0.0-1.0 (scales every LFO route)
+    uint8_t mod_route[ModMatrix::NUM_SLOTS];  // ModMatrix::Route()
+    float mod_amount[ModMatrix::NUM_SLOTS];   // -1.0 to +1.0
+
     /**
      * Initialize with default "Init Patch" values
      */
@@ -136,6 +161,31 @@ struct SynthParams
         level = 0.7f;
         pan = 0.0f;           // Center
         master_level = 1.0f;  // Full
+
+        InitMod();
+    }
+
+    /**
+     * LFO defaults and no routes
+     */
+    void InitMod()
+    {
+        lfo1_rate = 5.0f;
+        lfo1_wave = WAVE_SIN;
+        lfo2_rate = 0.5f;
+        lfo2_wave = WAVE_TRI;
+        lfo_depth = 1.0f;
+        for(uint8_t i = 0; i < ModMatrix::NUM_SLOTS; i++)
+        {
+            mod_route[i]  = ModMatrix::Route(ModMatrix::SRC_NONE, ModMatrix::DEST_CUTOFF);
+            mod_amount[i] = 0.0f;
+        }
+    }
+
+    void SetModSlot(uint8_t slot, ModMatrix::Source src, ModMatrix::Dest dest, float amount)
+    {
+        mod_route[slot]  = ModMatrix::Route(src, dest);
+        mod_amount[slot] = amount;
     }
 };
 
@@ -176,6 +226,16 @@ struct FactoryPresets
                 params.vel_to_amp = 0.3f;
                 params.vel_to_filter = 0.2f;
                 params.level = 0.6f;
+
+                // Slow filter sweep per voice, global stereo drift
+                params.InitMod();
+                params.lfo1_rate = 0.3f;
+                params.lfo1_wave = WAVE_TRI;
+                params.lfo2_rate = 0.2f;
+                params.lfo2_wave = WAVE_SIN;
+                params.SetModSlot(0, ModMatrix::SRC_LFO1, ModMatrix::DEST_CUTOFF, 0.15f);
+                params.SetModSlot(1, ModMatrix::SRC_LFO2, ModMatrix::DEST_PAN, 0.5f);
+                params.SetModSlot(2, ModMatrix::SRC_MOD_WHEEL, ModMatrix::DEST_CUTOFF, 0.5f);
                 break;
 
             case 2:  // Pluck Lead
@@ -202,6 +262,12 @@ struct FactoryPresets
                 params.vel_to_amp = 0.8f;
                 params.vel_to_filter = 0.6f;
                 params.level = 0.7f;
+
+                // Light vibrato, mod wheel opens the filter
+                params.InitMod();
+                params.lfo1_rate = 5.5f;
+                params.SetModSlot(0, ModMatrix::SRC_LFO1, ModMatrix::DEST_PITCH, 0.01f);
+                params.SetModSlot(1, ModMatrix::SRC_MOD_WHEEL, ModMatrix::DEST_CUTOFF, 0.5f);
                 break;
 
             case 3:  // Bass
@@ -228,6 +294,9 @@ struct FactoryPresets
                 params.vel_to_amp = 0.7f;
                 params.vel_to_filter = 0.5f;
                 params.level = 0.8f;
+
+                params.InitMod();
+                params.SetModSlot(0, ModMatrix::SRC_MOD_WHEEL, ModMatrix::DEST_CUTOFF, 0.5f);
                 break;
 
             default:
@@ -266,8 +335,13 @@ struct SynthVoice
     bool gate;              // Key is held down
     uint32_t start_time;    // For voice stealing
     uint32_t release_samples;  // Samples since gate released (for stuck detection)
+    uint32_t on_sample;     // Engine sample count at note on (for diagnostics)
     float last_env;         // Last envelope value (for diagnostics)
+    float last_cutoff;      // Last filter cutoff in Hz (for diagnostics)
     float cached_filt_env;  // Cached filter envelope for reduced update rate
+    float mod_env;          // Last filter envelope value (mod matrix source)
+    float osc1_freq;        // Note frequencies before pitch modulation
+    float osc2_freq;
 
     float sample_rate_ = 48000.0f;  // Store for Reset(), default to safe value
 
@@ -286,8 +360,13 @@ struct SynthVoice
         gate = false;
         start_time = 0;
         release_samples = 0;
+        on_sample = 0;
         last_env = 0.0f;
+        last_cutoff = 0.0f;
         cached_filt_env = 0.0f;
+        mod_env = 0.0f;
+        osc1_freq = 0.0f;
+        osc2_freq = 0.0f;
     }
 
     // Reset filter state to prevent accumulated errors/noise
@@ -319,6 +398,22 @@ struct SynthVoice
     }
 };
 
+/**
+ * Snapshot of one voice for MSG_VOICE_DIAG
+ */
+struct VoiceDiag
+{
+    uint8_t  note;
+    uint8_t  velocity;
+    bool     active;
+    bool     gate;
+    uint8_t  stage;            // Amp envelope segment (daisysp ADSR_SEG_*)
+    float    env;              // Amp envelope level 0-1
+    uint32_t age_samples;      // Since note on
+    uint32_t release_samples;  // Since gate off (0 while held)
+    float    cutoff;           // Filter cutoff in Hz
+};
+
 /**
  * Main 6-voice polyphonic synth engine
  */
@@ -338,17 +433,50 @@ class Engine
         }
 
         // Load default preset
-        FactoryPresets::GetPreset(0, params_);
-        ApplyParams();
+        FactoryPresets::GetPreset(0, sets_[0]);
+        sets_[1]       = sets_[0];
+        live_          = 0;
+        params_        = &sets_[0];
+        staged_        = false;
+        morphing_      = false;
+        morph_samples_ = 0;
+        morph_pos_     = 0;
+        dirty_         = ALL_PARAMS_MASK;
+        block_size_    = 0;
+        block_pos_     = 0;
+        mod_.Init(sample_rate);
+        Update(0);
 
         active_count_ = 0;
         time_counter_ = 0;
+        sample_count_ = 0;
         current_preset_ = 0;
         filter_update_counter_ = 0;
         nan_detected_ = false;
         stuck_voice_detected_ = false;
     }
 
+    /**
+     * Re-initialize the voices for a new sample rate (audio stopped)
+     * Sounding notes are cut. Presets and parameters are kept and pushed to
+     * the voices again at the next Update(), since envelope times and
+     * filter tuning depend on the rate; a morph in progress keeps its length.
+     */
+    void SetSampleRate(float sample_rate)
+    {
+        float scale  = sample_rate / sample_rate_;
+        sample_rate_ = sample_rate;
+        for(uint8_t i = 0; i < NUM_VOICES; i++)
+        {
+            voices_[i].Init(sample_rate);
+        }
+        morph_samples_ = static_cast<uint32_t>(morph_samples_ * scale);
+        morph_pos_     = static_cast<uint32_t>(morph_pos_ * scale);
+        active_count_  = 0;
+        dirty_         = ALL_PARAMS_MASK;
+        mod_.SetSampleRate(sample_rate);
+    }
+
     /**
      * Trigger a note on
      */
@@ -371,6 +499,7 @@ class Engine
         v.active = true;
         v.gate = true;
         v.start_time = time_counter_++;
+        v.on_sample = sample_count_;
 
         // Reset oscillator phase to prevent clicks from random phase position
         v.osc1.Reset();
@@ -378,27 +507,38 @@ class Engine
 
         // Set oscillator frequencies
         float freq = mtof(note);
-        v.osc1.SetFreq(freq);
+        v.osc1_freq = freq;
 
         // Osc2 with detune (semitones)
-        float detune_ratio = powf(2.0f, params_.osc2_detune / 12.0f);
-        v.osc2.SetFreq(freq * detune_ratio);
+        float detune_ratio = powf(2.0f, params_->osc2_detune / 12.0f);
+        v.osc2_freq = freq * detune_ratio;
+
+        // Restart the voice LFO; pitch modulation applies from the first sample
+        mod_.Trigger(static_cast<uint8_t>(voice_idx), velocity);
+        float ratio = mod_.At(ModMatrix::DEST_PITCH, static_cast<uint8_t>(voice_idx), 0.0f);
+        v.osc1.SetFreq(v.osc1_freq * ratio);
+        v.osc2.SetFreq(v.osc2_freq * ratio);
 
         // Set oscillator waveforms
-        v.SetWaveform(v.osc1, params_.osc1_wave);
-        v.SetWaveform(v.osc2, params_.osc2_wave);
+        v.SetWaveform(v.osc1, params_->osc1_wave);
+        v.SetWaveform(v.osc2, params_->osc2_wave);
 
         // Set oscillator amplitudes (normalized to prevent clipping before filter)
-        float osc_sum = params_.osc1_level + params_.osc2_level;
+        float osc_sum = params_->osc1_level + params_->osc2_level;
         float osc_scale = (osc_sum > 1.0f) ? (1.0f / osc_sum) : 1.0f;
-        v.osc1.SetAmp(params_.osc1_level * osc_scale);
-        v.osc2.SetAmp(params_.osc2_level * osc_scale);
+        v.osc1.SetAmp(params_->osc1_level * osc_scale);
+        v.osc2.SetAmp(params_->osc2_level * osc_scale);
 
         // Hard retrigger envelopes (reset to zero for clean attack)
         v.amp_env.Retrigger(true);
         v.filt_env.Retrigger(true);
     }
 
+    /**
+     * Mod wheel position 0.0-1.0 (mod matrix source, audio callback)
+     */
+    void SetModWheel(float value) { mod_.SetModWheel(value); }
+
     /**
      * Release a note
      */
@@ -473,8 +613,331 @@ class Engine
      */
     float Process()
     {
-        float out = 0.0f;
+        float out, unused_left, unused_right;
+        RenderVoices(out, unused_left, unused_right, false);
+
+        // Apply level and soft clip (master_level applied in stereo output)
+        return SoftClip(out * params_->level);
+    }
+
+    /**
+     * Process all voices and return stereo output with panning
+     */
+    void ProcessStereo(float* out_left, float* out_right)
+    {
+        // pan: -1.0 = full left, 0.0 = center, +1.0 = full right
+        if(!mod_.IsActive(ModMatrix::DEST_PAN))
+        {
+            float mono = Process();  // Get mono sum
+
+            // Apply pan and master level
+            float left_gain  = (1.0f - params_->pan) * 0.5f;
+            float right_gain = (1.0f + params_->pan) * 0.5f;
+
+            *out_left  = mono * left_gain * params_->master_level;
+            *out_right = mono * right_gain * params_->master_level;
+            return;
+        }
+
+        // Pan modulation: every voice is placed on its own. The clip is
+        // worked out on the mono sum, as above, and its gain applied to
+        // both sides, so level and saturation do not jump when a pan
+        // route comes or goes.
+        float mono, left, right;
+        RenderVoices(mono, left, right, true);
+        float x    = mono * params_->level;
+        float gain = params_->level * params_->master_level;
+        if(x > 1.0f || x < -1.0f)
+            gain *= SoftClip(x) / x;
+        *out_left  = left * gain;
+        *out_right = right * gain;
+    }
+
+    /**
+     * Get number of active voices
+     */
+    uint8_t GetActiveCount() const { return active_count_; }
+
+    /**
+     * Check if NaN was detected (clears flag)
+     */
+    bool HadNaN()
+    {
+        bool v = nan_detected_;
+        nan_detected_ = false;
+        return v;
+    }
+
+    /**
+     * Check if stuck voice was detected (clears flag)
+     */
+    bool HadStuckVoice()
+    {
+        bool v = stuck_voice_detected_;
+        stuck_voice_detected_ = false;
+        return v;
+    }
+
+    /**
+     * Fill one VoiceDiag per voice (main loop; fields are read while the
+     * audio callback runs, so a voice may be a sample stale or mid-update)
+     */
+    void GetVoiceDiag(VoiceDiag (&out)[NUM_VOICES])
+    {
+        uint32_t now = sample_count_;
+        for(uint8_t i = 0; i < NUM_VOICES; i++)
+        {
+            SynthVoice& v = voices_[i];
+            VoiceDiag&  d = out[i];
+            d.note            = v.note;
+            d.velocity        = v.velocity;
+            d.active          = v.active;
+            d.gate            = v.gate;
+            d.stage           = v.active ? v.amp_env.GetCurrentSegment() : 0;
+            d.env             = v.last_env;
+            d.age_samples     = v.active ? now - v.on_sample : 0;
+            d.release_samples = v.release_samples;
+            d.cutoff          = v.last_cutoff;
+        }
+    }
+
+    /**
+     * Get current parameters
+     * While a preset change is pending or morphing this is the set being
+     * moved to, so the companion shows where the synth is heading.
+     */
+    const SynthParams& GetParams() const
+    {
+        return (staged_ || morphing_) ? sets_[live_ ^ 1] : *params_;
+    }
+
+    /**
+     * Set a single parameter by ID
+     * Only stores the value and marks it dirty; the voices pick it up at the
+     * next Update(), so several moves of the same knob cost one voice update.
+     * During a pending swap or morph the value is also written to both ends,
+     * so the knob holds through the transition.
+     */
+    void SetParam(ParamId id, float value)
+    {
+        if(!StoreParam(*params_, id, value))
+            return;
+        if(staged_ || morphing_)
+        {
+            StoreParam(sets_[live_ ^ 1], id, value);
+            StoreParam(morph_from_, id, value);
+        }
+        dirty_ |= 1u << id;
+    }
+
+    /**
+     * Get a single parameter by ID (current value, see GetParams)
+     */
+    float GetParam(ParamId id) const
+    {
+        const SynthParams& p = GetParams();
+        switch(id)
+        {
+            case PARAM_OSC1_WAVE: return p.osc1_wave;
+            case PARAM_OSC2_WAVE: return p.osc2_wave;
+            case PARAM_OSC1_LEVEL: return p.osc1_level;
+            case PARAM_OSC2_LEVEL: return p.osc2_level;
+            case PARAM_OSC2_DETUNE: return p.osc2_detune;
+            case PARAM_FILTER_CUTOFF: return p.filter_cutoff;
+            case PARAM_FILTER_RES: return p.filter_res;
+            case PARAM_FILTER_ENV_AMT: return p.filter_env_amt;
+            case PARAM_AMP_ATTACK: return p.amp_attack;
+            case PARAM_AMP_DECAY: return p.amp_decay;
+            case PARAM_AMP_SUSTAIN: return p.amp_sustain;
+            case PARAM_AMP_RELEASE: return p.amp_release;
+            case PARAM_FILT_ATTACK: return p.filt_attack;
+            case PARAM_FILT_DECAY: return p.filt_decay;
+            case PARAM_FILT_SUSTAIN: return p.filt_sustain;
+            case PARAM_FILT_RELEASE: return p.filt_release;
+            case PARAM_VEL_TO_AMP: return p.vel_to_amp;
+            case PARAM_VEL_TO_FILTER: return p.vel_to_filter;
+            case PARAM_LEVEL: return p.level;
+            case PARAM_PAN: return p.pan;
+            case PARAM_MASTER_LEVEL: return p.master_level;
+            case PARAM_LFO1_RATE: return p.lfo1_rate;
+            case PARAM_LFO1_WAVE: return p.lfo1_wave;
+            case PARAM_LFO2_RATE: return p.lfo2_rate;
+            case PARAM_LFO2_WAVE: return p.lfo2_wave;
+            case PARAM_LFO_DEPTH: return p.lfo_depth;
+            case PARAM_MOD1_ROUTE:
+            case PARAM_MOD2_ROUTE:
+            case PARAM_MOD3_ROUTE: return p.mod_route[(id - PARAM_MOD1_ROUTE) / 2];
+            case PARAM_MOD1_AMOUNT:
+            case PARAM_MOD2_AMOUNT:
+            case PARAM_MOD3_AMOUNT: return p.mod_amount[(id - PARAM_MOD1_ROUTE) / 2];
+            default: return 0.0f;
+        }
+    }
+
+    /**
+     * Block boundary work (audio callback, once per block, before rendering)
+     *
+     * Swaps in a staged parameter set or advances a preset morph, then
+     * pushes dirty parameters to the voices. Each parameter touches only the
+     * voice fields that depend on it. Oscillator settings are read at note
+     * on, and level/pan/velocity amounts are read per sample, so those only
+     * need clearing. Finally the mod matrix is evaluated for the block.
+     *
+     * @param block_size Samples in the block about to be rendered
+     */
+    void Update(size_t block_size)
+    {
+        if(staged_)
+        {
+            staged_ = false;
+            if(morph_samples_ == 0)
+            {
+                // Instant change: flip buffers
+                live_ ^= 1;
+                params_ = &sets_[live_];
+                dirty_  = ALL_PARAMS_MASK;
+            }
+            else
+            {
+                morph_from_ = *params_;
+                morph_pos_  = 0;
+                morphing_   = true;
+            }
+        }
+        if(morphing_)
+        {
+            AdvanceMorph(static_cast<uint32_t>(block_size));
+        }
+
+        uint32_t dirty = dirty_;
+        dirty_ = 0;
+
+        if(dirty & MOD_MASK)
+        {
+            mod_.SetConfig(ModConfig(*params_));
+        }
+        float filt_env[NUM_VOICES];
+        for(uint8_t i = 0; i < NUM_VOICES; i++)
+        {
+            filt_env[i] = voices_[i].mod_env;
+        }
+        mod_.Evaluate(block_size, filt_env);
+        block_size_ = static_cast<uint32_t>(block_size);
+        block_pos_  = 0;
+
+        if(dirty == 0)
+            return;
+
+        if(dirty & ENVELOPE_MASK)
+        {
+            for(uint8_t i = 0; i < NUM_VOICES; i++)
+            {
+                SynthVoice& v = voices_[i];
+                if(dirty & (1u << PARAM_AMP_ATTACK))
+                    v.amp_env.SetTime(ADSR_SEG_ATTACK, params_->amp_attack);
+                if(dirty & (1u << PARAM_AMP_DECAY))
+                    v.amp_env.SetTime(ADSR_SEG_DECAY, params_->amp_decay);
+                if(dirty & (1u << PARAM_AMP_SUSTAIN))
+                    v.amp_env.SetSustainLevel(params_->amp_sustain);
+                if(dirty & (1u << PARAM_AMP_RELEASE))
+                    v.amp_env.SetTime(ADSR_SEG_RELEASE, params_->amp_release);
+                if(dirty & (1u << PARAM_FILT_ATTACK))
+                    v.filt_env.SetTime(ADSR_SEG_ATTACK, params_->filt_attack);
+                if(dirty & (1u << PARAM_FILT_DECAY))
+                    v.filt_env.SetTime(ADSR_SEG_DECAY, params_->filt_decay);
+                if(dirty & (1u << PARAM_FILT_SUSTAIN))
+                    v.filt_env.SetSustainLevel(params_->filt_sustain);
+                if(dirty & (1u << PARAM_FILT_RELEASE))
+                    v.filt_env.SetTime(ADSR_SEG_RELEASE, params_->filt_release);
+            }
+        }
+
+        // Recompute filter coefficients on the next sample instead of
+        // waiting up to FILTER_UPDATE_RATE samples
+        if(dirty & FILTER_MASK)
+        {
+            filter_update_counter_ = 0;
+        }
+    }
+
+    /**
+     * Load a factory preset
+     * The preset is written to the back buffer and takes effect at the next
+     * block boundary, either at once or morphed over morph_ms.
+     * Level, pan and master level carry over unless the preset sets them.
+     */
+    void LoadPreset(uint8_t index, float morph_ms = 0.0f)
+    {
+        if(index >= NUM_FACTORY_PRESETS)
+            return;
+
+        SynthParams& next = sets_[live_ ^ 1];
+        next = *params_;
+        FactoryPresets::GetPreset(index, next);
+        Stage(morph_ms);
+        current_preset_ = index;
+    }
+
+    /**
+     * Set full preset from companion (applied like LoadPreset)
+     */
+    void SetPreset(const SynthParams& p, float morph_ms = 0.0f)
+    {
+        sets_[live_ ^ 1] = p;
+        Stage(morph_ms);
+    }
+
+    /**
+     * True while a preset morph is in progress
+     */
+    bool IsMorphing() const { return morphing_; }
+
+    /**
+     * Get current preset index
+     */
+    uint8_t GetCurrentPreset() const { return current_preset_; }
+
+  private:
+    /**
+     * Find a free voice or steal the oldest
+     */
+    int FindFreeVoice()
+    {
+        // First, look for an inactive voice
+        for(int i = 0; i < NUM_VOICES; i++)
+        {
+            if(!voices_[i].active)
+                return i;
+        }
+
+        // All voices active - steal the oldest
+        int oldest = 0;
+        uint32_t oldest_time = voices_[0].start_time;
+
+        for(int i = 1; i < NUM_VOICES; i++)
+        {
+            if(voices_[i].start_time < oldest_time)
+            {
+                oldest = i;
+                oldest_time = voices_[i].start_time;
+            }
+        }
+
+        return oldest;
+    }
+
+    /**
+     * Run every active voice for one sample
+     * The voice outputs are summed into mono and, when split is set, also
+     * placed by the synth pan plus their pan modulation into left/right.
+     */
+    void RenderVoices(float& mono, float& left, float& right, bool split)
+    {
+        mono  = 0.0f;
+        left  = 0.0f;
+        right = 0.0f;
         active_count_ = 0;
+        sample_count_++;
 
         // Determine if we should update filter params this sample
         bool update_filters = (filter_update_counter_ == 0);
@@ -482,6 +945,15 @@ class Engine
         if(filter_update_counter_ >= FILTER_UPDATE_RATE)
             filter_update_counter_ = 0;
 
+        // Position on the mod matrix ramps (the block's last sample reaches
+        // the value evaluated for its end)
+        if(block_pos_ < block_size_)
+            block_pos_++;
+        float pos        = static_cast<float>(block_pos_);
+        bool  mod_cutoff = mod_.IsActive(ModMatrix::DEST_CUTOFF);
+        bool  mod_pitch  = mod_.IsActive(ModMatrix::DEST_PITCH);
+        bool  mod_level  = mod_.IsActive(ModMatrix::DEST_LEVEL);
+
         for(uint8_t i = 0; i < NUM_VOICES; i++)
         {
             SynthVoice& v = voices_[i];
@@ -489,11 +961,19 @@ class Engine
             if(!v.active)
                 continue;
 
+            if(mod_pitch)
+            {
+                float ratio = mod_.At(ModMatrix::DEST_PITCH, i, pos);
+                v.osc1.SetFreq(v.osc1_freq * ratio);
+                v.osc2.SetFreq(v.osc2_freq * ratio);
+            }
+
             // Process oscillators
             float osc_out = v.osc1.Process() + v.osc2.Process();
 
             // Process filter envelope every sample (for smooth modulation)
             float filt_env = v.filt_env.Process(v.gate);
+            v.mod_env = filt_env;
 
             // Velocity normalization (used for both filter and amp modulation)
             float vel_norm = v.velocity / 127.0f;
@@ -505,13 +985,16 @@ class Engine
                 v.cached_filt_env = filt_env;
 
                 // Calculate filter cutoff with envelope and velocity modulation
-                float vel_mod = (vel_norm - 0.5f) * params_.vel_to_filter * 1500.0f;
-                float env_mod = v.cached_filt_env * params_.filter_env_amt * 2000.0f;
-                float cutoff = params_.filter_cutoff + vel_mod + env_mod;
+                float vel_mod = (vel_norm - 0.5f) * params_->vel_to_filter * 1500.0f;
+                float env_mod = v.cached_filt_env * params_->filter_env_amt * 2000.0f;
+                float cutoff = params_->filter_cutoff + vel_mod + env_mod;
+                if(mod_cutoff)
+                    cutoff *= mod_.At(ModMatrix::DEST_CUTOFF, i, pos);
                 cutoff = fclamp(cutoff, 20.0f, 12000.0f);
 
                 v.filter.SetFreq(cutoff);
-                v.filter.SetRes(fminf(params_.filter_res, 0.7f));
+                v.last_cutoff = cutoff;
+                v.filter.SetRes(fminf(params_->filter_res, 0.7f));
             }
 
             // Filter.Process() is cheap - called every sample
@@ -523,7 +1006,7 @@ class Engine
             v.last_env = amp_env;
 
             // Apply velocity to amplitude
-            float vel_amp = 1.0f - params_.vel_to_amp + (vel_norm * params_.vel_to_amp);
+            float vel_amp = 1.0f - params_->vel_to_amp + (vel_norm * params_->vel_to_amp);
 
             // Track release time for stuck detection
             if(!v.gate)
@@ -563,258 +1046,263 @@ class Engine
             }
 
             // Mix voice output (0.15 per voice = 0.60 max with 4 voices)
-            out += filt_out * amp_env * vel_amp * 0.15f;
+            float out = filt_out * amp_env * vel_amp * 0.15f;
+            if(mod_level)
+                out *= mod_.At(ModMatrix::DEST_LEVEL, i, pos);
+            mono += out;
+            if(split)
+            {
+                float pan = fclamp(params_->pan + mod_.At(ModMatrix::DEST_PAN, i, pos), -1.0f, 1.0f);
+                left  += out * (1.0f - pan) * 0.5f;
+                right += out * (1.0f + pan) * 0.5f;
+            }
             active_count_++;
         }
-
-        // Apply level and soft clip (master_level applied in stereo output)
-        return SoftClip(out * params_.level);
-    }
-
-    /**
-     * Process all voices and return stereo output with panning
-     */
-    void ProcessStereo(float* out_left, float* out_right)
-    {
-        float mono = Process();  // Get mono sum
-
-        // Apply pan and master level
-        // pan: -1.0 = full left, 0.0 = center, +1.0 = full right
-        float left_gain  = (1.0f - params_.pan) * 0.5f;
-        float right_gain = (1.0f + params_.pan) * 0.5f;
-
-        *out_left  = mono * left_gain * params_.master_level;
-        *out_right = mono * right_gain * params_.master_level;
-    }
-
-    /**
-     * Get number of active voices
-     */
-    uint8_t GetActiveCount() const { return active_count_; }
-
-    /**
-     * Check if NaN was detected (clears flag)
-     */
-    bool HadNaN()
-    {
-        bool v = nan_detected_;
-        nan_detected_ = false;
-        return v;
-    }
-
-    /**
-     * Check if stuck voice was detected (clears flag)
-     */
-    bool HadStuckVoice()
-    {
-        bool v = stuck_voice_detected_;
-        stuck_voice_detected_ = false;
-        return v;
-    }
-
-    /**
-     * Get diagnostic string for all voices
-     * Note: Using integer for envelope (0-99) because nano libc doesn't support %f
-     */
-    void GetVoiceDiagString(char* buf, size_t len)
-    {
-        int pos = 0;
-        pos += snprintf(buf + pos, len - pos, "V:");
-        for(int i = 0; i < NUM_VOICES && pos < (int)len - 20; i++)
-        {
-            SynthVoice& v = voices_[i];
-            int env_pct = static_cast<int>(v.last_env * 99.0f);  // 0-99%
-            pos += snprintf(buf + pos, len - pos, " %d[%c%c n%d e%d]",
-                i,
-                v.active ? 'A' : '-',
-                v.gate ? 'G' : '-',
-                v.note,
-                env_pct);
-        }
     }
 
     /**
-     * Get current parameters
-     */
-    const SynthParams& GetParams() const { return params_; }
-
-    /**
-     * Set a single parameter by ID
+     * Clamp and store one parameter into a set
+     * Returns false for an unknown ID.
      */
-    void SetParam(ParamId id, float value)
+    static bool StoreParam(SynthParams& p, ParamId id, float value)
     {
         switch(id)
         {
             case PARAM_OSC1_WAVE:
-                params_.osc1_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
+                p.osc1_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
                 break;
             case PARAM_OSC2_WAVE:
-                params_.osc2_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
+                p.osc2_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
                 break;
             case PARAM_OSC1_LEVEL:
-                params_.osc1_level = fclamp(value, 0.0f, 1.0f);
+                p.osc1_level = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_OSC2_LEVEL:
-                params_.osc2_level = fclamp(value, 0.0f, 1.0f);
+                p.osc2_level = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_OSC2_DETUNE:
-                params_.osc2_detune = static_cast<int8_t>(fclamp(value, -24.0f, 24.0f));
+                p.osc2_detune = static_cast<int8_t>(fclamp(value, -24.0f, 24.0f));
                 break;
             case PARAM_FILTER_CUTOFF:
-                params_.filter_cutoff = fclamp(value, 20.0f, 20000.0f);
+                p.filter_cutoff = fclamp(value, 20.0f, 20000.0f);
                 break;
             case PARAM_FILTER_RES:
-                params_.filter_res = fclamp(value, 0.0f, 1.0f);
+                p.filter_res = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_FILTER_ENV_AMT:
-                params_.filter_env_amt = fclamp(value, 0.0f, 1.0f);
+                p.filter_env_amt = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_AMP_ATTACK:
-                params_.amp_attack = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.amp_attack = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_AMP_DECAY:
-                params_.amp_decay = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.amp_decay = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_AMP_SUSTAIN:
-                params_.amp_sustain = fclamp(value, 0.0f, 1.0f);
-                ApplyEnvelopes();
+                p.amp_sustain = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_AMP_RELEASE:
-                params_.amp_release = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.amp_release = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_FILT_ATTACK:
-                params_.filt_attack = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.filt_attack = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_FILT_DECAY:
-                params_.filt_decay = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.filt_decay = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_FILT_SUSTAIN:
-                params_.filt_sustain = fclamp(value, 0.0f, 1.0f);
-                ApplyEnvelopes();
+                p.filt_sustain = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_FILT_RELEASE:
-                params_.filt_release = fclamp(value, 0.001f, 5.0f);
-                ApplyEnvelopes();
+                p.filt_release = fclamp(value, 0.001f, 5.0f);
                 break;
             case PARAM_VEL_TO_AMP:
-                params_.vel_to_amp = fclamp(value, 0.0f, 1.0f);
+                p.vel_to_amp = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_VEL_TO_FILTER:
-                params_.vel_to_filter = fclamp(value, 0.0f, 1.0f);
+                p.vel_to_filter = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_LEVEL:
-                params_.level = fclamp(value, 0.0f, 1.0f);
+                p.level = fclamp(value, 0.0f, 1.0f);
                 break;
             case PARAM_PAN:
-                params_.pan = fclamp(value, -1.0f, 1.0f);
+                p.pan = fclamp(value, -1.0f, 1.0f);
                 break;
             case PARAM_MASTER_LEVEL:
-                params_.master_level = fclamp(value, 0.0f, 1.0f);
+                p.master_level = fclamp(value, 0.0f, 1.0f);
                 break;
-            default:
+            case PARAM_LFO1_RATE:
+                p.lfo1_rate = fclamp(value, ModMatrix::LFO_MIN_HZ, ModMatrix::LFO_MAX_HZ);
+                break;
+            case PARAM_LFO1_WAVE:
+                p.lfo1_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
+                break;
+            case PARAM_LFO2_RATE:
+                p.lfo2_rate = fclamp(value, ModMatrix::LFO_MIN_HZ, ModMatrix::LFO_MAX_HZ);
+                break;
+            case PARAM_LFO2_WAVE:
+                p.lfo2_wave = static_cast<uint8_t>(value) % WAVE_COUNT;
+                break;
+            case PARAM_LFO_DEPTH:
+                p.lfo_depth = fclamp(value, 0.0f, 1.0f);
                 break;
+            case PARAM_MOD1_ROUTE:
+            case PARAM_MOD2_ROUTE:
+            case PARAM_MOD3_ROUTE:
+                p.mod_route[(id - PARAM_MOD1_ROUTE) / 2] =
+                    static_cast<uint8_t>(fclamp(value, 0.0f, ModMatrix::NUM_ROUTES - 1.0f));
+                break;
+            case PARAM_MOD1_AMOUNT:
+            case PARAM_MOD2_AMOUNT:
+            case PARAM_MOD3_AMOUNT:
+                p.mod_amount[(id - PARAM_MOD1_ROUTE) / 2] = fclamp(value, -1.0f, 1.0f);
+                break;
+            default:
+                return false;
         }
+        return true;
     }
 
     /**
-     * Load a factory preset
-     */
-    void LoadPreset(uint8_t index)
-    {
-        if(index >= NUM_FACTORY_PRESETS)
-            return;
-
-        FactoryPresets::GetPreset(index, params_);
-        ApplyParams();
-        current_preset_ = index;
-    }
-
-    /**
-     * Set full preset from companion
+     * Schedule the back buffer to go live at the next Update()
+     * A change staged mid-morph starts a new morph from the current values.
      */
-    void SetPreset(const SynthParams& p)
+    void Stage(float morph_ms)
     {
-        params_ = p;
-        ApplyParams();
+        float samples  = fmaxf(morph_ms, 0.0f) * sample_rate_ * 0.001f;
+        morph_samples_ = static_cast<uint32_t>(samples);
+        morphing_      = false;
+        staged_        = true;
     }
 
     /**
-     * Get current preset index
-     */
-    uint8_t GetCurrentPreset() const { return current_preset_; }
-
-  private:
-    /**
-     * Find a free voice or steal the oldest
+     * Interpolate the live set between morph_from_ and the back buffer
+     * Every continuous parameter is recomputed each block, so the cost is
+     * the same whatever changed. Discrete parameters (waveforms, detune)
+     * only affect new notes and switch halfway through.
      */
-    int FindFreeVoice()
+    void AdvanceMorph(uint32_t samples)
     {
-        // First, look for an inactive voice
-        for(int i = 0; i < NUM_VOICES; i++)
+        morph_pos_ += samples;
+        if(morph_pos_ >= morph_samples_)
         {
-            if(!voices_[i].active)
-                return i;
+            // Done: the back buffer becomes live
+            live_ ^= 1;
+            params_   = &sets_[live_];
+            morphing_ = false;
+            dirty_    = ALL_PARAMS_MASK;
+            return;
         }
 
-        // All voices active - steal the oldest
-        int oldest = 0;
-        uint32_t oldest_time = voices_[0].start_time;
-
-        for(int i = 1; i < NUM_VOICES; i++)
+        const SynthParams& a   = morph_from_;
+        const SynthParams& b   = sets_[live_ ^ 1];
+        SynthParams&       out = *params_;
+        float t = static_cast<float>(morph_pos_) / static_cast<float>(morph_samples_);
+
+        out.osc1_level     = Lerp(a.osc1_level, b.osc1_level, t);
+        out.osc2_level     = Lerp(a.osc2_level, b.osc2_level, t);
+        out.filter_cutoff  = a.filter_cutoff * powf(b.filter_cutoff / a.filter_cutoff, t);  // Log sweep
+        out.filter_res     = Lerp(a.filter_res, b.filter_res, t);
+        out.filter_env_amt = Lerp(a.filter_env_amt, b.filter_env_amt, t);
+        out.amp_attack     = Lerp(a.amp_attack, b.amp_attack, t);
+        out.amp_decay      = Lerp(a.amp_decay, b.amp_decay, t);
+        out.amp_sustain    = Lerp(a.amp_sustain, b.amp_sustain, t);
+        out.amp_release    = Lerp(a.amp_release, b.amp_release, t);
+        out.filt_attack    = Lerp(a.filt_attack, b.filt_attack, t);
+        out.filt_decay     = Lerp(a.filt_decay, b.filt_decay, t);
+        out.filt_sustain   = Lerp(a.filt_sustain, b.filt_sustain, t);
+        out.filt_release   = Lerp(a.filt_release, b.filt_release, t);
+        out.vel_to_amp     = Lerp(a.vel_to_amp, b.vel_to_amp, t);
+        out.vel_to_filter  = Lerp(a.vel_to_filter, b.vel_to_filter, t);
+        out.level          = Lerp(a.level, b.level, t);
+        out.pan            = Lerp(a.pan, b.pan, t);
+        out.master_level   = Lerp(a.master_level, b.master_level, t);
+        out.lfo1_rate      = Lerp(a.lfo1_rate, b.lfo1_rate, t);
+        out.lfo2_rate      = Lerp(a.lfo2_rate, b.lfo2_rate, t);
+        out.lfo_depth      = Lerp(a.lfo_depth, b.lfo_depth, t);
+
+        const SynthParams& discrete = (t < 0.5f) ? a : b;
+        out.osc1_wave   = discrete.osc1_wave;
+        out.osc2_wave   = discrete.osc2_wave;
+        out.osc2_detune = discrete.osc2_detune;
+        out.lfo1_wave   = discrete.lfo1_wave;
+        out.lfo2_wave   = discrete.lfo2_wave;
+
+        // A slot keeps its route while both ends agree, otherwise the old
+        // route fades out over the first half and the new one in over the second
+        for(uint8_t i = 0; i < ModMatrix::NUM_SLOTS; i++)
         {
-            if(voices_[i].start_time < oldest_time)
+            if(a.mod_route[i] == b.mod_route[i])
             {
-                oldest = i;
-                oldest_time = voices_[i].start_time;
+                out.mod_route[i]  = a.mod_route[i];
+                out.mod_amount[i] = Lerp(a.mod_amount[i], b.mod_amount[i], t);
+            }
+            else if(t < 0.5f)
+            {
+                out.mod_route[i]  = a.mod_route[i];
+                out.mod_amount[i] = a.mod_amount[i] * (1.0f - 2.0f * t);
+            }
+            else
+            {
+                out.mod_route[i]  = b.mod_route[i];
+                out.mod_amount[i] = b.mod_amount[i] * (2.0f * t - 1.0f);
             }
         }
 
-        return oldest;
+        dirty_ |= ALL_PARAMS_MASK;
     }
 
-    /**
-     * Apply current parameters to all voices
-     */
-    void ApplyParams()
-    {
-        ApplyEnvelopes();
-    }
+    static float Lerp(float a, float b, float t) { return a + (b - a) * t; }
 
-    /**
-     * Apply envelope parameters to all voices
-     */
-    void ApplyEnvelopes()
+    static ModMatrix::Config ModConfig(const SynthParams& p)
     {
-        for(uint8_t i = 0; i < NUM_VOICES; i++)
+        ModMatrix::Config c;
+        c.lfo_rate[0] = p.lfo1_rate;
+        c.lfo_rate[1] = p.lfo2_rate;
+        c.lfo_wave[0] = p.lfo1_wave;
+        c.lfo_wave[1] = p.lfo2_wave;
+        c.lfo_depth   = p.lfo_depth;
+        for(uint8_t i = 0; i < ModMatrix::NUM_SLOTS; i++)
         {
-            SynthVoice& v = voices_[i];
-
-            // Amp envelope
-            v.amp_env.SetTime(ADSR_SEG_ATTACK, params_.amp_attack);
-            v.amp_env.SetTime(ADSR_SEG_DECAY, params_.amp_decay);
-            v.amp_env.SetSustainLevel(params_.amp_sustain);
-            v.amp_env.SetTime(ADSR_SEG_RELEASE, params_.amp_release);
-
-            // Filter envelope
-            v.filt_env.SetTime(ADSR_SEG_ATTACK, params_.filt_attack);
-            v.filt_env.SetTime(ADSR_SEG_DECAY, params_.filt_decay);
-            v.filt_env.SetSustainLevel(params_.filt_sustain);
-            v.filt_env.SetTime(ADSR_SEG_RELEASE, params_.filt_release);
+            c.slots[i].route  = p.mod_route[i];
+            c.slots[i].amount = p.mod_amount[i];
         }
+        return c;
     }
 
+    // Dirty-bit groups over ParamId
+    static constexpr uint32_t ALL_PARAMS_MASK = 0xFFFFFFFFu >> (32 - PARAM_COUNT);
+    static constexpr uint32_t ENVELOPE_MASK =
+        ((1u << (PARAM_FILT_RELEASE + 1)) - 1) & ~((1u << PARAM_AMP_ATTACK) - 1);
+    static constexpr uint32_t FILTER_MASK =
+        (1u << PARAM_FILTER_CUTOFF) | (1u << PARAM_FILTER_RES)
+        | (1u << PARAM_FILTER_ENV_AMT) | (1u << PARAM_VEL_TO_FILTER);
+    static constexpr uint32_t MOD_MASK = ALL_PARAMS_MASK & ~((1u << PARAM_LFO1_RATE) - 1);
+    static_assert(PARAM_COUNT <= 32, "dirty_ holds one bit per ParamId");
+
     SynthVoice voices_[NUM_VOICES];
-    SynthParams params_;
+
+    // Double-buffered parameter sets: params_ points at sets_[live_], the
+    // other set receives preset changes until the next block boundary
+    SynthParams  sets_[2];
+    SynthParams* params_;
+    SynthParams  morph_from_;      // Live values when the morph started
+    uint8_t      live_;
+    bool         staged_;          // Back buffer waiting for Update()
+    bool         morphing_;
+    uint32_t     morph_samples_;   // Morph length (0 = instant swap)
+    uint32_t     morph_pos_;       // Samples into the morph
     float sample_rate_;
     volatile uint8_t active_count_;
     uint32_t time_counter_;
+    uint32_t sample_count_;           // Samples processed (voice age for diagnostics)
     uint8_t current_preset_;
     uint16_t filter_update_counter_;  // Counter for reduced filter update rate
+    uint32_t dirty_;                  // One bit per ParamId awaiting Update()
+
+    ModMatrix::Matrix<NUM_VOICES> mod_;
+    uint32_t block_size_;             // Samples in the block being rendered
+    uint32_t block_pos_;              // Samples rendered since Update()
 
     // Diagnostic flags (set in audio callback, read in main loop)
     volatile bool nan_detected_;
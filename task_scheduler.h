@@ -0,0 +1,216 @@
+#pragma once
+#ifndef GROOVYDAISY_TASK_SCHEDULER_H
+#define GROOVYDAISY_TASK_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * GroovyDaisy Main-Loop Task Scheduler
+ *
+ * Cooperative, run-to-completion scheduler for the work the main loop does
+ * outside the audio callback. Each task has a period (0 = every pass), a
+ * priority and a time budget:
+ *
+ *   INPUT    - controls, USB commands, audio notifications. Run at the
+ *              start of every pass and again after every other task, so a
+ *              command never waits behind more than one task.
+ *   REALTIME - the companion frame (MIDI monitor, state, clock).
+ *   NORMAL   - periodic reports.
+ *   BULK     - pattern sync, telemetry. Only started while the pass is
+ *              within PASS_BUDGET_US; otherwise deferred to the next pass.
+ *
+ * Due tasks run highest priority first, then earliest deadline. A task that
+ * falls more than a period behind skips the missed runs instead of
+ * bursting. Per task the scheduler records runs, average and worst run
+ * time, worst lateness (how long after its deadline it started), budget
+ * overruns and deferrals, for MSG_TASK_STATS.
+ */
+
+namespace TaskScheduler
+{
+
+constexpr size_t   MAX_TASKS      = 12;
+constexpr uint32_t PASS_BUDGET_US = 1000;  // Bulk tasks start only within this
+
+enum class Priority : uint8_t
+{
+    INPUT,
+    REALTIME,
+    NORMAL,
+    BULK,
+};
+
+typedef void (*TaskFn)(uint32_t now_ms);
+typedef uint32_t (*MicrosFn)();
+
+/**
+ * Per-task counters since the last ResetStats()
+ */
+struct Stats
+{
+    uint32_t runs;
+    uint32_t total_us;
+    uint32_t max_us;
+    uint32_t max_late_ms;
+    uint16_t overruns;  // Runs longer than the task's budget
+    uint16_t deferred;  // Passes a due bulk task waited for budget
+};
+
+struct Task
+{
+    const char* name;
+    TaskFn      fn;
+    Priority    priority;
+    uint32_t    period_ms;  // 0 = every pass
+    uint32_t    budget_us;
+    uint32_t    next_due;
+    bool        ran;        // Already run this pass
+    Stats       stats;
+};
+
+class Scheduler
+{
+  public:
+    void Init(MicrosFn micros)
+    {
+        micros_      = micros;
+        count_       = 0;
+        started_     = false;
+        max_pass_us_ = 0;
+    }
+
+    /**
+     * Register a task (before the first RunPass). Returns false when full.
+     */
+    bool Add(const char* name, TaskFn fn, Priority priority, uint32_t period_ms,
+             uint32_t budget_us)
+    {
+        if(count_ >= MAX_TASKS)
+            return false;
+        Task& t     = tasks_[count_++];
+        t.name      = name;
+        t.fn        = fn;
+        t.priority  = priority;
+        t.period_ms = period_ms;
+        t.budget_us = budget_us;
+        t.next_due  = 0;
+        t.ran       = false;
+        t.stats     = Stats();
+        return true;
+    }
+
+    /**
+     * One main-loop pass
+     */
+    void RunPass(uint32_t now_ms)
+    {
+        if(!started_)
+        {
+            for(size_t i = 0; i < count_; i++)
+                tasks_[i].next_due = now_ms;
+            started_ = true;
+        }
+
+        uint32_t pass_start = micros_();
+        for(size_t i = 0; i < count_; i++)
+            tasks_[i].ran = false;
+
+        RunInputs(now_ms);
+        while(true)
+        {
+            Task* next = nullptr;
+            for(size_t i = 0; i < count_; i++)
+            {
+                Task& t = tasks_[i];
+                if(t.ran || t.priority == Priority::INPUT || !IsDue(t, now_ms))
+                    continue;
+                if(!next || t.priority < next->priority
+                   || (t.priority == next->priority
+                       && static_cast<int32_t>(t.next_due - next->next_due) < 0))
+                {
+                    next = &t;
+                }
+            }
+            if(!next)
+                break;
+
+            next->ran = true;
+            if(next->priority == Priority::BULK && micros_() - pass_start >= PASS_BUDGET_US)
+            {
+                next->stats.deferred++;
+                continue;
+            }
+            Run(*next, now_ms);
+            RunInputs(now_ms);  // Preemption point
+        }
+
+        uint32_t pass_us = micros_() - pass_start;
+        if(pass_us > max_pass_us_)
+            max_pass_us_ = pass_us;
+    }
+
+    size_t      GetTaskCount() const { return count_; }
+    const Task& GetTask(size_t i) const { return tasks_[i]; }
+    uint32_t    GetMaxPassUs() const { return max_pass_us_; }
+
+    /**
+     * Start a new reporting window
+     */
+    void ResetStats()
+    {
+        for(size_t i = 0; i < count_; i++)
+            tasks_[i].stats = Stats();
+        max_pass_us_ = 0;
+    }
+
+  private:
+    static bool IsDue(const Task& t, uint32_t now_ms)
+    {
+        return t.period_ms == 0 || static_cast<int32_t>(now_ms - t.next_due) >= 0;
+    }
+
+    void RunInputs(uint32_t now_ms)
+    {
+        for(size_t i = 0; i < count_; i++)
+        {
+            if(tasks_[i].priority == Priority::INPUT && IsDue(tasks_[i], now_ms))
+                Run(tasks_[i], now_ms);
+        }
+    }
+
+    void Run(Task& t, uint32_t now_ms)
+    {
+        uint32_t late = t.period_ms > 0 ? now_ms - t.next_due : 0;
+        uint32_t start = micros_();
+        t.fn(now_ms);
+        uint32_t elapsed = micros_() - start;
+
+        Stats& s = t.stats;
+        s.runs++;
+        s.total_us += elapsed;
+        if(elapsed > s.max_us)
+            s.max_us = elapsed;
+        if(late > s.max_late_ms)
+            s.max_late_ms = late;
+        if(t.budget_us > 0 && elapsed > t.budget_us)
+            s.overruns++;
+
+        if(t.period_ms > 0)
+        {
+            t.next_due += t.period_ms;
+            if(static_cast<int32_t>(now_ms - t.next_due) >= 0)
+                t.next_due = now_ms + t.period_ms;  // Fell behind: skip, don't burst
+        }
+    }
+
+    MicrosFn micros_;
+    Task     tasks_[MAX_TASKS];
+    size_t   count_;
+    bool     started_;
+    uint32_t max_pass_us_;
+};
+
+} // namespace TaskScheduler
+
+#endif // GROOVYDAISY_TASK_SCHEDULER_H
@@ -0,0 +1,495 @@
+#pragma once
+#ifndef GROOVYDAISY_TELEMETRY_H
+#define GROOVYDAISY_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <atomic>
+#include "spsc_queue.h"
+
+/**
+ * GroovyDaisy Audio Telemetry
+ *
+ * Optional remote view of the output: per-bus peak/RMS, a clip flag, a
+ * scope trace and a coarse spectrum, streamed as MSG_TELEMETRY.
+ *
+ * The work is split so the audio callback stays cheap:
+ *   - Tap (audio callback): per sample, max/sum-of-squares for each bus and
+ *     one decimated mono master sample every `decimation` samples into a
+ *     ring. Per block, one BlockStats record into an SPSC queue. Disabled
+ *     (the default) it costs one branch per sample.
+ *   - Analyzer (main loop): drains the block records into peak/RMS, reads
+ *     the newest ring samples, finds a rising zero crossing for a stable
+ *     scope trace and runs a FFT_SIZE-point FFT folded into NUM_BANDS log
+ *     bands.
+ *
+ * The main loop measures how long each analysis takes and stretches the
+ * send interval so analysis never uses more than BUDGET_US_PER_SEC of
+ * main-loop time, whatever interval the companion asked for.
+ */
+
+namespace Telemetry
+{
+
+enum Bus : uint8_t
+{
+    BUS_SYNTH,   // Live synth
+    BUS_FROZEN,  // Frozen track playback
+    BUS_DRUMS,
+    BUS_MASTER,  // Final output (after master level, including the input pass-through)
+    NUM_BUSES,
+};
+
+constexpr uint32_t RING_SIZE     = 1024;  // Decimated master samples (power of two)
+constexpr uint32_t RING_MARGIN   = 256;   // Samples the writer may run ahead while we read
+constexpr uint32_t FFT_SIZE      = 256;
+constexpr uint32_t SCOPE_POINTS  = 128;
+constexpr uint32_t NUM_BANDS     = 24;
+constexpr float    LOWEST_BAND_HZ = 40.0f;
+
+constexpr uint8_t  DEFAULT_DECIMATION  = 2;   // 24 kHz at 48 kHz
+constexpr uint8_t  MAX_DECIMATION      = 8;
+constexpr uint16_t DEFAULT_INTERVAL_MS = 100;
+constexpr uint16_t MIN_INTERVAL_MS     = 20;
+constexpr uint32_t BUDGET_US_PER_SEC   = 5000;  // 0.5% of main-loop time
+
+// CMD_TELEMETRY_CONFIG / MSG_TELEMETRY flags
+constexpr uint8_t FLAG_ENABLE   = 0x01;  // Config only
+constexpr uint8_t FLAG_LEVELS   = 0x01;  // Message only (always set)
+constexpr uint8_t FLAG_SCOPE    = 0x02;
+constexpr uint8_t FLAG_SPECTRUM = 0x04;
+
+static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "Telemetry ring size must be a power of two");
+static_assert(FFT_SIZE + SCOPE_POINTS + RING_MARGIN <= RING_SIZE, "Telemetry ring too small");
+
+/**
+ * Level in dBFS -> half-dB steps above -100 dBFS (0 = silence, 200 = 0 dBFS)
+ */
+inline uint8_t EncodeDb(float db)
+{
+    float v = (db + 100.0f) * 2.0f + 0.5f;
+    if(v <= 0.0f)
+        return 0;
+    return v >= 255.0f ? 255 : static_cast<uint8_t>(v);
+}
+
+inline uint8_t EncodeLevel(float linear)
+{
+    return linear > 1e-5f ? EncodeDb(20.0f * log10f(linear)) : 0;
+}
+
+/**
+ * One audio block's bus statistics
+ */
+struct BlockStats
+{
+    float    peak[NUM_BUSES];
+    float    sum_sq[NUM_BUSES];  // Mean of L^2 and R^2, summed over the block
+    uint16_t samples;
+};
+
+/**
+ * Audio callback side. Configure() is applied through an engine command so
+ * it never changes mid-block.
+ */
+class Tap
+{
+  public:
+    void Init()
+    {
+        stats_.Init();
+        write_.store(0, std::memory_order_relaxed);
+        local_write_ = 0;
+        enabled_     = false;
+        decimation_  = DEFAULT_DECIMATION;
+        decim_count_ = 0;
+        decim_sum_   = 0.0f;
+    }
+
+    void Configure(bool enabled, uint8_t decimation)
+    {
+        enabled_     = enabled;
+        decimation_  = (decimation >= 1 && decimation <= MAX_DECIMATION) ? decimation
+                                                                         : DEFAULT_DECIMATION;
+        decim_count_ = 0;
+        decim_sum_   = 0.0f;
+    }
+
+    bool IsEnabled() const { return enabled_; }
+
+    // ---- Audio callback ----
+
+    void BeginBlock()
+    {
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            block_.peak[b]   = 0.0f;
+            block_.sum_sq[b] = 0.0f;
+        }
+        block_.samples = 0;
+    }
+
+    /**
+     * One stereo sample of every bus (only called while enabled)
+     */
+    void Process(const float (&left)[NUM_BUSES], const float (&right)[NUM_BUSES])
+    {
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            float l = fabsf(left[b]);
+            float r = fabsf(right[b]);
+            float m = l > r ? l : r;
+            if(m > block_.peak[b])
+                block_.peak[b] = m;
+            block_.sum_sq[b] += 0.5f * (l * l + r * r);
+        }
+        block_.samples++;
+
+        // Box-filter decimation of the mono master into the ring
+        decim_sum_ += left[BUS_MASTER] + right[BUS_MASTER];
+        if(++decim_count_ >= decimation_)
+        {
+            ring_[local_write_ & (RING_SIZE - 1)] = decim_sum_ / (2.0f * decim_count_);
+            local_write_++;
+            decim_count_ = 0;
+            decim_sum_   = 0.0f;
+        }
+    }
+
+    void EndBlock()
+    {
+        if(block_.samples == 0)
+            return;
+        write_.store(local_write_, std::memory_order_release);
+        stats_.Push(block_);
+    }
+
+    // ---- Main loop ----
+
+    bool PopStats(BlockStats& stats) { return stats_.Pop(stats); }
+
+    uint32_t GetOverflows() const { return stats_.GetOverflows(); }
+
+    /**
+     * Copy the newest `count` decimated samples, oldest first. Returns false
+     * if the writer lapped the copy (the ring starts out silent).
+     */
+    bool ReadLatest(float* out, uint32_t count) const
+    {
+        uint32_t end   = write_.load(std::memory_order_acquire);
+        uint32_t start = end - count;
+        for(uint32_t i = 0; i < count; i++)
+        {
+            out[i] = ring_[(start + i) & (RING_SIZE - 1)];
+        }
+        // The writer may be up to a block past `end` before publishing
+        uint32_t now = write_.load(std::memory_order_acquire);
+        return now + RING_MARGIN - start <= RING_SIZE;
+    }
+
+  private:
+    Spsc::Queue<BlockStats, 64> stats_;
+    float                       ring_[RING_SIZE];
+    std::atomic<uint32_t>       write_;        // Published write index
+    uint32_t                    local_write_;  // Audio-side write index
+    BlockStats                  block_;
+    bool                        enabled_;
+    uint8_t                     decimation_;
+    uint8_t                     decim_count_;
+    float                       decim_sum_;
+};
+
+/**
+ * One telemetry frame, ready to encode
+ */
+struct Frame
+{
+    uint8_t flags;
+    uint8_t clip;                      // Bit per bus that reached full scale
+    uint8_t peak[NUM_BUSES];           // EncodeLevel()
+    uint8_t rms[NUM_BUSES];
+    uint8_t decimation;
+    int8_t  scope[SCOPE_POINTS];       // Full scale = +-127
+    uint8_t bands[NUM_BANDS];          // EncodeDb(), log-spaced LOWEST_BAND_HZ..Nyquist
+};
+
+/**
+ * Main loop side: configuration, rate control and analysis
+ */
+class Analyzer
+{
+  public:
+    void Init(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        flags_       = 0;
+        interval_ms_ = DEFAULT_INTERVAL_MS;
+        decimation_  = DEFAULT_DECIMATION;
+        last_ms_     = 0;
+        cost_us_     = 0;
+        ResetLevels();
+
+        // Hann window and twiddles
+        const float two_pi = 6.28318530718f;
+        for(uint32_t i = 0; i < FFT_SIZE; i++)
+        {
+            window_[i] = 0.5f - 0.5f * cosf(two_pi * i / FFT_SIZE);
+        }
+        for(uint32_t i = 0; i < FFT_SIZE / 2; i++)
+        {
+            cos_[i] = cosf(two_pi * i / FFT_SIZE);
+            sin_[i] = -sinf(two_pi * i / FFT_SIZE);
+        }
+        SetupBands();
+    }
+
+    /**
+     * Follow an audio sample rate change, keeping the configuration
+     */
+    void SetSampleRate(float sample_rate)
+    {
+        sample_rate_ = sample_rate;
+        ResetLevels();
+        SetupBands();
+    }
+
+    /**
+     * Apply CMD_TELEMETRY_CONFIG (the caller forwards enable + decimation to
+     * the Tap through an engine command)
+     */
+    void Configure(uint8_t flags, uint16_t interval_ms, uint8_t decimation)
+    {
+        flags_       = flags;
+        interval_ms_ = interval_ms < MIN_INTERVAL_MS ? MIN_INTERVAL_MS : interval_ms;
+        decimation_  = (decimation >= 1 && decimation <= MAX_DECIMATION) ? decimation
+                                                                         : DEFAULT_DECIMATION;
+        ResetLevels();
+        SetupBands();
+    }
+
+    bool    IsEnabled() const { return flags_ & FLAG_ENABLE; }
+    uint8_t GetDecimation() const { return decimation_; }
+
+    /**
+     * Requested interval, stretched so analysis stays within budget
+     */
+    uint32_t GetIntervalMs() const
+    {
+        uint32_t budget_ms = cost_us_ * 1000 / BUDGET_US_PER_SEC;
+        return budget_ms > interval_ms_ ? budget_ms : interval_ms_;
+    }
+
+    bool Due(uint32_t now_ms) const { return IsEnabled() && now_ms - last_ms_ >= GetIntervalMs(); }
+
+    /**
+     * Fold queued block statistics into the running levels (call every frame
+     * so the queue never fills)
+     */
+    void Collect(Tap& tap)
+    {
+        BlockStats s;
+        while(tap.PopStats(s))
+        {
+            for(uint8_t b = 0; b < NUM_BUSES; b++)
+            {
+                if(s.peak[b] > peak_[b])
+                    peak_[b] = s.peak[b];
+                sum_sq_[b] += s.sum_sq[b];
+            }
+            samples_ += s.samples;
+        }
+    }
+
+    /**
+     * Build the next frame from the levels collected since the last one and
+     * the newest ring samples
+     */
+    void Analyze(const Tap& tap, Frame& frame, uint32_t now_ms)
+    {
+        last_ms_ = now_ms;
+
+        frame.flags      = FLAG_LEVELS;
+        frame.clip       = 0;
+        frame.decimation = decimation_;
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            float rms     = samples_ > 0 ? sqrtf(sum_sq_[b] / samples_) : 0.0f;
+            frame.peak[b] = EncodeLevel(peak_[b]);
+            frame.rms[b]  = EncodeLevel(rms);
+            if(peak_[b] >= 1.0f)
+                frame.clip |= 1 << b;
+        }
+        ResetLevels();
+
+        if(!(flags_ & (FLAG_SCOPE | FLAG_SPECTRUM)))
+            return;
+        if(!tap.ReadLatest(samples_buf_, FFT_SIZE + SCOPE_POINTS))
+            return;
+
+        if(flags_ & FLAG_SCOPE)
+        {
+            BuildScope(frame);
+            frame.flags |= FLAG_SCOPE;
+        }
+        if(flags_ & FLAG_SPECTRUM)
+        {
+            BuildSpectrum(frame);
+            frame.flags |= FLAG_SPECTRUM;
+        }
+    }
+
+    /**
+     * Record how long the last Analyze() took (System::GetUs() delta)
+     */
+    void SetCost(uint32_t elapsed_us)
+    {
+        // Smooth, but react quickly to a slower frame
+        cost_us_ = elapsed_us > cost_us_ ? elapsed_us : (cost_us_ * 7 + elapsed_us) / 8;
+    }
+
+    uint32_t GetCostUs() const { return cost_us_; }
+
+  private:
+    void ResetLevels()
+    {
+        for(uint8_t b = 0; b < NUM_BUSES; b++)
+        {
+            peak_[b]   = 0.0f;
+            sum_sq_[b] = 0.0f;
+        }
+        samples_ = 0;
+    }
+
+    // Band edges as FFT bins for the current decimated rate
+    void SetupBands()
+    {
+        float rate    = sample_rate_ / decimation_;
+        float nyquist = rate * 0.5f;
+        float lowest  = LOWEST_BAND_HZ < nyquist ? LOWEST_BAND_HZ : nyquist * 0.5f;
+        float ratio   = powf(nyquist / lowest, 1.0f / NUM_BANDS);
+        float hz      = lowest;
+        for(uint32_t b = 0; b <= NUM_BANDS; b++)
+        {
+            uint32_t bin = static_cast<uint32_t>(hz * FFT_SIZE / rate + 0.5f);
+            if(bin < 1)
+                bin = 1;
+            if(bin > FFT_SIZE / 2)
+                bin = FFT_SIZE / 2;
+            band_bin_[b] = static_cast<uint16_t>(bin);
+            hz *= ratio;
+        }
+    }
+
+    // Newest SCOPE_POINTS samples starting at a rising zero crossing
+    void BuildScope(Frame& frame) const
+    {
+        uint32_t start = FFT_SIZE;  // Free-running if no crossing is found
+        for(uint32_t i = FFT_SIZE; i > 1; i--)
+        {
+            if(samples_buf_[i - 1] < 0.0f && samples_buf_[i] >= 0.0f)
+            {
+                start = i;
+                break;
+            }
+        }
+        for(uint32_t i = 0; i < SCOPE_POINTS; i++)
+        {
+            float v = samples_buf_[start + i] * 127.0f;
+            v       = v > 127.0f ? 127.0f : (v < -127.0f ? -127.0f : v);
+            frame.scope[i] = static_cast<int8_t>(v);
+        }
+    }
+
+    void BuildSpectrum(Frame& frame)
+    {
+        const float* in = &samples_buf_[SCOPE_POINTS];
+        for(uint32_t i = 0; i < FFT_SIZE; i++)
+        {
+            re_[i] = in[i] * window_[i];
+            im_[i] = 0.0f;
+        }
+        Fft();
+
+        // Full-scale sine through a Hann window peaks at FFT_SIZE / 4
+        const float ref = 1.0f / ((FFT_SIZE / 4.0f) * (FFT_SIZE / 4.0f));
+        for(uint32_t b = 0; b < NUM_BANDS; b++)
+        {
+            uint32_t lo = band_bin_[b];
+            uint32_t hi = band_bin_[b + 1] > lo ? band_bin_[b + 1] : lo + 1;
+            float    power = 0.0f;
+            for(uint32_t k = lo; k < hi && k < FFT_SIZE / 2; k++)
+            {
+                float p = re_[k] * re_[k] + im_[k] * im_[k];
+                if(p > power)
+                    power = p;
+            }
+            power *= ref;
+            frame.bands[b] = power > 1e-10f ? EncodeDb(10.0f * log10f(power)) : 0;
+        }
+    }
+
+    // In-place iterative radix-2 FFT over re_/im_
+    void Fft()
+    {
+        for(uint32_t i = 1, j = 0; i < FFT_SIZE; i++)
+        {
+            uint32_t bit = FFT_SIZE >> 1;
+            for(; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if(i < j)
+            {
+                float t = re_[i];
+                re_[i]  = re_[j];
+                re_[j]  = t;
+                t       = im_[i];
+                im_[i]  = im_[j];
+                im_[j]  = t;
+            }
+        }
+        for(uint32_t len = 2; len <= FFT_SIZE; len <<= 1)
+        {
+            uint32_t step = FFT_SIZE / len;
+            for(uint32_t i = 0; i < FFT_SIZE; i += len)
+            {
+                for(uint32_t k = 0; k < len / 2; k++)
+                {
+                    float    wr = cos_[k * step];
+                    float    wi = sin_[k * step];
+                    uint32_t a  = i + k;
+                    uint32_t b  = a + len / 2;
+                    float    xr = re_[b] * wr - im_[b] * wi;
+                    float    xi = re_[b] * wi + im_[b] * wr;
+                    re_[b]      = re_[a] - xr;
+                    im_[b]      = im_[a] - xi;
+                    re_[a] += xr;
+                    im_[a] += xi;
+                }
+            }
+        }
+    }
+
+    float    sample_rate_;
+    uint8_t  flags_;
+    uint16_t interval_ms_;
+    uint8_t  decimation_;
+    uint32_t last_ms_;
+    uint32_t cost_us_;
+
+    float    peak_[NUM_BUSES];
+    float    sum_sq_[NUM_BUSES];
+    uint32_t samples_;
+
+    float    samples_buf_[FFT_SIZE + SCOPE_POINTS];
+    float    window_[FFT_SIZE];
+    float    cos_[FFT_SIZE / 2];
+    float    sin_[FFT_SIZE / 2];
+    float    re_[FFT_SIZE];
+    float    im_[FFT_SIZE];
+    uint16_t band_bin_[NUM_BANDS + 1];
+};
+
+} // namespace Telemetry
+
+#endif // GROOVYDAISY_TELEMETRY_H
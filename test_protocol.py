@@ -19,6 +19,7 @@ MSG_TRANSPORT = 0x02
 MSG_VOICES = 0x03
 MSG_MIDI_IN = 0x04
 MSG_CC_STATE = 0x05
+MSG_MIDI_BATCH = 0x0B
 MSG_DEBUG = 0xFF
 
 CMD_PLAY = 0x80
@@ -33,6 +34,7 @@ MSG_NAMES = {
     MSG_VOICES: "VOICES",
     MSG_MIDI_IN: "MIDI_IN",
     MSG_CC_STATE: "CC_STATE",
+    MSG_MIDI_BATCH: "MIDI_BATCH",
     MSG_DEBUG: "DEBUG",
 }
 
@@ -0,0 +1,412 @@
+#!/usr/bin/env python3
+"""
+CC bank map generator for GroovyDaisy.
+
+This file is the single source for the KeyLab CC layout: hardware CC numbers,
+parameter targets (with their value curve) and the four bank maps. It writes
+
+  cc_banks.h                               - firmware (included by cc_map.h)
+  companion/src/core/ccBanks.generated.ts  - companion (used by ccMappings.ts)
+
+Run via `make cc-tables` after editing the tables below, and commit the
+generated files.
+
+Usage: python3 tools/gen_cc_map.py [repo-root]
+"""
+
+import os
+import sys
+
+# Hardware CC numbers (in physical order L->R)
+ENCODER_CCS = [74, 71, 76, 77, 93, 18, 19, 16, 17]
+FADER_CCS = [73, 75, 79, 72, 80, 81, 82, 83, 85]
+
+# Bank switch CCs (Part 1 / Next, Part 2 / Prev)
+CC_BANK_NEXT = 1
+CC_BANK_PREV = 2
+
+# CC value -> parameter value conversion
+CURVES = [
+    ("NONE", "No conversion (unmapped)"),
+    ("NORM", "0.0-1.0 linear"),
+    ("FREQ", "20-20000 Hz logarithmic"),
+    ("TIME", "0.001-5.0 s logarithmic"),
+    ("WAVE", "Waveform index 0-3"),
+    ("SEMI", "-24 to +24 semitones"),
+    ("PAN", "-1.0 to +1.0"),
+    ("RATE", "0.05-20 Hz logarithmic (LFO)"),
+    ("ROUTE", "Mod matrix route 0-23"),
+    ("AMOUNT", "-1.0 to +1.0 (mod amount)"),
+]
+
+# Parameter targets in enum order. Synth targets follow Synth::ParamId
+# order (target = param id + 1).
+TARGETS = [
+    ("NONE", "NONE"),
+    # Synth params
+    ("SYNTH_OSC1_WAVE", "WAVE"),
+    ("SYNTH_OSC2_WAVE", "WAVE"),
+    ("SYNTH_OSC1_LEVEL", "NORM"),
+    ("SYNTH_OSC2_LEVEL", "NORM"),
+    ("SYNTH_OSC2_DETUNE", "SEMI"),
+    ("SYNTH_FILTER_CUTOFF", "FREQ"),
+    ("SYNTH_FILTER_RES", "NORM"),
+    ("SYNTH_FILTER_ENV_AMT", "NORM"),
+    ("SYNTH_AMP_ATTACK", "TIME"),
+    ("SYNTH_AMP_DECAY", "TIME"),
+    ("SYNTH_AMP_SUSTAIN", "NORM"),
+    ("SYNTH_AMP_RELEASE", "TIME"),
+    ("SYNTH_FILT_ATTACK", "TIME"),
+    ("SYNTH_FILT_DECAY", "TIME"),
+    ("SYNTH_FILT_SUSTAIN", "NORM"),
+    ("SYNTH_FILT_RELEASE", "TIME"),
+    ("SYNTH_VEL_TO_AMP", "NORM"),
+    ("SYNTH_VEL_TO_FILTER", "NORM"),
+    ("SYNTH_LEVEL", "NORM"),
+    ("SYNTH_PAN", "PAN"),
+    ("SYNTH_MASTER_LEVEL", "NORM"),
+    ("SYNTH_LFO1_RATE", "RATE"),
+    ("SYNTH_LFO1_WAVE", "WAVE"),
+    ("SYNTH_LFO2_RATE", "RATE"),
+    ("SYNTH_LFO2_WAVE", "WAVE"),
+    ("SYNTH_LFO_DEPTH", "NORM"),
+    ("SYNTH_MOD1_ROUTE", "ROUTE"),
+    ("SYNTH_MOD1_AMOUNT", "AMOUNT"),
+    ("SYNTH_MOD2_ROUTE", "ROUTE"),
+    ("SYNTH_MOD2_AMOUNT", "AMOUNT"),
+    ("SYNTH_MOD3_ROUTE", "ROUTE"),
+    ("SYNTH_MOD3_AMOUNT", "AMOUNT"),
+    # Drum params
+    ("DRUM_1_LEVEL", "NORM"),
+    ("DRUM_2_LEVEL", "NORM"),
+    ("DRUM_3_LEVEL", "NORM"),
+    ("DRUM_4_LEVEL", "NORM"),
+    ("DRUM_5_LEVEL", "NORM"),
+    ("DRUM_6_LEVEL", "NORM"),
+    ("DRUM_7_LEVEL", "NORM"),
+    ("DRUM_8_LEVEL", "NORM"),
+    ("DRUM_1_PAN", "PAN"),
+    ("DRUM_2_PAN", "PAN"),
+    ("DRUM_3_PAN", "PAN"),
+    ("DRUM_4_PAN", "PAN"),
+    ("DRUM_5_PAN", "PAN"),
+    ("DRUM_6_PAN", "PAN"),
+    ("DRUM_7_PAN", "PAN"),
+    ("DRUM_8_PAN", "PAN"),
+    ("DRUM_MASTER_LEVEL", "NORM"),
+    # Global params
+    ("MASTER_OUTPUT", "NORM"),
+]
+
+# Bank maps: (target, firmware name, companion name) per control
+UNUSED = ("NONE", "---", "---")
+
+BANKS = [
+    {
+        "name": "General",
+        "comment": "Master Controls + Modulation",
+        "encoders": [
+            ("SYNTH_LFO1_RATE", "LFO1Rt", "LFO1 Rate"),
+            ("SYNTH_LFO1_WAVE", "LFO1Wv", "LFO1 Wave"),
+            ("SYNTH_LFO2_RATE", "LFO2Rt", "LFO2 Rate"),
+            ("SYNTH_LFO2_WAVE", "LFO2Wv", "LFO2 Wave"),
+            ("SYNTH_MOD1_AMOUNT", "Mod1", "Mod 1"),
+            ("SYNTH_MOD2_AMOUNT", "Mod2", "Mod 2"),
+            ("SYNTH_MOD3_AMOUNT", "Mod3", "Mod 3"),
+            UNUSED,
+            UNUSED,
+        ],
+        "faders": [
+            ("DRUM_MASTER_LEVEL", "DrumMst", "Drum Mst"),
+            ("SYNTH_MASTER_LEVEL", "SynthMst", "Synth Mst"),
+            UNUSED,
+            ("SYNTH_LFO_DEPTH", "LFO Dep", "LFO Depth"),
+            UNUSED,
+            UNUSED,
+            ("SYNTH_VEL_TO_AMP", "Vel>Amp", "Vel>Amp"),
+            ("SYNTH_VEL_TO_FILTER", "Vel>Flt", "Vel>Flt"),
+            ("MASTER_OUTPUT", "Master", "Master"),
+        ],
+    },
+    {
+        "name": "Mix",
+        "comment": "Individual Levels + Pan",
+        "encoders": [
+            ("DRUM_1_PAN", "D1 Pan", "Kick Pan"),
+            ("DRUM_2_PAN", "D2 Pan", "Snare Pan"),
+            ("DRUM_3_PAN", "D3 Pan", "HH-C Pan"),
+            ("DRUM_4_PAN", "D4 Pan", "HH-O Pan"),
+            ("DRUM_5_PAN", "D5 Pan", "Clap Pan"),
+            ("DRUM_6_PAN", "D6 Pan", "TomL Pan"),
+            ("DRUM_7_PAN", "D7 Pan", "TomM Pan"),
+            ("DRUM_8_PAN", "D8 Pan", "Rim Pan"),
+            ("SYNTH_PAN", "Syn Pan", "Synth Pan"),
+        ],
+        "faders": [
+            ("DRUM_1_LEVEL", "D1 Lvl", "Kick"),
+            ("DRUM_2_LEVEL", "D2 Lvl", "Snare"),
+            ("DRUM_3_LEVEL", "D3 Lvl", "HH-C"),
+            ("DRUM_4_LEVEL", "D4 Lvl", "HH-O"),
+            ("DRUM_5_LEVEL", "D5 Lvl", "Clap"),
+            ("DRUM_6_LEVEL", "D6 Lvl", "Tom L"),
+            ("DRUM_7_LEVEL", "D7 Lvl", "Tom M"),
+            ("DRUM_8_LEVEL", "D8 Lvl", "Rim"),
+            ("SYNTH_LEVEL", "Syn Lvl", "Synth"),
+        ],
+    },
+    {
+        "name": "Synth",
+        "comment": "Sound Design",
+        "encoders": [
+            ("SYNTH_FILTER_CUTOFF", "Cutoff", "Cutoff"),
+            ("SYNTH_FILT_ATTACK", "FltAtk", "Flt Atk"),
+            ("SYNTH_FILT_DECAY", "FltDcy", "Flt Dcy"),
+            ("SYNTH_OSC2_DETUNE", "Detune", "Detune"),
+            ("SYNTH_AMP_ATTACK", "AmpAtk", "Amp Atk"),
+            ("SYNTH_AMP_DECAY", "AmpDcy", "Amp Dcy"),
+            ("SYNTH_AMP_RELEASE", "AmpRel", "Amp Rel"),
+            ("SYNTH_OSC1_WAVE", "Wave1", "Wave 1"),
+            ("SYNTH_OSC2_WAVE", "Wave2", "Wave 2"),
+        ],
+        "faders": [
+            ("SYNTH_OSC1_LEVEL", "Osc1", "Osc 1"),
+            ("SYNTH_OSC2_LEVEL", "Osc2", "Osc 2"),
+            ("SYNTH_FILTER_RES", "Reso", "Reso"),
+            ("SYNTH_FILTER_ENV_AMT", "FltEnv", "Flt Env"),
+            ("SYNTH_AMP_SUSTAIN", "AmpSus", "Amp Sus"),
+            ("SYNTH_FILT_SUSTAIN", "FltSus", "Flt Sus"),
+            ("SYNTH_FILT_RELEASE", "FltRel", "Flt Rel"),
+            ("SYNTH_LFO_DEPTH", "LFO Dep", "LFO Depth"),
+            ("SYNTH_LEVEL", "Syn Lvl", "Level"),
+        ],
+    },
+    {
+        "name": "Sampler",
+        "comment": "Per-Drum Sound Design - future",
+        "encoders": [
+            ("NONE", "Pitch", "Pitch"),    # Future: selected drum pitch
+            ("NONE", "Decay", "Decay"),    # Future: selected drum decay
+            ("NONE", "Filter", "Filter"),  # Future: selected drum filter
+            ("NONE", "FltRes", "Flt Res"), # Future: selected drum filter res
+            ("NONE", "Swing", "Swing"),    # Future: swing amount
+            UNUSED,
+            UNUSED,
+            UNUSED,
+            UNUSED,
+        ],
+        "faders": [
+            ("DRUM_1_LEVEL", "D1 Lvl", "Kick"),
+            ("DRUM_2_LEVEL", "D2 Lvl", "Snare"),
+            ("DRUM_3_LEVEL", "D3 Lvl", "HH-C"),
+            ("DRUM_4_LEVEL", "D4 Lvl", "HH-O"),
+            ("DRUM_5_LEVEL", "D5 Lvl", "Clap"),
+            ("DRUM_6_LEVEL", "D6 Lvl", "Tom L"),
+            ("DRUM_7_LEVEL", "D7 Lvl", "Tom M"),
+            ("DRUM_8_LEVEL", "D8 Lvl", "Rim"),
+            ("DRUM_MASTER_LEVEL", "DrumMst", "Drum Mst"),
+        ],
+    },
+]
+
+HEADER_NOTE = "Generated by tools/gen_cc_map.py - do not edit, run `make cc-tables`"
+
+
+def check():
+    """Validate the tables before generating anything."""
+    names = [t for t, _ in TARGETS]
+    curves = [c for c, _ in CURVES]
+    assert len(ENCODER_CCS) == 9 and len(FADER_CCS) == 9
+    assert len(set(ENCODER_CCS + FADER_CCS + [CC_BANK_NEXT, CC_BANK_PREV])) == 20, \
+        "CC numbers must be unique"
+    for _, curve in TARGETS:
+        assert curve in curves, curve
+    for bank in BANKS:
+        assert len(bank["encoders"]) == len(ENCODER_CCS), bank["name"]
+        assert len(bank["faders"]) == len(FADER_CCS), bank["name"]
+        for target, _, _ in bank["encoders"] + bank["faders"]:
+            assert target in names, target
+
+
+def gen_cpp():
+    out = []
+    w = out.append
+    w("#pragma once")
+    w("#ifndef GROOVYDAISY_CC_BANKS_H")
+    w("#define GROOVYDAISY_CC_BANKS_H")
+    w("")
+    w("#include <stdint.h>")
+    w("")
+    w("// " + HEADER_NOTE)
+    w("")
+    w("/**")
+    w(" * GroovyDaisy CC Bank Tables")
+    w(" *")
+    w(" * Hardware CC layout, parameter targets and bank maps. The companion's")
+    w(" * ccBanks.generated.ts is produced from the same source.")
+    w(" */")
+    w("")
+    w("namespace CCMap")
+    w("{")
+    w("")
+    w("// Bank switch CCs")
+    w("constexpr uint8_t CC_BANK_NEXT = %d;   // Part 1 / Next button" % CC_BANK_NEXT)
+    w("constexpr uint8_t CC_BANK_PREV = %d;   // Part 2 / Prev button" % CC_BANK_PREV)
+    w("")
+    w("// Hardware CC numbers")
+    w("constexpr uint8_t NUM_ENCODERS = %d;" % len(ENCODER_CCS))
+    w("constexpr uint8_t NUM_FADERS = %d;" % len(FADER_CCS))
+    w("")
+    w("// Encoder CCs (in physical order L->R)")
+    w("constexpr uint8_t ENCODER_CCS[NUM_ENCODERS] = {%s};" % ", ".join(map(str, ENCODER_CCS)))
+    w("")
+    w("// Fader CCs (in physical order L->R)")
+    w("constexpr uint8_t FADER_CCS[NUM_FADERS] = {%s};" % ", ".join(map(str, FADER_CCS)))
+    w("")
+    w("// CC value -> parameter value conversion")
+    w("enum Curve : uint8_t")
+    w("{")
+    for name, desc in CURVES:
+        w("    CURVE_%-6s // %s" % (name + ",", desc))
+    w("};")
+    w("")
+    w("// Parameter types for routing")
+    w("enum ParamTarget : uint8_t")
+    w("{")
+    for i, (name, _) in enumerate(TARGETS):
+        if i == 0:
+            w("    TARGET_NONE = 0,")
+        else:
+            w("    TARGET_%s," % name)
+    w("    TARGET_COUNT")
+    w("};")
+    w("")
+    w("// Value curve of each target")
+    w("constexpr Curve TARGET_CURVES[TARGET_COUNT] = {")
+    for name, curve in TARGETS:
+        w("    CURVE_%s,  // %s" % (curve, name))
+    w("};")
+    w("")
+    w("/**")
+    w(" * Mapping entry: what a control does in a specific bank")
+    w(" */")
+    w("struct ControlMapping")
+    w("{")
+    w("    ParamTarget target;")
+    w("    const char* name;")
+    w("};")
+    w("")
+    w("/**")
+    w(" * Bank mappings - what each encoder/fader does per bank")
+    w(" */")
+    w("struct BankMappings")
+    w("{")
+    w("    const char* bank_name;")
+    w("    ControlMapping encoders[NUM_ENCODERS];")
+    w("    ControlMapping faders[NUM_FADERS];")
+    w("};")
+    w("")
+    w("// Bank definitions")
+    w("enum Bank : uint8_t")
+    w("{")
+    for i, bank in enumerate(BANKS):
+        w("    BANK_%s = %d," % (bank["name"].upper(), i))
+    w("    NUM_BANKS = %d" % len(BANKS))
+    w("};")
+    for i, bank in enumerate(BANKS):
+        w("")
+        w("// Bank %d: %s (%s)" % (i, bank["name"], bank["comment"]))
+        w("constexpr BankMappings BANK_%s_MAP = {" % bank["name"].upper())
+        w('    "%s",' % bank["name"])
+        for section in ("encoders", "faders"):
+            w("    {")
+            for target, fw_name, _ in bank[section]:
+                w('        {TARGET_%s, "%s"},' % (target, fw_name))
+            w("    },")
+        w("};")
+    w("")
+    w("// All bank mappings array")
+    w("constexpr const BankMappings* ALL_BANKS[NUM_BANKS] = {")
+    w(",\n".join("    &BANK_%s_MAP" % b["name"].upper() for b in BANKS))
+    w("};")
+    w("")
+    w("} // namespace CCMap")
+    w("")
+    w("#endif // GROOVYDAISY_CC_BANKS_H")
+    return "\n".join(out) + "\n"
+
+
+def gen_ts():
+    out = []
+    w = out.append
+    w("/**")
+    w(" * CC bank tables for KeyLab Essential 61")
+    w(" *")
+    w(" * " + HEADER_NOTE)
+    w(" * (same source as the firmware's cc_banks.h)")
+    w(" */")
+    w("")
+    w("export const CC_BANK_NEXT = %d" % CC_BANK_NEXT)
+    w("export const CC_BANK_PREV = %d" % CC_BANK_PREV)
+    w("")
+    w("// Hardware CC numbers (in physical order L->R)")
+    w("export const ENCODER_CCS = [%s] as const" % ", ".join(map(str, ENCODER_CCS)))
+    w("export const FADER_CCS = [%s] as const" % ", ".join(map(str, FADER_CCS)))
+    w("")
+    w("// CC value -> parameter value conversion (matches cc_banks.h Curve)")
+    w("export enum Curve {")
+    for name, desc in CURVES:
+        w("  %s,  // %s" % (name, desc))
+    w("}")
+    w("")
+    w("// Parameter target types (matches cc_banks.h ParamTarget enum)")
+    w("export enum ParamTarget {")
+    for i, (name, _) in enumerate(TARGETS):
+        w("  %s%s," % (name, " = 0" if i == 0 else ""))
+    w("}")
+    w("")
+    w("// Value curve of each target, indexed by ParamTarget")
+    w("export const TARGET_CURVES: readonly Curve[] = [")
+    for name, curve in TARGETS:
+        w("  Curve.%s,  // %s" % (curve, name))
+    w("]")
+    w("")
+    w("export interface BankTableEntry {")
+    w("  target: ParamTarget")
+    w("  name: string")
+    w("}")
+    w("")
+    w("export interface BankTable {")
+    w("  bankName: string")
+    w("  encoders: BankTableEntry[]")
+    w("  faders: BankTableEntry[]")
+    w("}")
+    w("")
+    w("export const BANK_TABLES: BankTable[] = [")
+    for bank in BANKS:
+        w("  {")
+        w("    bankName: '%s'," % bank["name"])
+        for section in ("encoders", "faders"):
+            w("    %s: [" % section)
+            for target, _, ui_name in bank[section]:
+                w("      { target: ParamTarget.%s, name: '%s' }," % (target, ui_name))
+            w("    ],")
+        w("  },")
+    w("]")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    root = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "..")
+    check()
+    outputs = [
+        (os.path.join(root, "cc_banks.h"), gen_cpp()),
+        (os.path.join(root, "companion", "src", "core", "ccBanks.generated.ts"), gen_ts()),
+    ]
+    for path, text in outputs:
+        with open(path, "w") as f:
+            f.write(text)
+        print("wrote %s" % os.path.relpath(path, root))
+
+
+if __name__ == "__main__":
+    main()
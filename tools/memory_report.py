@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Memory placement report for the GroovyDaisy firmware.
+
+Lists where each hot/bulk/cold engine object landed (DTCM, AXI SRAM, SDRAM)
+and how much of each region is used. Run via `make memory-report`.
+
+Usage: python3 tools/memory_report.py build/GroovyDaisy.elf [nm-tool]
+"""
+
+import subprocess
+import sys
+
+# Region name, start address, size in bytes (STM32H750, libDaisy flash linker script)
+REGIONS = [
+    ("DTCM",     0x20000000, 128 * 1024),
+    ("AXI SRAM", 0x24000000, 512 * 1024),
+    ("SRAM D2",  0x30000000, 288 * 1024),
+    ("SRAM D3",  0x38000000, 64 * 1024),
+    ("SDRAM",    0xC0000000, 64 * 1024 * 1024),
+]
+
+# Objects we care about and the region they are expected to land in
+TRACKED = [
+    ("transport",           "DTCM"),
+    ("sampler",             "DTCM"),
+    ("synth",               "DTCM"),
+    ("cc_engine",           "DTCM"),
+    ("cc_coalescer",        "DTCM"),
+    ("audio_track_manager", "DTCM"),
+    ("sequencer",           "AXI SRAM"),
+    ("automation",          "AXI SRAM"),
+    ("sample_bank",         "SDRAM"),
+    ("frozen_track_L",      "SDRAM"),
+    ("frozen_track_R",      "SDRAM"),
+]
+
+
+def region_for(addr):
+    """Return the region name containing an address, or None."""
+    for name, start, size in REGIONS:
+        if start <= addr < start + size:
+            return name
+    return None
+
+
+def read_symbols(elf, nm):
+    """Return {name: (addr, size)} for all sized data symbols."""
+    out = subprocess.run([nm, "-S", "-C", "--defined-only", elf],
+                         check=True, capture_output=True, text=True).stdout
+    symbols = {}
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) != 4 or parts[2] not in "bBdD":
+            continue
+        symbols[parts[3]] = (int(parts[0], 16), int(parts[1], 16))
+    return symbols
+
+
+def format_size(n):
+    if n >= 1024 * 1024:
+        return "%.1f MB" % (n / (1024.0 * 1024.0))
+    if n >= 1024:
+        return "%.1f KB" % (n / 1024.0)
+    return "%d B" % n
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+
+    elf = sys.argv[1]
+    nm = sys.argv[2] if len(sys.argv) > 2 else "arm-none-eabi-nm"
+    symbols = read_symbols(elf, nm)
+
+    print("Hot/bulk/cold placement:")
+    misplaced = 0
+    for name, expected in TRACKED:
+        if name not in symbols:
+            print("  %-22s (not found)" % name)
+            continue
+        addr, size = symbols[name]
+        region = region_for(addr) or "?"
+        flag = "" if region == expected else "  <-- expected %s" % expected
+        if flag:
+            misplaced += 1
+        print("  %-22s 0x%08X %-9s %10s%s" % (name, addr, region, format_size(size), flag))
+
+    # Sum every sized data symbol per region
+    used = {name: 0 for name, _, _ in REGIONS}
+    for addr, size in symbols.values():
+        region = region_for(addr)
+        if region is not None:
+            used[region] += size
+
+    print("\nRegion usage (static data):")
+    for name, _, size in REGIONS:
+        pct = 100.0 * used[name] / size
+        print("  %-9s %10s / %-10s %5.1f%%" % (name, format_size(used[name]), format_size(size), pct))
+
+    return 1 if misplaced else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
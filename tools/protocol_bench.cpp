@@ -0,0 +1,257 @@
+/**
+ * GroovyDaisy protocol throughput benchmark (host)
+ *
+ * Encodes a representative mix of messages with protocol_codec.h, frames
+ * them (XOR and CRC-16 formats), then parses the stream back with the block
+ * Protocol::Parser and decodes every payload. Reports messages/s and MB/s
+ * for each stage so protocol changes can be measured.
+ *
+ * Build and run: make protocol-bench
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "protocol_codec.h"
+
+namespace Codec = ProtocolCodec;
+
+namespace
+{
+
+// Firmware-side parser limit; bulk chunks are benchmarked at this size so the
+// same Parser can read them back
+constexpr size_t BULK_SIZE = Protocol::MAX_PAYLOAD;
+
+constexpr int MIX_SIZE   = 8;      // Messages per mix round
+constexpr int ROUNDS     = 50000;  // Mix rounds per measurement
+
+struct Result
+{
+    double seconds;
+    size_t messages;
+    size_t bytes;
+};
+
+double Now()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Report(const char* name, const Result& r)
+{
+    printf("  %-22s %10.0f msg/s %8.1f MB/s\n", name, r.messages / r.seconds,
+           r.bytes / r.seconds / 1e6);
+}
+
+// Append one encoded + framed message to the stream
+template <typename M>
+size_t Emit(std::vector<uint8_t>& out, const M& msg, bool framed, uint8_t& seq)
+{
+    uint8_t payload[M::MAX_SIZE > 0 ? M::MAX_SIZE : 1];
+    size_t  len = msg.Encode(payload);
+    size_t  pos = out.size();
+    out.resize(pos + len + Protocol::FRAMED_OVERHEAD);
+    size_t n = framed ? Protocol::BuildFramedMessage(&out[pos], M::TYPE, seq++, payload, len)
+                      : Protocol::BuildMessage(&out[pos], M::TYPE, payload, len);
+    out.resize(pos + n);
+    return n;
+}
+
+// One frame's worth of typical traffic: tick, MIDI, state delta, bulk chunk...
+size_t EncodeMix(std::vector<uint8_t>& out, bool framed, uint8_t& seq, uint32_t i)
+{
+    static Codec::MidiEvent        events[12];
+    static Codec::StateDelta::Entry entries[6];
+    static uint8_t                  bulk[BULK_SIZE - 2];
+    static const char               text[] = "Pattern sync complete";
+
+    size_t messages = 0;
+
+    Codec::Tick tick;
+    tick.tick = i * 4;
+    Emit(out, tick, framed, seq);
+    messages++;
+
+    Codec::MidiBatch batch;
+    for(uint8_t e = 0; e < 12; e++)
+    {
+        events[e].status = 0x90;
+        events[e].data1  = static_cast<uint8_t>(36 + e);
+        events[e].data2  = static_cast<uint8_t>(i);
+    }
+    batch.events = events;
+    batch.count  = 12;
+    Emit(out, batch, framed, seq);
+    messages++;
+
+    Codec::StateDelta delta;
+    for(uint8_t e = 0; e < 6; e++)
+    {
+        entries[e].field = e;
+        entries[e].value = i + e;
+    }
+    delta.version = static_cast<uint16_t>(i);
+    delta.base    = static_cast<uint16_t>(i - 1);
+    delta.flags   = 0;
+    delta.entries = entries;
+    delta.count   = 6;
+    Emit(out, delta, framed, seq);
+    messages++;
+
+    Codec::PatternBulk chunk;
+    chunk.seq   = static_cast<uint8_t>(i);
+    chunk.flags = 0;
+    chunk.data  = bulk;
+    chunk.len   = sizeof(bulk);
+    Emit(out, chunk, framed, seq);
+    messages++;
+
+    Codec::Resources res;
+    res.memory_used  = 1 << 20;
+    res.memory_total = 64 << 20;
+    res.cpu_percent  = 42;
+    Emit(out, res, framed, seq);
+    messages++;
+
+    Codec::Debug dbg;
+    dbg.text = text;
+    dbg.len  = sizeof(text) - 1;
+    Emit(out, dbg, framed, seq);
+    messages++;
+
+    Codec::SynthParam param;
+    param.param_id = 5;
+    param.value    = 1000.0f + i;
+    Emit(out, param, framed, seq);
+    messages++;
+
+    Codec::BulkConfig config;
+    config.max_chunk = 1024;
+    config.window    = 8;
+    Emit(out, config, framed, seq);
+    messages++;
+
+    return messages;
+}
+
+// Decode the parser's current message; returns a value so the work is kept
+uint32_t DecodeCurrent(const Protocol::Parser& parser)
+{
+    switch(parser.type)
+    {
+        case Protocol::MSG_TICK:
+        {
+            Codec::Tick m;
+            return Codec::Decode(parser, m) ? m.tick : 0;
+        }
+        case Protocol::MSG_MIDI_BATCH:
+        {
+            Codec::MidiBatch m;
+            uint32_t         sum = 0;
+            if(Codec::Decode(parser, m))
+                for(size_t i = 0; i < m.count; i++)
+                    sum += m.EventAt(i).data1;
+            return sum;
+        }
+        case Protocol::MSG_STATE_DELTA:
+        {
+            Codec::StateDelta m;
+            uint32_t          sum = 0;
+            if(Codec::Decode(parser, m))
+                for(size_t i = 0; i < m.count; i++)
+                    sum += m.EntryAt(i).value;
+            return sum;
+        }
+        case Protocol::MSG_PATTERN_BULK:
+        {
+            Codec::PatternBulk m;
+            return Codec::Decode(parser, m) ? static_cast<uint32_t>(m.len) : 0;
+        }
+        case Protocol::MSG_RESOURCES:
+        {
+            Codec::Resources m;
+            return Codec::Decode(parser, m) ? m.cpu_percent : 0;
+        }
+        case Protocol::MSG_DEBUG:
+        {
+            Codec::Debug m;
+            return Codec::Decode(parser, m) ? static_cast<uint32_t>(m.len) : 0;
+        }
+        case Protocol::CMD_SYNTH_PARAM:
+        {
+            Codec::SynthParam m;
+            return Codec::Decode(parser, m) ? static_cast<uint32_t>(m.value) : 0;
+        }
+        case Protocol::CMD_BULK_CONFIG:
+        {
+            Codec::BulkConfig m;
+            return Codec::Decode(parser, m) ? m.max_chunk : 0;
+        }
+        default: return 0;
+    }
+}
+
+void Run(bool framed)
+{
+    printf("%s framing:\n", framed ? "CRC-16" : "XOR");
+
+    // Encode
+    std::vector<uint8_t> stream;
+    stream.reserve(static_cast<size_t>(ROUNDS) * MIX_SIZE * 64);
+    uint8_t seq      = 0;
+    size_t  messages = 0;
+    double  t0       = Now();
+    for(uint32_t i = 0; i < ROUNDS; i++)
+    {
+        messages += EncodeMix(stream, framed, seq, i);
+    }
+    Result enc = {Now() - t0, messages, stream.size()};
+    Report("encode + frame", enc);
+
+    // Parse + decode, fed in USB-sized blocks
+    Protocol::Parser parser;
+    parser.Reset();
+    parser.errors   = 0;
+    size_t   parsed = 0;
+    uint32_t sink   = 0;
+    t0              = Now();
+    for(size_t pos = 0; pos < stream.size();)
+    {
+        size_t block = stream.size() - pos < 64 ? stream.size() - pos : 64;
+        size_t used  = 0;
+        while(used < block)
+        {
+            bool complete;
+            used += parser.Feed(&stream[pos + used], block - used, complete);
+            if(complete)
+            {
+                sink += DecodeCurrent(parser);
+                parsed++;
+            }
+        }
+        pos += block;
+    }
+    Result dec = {Now() - t0, parsed, stream.size()};
+    Report("parse + decode", dec);
+
+    if(parsed != messages || parser.errors != 0)
+    {
+        printf("  MISMATCH: %zu sent, %zu parsed, %u errors\n", messages, parsed,
+               static_cast<unsigned>(parser.errors));
+        exit(1);
+    }
+    printf("  (%zu messages, %zu bytes, check %u)\n", messages, stream.size(), sink);
+}
+
+} // namespace
+
+int main()
+{
+    Run(false);
+    Run(true);
+    return 0;
+}
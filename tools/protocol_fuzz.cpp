@@ -0,0 +1,301 @@
+/**
+ * GroovyDaisy protocol parser fuzz harness (host)
+ *
+ * For each input it checks that Protocol::Parser:
+ *   - never overruns its payload buffer and only completes well-formed messages
+ *   - gives the same messages whether fed byte-by-byte or in blocks
+ *   - cannot be wedged: after any input plus MAX_PAYLOAD + FRAMED_OVERHEAD
+ *     non-sync bytes it is idle, and the next valid message parses exactly
+ * and runs every typed decoder in protocol_codec.h over each completed
+ * payload (out-of-bounds reads are caught by AddressSanitizer). Import
+ * payloads also go through the streaming MIDI file parser (smf.h).
+ *
+ * Standalone (random mutations of valid traffic):  make protocol-fuzz
+ * libFuzzer: clang++ -std=gnu++14 -g -O1 -fsanitize=fuzzer,address,undefined
+ *            -DPROTOCOL_FUZZ_LIBFUZZER -I. tools/protocol_fuzz.cpp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "protocol_codec.h"
+#include "smf.h"
+
+namespace Codec = ProtocolCodec;
+
+namespace
+{
+
+struct Message
+{
+    uint8_t              type;
+    bool                 framed;
+    uint8_t              seq;
+    std::vector<uint8_t> payload;
+
+    bool operator==(const Message& o) const
+    {
+        return type == o.type && framed == o.framed && (!framed || seq == o.seq)
+               && payload == o.payload;
+    }
+};
+
+void Fail(const char* what)
+{
+    fprintf(stderr, "protocol_fuzz: %s\n", what);
+    abort();
+}
+
+template <typename M>
+void TryDecode(const uint8_t* data, size_t len)
+{
+    M msg;
+    msg.Decode(data, len);
+}
+
+// Every decoder must stay inside the payload whatever the type byte said
+void DecodeAll(const uint8_t* data, size_t len)
+{
+    TryDecode<Codec::Tick>(data, len);
+    TryDecode<Codec::TransportState>(data, len);
+    TryDecode<Codec::Voices>(data, len);
+    TryDecode<Codec::MidiIn>(data, len);
+    TryDecode<Codec::CcState>(data, len);
+    TryDecode<Codec::SynthState>(data, len);
+    TryDecode<Codec::CcBank>(data, len);
+    TryDecode<Codec::FaderState>(data, len);
+    TryDecode<Codec::MixerState>(data, len);
+    TryDecode<Codec::TrackState>(data, len);
+    TryDecode<Codec::PatternClear>(data, len);
+    TryDecode<Codec::Resources>(data, len);
+    TryDecode<Codec::LinkGap>(data, len);
+    TryDecode<Codec::ClockSync>(data, len);
+    TryDecode<Codec::VoiceDiag>(data, len);
+
+    Codec::TaskStats tasks;
+    if(tasks.Decode(data, len))
+    {
+        volatile char sink = 0;
+        for(size_t i = 0; i < tasks.count; i++)
+            for(size_t c = 0; c < tasks.tasks[i].name_len; c++)
+                sink = sink + tasks.tasks[i].name[c];
+    }
+    TryDecode<Codec::Debug>(data, len);
+    TryDecode<Codec::Tempo>(data, len);
+    TryDecode<Codec::SynthParam>(data, len);
+    TryDecode<Codec::LoadPreset>(data, len);
+    TryDecode<Codec::ReqPattern>(data, len);
+    TryDecode<Codec::BulkConfig>(data, len);
+    TryDecode<Codec::StateAck>(data, len);
+    TryDecode<Codec::LinkNak>(data, len);
+    TryDecode<Codec::TelemetryConfig>(data, len);
+    TryDecode<Codec::SmfStatus>(data, len);
+    TryDecode<Codec::SmfExport>(data, len);
+    TryDecode<Codec::AudioStatus>(data, len);
+    TryDecode<Codec::AudioBench>(data, len);
+    TryDecode<Codec::AudioConfigCmd>(data, len);
+
+    // A file split across imports: the parser must cope with any bytes,
+    // including a valid header followed by garbage
+    Codec::SmfImport import;
+    if(import.Decode(data, len))
+    {
+        static const uint8_t header[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96};
+        Smf::Parser smf;
+        smf.Init(nullptr, nullptr);
+        smf.Feed(header, sizeof(header));
+        smf.Feed(import.data, import.len);
+        smf.Init(nullptr, nullptr);
+        smf.Feed(import.data, import.len);
+    }
+
+    Codec::MidiBatch batch;
+    if(batch.Decode(data, len))
+        for(size_t i = 0; i < batch.count; i++)
+            batch.EventAt(i);
+
+    Codec::StateDelta delta;
+    if(delta.Decode(data, len))
+        for(size_t i = 0; i < delta.count; i++)
+            delta.EntryAt(i);
+
+    Codec::PatternDump dump;
+    if(dump.Decode(data, len))
+    {
+        volatile uint8_t sink = 0;
+        for(size_t i = 0; i < dump.count * Codec::PatternDump::EVENT_SIZE; i++)
+            sink = sink + dump.events[i];
+    }
+
+    Codec::Telemetry telemetry;
+    if(telemetry.Decode(data, len))
+    {
+        volatile int sink = 0;
+        for(size_t i = 0; i < telemetry.scope_count; i++)
+            sink = sink + telemetry.scope[i];
+        for(size_t i = 0; i < telemetry.band_count; i++)
+            sink = sink + telemetry.bands[i];
+    }
+
+    Codec::PatternBulk bulk;
+    if(bulk.Decode(data, len) && bulk.len > 0)
+    {
+        volatile uint8_t sink = bulk.data[bulk.len - 1];
+        (void)sink;
+    }
+}
+
+Message Capture(const Protocol::Parser& parser)
+{
+    if(parser.payload_len > Protocol::MAX_PAYLOAD)
+        Fail("completed message longer than MAX_PAYLOAD");
+    Message m;
+    m.type   = parser.type;
+    m.framed = parser.framed;
+    m.seq    = parser.seq;
+    m.payload.assign(parser.payload, parser.payload + parser.payload_len);
+    DecodeAll(m.payload.data(), m.payload.size());
+    return m;
+}
+
+std::vector<Message> FeedBytes(Protocol::Parser& parser, const uint8_t* data, size_t size)
+{
+    std::vector<Message> out;
+    for(size_t i = 0; i < size; i++)
+    {
+        if(parser.Feed(data[i]))
+            out.push_back(Capture(parser));
+    }
+    return out;
+}
+
+std::vector<Message> FeedBlocks(Protocol::Parser& parser, const uint8_t* data, size_t size)
+{
+    std::vector<Message> out;
+    size_t pos = 0;
+    size_t step = 1;
+    while(pos < size)
+    {
+        // Vary the block size so blocks split headers and payloads everywhere
+        size_t block = size - pos < step ? size - pos : step;
+        step         = step * 3 % 97 + 1;
+        size_t used  = 0;
+        while(used < block)
+        {
+            bool   complete;
+            size_t n = parser.Feed(data + pos + used, block - used, complete);
+            if(n == 0 || n > block - used)
+                Fail("block Feed consumed an impossible byte count");
+            used += n;
+            if(complete)
+                out.push_back(Capture(parser));
+        }
+        pos += block;
+    }
+    return out;
+}
+
+void CheckInput(const uint8_t* data, size_t size)
+{
+    Protocol::Parser bytewise;
+    Protocol::Parser blockwise;
+    bytewise.Reset();
+    blockwise.Reset();
+    bytewise.errors  = 0;
+    blockwise.errors = 0;
+
+    if(!(FeedBytes(bytewise, data, size) == FeedBlocks(blockwise, data, size)))
+        Fail("byte and block feeding disagree");
+    if(bytewise.errors != blockwise.errors)
+        Fail("byte and block feeding count different errors");
+
+    // Recovery: filler that can never start a message drains any partial one
+    std::vector<uint8_t> tail(Protocol::MAX_PAYLOAD + Protocol::FRAMED_OVERHEAD, 0x00);
+    FeedBlocks(blockwise, tail.data(), tail.size());
+    if(!blockwise.IsIdle())
+        Fail("parser not idle after filler");
+
+    uint8_t probe_payload[3] = {0x12, Protocol::SYNC_BYTE, Protocol::SYNC_FRAMED};
+    uint8_t probe[Protocol::MAX_MESSAGE];
+    size_t  n = Protocol::BuildMessage(probe, Protocol::MSG_MIDI_IN, probe_payload, 3);
+    std::vector<Message> got = FeedBlocks(blockwise, probe, n);
+    if(got.size() != 1 || got[0].type != Protocol::MSG_MIDI_IN || got[0].payload.size() != 3
+       || memcmp(got[0].payload.data(), probe_payload, 3) != 0)
+        Fail("valid message after garbage not recovered");
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    CheckInput(data, size);
+    return 0;
+}
+
+#ifndef PROTOCOL_FUZZ_LIBFUZZER
+
+namespace
+{
+
+uint32_t rng_state = 0x12345678;
+
+uint32_t Rand()
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Valid traffic of both formats, then a few random mutations
+std::vector<uint8_t> MakeInput()
+{
+    std::vector<uint8_t> data;
+    uint32_t count = Rand() % 8;
+    for(uint32_t m = 0; m < count; m++)
+    {
+        uint8_t payload[Protocol::MAX_PAYLOAD];
+        size_t  len = Rand() % 4 == 0 ? Rand() % (Protocol::MAX_PAYLOAD + 1) : Rand() % 16;
+        for(size_t i = 0; i < len; i++)
+            payload[i] = static_cast<uint8_t>(Rand());
+
+        uint8_t frame[Protocol::MAX_PAYLOAD + Protocol::FRAMED_OVERHEAD];
+        uint8_t type = static_cast<uint8_t>(Rand());
+        size_t  n    = Rand() & 1 ? Protocol::BuildFramedMessage(frame, type, Rand(), payload, len)
+                                  : Protocol::BuildMessage(frame, type, payload, len);
+        data.insert(data.end(), frame, frame + n);
+    }
+
+    uint32_t mutations = Rand() % 6;
+    for(uint32_t m = 0; m < mutations && !data.empty(); m++)
+    {
+        size_t pos = Rand() % data.size();
+        switch(Rand() % 5)
+        {
+            case 0: data[pos] ^= 1 << (Rand() % 8); break;
+            case 1: data[pos] = Rand() & 1 ? Protocol::SYNC_BYTE : Protocol::SYNC_FRAMED; break;
+            case 2: data.erase(data.begin() + pos); break;
+            case 3: data.insert(data.begin() + pos, static_cast<uint8_t>(Rand())); break;
+            case 4: data[pos] = 0xFF; break;  // Length high byte -> oversize
+        }
+    }
+    return data;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    for(long i = 0; i < iterations; i++)
+    {
+        std::vector<uint8_t> input = MakeInput();
+        CheckInput(input.data(), input.size());
+    }
+    printf("protocol_fuzz: %ld inputs OK\n", iterations);
+    return 0;
+}
+
+#endif
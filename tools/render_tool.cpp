@@ -0,0 +1,916 @@
+/**
+ * GroovyDaisy batch renderer (host)
+ *
+ *   render_tool [-j N] [-bars N] [-loops N] [-chunk S] [-preroll S] [-tail S]
+ *               [-rate HZ] [-block N] [-bench S] <path>...
+ *
+ * Renders session images (.session) and MIDI files (.mid/.midi) to stereo
+ * float WAVs next to each input (<input>.wav); a directory argument renders every
+ * such file in it. The engine is the firmware's own headers (transport,
+ * sequencer, automation, CC map, router, synth, sampler) built for the host
+ * against DaisySP's sources, wired the way the audio callback wires them:
+ * -block frame blocks (default 64) at -rate (default 48000, see
+ * audio_config.h), sequencer and automation on each tick, CC changes applied
+ * once per block. Live input, frozen tracks and telemetry are not part of an
+ * offline render. A session's pattern length is not stored, so -bars
+ * (default 4) sets it, as for smf_tool; the song is -loops passes of the
+ * pattern (default 8) plus -tail seconds of release after the stop.
+ *
+ * Each worker thread owns one engine instance, reset and reloaded for every
+ * task. A task is one chunk (-chunk seconds, default 20) of one song, so a
+ * long song keeps several cores busy. A chunk that does not start the song
+ * fast-forwards the transport, sequencer and automation to -preroll seconds
+ * before its start without producing audio (notes muted, CC changes still
+ * applied), then renders the preroll and discards it so voices ringing into
+ * the chunk are there at its first frame. Tasks are dealt round-robin to
+ * per-worker deques; a worker takes from the back of its own and steals
+ * from the front of the others'. The worker finishing a song's last chunk
+ * writes its file.
+ *
+ * Throughput is reported in realtime multiples: song audio rendered per
+ * CPU second of each worker, per CPU second over all workers (per core),
+ * and per second of wall time for the whole run.
+ *
+ * -bench S writes no files: for every rate and block size of the firmware's
+ * benchmark matrix it renders the first S seconds of each input on one
+ * thread, one block at a time, and prints the average and worst block's CPU
+ * time as a share of the block period next to the MIDI-to-output latency.
+ * Host loads only rank the settings; CMD_AUDIO_BENCH measures the device.
+ *
+ * Build: make render-tool (DAISYSP_DIR as for the firmware)
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "transport.h"
+#include "sampler.h"
+#include "sequencer.h"
+#include "synth.h"
+#include "cc_map.h"
+#include "midi_router.h"
+#include "automation.h"
+#include "session.h"
+#include "smf.h"
+#include "audio_config.h"
+#include "samples/drums.h"
+
+namespace Codec = ProtocolCodec;
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+double Seconds(Clock::time_point since)
+{
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+// CPU time of the calling thread: per-core figures stay honest with more
+// workers than cores
+double ThreadSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Render settings (command line)
+uint32_t pattern_ticks   = Transport::DEFAULT_BARS * Transport::TICKS_PER_BAR;
+uint32_t loops           = 8;
+float    chunk_seconds   = 20.0f;
+float    preroll_seconds = 2.0f;
+float    tail_seconds    = 2.0f;
+float    render_rate     = AudioConfig::DEFAULT_RATE;
+size_t   block_size      = AudioConfig::DEFAULT_BLOCK;
+float    bench_seconds   = 0.0f;  // 0: render files
+
+// Drum samples, generated once per rate and shared read-only by every engine
+DrumSamples::SampleBank* sample_bank;
+
+/**
+ * One input file and its rendered song
+ */
+struct Job
+{
+    std::string          path;
+    bool                 midi;
+    std::vector<uint8_t> file;    // Session image or MIDI file, reloaded per task
+    uint64_t             song;    // Frames while the transport runs
+    uint64_t             frames;  // Song + tail
+    std::vector<float>   out;     // Interleaved stereo
+    std::atomic<uint32_t> pending;
+    uint32_t             notes, points, dropped;
+};
+
+/**
+ * Frames [start, start + frames) of one job
+ */
+struct Task
+{
+    Job*     job;
+    uint64_t start;
+    uint64_t frames;
+};
+
+// ============================================================================
+// Engine
+
+/**
+ * The firmware's engines for one offline render
+ * Engine callbacks are plain function pointers, so they reach the instance
+ * through the calling thread's active renderer.
+ */
+class Renderer
+{
+  public:
+    void Init()
+    {
+        transport_.Init(render_rate);
+        sequencer_.Init(pattern_ticks);
+        automation_.Init(pattern_ticks);
+        sampler_.Init();
+        sampler_.SetSampleRate(render_rate);
+        synth_.Init(render_rate);
+        router_.Init(&sampler_, &synth_, IgnoreMidiOut);
+        cc_engine_.Init();
+        cc_coalescer_.Init(ApplyParamTarget);
+        sequencer_.SetPlaybackCallback(SequencerPlayback);
+
+        const DrumSamples::SampleBank& bank = *sample_bank;
+        sampler_.LoadSample(0, bank.kick, bank.Length(DrumSamples::KICK_LENGTH), "Kick");
+        sampler_.LoadSample(1, bank.snare, bank.Length(DrumSamples::SNARE_LENGTH), "Snare");
+        sampler_.LoadSample(2, bank.hihat_closed, bank.Length(DrumSamples::HIHAT_C_LENGTH), "HH Closed");
+        sampler_.LoadSample(3, bank.hihat_open, bank.Length(DrumSamples::HIHAT_O_LENGTH), "HH Open");
+        sampler_.LoadSample(4, bank.clap, bank.Length(DrumSamples::CLAP_LENGTH), "Clap");
+        sampler_.LoadSample(5, bank.tom_low, bank.Length(DrumSamples::TOM_LOW_LENGTH), "Tom Low");
+        sampler_.LoadSample(6, bank.tom_mid, bank.Length(DrumSamples::TOM_MID_LENGTH), "Tom Mid");
+        sampler_.LoadSample(7, bank.rim, bank.Length(DrumSamples::RIM_LENGTH), "Rim");
+
+        audible_   = true;
+        tempo_set_ = false;
+        frame_     = 0;
+        stop_at_   = 0;
+        notes_ = points_ = dropped_ = 0;
+    }
+
+    /**
+     * Reset to power-on state and load a job's session or MIDI file
+     * @return false if the file holds nothing to render
+     */
+    bool Load(const Job& job)
+    {
+        active = this;
+        Init();
+        return job.midi ? LoadMidi(job) : LoadSession(job);
+    }
+
+    /**
+     * Start playback from the top, stopping the transport after song frames
+     */
+    void Play(uint64_t song)
+    {
+        automation_.CaptureBaseValues();
+        automation_.ResetPlayback();
+        transport_.Play();
+        stop_at_ = song;
+    }
+
+    /**
+     * Render whole blocks; out == nullptr advances the transport, sequencer
+     * and automation without notes or audio
+     */
+    void Render(float* out, uint64_t frames)
+    {
+        active   = this;
+        audible_ = out != nullptr;
+        while(frames > 0)
+        {
+            size_t size = frames < block_size ? static_cast<size_t>(frames) : block_size;
+            RenderBlock(out, size);
+            frames -= size;
+            if(out)
+                out += 2 * size;
+        }
+    }
+
+    uint16_t GetBpm() const { return transport_.GetBpm(); }
+    uint32_t GetNotes() const { return notes_; }
+    uint32_t GetPoints() const { return points_; }
+    uint32_t GetDropped() const { return dropped_; }
+
+  private:
+    void RenderBlock(float* out, size_t size)
+    {
+        if(audible_)
+            synth_.Update(size);
+
+        for(size_t i = 0; i < size; i++, frame_++)
+        {
+            // Song end: the STOP command's engine side
+            if(frame_ == stop_at_ && !transport_.IsStopped())
+            {
+                transport_.Stop();
+                synth_.AllNotesOff();
+                sequencer_.ResetPlayback();
+                automation_.ResetPlayback();
+            }
+
+            if(transport_.Process() && transport_.IsPlaying())
+            {
+                uint32_t tick = transport_.GetPosition().tick;
+                sequencer_.Process(tick);
+                automation_.Process(tick, AutomationPlayback);
+            }
+            if(!out)
+                continue;
+
+            float synth_left, synth_right, drum_left, drum_right;
+            synth_.ProcessStereo(&synth_left, &synth_right);
+            sampler_.ProcessStereo(&drum_left, &drum_right);
+            float master = cc_engine_.GetMasterOutput();
+            out[2 * i]     = (synth_left + drum_left) * master;
+            out[2 * i + 1] = (synth_right + drum_right) * master;
+        }
+
+        cc_coalescer_.Flush();
+    }
+
+    // Same as the firmware's ApplySessionChunk (frozen tracks are not rendered)
+    bool LoadSession(const Job& job)
+    {
+        using namespace Session;
+
+        Directory dir;
+        dir.Scan(job.file.data(), job.file.size());
+        if(dir.GetValidCount() == 0)
+            return false;
+
+        for(uint8_t id = 0; id < CHUNK_TRACKS; id++)
+        {
+            const Chunk& chunk = dir.Get(id);
+            if(!chunk.valid)
+                continue;
+            Codec::Reader r(chunk.data, chunk.len);
+
+            if(id == CHUNK_TRANSPORT)
+            {
+                uint16_t bpm   = r.U16();
+                uint8_t  flags = r.U8();
+                if(!r.ok)
+                    continue;
+                transport_.SetBpm(bpm);
+                sequencer_.SetOverdubMode(flags & TRANSPORT_OVERDUB);
+                automation_.SetBlendEnabled(flags & TRANSPORT_BLEND);
+            }
+            else if(id == CHUNK_MIXER)
+            {
+                float levels[NUM_DRUMS], pans[NUM_DRUMS];
+                for(uint8_t i = 0; i < NUM_DRUMS; i++)
+                    levels[i] = r.F32();
+                for(uint8_t i = 0; i < NUM_DRUMS; i++)
+                    pans[i] = r.F32();
+                float drum_master = r.F32();
+                float master_out  = r.F32();
+                if(!r.ok)
+                    continue;
+                for(uint8_t i = 0; i < NUM_DRUMS; i++)
+                {
+                    sampler_.SetLevel(i, levels[i]);
+                    sampler_.SetPan(i, pans[i]);
+                }
+                sampler_.SetMasterLevel(drum_master);
+                cc_engine_.SetMasterOutput(master_out);
+            }
+            else if(id == CHUNK_SYNTH)
+            {
+                uint8_t count = r.U8();
+                for(uint8_t i = 0; i < count && i < Synth::PARAM_COUNT; i++)
+                {
+                    float value = r.F32();
+                    if(r.ok)
+                        synth_.SetParam(static_cast<Synth::ParamId>(i), value);
+                }
+            }
+            else if(id < CHUNK_AUTO)
+            {
+                uint8_t  track = id - CHUNK_PATTERN;
+                uint32_t count = r.Varint();
+                uint32_t tick  = 0;
+                for(uint32_t i = 0; i < count && r.ok; i++)
+                {
+                    Sequencer::MidiEvent ev;
+                    ev.tick   = GetTick(r, tick);
+                    ev.status = r.U8();
+                    ev.data1  = r.U8();
+                    ev.data2  = r.U8();
+                    if(r.ok && !sequencer_.AppendEvent(track, ev))
+                        break;
+                    notes_ += r.ok;
+                }
+            }
+            else
+            {
+                uint8_t  cc    = r.U8();
+                uint8_t  lane  = automation_.GetCCIndex(cc);
+                uint32_t count = r.Varint();
+                uint32_t tick  = 0;
+                if(!r.ok || lane >= Automation::NUM_AUTO_CCS)
+                    continue;
+                for(uint32_t i = 0; i < count && r.ok; i++)
+                {
+                    uint32_t t     = GetTick(r, tick);
+                    uint8_t  value = r.U8();
+                    if(r.ok && !automation_.AppendPoint(lane, t, value))
+                        break;
+                    points_ += r.ok;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool LoadMidi(const Job& job)
+    {
+        Smf::Parser parser;
+        parser.Init(OnSmfEvent, OnSmfTempo);
+        parser.Feed(job.file.data(), job.file.size());
+        return parser.IsDone();
+    }
+
+    // Same mapping as the firmware's OnSmfEvent
+    static void OnSmfEvent(uint8_t, const Smf::Event& ev)
+    {
+        Renderer& r       = *active;
+        uint8_t   type    = ev.status & 0xF0;
+        uint8_t   channel = ev.status & 0x0F;
+        uint8_t   status  = ev.status;
+
+        if(type == 0x90 || type == 0x80)
+        {
+            if(type == 0x90 && ev.data2 == 0)
+                status = 0x80 | channel;
+            if(channel != Sequencer::DRUM_CHANNEL)
+                status = (status & 0xF0) | Sequencer::SYNTH_CHANNEL;
+            else if(ev.data1 < Sequencer::FIRST_PAD_NOTE || ev.data1 > Sequencer::LAST_PAD_NOTE)
+                return;
+        }
+        else if(type != 0xB0 || !r.automation_.IsAutomatedCC(ev.data1))
+        {
+            return;
+        }
+
+        bool added = ev.tick < pattern_ticks
+                     && (type == 0xB0 ? r.automation_.ImportCC(ev.tick, ev.data1, ev.data2)
+                                      : r.sequencer_.ImportEvent(ev.tick, status, ev.data1, ev.data2));
+        if(!added)
+            r.dropped_++;
+        else if(type == 0xB0)
+            r.points_++;
+        else
+            r.notes_++;
+    }
+
+    // The file's first tempo sets the BPM
+    static void OnSmfTempo(uint32_t, uint32_t us_per_quarter)
+    {
+        Renderer& r = *active;
+        if(r.tempo_set_ || us_per_quarter == 0)
+            return;
+        r.tempo_set_ = true;
+        r.transport_.SetBpm(static_cast<uint16_t>((60000000 + us_per_quarter / 2) / us_per_quarter));
+    }
+
+    static void IgnoreMidiOut(uint8_t, uint8_t, uint8_t) {}
+
+    static void SequencerPlayback(uint8_t status, uint8_t data1, uint8_t data2)
+    {
+        if(active->audible_)
+            active->router_.RouteEvent(status, data1, data2, MidiRouter::Source::SEQUENCER);
+    }
+
+    static void AutomationPlayback(uint8_t cc, uint8_t value)
+    {
+        uint8_t            out_value;
+        CCMap::ParamTarget target = active->cc_engine_.ProcessCC(cc, value, out_value);
+        active->cc_coalescer_.Set(target, out_value);
+    }
+
+    // Same as the firmware's ApplyParamTarget
+    static void ApplyParamTarget(CCMap::ParamTarget target, uint8_t cc_value)
+    {
+        using namespace CCMap;
+
+        Renderer& r = *active;
+        if(IsSynthTarget(target))
+        {
+            ApplySynthTarget(target, cc_value, r.synth_);
+        }
+        else if(target >= TARGET_DRUM_1_LEVEL && target <= TARGET_DRUM_8_LEVEL)
+        {
+            r.sampler_.SetLevel(target - TARGET_DRUM_1_LEVEL, CCToNorm(cc_value));
+        }
+        else if(target >= TARGET_DRUM_1_PAN && target <= TARGET_DRUM_8_PAN)
+        {
+            r.sampler_.SetPan(target - TARGET_DRUM_1_PAN, CCToPan(cc_value));
+        }
+        else if(target == TARGET_DRUM_MASTER_LEVEL)
+        {
+            r.sampler_.SetMasterLevel(CCToNorm(cc_value));
+        }
+        else if(target == TARGET_MASTER_OUTPUT)
+        {
+            r.cc_engine_.SetMasterOutput(CCToNorm(cc_value));
+        }
+    }
+
+    static thread_local Renderer* active;
+
+    Transport::Engine  transport_;
+    Sampler::Engine    sampler_;
+    Synth::Engine      synth_;
+    CCMap::Engine      cc_engine_;
+    CCMap::Coalescer   cc_coalescer_;
+    Sequencer::Engine  sequencer_;
+    Automation::Engine automation_;
+    MidiRouter::Router router_;
+    bool               audible_;
+    bool               tempo_set_;
+    uint64_t           frame_;
+    uint64_t           stop_at_;
+    uint32_t           notes_, points_, dropped_;
+};
+
+thread_local Renderer* Renderer::active = nullptr;
+
+// ============================================================================
+// Files
+
+bool ReadFile(const char* path, std::vector<uint8_t>& data)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    data.resize(static_cast<size_t>(st.st_size));
+    if(st.st_size > 0)
+    {
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED)
+        {
+            perror(path);
+            close(fd);
+            return false;
+        }
+        memcpy(data.data(), p, data.size());
+        munmap(p, st.st_size);
+    }
+    close(fd);
+    return true;
+}
+
+void Put16(uint8_t*& p, uint16_t v)
+{
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+}
+
+void Put32(uint8_t*& p, uint32_t v)
+{
+    Put16(p, v & 0xFFFF);
+    Put16(p, v >> 16);
+}
+
+// 32-bit float stereo WAV (WAVE_FORMAT_IEEE_FLOAT, with the fact chunk it requires)
+bool WriteWav(const std::string& path, const std::vector<float>& samples)
+{
+    uint32_t data_len = static_cast<uint32_t>(samples.size() * sizeof(float));
+    uint8_t  header[58];
+    uint8_t* p = header;
+    memcpy(p, "RIFF", 4);
+    p += 4;
+    Put32(p, sizeof(header) - 8 + data_len);
+    memcpy(p, "WAVEfmt ", 8);
+    p += 8;
+    Put32(p, 18);
+    Put16(p, 3);  // IEEE float
+    Put16(p, 2);
+    Put32(p, static_cast<uint32_t>(render_rate));
+    Put32(p, static_cast<uint32_t>(render_rate) * 2 * sizeof(float));
+    Put16(p, 2 * sizeof(float));
+    Put16(p, 32);
+    Put16(p, 0);
+    memcpy(p, "fact", 4);
+    p += 4;
+    Put32(p, 4);
+    Put32(p, static_cast<uint32_t>(samples.size() / 2));
+    memcpy(p, "data", 4);
+    p += 4;
+    Put32(p, data_len);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        perror(path.c_str());
+        return false;
+    }
+    bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header)
+              && fwrite(samples.data(), sizeof(float), samples.size(), f) == samples.size();
+    ok = fclose(f) == 0 && ok;
+    if(!ok)
+        fprintf(stderr, "%s: write failed\n", path.c_str());
+    return ok;
+}
+
+bool IsMidi(const std::string& path)
+{
+    std::string ext = path.substr(path.find_last_of('.') + 1);
+    return ext == "mid" || ext == "midi";
+}
+
+bool IsInput(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    return dot != std::string::npos && (IsMidi(path) || path.substr(dot) == ".session");
+}
+
+// Files named on the command line, plus the inputs found in named directories
+void CollectInputs(const char* arg, std::vector<std::string>& paths)
+{
+    struct stat st;
+    if(stat(arg, &st) != 0 || !S_ISDIR(st.st_mode))
+    {
+        paths.push_back(arg);
+        return;
+    }
+    DIR* dir = opendir(arg);
+    if(!dir)
+    {
+        perror(arg);
+        return;
+    }
+    std::vector<std::string> found;
+    while(struct dirent* entry = readdir(dir))
+    {
+        std::string path = std::string(arg) + "/" + entry->d_name;
+        if(IsInput(path) && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+            found.push_back(path);
+    }
+    closedir(dir);
+    std::sort(found.begin(), found.end());
+    paths.insert(paths.end(), found.begin(), found.end());
+}
+
+// ============================================================================
+// Scheduling
+
+std::mutex print_lock;
+
+/**
+ * A worker's task deque (owner pops the back, thieves take the front)
+ */
+class TaskDeque
+{
+  public:
+    void Push(const Task& task)
+    {
+        std::lock_guard<std::mutex> hold(lock_);
+        tasks_.push_back(task);
+    }
+
+    bool Pop(Task& task)
+    {
+        std::lock_guard<std::mutex> hold(lock_);
+        if(tasks_.empty())
+            return false;
+        task = tasks_.back();
+        tasks_.pop_back();
+        return true;
+    }
+
+    bool Steal(Task& task)
+    {
+        std::lock_guard<std::mutex> hold(lock_);
+        if(tasks_.empty())
+            return false;
+        task = tasks_.front();
+        tasks_.pop_front();
+        return true;
+    }
+
+  private:
+    std::mutex       lock_;
+    std::deque<Task> tasks_;
+};
+
+struct WorkerStats
+{
+    uint32_t tasks   = 0;
+    uint32_t stolen  = 0;
+    uint32_t failed  = 0;
+    uint64_t frames  = 0;  // Kept (song and tail)
+    uint64_t preroll = 0;  // Rendered and discarded
+    double   busy    = 0;  // CPU seconds rendering (file writes excluded)
+};
+
+void RunTask(Renderer& engine, const Task& task, WorkerStats& stats)
+{
+    Job&   job   = *task.job;
+    double start = ThreadSeconds();
+
+    engine.Load(job);
+    engine.Play(job.song);
+    uint64_t preroll = std::min<uint64_t>(task.start, static_cast<uint64_t>(preroll_seconds * render_rate));
+    preroll -= preroll % block_size;  // Blocks line up with a render from the top
+    if(task.start > 0)
+    {
+        static thread_local std::vector<float> scratch;
+        scratch.resize(2 * preroll);
+        engine.Render(nullptr, task.start - preroll);
+        engine.Render(scratch.data(), preroll);
+    }
+    engine.Render(&job.out[2 * task.start], task.frames);
+
+    stats.tasks++;
+    stats.frames += task.frames;
+    stats.preroll += preroll;
+    stats.busy += ThreadSeconds() - start;
+
+    if(job.pending.fetch_sub(1) == 1)
+    {
+        std::string out = job.path + ".wav";  // a.mid and a.session may sit side by side
+        bool        ok  = WriteWav(out, job.out);
+        if(!ok)
+            stats.failed++;
+        std::lock_guard<std::mutex> hold(print_lock);
+        printf("%s -> %s: %u BPM, %.1f s, %u notes, %u points, %u dropped%s\n", job.path.c_str(),
+               out.c_str(), engine.GetBpm(), job.frames / render_rate,
+               job.notes, job.points, job.dropped, ok ? "" : " (write failed)");
+        std::vector<float>().swap(job.out);
+    }
+}
+
+void Worker(size_t self, std::vector<TaskDeque>& deques, WorkerStats& stats)
+{
+    std::unique_ptr<Renderer> engine(new Renderer);
+    Task                      task;
+    for(;;)
+    {
+        bool found = deques[self].Pop(task);
+        for(size_t i = 1; !found && i < deques.size(); i++)
+        {
+            found = deques[(self + i) % deques.size()].Steal(task);
+            stats.stolen += found;
+        }
+        if(!found)
+            return;  // Every task exists up front: nothing left anywhere
+        RunTask(*engine, task, stats);
+    }
+}
+
+// Load a file, probe its tempo and size the song (main thread)
+bool Prepare(Renderer& probe, Job& job)
+{
+    if(!ReadFile(job.path.c_str(), job.file))
+        return false;
+    job.midi = IsMidi(job.path);
+    if(!probe.Load(job))
+    {
+        fprintf(stderr, "%s: %s\n", job.path.c_str(),
+                job.midi ? "not a type 0/1 MIDI file" : "no valid session chunks");
+        return false;
+    }
+    double samples_per_tick = render_rate * 60.0 / (probe.GetBpm() * Transport::PPQN);
+    job.song    = static_cast<uint64_t>(loops * pattern_ticks * samples_per_tick + 0.5);
+    job.frames  = job.song + static_cast<uint64_t>(tail_seconds * render_rate);
+    job.notes   = probe.GetNotes();
+    job.points  = probe.GetPoints();
+    job.dropped = probe.GetDropped();
+    job.out.assign(2 * job.frames, 0.0f);
+    return true;
+}
+
+// ============================================================================
+// Benchmark (-bench)
+
+struct BenchStats
+{
+    uint64_t blocks = 0;
+    double   total  = 0;  // CPU seconds
+    double   worst  = 0;  // Slowest block
+};
+
+// Render the first bench_seconds of a song block by block, timing each block
+void BenchJob(Renderer& engine, const Job& job, BenchStats& stats)
+{
+    std::vector<float> block(2 * block_size);
+    uint64_t frames = std::min<uint64_t>(job.frames, static_cast<uint64_t>(bench_seconds * render_rate));
+    engine.Load(job);
+    engine.Play(job.song);
+    for(uint64_t done = 0; done + block_size <= frames; done += block_size)
+    {
+        double start = ThreadSeconds();
+        engine.Render(block.data(), block_size);
+        double seconds = ThreadSeconds() - start;
+        stats.blocks++;
+        stats.total += seconds;
+        stats.worst = std::max(stats.worst, seconds);
+    }
+}
+
+// Every cell of the firmware's matrix, on one thread so cells do not share caches
+int Bench(const std::vector<std::string>& candidates)
+{
+    std::unique_ptr<Renderer> engine(new Renderer);
+    std::vector<std::string>  paths;
+    for(const std::string& path : candidates)
+    {
+        Job job;
+        job.path = path;
+        if(Prepare(*engine, job))
+            paths.push_back(path);
+    }
+    if(paths.empty())
+        return 1;
+
+    printf("%zu input%s, %.1f s each per cell\n", paths.size(), paths.size() == 1 ? "" : "s",
+           bench_seconds);
+    printf("%6s %6s %10s %9s %9s\n", "rate", "block", "latency", "avg load", "max load");
+    for(size_t cell = 0; cell < AudioConfig::NUM_BENCH_CELLS; cell++)
+    {
+        AudioConfig::Settings settings = AudioConfig::BenchCell(cell);
+        render_rate                    = static_cast<float>(settings.rate);
+        block_size                     = settings.block;
+        sample_bank->Generate(render_rate);
+
+        BenchStats stats;
+        for(const std::string& path : paths)
+        {
+            Job job;
+            job.path = path;
+            if(Prepare(*engine, job))
+                BenchJob(*engine, job, stats);
+        }
+        double period = block_size / render_rate;
+        double avg    = stats.blocks > 0 ? stats.total / stats.blocks : 0.0;
+        printf("%6u %6u %7.2f ms %8.2f%% %8.2f%%\n", settings.rate, settings.block,
+               AudioConfig::LatencyUs(settings) / 1000.0, 100.0 * avg / period,
+               100.0 * stats.worst / period);
+    }
+    return 0;
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "usage: render_tool [-j N] [-bars N] [-loops N] [-chunk S] [-preroll S] [-tail S]\n"
+            "                   [-rate HZ] [-block N] [-bench S]\n"
+            "                   <file.session | file.mid | directory>...\n");
+}
+
+bool ParseOption(const char* name, const char* value, unsigned& threads)
+{
+    float v = value ? static_cast<float>(atof(value)) : -1.0f;
+    if(strcmp(name, "-j") == 0 && v >= 1 && v <= 256)
+        threads = static_cast<unsigned>(v);
+    else if(strcmp(name, "-bars") == 0 && v >= 1 && v <= 16)
+        pattern_ticks = static_cast<uint32_t>(v) * Transport::TICKS_PER_BAR;
+    else if(strcmp(name, "-loops") == 0 && v >= 1 && v <= 10000)
+        loops = static_cast<uint32_t>(v);
+    else if(strcmp(name, "-chunk") == 0 && v >= 1)
+        chunk_seconds = v;
+    else if(strcmp(name, "-preroll") == 0 && v >= 0)
+        preroll_seconds = v;
+    else if(strcmp(name, "-tail") == 0 && v >= 0)
+        tail_seconds = v;
+    else if(strcmp(name, "-rate") == 0 && AudioConfig::IsValidRate(static_cast<uint32_t>(v)))
+        render_rate = v;
+    else if(strcmp(name, "-block") == 0 && AudioConfig::IsValidBlock(static_cast<uint32_t>(v)))
+        block_size = static_cast<size_t>(v);
+    else if(strcmp(name, "-bench") == 0 && v > 0)
+        bench_seconds = v;
+    else
+        return false;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int      first   = 1;
+    while(first < argc && argv[first][0] == '-')
+    {
+        if(!ParseOption(argv[first], first + 1 < argc ? argv[first + 1] : nullptr, threads))
+        {
+            fprintf(stderr, "render_tool: bad option %s\n", argv[first]);
+            Usage();
+            return 1;
+        }
+        first += 2;
+    }
+    std::vector<std::string> paths;
+    for(int i = first; i < argc; i++)
+        CollectInputs(argv[i], paths);
+    if(paths.empty())
+    {
+        Usage();
+        return 1;
+    }
+
+    sample_bank = new DrumSamples::SampleBank;
+    sample_bank->Generate(render_rate);
+    if(bench_seconds > 0)
+        return Bench(paths);
+
+    std::vector<std::unique_ptr<Job>> jobs;
+    std::unique_ptr<Renderer>         probe(new Renderer);
+    size_t                            failed = 0;
+    for(const std::string& path : paths)
+    {
+        std::unique_ptr<Job> job(new Job);
+        job->path = path;
+        if(Prepare(*probe, *job))
+            jobs.push_back(std::move(job));
+        else
+            failed++;
+    }
+
+    // Longest songs first, each cut into block-aligned chunks dealt round-robin
+    std::sort(jobs.begin(), jobs.end(),
+              [](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) { return a->frames > b->frames; });
+    uint64_t chunk = static_cast<uint64_t>(chunk_seconds * render_rate);
+    chunk          = std::max<uint64_t>(block_size, chunk - chunk % block_size);
+    std::vector<TaskDeque> deques(threads);
+    size_t                 dealt = 0;
+    uint64_t               total = 0;
+    for(auto& job : jobs)
+    {
+        uint32_t count = static_cast<uint32_t>((job->frames + chunk - 1) / chunk);
+        job->pending   = count;
+        total += job->frames;
+        for(uint64_t start = 0; start < job->frames; start += chunk)
+            deques[dealt++ % threads].Push(Task{job.get(), start, std::min(chunk, job->frames - start)});
+    }
+
+    std::vector<WorkerStats> stats(threads);
+    std::vector<std::thread> workers;
+    Clock::time_point        start = Clock::now();
+    for(unsigned i = 0; i < threads; i++)
+        workers.emplace_back(Worker, i, std::ref(deques), std::ref(stats[i]));
+    for(auto& worker : workers)
+        worker.join();
+    double wall = Seconds(start);
+
+    WorkerStats sum;
+    for(unsigned i = 0; i < threads; i++)
+    {
+        const WorkerStats& s    = stats[i];
+        double             busy = s.busy > 0 ? s.busy : 1e-9;
+        printf("worker %u: %u chunks (%u stolen), %.1f s audio + %.1f s preroll in %.2f s: %.1fx realtime\n",
+               i, s.tasks, s.stolen, s.frames / render_rate, s.preroll / render_rate, s.busy,
+               s.frames / render_rate / busy);
+        sum.tasks += s.tasks;
+        sum.failed += s.failed;
+        sum.frames += s.frames;
+        sum.preroll += s.preroll;
+        sum.busy += s.busy;
+    }
+    double audio = total / render_rate;
+    wall         = wall > 0 ? wall : 1e-9;
+    printf("%zu song%s (%zu failed), %u chunks on %u thread%s: %.1f s of audio in %.2f s, "
+           "%.1fx realtime, %.1fx per core; preroll overhead %.1f%%\n",
+           jobs.size(), jobs.size() == 1 ? "" : "s", failed + sum.failed, sum.tasks, threads,
+           threads == 1 ? "" : "s", audio, wall, audio / wall, audio / (sum.busy > 0 ? sum.busy : 1e-9),
+           total > 0 ? 100.0 * sum.preroll / total : 0.0);
+    return failed + sum.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,345 @@
+/**
+ * GroovyDaisy session image inspector (host)
+ *
+ *   session_tool inspect [-v] <image>   chunk table and decoded contents
+ *   session_tool diff <a> <b>           what changed between two images
+ *
+ * An image is the session region of the QSPI flash: Session::REGION_SIZE
+ * bytes from Session::FLASH_OFFSET (0x90700000 in the memory map), e.g. read
+ * back over DFU with the Daisy bootloader. Images are mmapped and scanned in
+ * place with the firmware's own Session::Directory, so a chunk the tool
+ * shows is exactly the one the device would load.
+ *
+ * Build: make session-tool
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "session.h"
+
+namespace Codec = ProtocolCodec;
+using namespace Session;
+
+namespace
+{
+
+struct Image
+{
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+    Directory      dir;
+};
+
+bool Map(const char* path, Image& image)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        fprintf(stderr, "%s: empty or unreadable\n", path);
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED)
+    {
+        perror(path);
+        return false;
+    }
+    image.data = static_cast<const uint8_t*>(p);
+    image.size = static_cast<size_t>(st.st_size);
+    image.dir.Scan(image.data, image.size);
+    if(image.size < REGION_SIZE)
+    {
+        fprintf(stderr, "%s: %zu bytes, expected %u (missing slots read as empty)\n", path,
+                image.size, REGION_SIZE);
+    }
+    return true;
+}
+
+// Decoded chunk contents. Event lists are tick sorted; each entry packs
+// [status|data1|data2] (pattern) or the value (automation) next to its tick.
+struct Event
+{
+    uint32_t tick;
+    uint32_t data;
+
+    bool operator==(const Event& o) const { return tick == o.tick && data == o.data; }
+    bool operator<(const Event& o) const
+    {
+        return tick != o.tick ? tick < o.tick : data < o.data;
+    }
+};
+
+struct Contents
+{
+    bool               ok = false;
+    std::vector<float> values;  // Transport, mixer, synth, tracks, audio
+    uint8_t            cc = 0;  // Automation lane
+    std::vector<Event> events;  // Pattern, automation
+};
+
+Contents Decode(uint8_t id, const Chunk& chunk)
+{
+    Contents      c;
+    Codec::Reader r(chunk.data, chunk.len);
+    if(id == CHUNK_TRANSPORT)
+    {
+        c.values.push_back(r.U16());
+        uint8_t flags = r.U8();
+        c.values.push_back((flags & TRANSPORT_OVERDUB) ? 1 : 0);
+        c.values.push_back((flags & TRANSPORT_BLEND) ? 1 : 0);
+    }
+    else if(id == CHUNK_MIXER)
+    {
+        for(int i = 0; i < 2 * NUM_DRUMS + 2; i++)
+            c.values.push_back(r.F32());
+    }
+    else if(id == CHUNK_SYNTH)
+    {
+        uint8_t count = r.U8();
+        for(uint8_t i = 0; i < count && r.ok; i++)
+            c.values.push_back(r.F32());
+    }
+    else if(id == CHUNK_TRACKS)
+    {
+        uint8_t count = r.U8();
+        for(uint8_t i = 0; i < count && r.ok; i++)
+            c.values.push_back(r.U8());
+    }
+    else if(id == CHUNK_AUDIO)
+    {
+        c.values.push_back(r.U32());
+        c.values.push_back(r.U16());
+    }
+    else
+    {
+        bool     pattern = id < CHUNK_AUTO;
+        uint32_t tick    = 0;
+        if(!pattern)
+            c.cc = r.U8();
+        uint32_t count = r.Varint();
+        for(uint32_t i = 0; i < count && r.ok; i++)
+        {
+            Event ev;
+            ev.tick = GetTick(r, tick);
+            if(pattern)
+            {
+                ev.data = r.U8() << 16;
+                ev.data |= r.U8() << 8;
+                ev.data |= r.U8();
+            }
+            else
+            {
+                ev.data = r.U8();
+            }
+            if(r.ok)
+                c.events.push_back(ev);
+        }
+    }
+    c.ok = r.ok && r.pos == chunk.len;
+    return c;
+}
+
+void Label(uint8_t id, char* out, size_t size)
+{
+    if(id >= CHUNK_PATTERN && id < CHUNK_AUTO)
+        snprintf(out, size, "pattern %d", id - CHUNK_PATTERN);
+    else if(id >= CHUNK_AUTO && id < CHUNK_TRACKS)
+        snprintf(out, size, "auto %d", id - CHUNK_AUTO);
+    else
+        snprintf(out, size, "%s", ChunkName(id));
+}
+
+const char* ValueName(uint8_t id, size_t i)
+{
+    static const char* transport[] = {"bpm", "overdub", "blend"};
+    static const char* mixer_tail[] = {"drum master", "master out"};
+    static const char* audio[]      = {"rate", "block"};
+    static char        buf[24];
+    if(id == CHUNK_TRANSPORT && i < 3)
+        return transport[i];
+    if(id == CHUNK_AUDIO && i < 2)
+        return audio[i];
+    if(id == CHUNK_MIXER)
+    {
+        if(i < NUM_DRUMS)
+            snprintf(buf, sizeof(buf), "drum %zu level", i);
+        else if(i < 2 * NUM_DRUMS)
+            snprintf(buf, sizeof(buf), "drum %zu pan", i - NUM_DRUMS);
+        else
+            return mixer_tail[(i - 2 * NUM_DRUMS) & 1];
+        return buf;
+    }
+    snprintf(buf, sizeof(buf), id == CHUNK_TRACKS ? "track %zu frozen" : "param %zu", i);
+    return buf;
+}
+
+void PrintEvent(uint8_t id, const Event& ev, const char* prefix)
+{
+    if(id < CHUNK_AUTO)
+        printf("%s  tick %6u  %02X %3u %3u\n", prefix, ev.tick, ev.data >> 16,
+               (ev.data >> 8) & 0xFF, ev.data & 0xFF);
+    else
+        printf("%s  tick %6u  value %3u\n", prefix, ev.tick, ev.data);
+}
+
+int Inspect(const char* path, bool verbose)
+{
+    Image image;
+    if(!Map(path, image))
+        return 1;
+
+    printf("%s: %zu/%d chunks valid, format %d\n", path, image.dir.GetValidCount(),
+           NUM_CHUNKS, FORMAT_VERSION);
+    printf("%-11s %4s %8s %6s %10s  contents\n", "chunk", "copy", "gen", "bytes", "crc");
+    for(uint8_t id = 0; id < NUM_CHUNKS; id++)
+    {
+        char label[16];
+        Label(id, label, sizeof(label));
+        const Chunk& chunk = image.dir.Get(id);
+        if(!chunk.valid)
+        {
+            printf("%-11s    -        -      -          -  (empty)\n", label);
+            continue;
+        }
+
+        Contents c = Decode(id, chunk);
+        printf("%-11s %4c %8u %6u 0x%08X  ", label, 'A' + chunk.copy, chunk.gen, chunk.len,
+               chunk.crc);
+        if(!c.ok)
+            printf("DECODE ERROR");
+        else if(id == CHUNK_TRANSPORT)
+            printf("%.0f BPM, %s, blend %s", c.values[0], c.values[1] ? "overdub" : "replace",
+                   c.values[2] ? "on" : "off");
+        else if(id == CHUNK_TRACKS)
+            for(size_t i = 0; i < c.values.size(); i++)
+                printf("%s", c.values[i] ? "F" : "-");
+        else if(id == CHUNK_AUDIO)
+            printf("%.0f Hz, %.0f frames", c.values[0], c.values[1]);
+        else if(!c.values.empty())
+            printf("%zu values", c.values.size());
+        else
+        {
+            if(id >= CHUNK_AUTO)
+                printf("CC %u, ", c.cc);
+            printf("%zu events", c.events.size());
+            if(!c.events.empty())
+                printf(" (ticks %u-%u)", c.events.front().tick, c.events.back().tick);
+        }
+        printf("\n");
+
+        if(verbose && c.ok)
+        {
+            if(id == CHUNK_MIXER || id == CHUNK_SYNTH)
+                for(size_t i = 0; i < c.values.size(); i++)
+                    printf("    %-16s %g\n", ValueName(id, i), c.values[i]);
+            for(const Event& ev : c.events)
+                PrintEvent(id, ev, "  ");
+        }
+    }
+    return 0;
+}
+
+int Diff(const char* path_a, const char* path_b)
+{
+    Image a, b;
+    if(!Map(path_a, a) || !Map(path_b, b))
+        return 1;
+
+    int changed = 0;
+    for(uint8_t id = 0; id < NUM_CHUNKS; id++)
+    {
+        char label[16];
+        Label(id, label, sizeof(label));
+        const Chunk& ca = a.dir.Get(id);
+        const Chunk& cb = b.dir.Get(id);
+        if(!ca.valid && !cb.valid)
+            continue;
+        if(ca.valid && cb.valid && ca.len == cb.len && ca.crc == cb.crc)
+            continue;
+
+        changed++;
+        if(!ca.valid || !cb.valid)
+        {
+            printf("%s: only in %s\n", label, ca.valid ? "a" : "b");
+            continue;
+        }
+        printf("%s: gen %u -> %u\n", label, ca.gen, cb.gen);
+
+        Contents da = Decode(id, ca);
+        Contents db = Decode(id, cb);
+        if(!da.ok || !db.ok)
+        {
+            printf("  DECODE ERROR\n");
+            continue;
+        }
+        for(size_t i = 0; i < da.values.size() || i < db.values.size(); i++)
+        {
+            bool  in_a = i < da.values.size();
+            bool  in_b = i < db.values.size();
+            float va   = in_a ? da.values[i] : 0;
+            float vb   = in_b ? db.values[i] : 0;
+            if(!in_a)
+                printf("  %-16s (none) -> %g\n", ValueName(id, i), vb);
+            else if(!in_b)
+                printf("  %-16s %g -> (none)\n", ValueName(id, i), va);
+            else if(va != vb)
+                printf("  %-16s %g -> %g\n", ValueName(id, i), va, vb);
+        }
+        if(da.cc != db.cc)
+            printf("  cc %u -> %u\n", da.cc, db.cc);
+
+        // Both lists are sorted: merge to find removed (-) and added (+) events
+        size_t i = 0, j = 0;
+        while(i < da.events.size() || j < db.events.size())
+        {
+            if(j >= db.events.size() || (i < da.events.size() && da.events[i] < db.events[j]))
+                PrintEvent(id, da.events[i++], "-");
+            else if(i >= da.events.size() || db.events[j] < da.events[i])
+                PrintEvent(id, db.events[j++], "+");
+            else
+                i++, j++;
+        }
+    }
+    printf("%d chunk%s differ\n", changed, changed == 1 ? "" : "s");
+    return changed > 0 ? 2 : 0;
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "usage: session_tool inspect [-v] <image>\n"
+            "       session_tool diff <image_a> <image_b>\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && strcmp(argv[1], "inspect") == 0)
+    {
+        bool verbose = strcmp(argv[2], "-v") == 0;
+        if(argc == (verbose ? 4 : 3))
+            return Inspect(argv[argc - 1], verbose);
+    }
+    else if(argc == 4 && strcmp(argv[1], "diff") == 0)
+    {
+        return Diff(argv[2], argv[3]);
+    }
+    Usage();
+    return 1;
+}
@@ -0,0 +1,466 @@
+/**
+ * GroovyDaisy Standard MIDI File converter (host)
+ *
+ *   smf_tool import [-bars N] <file.mid>...   one <file>.session image each
+ *   smf_tool export [-bars N] <image>...      one <image>.mid each
+ *
+ * Batch counterpart of the device's CMD_SMF_IMPORT / CMD_SMF_EXPORT, built
+ * from the same streaming converter (smf.h) and session format (session.h).
+ * Import maps events like the firmware: channel 10 pad notes (36-43) to the
+ * drum tracks, notes on any other channel to the synth, automated CCs to
+ * their lanes with the recording thinning; events past the pattern end
+ * (-bars, default 4) are dropped. The image holds the transport, pattern
+ * and automation chunks only, so loading it keeps the device's mixer,
+ * synth and freeze state. Export writes a type 1 file at the stored tempo.
+ *
+ * Build: make smf-tool
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "session.h"
+#include "sequencer.h"
+#include "smf.h"
+
+namespace Codec = ProtocolCodec;
+using namespace Session;
+
+namespace
+{
+
+constexpr uint32_t TICKS_PER_BAR       = Smf::PPQN * 4;  // Transport::TICKS_PER_BAR
+constexpr uint16_t DEFAULT_BPM         = 120;            // Transport::DEFAULT_BPM
+constexpr uint16_t MIN_BPM             = 30;
+constexpr uint16_t MAX_BPM             = 300;
+constexpr uint16_t MIN_RECORD_INTERVAL = 6;              // Automation thinning
+constexpr uint8_t  MIN_VALUE_CHANGE    = 2;
+
+struct Point
+{
+    uint32_t tick;
+    uint8_t  value;
+};
+
+// Conversion state (Smf callbacks are plain function pointers)
+Sequencer::Engine  sequencer;
+std::vector<Point> lanes[NUM_AUTO_LANES];
+uint32_t           pattern_ticks = 4 * TICKS_PER_BAR;
+uint16_t           bpm;
+bool               tempo_set;
+uint32_t           notes, points, dropped;
+
+struct Stats
+{
+    size_t   files   = 0;
+    size_t   failed  = 0;
+    uint64_t bytes   = 0;
+    uint64_t events  = 0;
+    double   seconds = 0;
+};
+
+bool ReadFile(const char* path, std::vector<uint8_t>& data)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    data.resize(static_cast<size_t>(st.st_size));
+    if(st.st_size > 0)
+    {
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED)
+        {
+            perror(path);
+            close(fd);
+            return false;
+        }
+        memcpy(data.data(), p, data.size());
+        munmap(p, st.st_size);
+    }
+    close(fd);
+    return true;
+}
+
+bool WriteFile(const std::string& path, const uint8_t* data, size_t len)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if(!f)
+    {
+        perror(path.c_str());
+        return false;
+    }
+    bool ok = fwrite(data, 1, len, f) == len;
+    ok      = fclose(f) == 0 && ok;
+    if(!ok)
+        fprintf(stderr, "%s: write failed\n", path.c_str());
+    return ok;
+}
+
+std::string OutputPath(const char* in, const char* ext)
+{
+    std::string path = in;
+    size_t      dot  = path.find_last_of('.');
+    size_t      dir  = path.find_last_of('/');
+    if(dot != std::string::npos && (dir == std::string::npos || dot > dir))
+        path.resize(dot);
+    return path + ext;
+}
+
+// ============================================================================
+// Import
+
+int LaneOf(uint8_t cc)
+{
+    for(int i = 0; i < NUM_AUTO_LANES; i++)
+    {
+        if(AUTO_LANE_CCS[i] == cc)
+            return i;
+    }
+    return -1;
+}
+
+// Same thinning as Automation::Engine::ImportCC
+bool AddPoint(std::vector<Point>& lane, uint32_t tick, uint8_t value)
+{
+    if(!lane.empty())
+    {
+        const Point& last = lane.back();
+        if(tick - last.tick < MIN_RECORD_INTERVAL && abs(value - last.value) < MIN_VALUE_CHANGE)
+            return true;
+    }
+    if(lane.size() >= MAX_AUTO_POINTS)
+        return false;
+    // Events arrive in tick order per file track; merge the rest
+    auto pos = lane.end();
+    while(pos != lane.begin() && (pos - 1)->tick > tick)
+        --pos;
+    lane.insert(pos, Point{tick, value});
+    return true;
+}
+
+// Same mapping as the firmware's OnSmfEvent
+void OnEvent(uint8_t, const Smf::Event& ev)
+{
+    uint8_t type    = ev.status & 0xF0;
+    uint8_t channel = ev.status & 0x0F;
+    uint8_t status  = ev.status;
+    int     lane    = -1;
+
+    if(type == 0x90 || type == 0x80)
+    {
+        if(type == 0x90 && ev.data2 == 0)
+            status = 0x80 | channel;
+        if(channel != Sequencer::DRUM_CHANNEL)
+            status = (status & 0xF0) | Sequencer::SYNTH_CHANNEL;
+        else if(ev.data1 < Sequencer::FIRST_PAD_NOTE || ev.data1 > Sequencer::LAST_PAD_NOTE)
+            return;
+    }
+    else if(type != 0xB0 || (lane = LaneOf(ev.data1)) < 0)
+    {
+        return;
+    }
+
+    if(ev.tick >= pattern_ticks)
+    {
+        dropped++;
+        return;
+    }
+    bool added = lane >= 0 ? AddPoint(lanes[lane], ev.tick, ev.data2)
+                           : sequencer.ImportEvent(ev.tick, status, ev.data1, ev.data2);
+    if(!added)
+        dropped++;
+    else if(lane >= 0)
+        points++;
+    else
+        notes++;
+}
+
+void OnTempo(uint32_t, uint32_t us_per_quarter)
+{
+    if(tempo_set || us_per_quarter == 0)
+        return;
+    tempo_set    = true;
+    uint32_t raw = (60000000 + us_per_quarter / 2) / us_per_quarter;
+    bpm          = raw < MIN_BPM ? MIN_BPM : raw > MAX_BPM ? MAX_BPM : raw;
+}
+
+void PutChunk(uint8_t* image, uint8_t id, const uint8_t* payload, size_t len)
+{
+    uint8_t* slot = &image[SlotOffset(id, 0)];
+    WriteHeader(slot, id, static_cast<uint16_t>(len), 1, Crc32(payload, len));
+    memcpy(&slot[HEADER_SIZE], payload, len);
+}
+
+// Encode the converted pattern as a session image (erased flash is 0xFF)
+void BuildImage(std::vector<uint8_t>& image)
+{
+    static uint8_t payload[MAX_PAYLOAD];
+    image.assign(REGION_SIZE, 0xFF);
+
+    Codec::Writer transport(payload);
+    transport.U16(bpm);
+    transport.U8(TRANSPORT_OVERDUB | TRANSPORT_BLEND);  // Engine defaults
+    PutChunk(image.data(), CHUNK_TRANSPORT, payload, transport.pos);
+
+    for(uint8_t t = 0; t < NUM_PATTERNS; t++)
+    {
+        Codec::Writer w(payload);
+        uint16_t      count = sequencer.GetTrackEventCount(t);
+        uint32_t      tick  = 0;
+        w.Varint(count);
+        for(uint16_t i = 0; i < count; i++)
+        {
+            const Sequencer::MidiEvent& ev = sequencer.GetTrackEvent(t, i);
+            PutTick(w, tick, ev.tick);
+            w.U8(ev.status);
+            w.U8(ev.data1);
+            w.U8(ev.data2);
+        }
+        PutChunk(image.data(), CHUNK_PATTERN + t, payload, w.pos);
+    }
+
+    for(uint8_t l = 0; l < NUM_AUTO_LANES; l++)
+    {
+        Codec::Writer w(payload);
+        uint32_t      tick = 0;
+        w.U8(AUTO_LANE_CCS[l]);
+        w.Varint(static_cast<uint32_t>(lanes[l].size()));
+        for(const Point& p : lanes[l])
+        {
+            PutTick(w, tick, p.tick);
+            w.U8(p.value);
+        }
+        PutChunk(image.data(), CHUNK_AUTO + l, payload, w.pos);
+    }
+}
+
+bool Import(const char* path, Stats& stats)
+{
+    std::vector<uint8_t> file;
+    if(!ReadFile(path, file))
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    sequencer.Init(pattern_ticks);
+    for(auto& lane : lanes)
+        lane.clear();
+    bpm       = DEFAULT_BPM;
+    tempo_set = false;
+    notes = points = dropped = 0;
+
+    Smf::Parser parser;
+    parser.Init(OnEvent, OnTempo);
+    parser.Feed(file.data(), file.size());
+    if(!parser.IsDone())
+    {
+        static const char* errors[] = {"truncated", "not a MIDI file",
+                                       "unsupported format (type 2 or SMPTE)", "malformed"};
+        fprintf(stderr, "%s: %s at byte %u\n", path, errors[static_cast<int>(parser.GetError())],
+                parser.GetPosition());
+        return false;
+    }
+
+    std::vector<uint8_t> image;
+    BuildImage(image);
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.bytes += file.size();
+    stats.events += notes + points;
+
+    std::string out = OutputPath(path, ".session");
+    if(!WriteFile(out, image.data(), image.size()))
+        return false;
+    printf("%s -> %s: type %u, %u tracks, %u PPQN, %u BPM, %u notes, %u points, %u dropped\n",
+           path, out.c_str(), parser.GetFormat(), parser.GetTrackCount(), parser.GetDivision(),
+           bpm, notes, points, dropped);
+    return true;
+}
+
+// ============================================================================
+// Export
+
+// Decoded image contents, sources for the writer
+std::vector<Smf::Event> sources[NUM_PATTERNS + NUM_AUTO_LANES];
+
+uint16_t SourceCount(uint8_t track)
+{
+    return static_cast<uint16_t>(sources[track].size());
+}
+
+void SourceEvent(uint8_t track, uint16_t index, Smf::Event& ev)
+{
+    ev = sources[track][index];
+}
+
+// Chunks that fail to decode export as empty tracks
+void DecodeImage(const Directory& dir)
+{
+    for(auto& source : sources)
+        source.clear();
+    bpm = DEFAULT_BPM;
+
+    const Chunk& transport = dir.Get(CHUNK_TRANSPORT);
+    if(transport.valid)
+    {
+        Codec::Reader r(transport.data, transport.len);
+        uint16_t      stored = r.U16();
+        if(r.ok && stored >= MIN_BPM && stored <= MAX_BPM)
+            bpm = stored;
+    }
+
+    for(uint8_t id = CHUNK_PATTERN; id < CHUNK_TRACKS; id++)
+    {
+        const Chunk& chunk = dir.Get(id);
+        if(!chunk.valid)
+            continue;
+        bool                     pattern = id < CHUNK_AUTO;
+        std::vector<Smf::Event>& source  = sources[id - CHUNK_PATTERN];
+        Codec::Reader            r(chunk.data, chunk.len);
+        uint8_t                  cc    = pattern ? 0 : r.U8();
+        uint32_t                 count = r.Varint();
+        uint32_t                 tick  = 0;
+        for(uint32_t i = 0; i < count && r.ok; i++)
+        {
+            Smf::Event ev;
+            ev.tick = GetTick(r, tick);
+            if(pattern)
+            {
+                ev.status = r.U8();
+                ev.data1  = r.U8();
+                ev.data2  = r.U8();
+            }
+            else
+            {
+                ev.status = 0xB0 | Sequencer::SYNTH_CHANNEL;
+                ev.data1  = cc;
+                ev.data2  = r.U8();
+            }
+            if(r.ok && (ev.status & 0x80) && ev.status < 0xF0)
+                source.push_back(ev);
+        }
+        if(!r.ok)
+        {
+            fprintf(stderr, "  %s %d: decode error, skipped\n", ChunkName(id),
+                    id - (pattern ? CHUNK_PATTERN : CHUNK_AUTO));
+            source.clear();
+        }
+    }
+}
+
+bool Export(const char* path, Stats& stats)
+{
+    std::vector<uint8_t> image;
+    if(!ReadFile(path, image))
+        return false;
+
+    auto      start = std::chrono::steady_clock::now();
+    Directory dir;
+    dir.Scan(image.data(), image.size());
+    if(dir.GetValidCount() == 0)
+    {
+        fprintf(stderr, "%s: no valid session chunks\n", path);
+        return false;
+    }
+    DecodeImage(dir);
+
+    Smf::Writer writer;
+    writer.Begin(NUM_PATTERNS + NUM_AUTO_LANES, SourceCount, SourceEvent, pattern_ticks,
+                 60000000 / bpm);
+    std::vector<uint8_t> file(writer.GetTotalSize());
+    size_t               len = writer.Fill(file.data(), file.size());
+    stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(len != file.size() || !writer.Done())
+    {
+        fprintf(stderr, "%s: writer produced %zu of %zu bytes\n", path, len, file.size());
+        return false;
+    }
+
+    size_t events = 0;
+    for(const auto& source : sources)
+        events += source.size();
+    stats.bytes += file.size();
+    stats.events += events;
+
+    std::string out = OutputPath(path, ".mid");
+    if(!WriteFile(out, file.data(), file.size()))
+        return false;
+    printf("%s -> %s: %zu events, %u BPM, %zu bytes\n", path, out.c_str(), events, bpm,
+           file.size());
+    return true;
+}
+
+void Usage()
+{
+    fprintf(stderr,
+            "usage: smf_tool import [-bars N] <file.mid>...\n"
+            "       smf_tool export [-bars N] <image>...\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        Usage();
+        return 1;
+    }
+    bool import = strcmp(argv[1], "import") == 0;
+    if(!import && strcmp(argv[1], "export") != 0)
+    {
+        Usage();
+        return 1;
+    }
+
+    int first = 2;
+    if(strcmp(argv[first], "-bars") == 0)
+    {
+        int bars = first + 1 < argc ? atoi(argv[first + 1]) : 0;
+        if(bars < 1 || bars > 64)
+        {
+            fprintf(stderr, "smf_tool: -bars takes 1-64\n");
+            return 1;
+        }
+        pattern_ticks = bars * TICKS_PER_BAR;
+        first += 2;
+    }
+    if(first >= argc)
+    {
+        Usage();
+        return 1;
+    }
+
+    Stats stats;
+    for(int i = first; i < argc; i++)
+    {
+        stats.files++;
+        if(!(import ? Import(argv[i], stats) : Export(argv[i], stats)))
+            stats.failed++;
+    }
+
+    // Conversion only: file I/O is outside the timed part
+    double seconds = stats.seconds > 0 ? stats.seconds : 1e-9;
+    printf("%zu file%s, %zu failed; %llu events, %.2f MB of MIDI in %.1f ms (%.1f MB/s)\n",
+           stats.files, stats.files == 1 ? "" : "s", stats.failed,
+           static_cast<unsigned long long>(stats.events), stats.bytes / 1e6, seconds * 1e3,
+           stats.bytes / 1e6 / seconds);
+    return stats.failed > 0 ? 1 : 0;
+}
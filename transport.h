@@ -197,6 +197,17 @@ class Engine
         SetBpm(static_cast<uint16_t>(new_bpm));
     }
 
+    /**
+     * Change the audio sample rate, keeping position and tempo
+     * The fraction of the current tick already elapsed carries over.
+     */
+    void SetSampleRate(float sample_rate)
+    {
+        accumulator_ *= sample_rate / sample_rate_;
+        sample_rate_ = sample_rate;
+        UpdateTickInterval();
+    }
+
     // Pattern length control
     void SetPatternBars(uint8_t bars)
     {
@@ -227,6 +238,16 @@ class Engine
 
     const Position& GetPosition() const { return position_; }
 
+    /**
+     * Progress from the current tick towards the next one (Q16, 0-65535)
+     * Lets the clock sync anchor the playhead between ticks.
+     */
+    uint16_t GetTickPhase() const
+    {
+        float phase = accumulator_ / samples_per_tick_;
+        return phase >= 1.0f ? 0xFFFF : static_cast<uint16_t>(phase * 65536.0f);
+    }
+
     /**
      * Check and clear state changed flag
      * Use this to know when to send TRANSPORT message
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef GROOVYDAISY_USB_TX_H
+#define GROOVYDAISY_USB_TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * GroovyDaisy USB Transmit Ring
+ *
+ * Outgoing protocol messages are built directly into a byte ring
+ * (Reserve/Commit, no intermediate copy). Once per main-loop iteration
+ * Flush() hands the oldest pending bytes to the CDC driver as a single
+ * transfer of up to MAX_TRANSFER bytes, so a burst of small messages (a
+ * state request answers with six or more) costs one transfer instead of one
+ * each.
+ *
+ * The CDC driver transmits straight from the buffer it is given, so a
+ * transfer's bytes stay reserved until the driver accepts the next one,
+ * which it only does once the previous one has completed. While it is busy
+ * data waits in the ring; when the ring is full new messages are dropped
+ * and counted. Messages never straddle the end of the ring: if one does not
+ * fit, the tail is padded and skipped by Flush().
+ *
+ * Main loop only - not safe to call from interrupts.
+ */
+
+namespace UsbTx
+{
+
+// Ring capacity (power of two)
+constexpr uint32_t RING_SIZE = 4096;
+
+// Largest single CDC transfer (multiple of the 64-byte full-speed packet)
+constexpr uint32_t MAX_TRANSFER = 1024;
+
+/**
+ * Start a transfer; returns false if the driver is still busy
+ */
+typedef bool (*TransmitFn)(uint8_t* data, size_t len);
+
+struct Stats
+{
+    uint32_t messages;       // Messages committed
+    uint32_t bytes;          // Bytes handed to the driver
+    uint32_t transfers;      // Transfers accepted by the driver
+    uint32_t busy;           // Flushes refused because a transfer was in flight
+    uint32_t drops;          // Messages dropped because the ring was full
+    uint32_t high_water;     // Most bytes held in the ring at once
+};
+
+class Ring
+{
+  public:
+    void Init(TransmitFn transmit)
+    {
+        transmit_    = transmit;
+        head_        = 0;
+        sent_        = 0;
+        free_        = 0;
+        pad_start_   = 0;
+        pad_end_     = 0;
+        pad_pending_ = false;
+        stats_       = Stats();
+    }
+
+    /**
+     * Reserve contiguous space for one message
+     * Returns nullptr (and counts a drop) if the ring cannot hold it.
+     */
+    uint8_t* Reserve(uint32_t len)
+    {
+        if(!CanReserve(len))
+        {
+            stats_.drops++;
+            return nullptr;
+        }
+
+        uint32_t pos = head_ & (RING_SIZE - 1);
+        uint32_t pad = (pos + len > RING_SIZE) ? RING_SIZE - pos : 0;
+
+        if(pad > 0)
+        {
+            pad_start_   = head_;
+            pad_end_     = head_ + pad;
+            pad_pending_ = true;
+            head_ += pad;
+        }
+        return &buf_[head_ & (RING_SIZE - 1)];
+    }
+
+    /**
+     * True if Reserve(len) would succeed now (for senders that would rather
+     * wait than drop)
+     */
+    bool CanReserve(uint32_t len) const
+    {
+        uint32_t pos = head_ & (RING_SIZE - 1);
+        uint32_t pad = (pos + len > RING_SIZE) ? RING_SIZE - pos : 0;
+
+        // Only one padded gap can be outstanding at a time
+        return len <= RING_SIZE && !(pad > 0 && pad_pending_)
+               && (head_ - free_) + pad + len <= RING_SIZE;
+    }
+
+    /**
+     * Publish len bytes written to the last Reserve()
+     */
+    void Commit(uint32_t len)
+    {
+        head_ += len;
+        stats_.messages++;
+        if(head_ - free_ > stats_.high_water)
+        {
+            stats_.high_water = head_ - free_;
+        }
+    }
+
+    /**
+     * Hand pending bytes to the driver (one transfer at most)
+     * Returns true if a transfer was started.
+     */
+    bool Flush()
+    {
+        if(pad_pending_ && sent_ == pad_start_)
+        {
+            sent_        = pad_end_;  // Skip the padded gap
+            pad_pending_ = false;
+        }
+        if(sent_ == head_)
+            return false;
+
+        uint32_t len = head_ - sent_;
+        if(pad_pending_ && pad_start_ - sent_ < len)
+        {
+            len = pad_start_ - sent_;  // Stop at the gap
+        }
+        uint32_t pos    = sent_ & (RING_SIZE - 1);
+        uint32_t to_end = RING_SIZE - pos;
+        if(len > to_end)
+        {
+            len = to_end;  // Data that filled the ring exactly continues at 0
+        }
+        if(len > MAX_TRANSFER)
+        {
+            len = MAX_TRANSFER;
+        }
+
+        if(!transmit_(&buf_[pos], len))
+        {
+            stats_.busy++;
+            return false;
+        }
+
+        // The driver accepted this transfer, so the previous one is done
+        free_ = sent_;
+        sent_ += len;
+        stats_.transfers++;
+        stats_.bytes += len;
+        return true;
+    }
+
+    /**
+     * Bytes committed but not yet handed to the driver
+     */
+    uint32_t Pending() const { return head_ - sent_; }
+
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    uint8_t    buf_[RING_SIZE];
+    TransmitFn transmit_;
+    uint32_t   head_;       // Next byte to reserve (running count)
+    uint32_t   sent_;       // Next byte to hand to the driver
+    uint32_t   free_;       // Start of the transfer the driver may still be reading
+    uint32_t   pad_start_;  // Padded gap at the end of the ring [pad_start_, pad_end_)
+    uint32_t   pad_end_;
+    bool       pad_pending_;
+    Stats      stats_;
+};
+
+} // namespace UsbTx
+
+#endif // GROOVYDAISY_USB_TX_H